@@ -0,0 +1,106 @@
+/*
+ * Poly2Tri Copyright (c) 2009-2010, Poly2Tri Contributors
+ * http://code.google.com/p/poly2tri/
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * * Neither the name of Poly2Tri nor the names of its contributors may be
+ *   used to endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <vector>
+#include <cstddef>
+#include <new>
+
+namespace p2t {
+
+/**
+ * Storage for the objects of one triangulation, which all go away together.
+ *
+ * Objects are constructed with placement new in the memory returned by
+ * Allocate(), in blocks that double in size, and are never freed one by
+ * one. Clear() destroys them all but keeps the blocks, so a context that
+ * is reset and used again doesn't allocate until it needs more than the
+ * last time.
+ */
+template <class T>
+class Pool {
+public:
+
+  Pool() : block_(0), used_(0)
+  {
+  }
+
+  ~Pool()
+  {
+    Clear();
+    for (size_t i = 0; i < blocks_.size(); i++)
+      ::operator delete(blocks_[i]);
+  }
+
+  /// Returns uninitialized memory for one more object
+  void* Allocate()
+  {
+    if (block_ < blocks_.size() && used_ == Capacity(block_)) {
+      block_++;
+      used_ = 0;
+    }
+    if (block_ == blocks_.size())
+      blocks_.push_back(static_cast<T*>(::operator new(Capacity(block_) * sizeof(T))));
+    return blocks_[block_] + used_++;
+  }
+
+  /// Destroys every object, keeping the memory for reuse
+  void Clear()
+  {
+    for (size_t b = 0; b < blocks_.size() && b <= block_; b++) {
+      size_t count = b < block_ ? Capacity(b) : used_;
+      for (size_t i = 0; i < count; i++)
+        blocks_[b][i].~T();
+    }
+    block_ = 0;
+    used_ = 0;
+  }
+
+private:
+
+  Pool(const Pool&);
+  Pool& operator=(const Pool&);
+
+  static size_t Capacity(size_t block)
+  {
+    return size_t(32) << block;
+  }
+
+  std::vector<T*> blocks_;
+  size_t block_;
+  size_t used_;
+};
+
+}
+
+#endif
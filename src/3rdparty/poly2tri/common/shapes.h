@@ -42,6 +42,50 @@ namespace p2t {
 
 struct Edge;
 
+/// The edges a point is the upper end of. Those are one or two for almost
+/// every point, so they are kept in place and only more go to the heap.
+class EdgeList {
+public:
+
+  EdgeList() : size_(0)
+  {
+    inline_[0] = inline_[1] = NULL;
+  }
+
+  void push_back(Edge* edge)
+  {
+    if (size_ < kInline)
+      inline_[size_] = edge;
+    else
+      more_.push_back(edge);
+    size_++;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  Edge* operator[](size_t i) const
+  {
+    return i < kInline ? inline_[i] : more_[i - kInline];
+  }
+
+  void clear()
+  {
+    size_ = 0;
+    more_.clear();
+  }
+
+private:
+
+  static const size_t kInline = 2;
+
+  Edge* inline_[kInline];
+  std::vector<Edge*> more_;
+  size_t size_;
+};
+
 struct Point {
 
   float x, y;
@@ -54,7 +98,7 @@ struct Point {
   }
 
   /// The edges this point constitutes an upper ending point
-  std::vector<Edge*> edge_list;
+  EdgeList edge_list;
 
   /// Construct using coordinates.
   Point(float x, float y) : x(x), y(y) {}
@@ -38,6 +38,11 @@ CDT::CDT(std::vector<Point*> polyline)
   sweep_ = new Sweep;
 }
 
+void CDT::Reset(const std::vector<Point*>& polyline)
+{
+  sweep_context_->Reset(polyline);
+}
+
 void CDT::AddHole(std::vector<Point*> polyline)
 {
   sweep_context_->AddHole(polyline);
@@ -57,6 +62,11 @@ std::vector<p2t::Triangle*> CDT::GetTriangles()
   return sweep_context_->GetTriangles();
 }
 
+void CDT::GetTriangleIndices(const Point* points, std::vector<int>& indices)
+{
+  sweep_context_->GetTriangleIndices(points, indices);
+}
+
 std::list<p2t::Triangle*> CDT::GetMap()
 {
   return sweep_context_->GetMap();
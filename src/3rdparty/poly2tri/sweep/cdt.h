@@ -55,6 +55,15 @@ public:
    */
   CDT(std::vector<Point*> polyline);
 
+  /**
+   * Start over with a new polyline. The memory used by the last
+   * triangulation is kept for the next, so one CDT can triangulate many
+   * polygons without allocating for each.
+   *
+   * @param polyline
+   */
+  void Reset(const std::vector<Point*>& polyline);
+
    /**
    * Destructor - clean up memory
    */
@@ -84,6 +93,15 @@ public:
    */
   std::vector<Triangle*> GetTriangles();
 
+  /**
+   * Get CDT triangles as three indices each into points, which must hold
+   * every point of the polyline, holes and Steiner points
+   *
+   * @param points
+   * @param indices
+   */
+  void GetTriangleIndices(const Point* points, std::vector<int>& indices);
+
   /**
    * Get triangle map
    */
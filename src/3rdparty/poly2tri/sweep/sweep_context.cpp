@@ -35,6 +35,7 @@
 namespace p2t {
 
 SweepContext::SweepContext(std::vector<Point*> polyline)
+  : front_(NULL), head_(NULL), tail_(NULL), af_head_(NULL), af_middle_(NULL), af_tail_(NULL)
 {
   basin = Basin();
   edge_event = EdgeEvent();
@@ -44,6 +45,30 @@ SweepContext::SweepContext(std::vector<Point*> polyline)
   InitEdges(points_);
 }
 
+void SweepContext::Reset(const std::vector<Point*>& polyline)
+{
+  delete front_;
+  front_ = NULL;
+  head_ = tail_ = NULL;
+  af_head_ = af_middle_ = af_tail_ = NULL;
+
+  triangle_pool_.Clear();
+  node_pool_.Clear();
+  edge_pool_.Clear();
+  point_pool_.Clear();
+
+  edge_list.clear();
+  triangles_.clear();
+  map_.clear();
+
+  basin.Clear();
+  edge_event = EdgeEvent();
+
+  points_ = polyline;
+
+  InitEdges(points_);
+}
+
 void SweepContext::AddHole(std::vector<Point*> polyline)
 {
   InitEdges(polyline);
@@ -63,7 +88,17 @@ std::vector<Triangle*> SweepContext::GetTriangles()
 
 std::list<Triangle*> SweepContext::GetMap()
 {
-  return map_;
+  return std::list<Triangle*>(map_.begin(), map_.end());
+}
+
+void SweepContext::GetTriangleIndices(const Point* points, std::vector<int>& indices)
+{
+  indices.clear();
+  indices.reserve(3 * triangles_.size());
+  for (size_t i = 0; i < triangles_.size(); i++) {
+    for (int j = 0; j < 3; j++)
+      indices.push_back(int(triangles_[i]->GetPoint(j) - points));
+  }
 }
 
 void SweepContext::InitTriangulation()
@@ -86,20 +121,20 @@ void SweepContext::InitTriangulation()
 
   float dx = kAlpha * (xmax - xmin);
   float dy = kAlpha * (ymax - ymin);
-  head_ = new Point(xmax + dx, ymin - dy);
-  tail_ = new Point(xmin - dx, ymin - dy);
+  head_ = new (point_pool_.Allocate()) Point(xmax + dx, ymin - dy);
+  tail_ = new (point_pool_.Allocate()) Point(xmin - dx, ymin - dy);
 
   // Sort points along y-axis
   std::sort(points_.begin(), points_.end(), cmp);
 
 }
 
-void SweepContext::InitEdges(std::vector<Point*> polyline)
+void SweepContext::InitEdges(const std::vector<Point*>& polyline)
 {
   int num_points = polyline.size();
   for (int i = 0; i < num_points; i++) {
     int j = i < num_points - 1 ? i + 1 : 0;
-    edge_list.push_back(new Edge(*polyline[i], *polyline[j]));
+    edge_list.push_back(new (edge_pool_.Allocate()) Edge(*polyline[i], *polyline[j]));
   }
 }
 
@@ -124,13 +159,13 @@ void SweepContext::CreateAdvancingFront(std::vector<Node*> nodes)
 
   (void) nodes;
   // Initial triangle
-  Triangle* triangle = new Triangle(*points_[0], *tail_, *head_);
+  Triangle* triangle = NewTriangle(*points_[0], *tail_, *head_);
 
   map_.push_back(triangle);
 
-  af_head_ = new Node(*triangle->GetPoint(1), *triangle);
-  af_middle_ = new Node(*triangle->GetPoint(0), *triangle);
-  af_tail_ = new Node(*triangle->GetPoint(2));
+  af_head_ = new (node_pool_.Allocate()) Node(*triangle->GetPoint(1), *triangle);
+  af_middle_ = new (node_pool_.Allocate()) Node(*triangle->GetPoint(0), *triangle);
+  af_tail_ = NewNode(*triangle->GetPoint(2));
   front_ = new AdvancingFront(*af_head_, *af_tail_);
 
   // TODO: More intuitive if head is middles next and not previous?
@@ -143,7 +178,18 @@ void SweepContext::CreateAdvancingFront(std::vector<Node*> nodes)
 
 void SweepContext::RemoveNode(Node* node)
 {
-  delete node;
+  // freed with the rest of the nodes
+  (void) node;
+}
+
+Node* SweepContext::NewNode(Point& point)
+{
+  return new (node_pool_.Allocate()) Node(point);
+}
+
+Triangle* SweepContext::NewTriangle(Point& a, Point& b, Point& c)
+{
+  return new (triangle_pool_.Allocate()) Triangle(a, b, c);
 }
 
 void SweepContext::MapTriangleToNodes(Triangle& t)
@@ -159,7 +205,7 @@ void SweepContext::MapTriangleToNodes(Triangle& t)
 
 void SweepContext::RemoveFromMap(Triangle* triangle)
 {
-  map_.remove(triangle);
+  map_.erase(std::remove(map_.begin(), map_.end(), triangle), map_.end());
 }
 
 void SweepContext::MeshClean(Triangle& triangle)
@@ -177,25 +223,10 @@ void SweepContext::MeshClean(Triangle& triangle)
 SweepContext::~SweepContext()
 {
 
-    // Clean up memory
+    // Clean up memory, the points, nodes, triangles and edges go with
+    // their pools
 
-    delete head_;
-    delete tail_;
     delete front_;
-    delete af_head_;
-    delete af_middle_;
-    delete af_tail_;
-
-    typedef std::list<Triangle*> type_list;
-
-    for (type_list::iterator iter = map_.begin(); iter != map_.end(); ++iter) {
-        Triangle* ptr = *iter;
-        delete ptr;
-    }
-
-     for (unsigned int i = 0; i < edge_list.size(); i++) {
-        delete edge_list[i];
-    }
 
 }
 
@@ -35,6 +35,9 @@
 #include <list>
 #include <vector>
 #include <cstddef>
+#include "../common/shapes.h"
+#include "../common/pool.h"
+#include "advancing_front.h"
 
 namespace p2t {
 
@@ -56,6 +59,9 @@ SweepContext(std::vector<Point*> polyline);
 /// Destructor
 ~SweepContext();
 
+/// Start over with a new polyline, keeping the memory of the last run
+void Reset(const std::vector<Point*>& polyline);
+
 void set_head(Point* p1);
 
 Point* head();
@@ -70,6 +76,10 @@ Node& LocateNode(Point& point);
 
 void RemoveNode(Node* node);
 
+Node* NewNode(Point& point);
+
+Triangle* NewTriangle(Point& a, Point& b, Point& c);
+
 void CreateAdvancingFront(std::vector<Node*> nodes);
 
 /// Try to map a node to all sides of this triangle that don't have a neighbor
@@ -94,6 +104,9 @@ void MeshClean(Triangle& triangle);
 std::vector<Triangle*> GetTriangles();
 std::list<Triangle*> GetMap();
 
+/// Writes three indices into points for each triangle
+void GetTriangleIndices(const Point* points, std::vector<int>& indices);
+
 std::vector<Edge*> edge_list;
 
 struct Basin {
@@ -134,9 +147,15 @@ private:
 friend class Sweep;
 
 std::vector<Triangle*> triangles_;
-std::list<Triangle*> map_;
+std::vector<Triangle*> map_;
 std::vector<Point*> points_;
 
+// everything created during a triangulation lives here
+Pool<Triangle> triangle_pool_;
+Pool<Node> node_pool_;
+Pool<Edge> edge_pool_;
+Pool<Point> point_pool_;
+
 // Advancing front
 AdvancingFront* front_;
 // head point used with advancing front
@@ -147,7 +166,7 @@ Point* tail_;
 Node *af_head_, *af_middle_, *af_tail_;
 
 void InitTriangulation();
-void InitEdges(std::vector<Point*> polyline);
+void InitEdges(const std::vector<Point*>& polyline);
 
 };
 
@@ -65,6 +65,7 @@
 #include "qdeclarativegeomaptype_p.h"
 #include "qdeclarativerectanglemapitem_p.h"
 #include "qdeclarativecirclemapitem_p.h"
+#include "qdeclarativecirclecollectionmapitem_p.h"
 #include "qdeclarativeroutemapitem_p.h"
 #include "qdeclarativepolylinemapitem_p.h"
 #include "qdeclarativepolygonmapitem_p.h"
@@ -202,6 +203,10 @@ public:
             qRegisterMetaType<QPlaceUser>("QPlaceUser");
             qRegisterMetaType<QPlaceAttribute>("QPlaceAttribute");
             qRegisterMetaType<QPlaceContactDetail>("QPlaceContactDetail");
+
+            // @uri QtLocation 5.2
+
+            qmlRegisterType<QDeclarativeCircleCollectionMapItem>(uri, 5, 2, "MapCircleCollection");
         } else {
             qDebug() << "Unsupported URI given to load location QML plugin: " << QLatin1String(uri);
         }
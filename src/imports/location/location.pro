@@ -38,11 +38,16 @@ HEADERS += qdeclarativeposition_p.h \
            qdeclarativegeomapquickitem_p.h \
            mapnode_p.h \
            qdeclarativecirclemapitem_p.h \
+           qdeclarativecirclecollectionmapitem_p.h \
            qdeclarativerectanglemapitem_p.h \
            qdeclarativepolygonmapitem_p.h \
            qdeclarativepolylinemapitem_p.h \
            qdeclarativeroutemapitem_p.h \
            qgeomapitemgeometry_p.h \
+           qgeomapgeometryjob_p.h \
+           qgeomappolylinehitgrid_p.h \
+           qgeomappolygontriangles_p.h \
+           qgeomapcirclebatch_p.h \
            qdeclarativegeomapcopyrightsnotice_p.h \
            qdeclarativegeomapgesturearea_p.h \
            error_messages.h \
@@ -73,11 +78,16 @@ SOURCES += qdeclarativeposition.cpp \
            qdeclarativegeomapquickitem.cpp \
            mapnode.cpp \
            qdeclarativecirclemapitem.cpp \
+           qdeclarativecirclecollectionmapitem.cpp \
            qdeclarativerectanglemapitem.cpp \
            qdeclarativepolygonmapitem.cpp \
            qdeclarativepolylinemapitem.cpp \
            qdeclarativeroutemapitem.cpp \
            qgeomapitemgeometry.cpp \
+           qgeomapgeometryjob.cpp \
+           qgeomappolylinehitgrid.cpp \
+           qgeomappolygontriangles.cpp \
+           qgeomapcirclebatch.cpp \
            qdeclarativegeomapcopyrightsnotice.cpp \
            qdeclarativegeomapgesturearea.cpp \
            error_messages.cpp \
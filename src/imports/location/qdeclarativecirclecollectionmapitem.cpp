@@ -0,0 +1,676 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qdeclarativecirclecollectionmapitem_p.h"
+#include "qgeoprojection_p.h"
+
+#include <QtCore/QAbstractItemModel>
+#include <QtQuick/QSGGeometryNode>
+#include <QtQuick/qsgsimplematerial.h>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QGenericMatrix>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \qmltype MapCircleCollection
+    \instantiates QDeclarativeCircleCollectionMapItem
+    \inqmlmodule QtLocation 5.0
+    \ingroup qml-QtLocation5-maps
+    \since Qt Location 5.2
+
+    \brief The MapCircleCollection type displays a circle on a Map for each
+    row of a model.
+
+    The MapCircleCollection type draws one circle for every row of its
+    \l model, all of them in a single draw call. It is meant for views
+    showing thousands of points of the same kind, such as the vehicles
+    of a fleet or the results of a search, where a MapItemView with a
+    MapCircle or MapQuickItem delegate would create an item for each row.
+
+    Each circle is placed at the coordinate from the \l coordinateRole
+    of its row. Its radius and fill color come from the \l radiusRole and
+    \l colorRole if the model has them, and from the \l radius and \l color
+    properties otherwise. The radius is in meters on the ground, or in
+    pixels on the screen when \l radiusUnit is \c MapCircleCollection.Pixels,
+    which suits markers that keep their size as the map zooms.
+
+    By default, the circles are displayed as a 1 pixel black border with
+    no fill. All circles share the border.color and border.width
+    properties.
+
+    \section2 Performance
+
+    The circles are kept as one vertex buffer which the graphics hardware
+    places on the screen. Panning, zooming, rotating and tilting the map
+    only change the transform it is drawn with, whatever the number of
+    circles, and changes to the model rebuild the buffer once per frame.
+    Unlike MapCircle, the circles are exact on the screen and are not
+    bent near the poles.
+
+    \section2 Example Usage
+
+    The following snippet shows a map with a red dot of 6 pixels radius at
+    the position of each vehicle in a model. MapCircleCollection needs
+    \c {import QtLocation 5.2}.
+
+    \code
+    Map {
+        MapCircleCollection {
+            model: vehicleModel
+            coordinateRole: "position"
+            radius: 6
+            radiusUnit: MapCircleCollection.Pixels
+            color: "red"
+            border.width: 0
+        }
+    }
+    \endcode
+*/
+
+struct MapCircleCollectionState
+{
+    QMatrix3x3 transform;
+    float pixelsPerUnit;
+    float geographic;
+    QColor borderColor;
+    float borderWidth;
+};
+
+class MapCircleCollectionShader : public QSGSimpleMaterialShader<MapCircleCollectionState>
+{
+    QSG_DECLARE_SIMPLE_SHADER(MapCircleCollectionShader, MapCircleCollectionState)
+
+public:
+    const char *vertexShader() const;
+    const char *fragmentShader() const;
+    QList<QByteArray> attributes() const;
+    void updateState(const MapCircleCollectionState *state, const MapCircleCollectionState *);
+    void resolveUniforms();
+
+private:
+    int transformId_;
+    int pixelsPerUnitId_;
+    int geographicId_;
+    int borderColorId_;
+    int borderWidthId_;
+};
+
+// the corner of the quad is offset in mercator space for geographic
+// circles and on the screen for the others, keeping w for perspective
+const char *MapCircleCollectionShader::vertexShader() const
+{
+    return
+        "uniform highp mat4 qt_Matrix;                                      \n"
+        "uniform highp mat3 transform;                                      \n"
+        "uniform highp float pixelsPerUnit;                                 \n"
+        "uniform highp float geographic;                                    \n"
+        "attribute highp vec2 center;                                       \n"
+        "attribute highp vec2 corner;                                       \n"
+        "attribute highp float radius;                                      \n"
+        "attribute lowp vec4 color;                                         \n"
+        "varying highp vec2 coord;                                          \n"
+        "varying highp float pixelRadius;                                   \n"
+        "varying lowp vec4 fillColor;                                       \n"
+        "void main() {                                                      \n"
+        "    highp vec2 offset = corner * radius;                           \n"
+        "    highp vec3 p = transform * vec3(center + offset * geographic, 1.0); \n"
+        "    p.xy += offset * (1.0 - geographic) * p.z;                     \n"
+        "    coord = corner;                                                \n"
+        "    pixelRadius = radius * mix(1.0, pixelsPerUnit, geographic);    \n"
+        "    fillColor = color;                                             \n"
+        "    gl_Position = qt_Matrix * vec4(p.xy, 0.0, p.z);                \n"
+        "}";
+}
+
+const char *MapCircleCollectionShader::fragmentShader() const
+{
+    return
+        "uniform lowp float qt_Opacity;                                     \n"
+        "uniform lowp vec4 borderColor;                                     \n"
+        "uniform highp float borderWidth;                                   \n"
+        "varying highp vec2 coord;                                          \n"
+        "varying highp float pixelRadius;                                   \n"
+        "varying lowp vec4 fillColor;                                       \n"
+        "void main() {                                                      \n"
+        "    highp float d = length(coord) * pixelRadius;                   \n"
+        "    lowp float outside = clamp(d - pixelRadius + 0.5, 0.0, 1.0);   \n"
+        "    lowp float border = clamp(d - pixelRadius + borderWidth + 0.5, 0.0, 1.0); \n"
+        "    lowp vec4 color = mix(fillColor, borderColor, border);         \n"
+        "    gl_FragColor = color * (1.0 - outside) * qt_Opacity;           \n"
+        "}";
+}
+
+QList<QByteArray> MapCircleCollectionShader::attributes() const
+{
+    return QList<QByteArray>() << "center" << "corner" << "radius" << "color";
+}
+
+void MapCircleCollectionShader::updateState(const MapCircleCollectionState *state,
+                                            const MapCircleCollectionState *)
+{
+    program()->setUniformValue(transformId_, state->transform);
+    program()->setUniformValue(pixelsPerUnitId_, state->pixelsPerUnit);
+    program()->setUniformValue(geographicId_, state->geographic);
+    QColor c = state->borderColor;
+    program()->setUniformValue(borderColorId_, c.redF() * c.alphaF(), c.greenF() * c.alphaF(),
+                               c.blueF() * c.alphaF(), c.alphaF());
+    program()->setUniformValue(borderWidthId_, state->borderWidth);
+}
+
+void MapCircleCollectionShader::resolveUniforms()
+{
+    transformId_ = program()->uniformLocation("transform");
+    pixelsPerUnitId_ = program()->uniformLocation("pixelsPerUnit");
+    geographicId_ = program()->uniformLocation("geographic");
+    borderColorId_ = program()->uniformLocation("borderColor");
+    borderWidthId_ = program()->uniformLocation("borderWidth");
+}
+
+static const QSGGeometry::AttributeSet &circleAttributes()
+{
+    static QSGGeometry::Attribute attributes[] = {
+        QSGGeometry::Attribute::create(0, 2, GL_FLOAT, true),
+        QSGGeometry::Attribute::create(1, 2, GL_FLOAT),
+        QSGGeometry::Attribute::create(2, 1, GL_FLOAT),
+        QSGGeometry::Attribute::create(3, 4, GL_UNSIGNED_BYTE)
+    };
+    static QSGGeometry::AttributeSet set = {
+        4, sizeof(QGeoMapCircleBatch::Vertex), attributes
+    };
+    return set;
+}
+
+class MapCircleCollectionNode : public QSGGeometryNode
+{
+public:
+    MapCircleCollectionNode();
+    ~MapCircleCollectionNode();
+
+    void update(QGeoMapCircleBatch *batch, const QColor &borderColor, qreal borderWidth);
+
+private:
+    QSGGeometry geometry_;
+    QSGSimpleMaterial<MapCircleCollectionState> *material_;
+};
+
+MapCircleCollectionNode::MapCircleCollectionNode()
+    : geometry_(circleAttributes(), 0),
+      material_(MapCircleCollectionShader::createMaterial())
+{
+    geometry_.setDrawingMode(GL_TRIANGLES);
+    material_->setFlag(QSGMaterial::Blending);
+    setGeometry(&geometry_);
+    setMaterial(material_);
+}
+
+MapCircleCollectionNode::~MapCircleCollectionNode()
+{
+    delete material_;
+}
+
+void MapCircleCollectionNode::update(QGeoMapCircleBatch *batch, const QColor &borderColor,
+                                     qreal borderWidth)
+{
+    if (batch->isVertexDataDirty()) {
+        geometry_.allocate(batch->vertexCount());
+        batch->fillVertices(static_cast<QGeoMapCircleBatch::Vertex *>(geometry_.vertexData()));
+        markDirty(DirtyGeometry);
+    }
+
+    // the transform takes the place of regenerating any geometry
+    const QTransform t = batch->transform();
+    const float matrix[] = { float(t.m11()), float(t.m21()), float(t.m31()),
+                             float(t.m12()), float(t.m22()), float(t.m32()),
+                             float(t.m13()), float(t.m23()), float(t.m33()) };
+    MapCircleCollectionState *state = material_->state();
+    state->transform = QMatrix3x3(matrix);
+    state->pixelsPerUnit = batch->pixelsPerUnit();
+    state->geographic = batch->radiusUnit() == QGeoMapCircleBatch::Meters ? 1.0f : 0.0f;
+    state->borderColor = borderColor;
+    state->borderWidth = borderWidth;
+    markDirty(DirtyMaterial);
+}
+
+QDeclarativeCircleCollectionMapItem::QDeclarativeCircleCollectionMapItem(QQuickItem *parent)
+    : QDeclarativeGeoMapItemBase(parent),
+      coordinateRole_(QLatin1String("coordinate")),
+      radiusRole_(QLatin1String("radius")),
+      colorRole_(QLatin1String("color")),
+      radius_(0),
+      color_(Qt::transparent),
+      circlesDirty_(true)
+{
+    setFlag(ItemHasContents, true);
+    QObject::connect(&border_, SIGNAL(colorChanged(QColor)),
+                     this, SLOT(updateMaterial()));
+    QObject::connect(&border_, SIGNAL(widthChanged(qreal)),
+                     this, SLOT(updateMaterial()));
+}
+
+QDeclarativeCircleCollectionMapItem::~QDeclarativeCircleCollectionMapItem()
+{
+}
+
+/*!
+    \internal
+*/
+void QDeclarativeCircleCollectionMapItem::setMap(QDeclarativeGeoMap *quickMap, QGeoMap *map)
+{
+    QDeclarativeGeoMapItemBase::setMap(quickMap, map);
+    if (map)
+        updateMapItem();
+}
+
+/*!
+    \qmlproperty model QtLocation5::MapCircleCollection::model
+
+    This property holds the model with a row for each circle to draw.
+*/
+QVariant QDeclarativeCircleCollectionMapItem::model() const
+{
+    return modelVariant_;
+}
+
+void QDeclarativeCircleCollectionMapItem::setModel(const QVariant &model)
+{
+    if (model == modelVariant_)
+        return;
+
+    QAbstractItemModel *itemModel = 0;
+    if (QObject *object = qvariant_cast<QObject *>(model))
+        itemModel = qobject_cast<QAbstractItemModel *>(object);
+
+    if (itemModel_)
+        itemModel_->disconnect(this);
+
+    modelVariant_ = model;
+    itemModel_ = itemModel;
+    if (itemModel_) {
+        QObject::connect(itemModel_, SIGNAL(modelReset()),
+                         this, SLOT(markCirclesDirty()));
+        QObject::connect(itemModel_, SIGNAL(layoutChanged()),
+                         this, SLOT(markCirclesDirty()));
+        QObject::connect(itemModel_, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                         this, SLOT(markCirclesDirty()));
+        QObject::connect(itemModel_, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+                         this, SLOT(markCirclesDirty()));
+        QObject::connect(itemModel_, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
+                         this, SLOT(markCirclesDirty()));
+        QObject::connect(itemModel_, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+                         this, SLOT(markCirclesDirty()));
+    }
+
+    markCirclesDirty();
+    emit modelChanged();
+}
+
+/*!
+    \qmlproperty string MapCircleCollection::coordinateRole
+
+    This property holds the name of the model role holding the center of
+    each circle. Rows whose role holds no valid coordinate are read from
+    roles named \c latitude and \c longitude instead, and are left out if
+    they have neither.
+
+    The default is \c coordinate.
+*/
+QString QDeclarativeCircleCollectionMapItem::coordinateRole() const
+{
+    return coordinateRole_;
+}
+
+void QDeclarativeCircleCollectionMapItem::setCoordinateRole(const QString &role)
+{
+    if (coordinateRole_ == role)
+        return;
+    coordinateRole_ = role;
+    markCirclesDirty();
+    emit coordinateRoleChanged();
+}
+
+/*!
+    \qmlproperty string MapCircleCollection::radiusRole
+
+    This property holds the name of the model role holding the radius of
+    each circle, in the unit set by \l radiusUnit. Rows without it use the
+    \l radius property.
+
+    The default is \c radius.
+*/
+QString QDeclarativeCircleCollectionMapItem::radiusRole() const
+{
+    return radiusRole_;
+}
+
+void QDeclarativeCircleCollectionMapItem::setRadiusRole(const QString &role)
+{
+    if (radiusRole_ == role)
+        return;
+    radiusRole_ = role;
+    markCirclesDirty();
+    emit radiusRoleChanged();
+}
+
+/*!
+    \qmlproperty string MapCircleCollection::colorRole
+
+    This property holds the name of the model role holding the fill color
+    of each circle. Rows without it use the \l color property.
+
+    The default is \c color.
+*/
+QString QDeclarativeCircleCollectionMapItem::colorRole() const
+{
+    return colorRole_;
+}
+
+void QDeclarativeCircleCollectionMapItem::setColorRole(const QString &role)
+{
+    if (colorRole_ == role)
+        return;
+    colorRole_ = role;
+    markCirclesDirty();
+    emit colorRoleChanged();
+}
+
+/*!
+    \qmlproperty real MapCircleCollection::radius
+
+    This property holds the radius of the circles whose row has no radius
+    of its own, in the unit set by \l radiusUnit.
+*/
+qreal QDeclarativeCircleCollectionMapItem::radius() const
+{
+    return radius_;
+}
+
+void QDeclarativeCircleCollectionMapItem::setRadius(qreal radius)
+{
+    if (radius_ == radius)
+        return;
+    radius_ = radius;
+    markCirclesDirty();
+    emit radiusChanged(radius_);
+}
+
+/*!
+    \qmlproperty enumeration MapCircleCollection::radiusUnit
+
+    This property holds the unit of the radius of the circles.
+
+    \list
+    \li MapCircleCollection.Meters - meters on the ground, so that the
+        circles grow and shrink as the map zooms (default)
+    \li MapCircleCollection.Pixels - pixels on the screen, so that the
+        circles keep their size as the map zooms
+    \endlist
+*/
+QDeclarativeCircleCollectionMapItem::RadiusUnit QDeclarativeCircleCollectionMapItem::radiusUnit() const
+{
+    return static_cast<RadiusUnit>(batch_.radiusUnit());
+}
+
+void QDeclarativeCircleCollectionMapItem::setRadiusUnit(RadiusUnit unit)
+{
+    if (radiusUnit() == unit)
+        return;
+    batch_.setRadiusUnit(static_cast<QGeoMapCircleBatch::RadiusUnit>(unit));
+    update();
+    emit radiusUnitChanged();
+}
+
+/*!
+    \qmlproperty color MapCircleCollection::color
+
+    This property holds the fill color of the circles whose row has no
+    color of its own. For no fill, use a transparent color.
+*/
+QColor QDeclarativeCircleCollectionMapItem::color() const
+{
+    return color_;
+}
+
+void QDeclarativeCircleCollectionMapItem::setColor(const QColor &color)
+{
+    if (color_ == color)
+        return;
+    color_ = color;
+    markCirclesDirty();
+    emit colorChanged(color_);
+}
+
+/*!
+    \qmlproperty int MapCircleCollection::border.width
+    \qmlproperty color MapCircleCollection::border.color
+
+    These properties hold the width and color used to draw the border of
+    the circles. The width is in pixels and is independent of the zoom
+    level of the map.
+
+    The default values correspond to a black border with a width of 1 pixel.
+    For no line, use a width of 0 or a transparent color.
+*/
+QDeclarativeMapLineProperties *QDeclarativeCircleCollectionMapItem::border()
+{
+    return &border_;
+}
+
+/*!
+    \qmlproperty int MapCircleCollection::count
+
+    This property holds the number of circles drawn.
+*/
+int QDeclarativeCircleCollectionMapItem::count() const
+{
+    return batch_.size();
+}
+
+/*!
+    \qmlmethod int MapCircleCollection::indexAt(point position)
+
+    Returns the model row of the topmost circle at \a position, given in
+    the coordinates of the collection, or -1 if there is none. The
+    collection covers the map, so these are the coordinates of the map as
+    well, as in the mouse events of a MapMouseArea inside it.
+*/
+int QDeclarativeCircleCollectionMapItem::indexAt(const QPointF &position) const
+{
+    int i = batch_.indexAt(position);
+    return i < 0 ? -1 : rows_.at(i);
+}
+
+/*!
+    \internal
+*/
+bool QDeclarativeCircleCollectionMapItem::contains(const QPointF &point) const
+{
+    return batch_.indexAt(point) >= 0;
+}
+
+/*!
+    \internal
+    Model changes are gathered and read once per frame.
+*/
+void QDeclarativeCircleCollectionMapItem::markCirclesDirty()
+{
+    circlesDirty_ = true;
+    polish();
+}
+
+/*!
+    \internal
+*/
+void QDeclarativeCircleCollectionMapItem::updateMaterial()
+{
+    update();
+}
+
+/*!
+    \internal
+*/
+void QDeclarativeCircleCollectionMapItem::updatePolish()
+{
+    if (circlesDirty_)
+        updateCircles();
+}
+
+/*!
+    \internal
+*/
+void QDeclarativeCircleCollectionMapItem::updateCircles()
+{
+    circlesDirty_ = false;
+    int oldCount = batch_.size();
+    batch_.clear();
+    rows_.clear();
+
+    if (itemModel_) {
+        QHash<int, QByteArray> roleNames = itemModel_->roleNames();
+        int coordinateRole = roleNames.key(coordinateRole_.toLatin1(), -1);
+        int latitudeRole = roleNames.key("latitude", -1);
+        int longitudeRole = roleNames.key("longitude", -1);
+        int radiusRole = roleNames.key(radiusRole_.toLatin1(), -1);
+        int colorRole = roleNames.key(colorRole_.toLatin1(), -1);
+
+        int rows = itemModel_->rowCount();
+        batch_.reserve(rows);
+        rows_.reserve(rows);
+        for (int row = 0; row < rows; ++row) {
+            QModelIndex index = itemModel_->index(row, 0);
+
+            QGeoCoordinate center;
+            if (coordinateRole >= 0)
+                center = itemModel_->data(index, coordinateRole).value<QGeoCoordinate>();
+            if (!center.isValid() && latitudeRole >= 0 && longitudeRole >= 0) {
+                center = QGeoCoordinate(itemModel_->data(index, latitudeRole).toDouble(),
+                                        itemModel_->data(index, longitudeRole).toDouble());
+            }
+            if (!center.isValid())
+                continue;
+
+            qreal radius = radius_;
+            if (radiusRole >= 0) {
+                QVariant value = itemModel_->data(index, radiusRole);
+                if (value.isValid())
+                    radius = value.toReal();
+            }
+
+            QColor color = color_;
+            if (colorRole >= 0) {
+                QVariant value = itemModel_->data(index, colorRole);
+                if (value.isValid())
+                    color = value.value<QColor>();
+            }
+
+            batch_.append(center, radius, color);
+            rows_.append(row);
+        }
+    }
+
+    update();
+    if (batch_.size() != oldCount)
+        emit countChanged();
+}
+
+/*!
+    \internal
+    The collection covers the whole map; the camera only gives the
+    transform from mercator space to the screen, found from where four
+    points around the middle of the map show.
+*/
+void QDeclarativeCircleCollectionMapItem::updateMapItem()
+{
+    if (!map())
+        return;
+
+    setPosition(QPointF(0, 0));
+    setWidth(quickMap()->width());
+    setHeight(quickMap()->height());
+
+    qreal w = map()->width();
+    qreal h = map()->height();
+    QPointF screen[4] = { QPointF(w / 4, h / 4), QPointF(3 * w / 4, h / 4),
+                          QPointF(3 * w / 4, 3 * h / 4), QPointF(w / 4, 3 * h / 4) };
+    QDoubleVector2D mercator[4];
+    bool valid = w > 0 && h > 0;
+    for (int i = 0; i < 4 && valid; ++i) {
+        QGeoCoordinate coordinate = map()->screenPositionToCoordinate(screen[i], false);
+        valid = coordinate.isValid();
+        if (valid)
+            mercator[i] = QGeoProjection::coordToMercator(coordinate);
+    }
+
+    if (valid)
+        batch_.setProjection(mercator, screen);
+    update();
+}
+
+/*!
+    \internal
+*/
+void QDeclarativeCircleCollectionMapItem::afterViewportChanged(const QGeoMapViewportChangeEvent &event)
+{
+    Q_UNUSED(event);
+    updateMapItem();
+}
+
+/*!
+    \internal
+*/
+QSGNode *QDeclarativeCircleCollectionMapItem::updateMapItemPaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data);
+
+    if (!batch_.hasProjection() || batch_.size() == 0) {
+        delete oldNode;
+        return 0;
+    }
+
+    MapCircleCollectionNode *node = static_cast<MapCircleCollectionNode *>(oldNode);
+    if (!node)
+        node = new MapCircleCollectionNode();
+
+    node->update(&batch_, border_.color(), border_.width());
+    return node;
+}
+
+QT_END_NAMESPACE
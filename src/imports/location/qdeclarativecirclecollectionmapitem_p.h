@@ -0,0 +1,153 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QDECLARATIVECIRCLECOLLECTIONMAPITEM_H
+#define QDECLARATIVECIRCLECOLLECTIONMAPITEM_H
+
+#include "qdeclarativegeomapitembase_p.h"
+#include "qdeclarativepolylinemapitem_p.h"
+#include "qgeomapcirclebatch_p.h"
+
+#include <QtCore/QPointer>
+
+QT_BEGIN_NAMESPACE
+
+class QAbstractItemModel;
+
+class QDeclarativeCircleCollectionMapItem : public QDeclarativeGeoMapItemBase
+{
+    Q_OBJECT
+    Q_ENUMS(RadiusUnit)
+
+    Q_PROPERTY(QVariant model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(QString coordinateRole READ coordinateRole WRITE setCoordinateRole NOTIFY coordinateRoleChanged)
+    Q_PROPERTY(QString radiusRole READ radiusRole WRITE setRadiusRole NOTIFY radiusRoleChanged)
+    Q_PROPERTY(QString colorRole READ colorRole WRITE setColorRole NOTIFY colorRoleChanged)
+    Q_PROPERTY(qreal radius READ radius WRITE setRadius NOTIFY radiusChanged)
+    Q_PROPERTY(RadiusUnit radiusUnit READ radiusUnit WRITE setRadiusUnit NOTIFY radiusUnitChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(QDeclarativeMapLineProperties *border READ border CONSTANT)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum RadiusUnit {
+        Meters = QGeoMapCircleBatch::Meters,
+        Pixels = QGeoMapCircleBatch::Pixels
+    };
+
+    explicit QDeclarativeCircleCollectionMapItem(QQuickItem *parent = 0);
+    ~QDeclarativeCircleCollectionMapItem();
+
+    virtual void setMap(QDeclarativeGeoMap *quickMap, QGeoMap *map);
+    virtual QSGNode *updateMapItemPaintNode(QSGNode *, UpdatePaintNodeData *);
+
+    QVariant model() const;
+    void setModel(const QVariant &model);
+
+    QString coordinateRole() const;
+    void setCoordinateRole(const QString &role);
+
+    QString radiusRole() const;
+    void setRadiusRole(const QString &role);
+
+    QString colorRole() const;
+    void setColorRole(const QString &role);
+
+    qreal radius() const;
+    void setRadius(qreal radius);
+
+    RadiusUnit radiusUnit() const;
+    void setRadiusUnit(RadiusUnit unit);
+
+    QColor color() const;
+    void setColor(const QColor &color);
+
+    QDeclarativeMapLineProperties *border();
+
+    int count() const;
+
+    Q_INVOKABLE int indexAt(const QPointF &position) const;
+
+    bool contains(const QPointF &point) const;
+
+Q_SIGNALS:
+    void modelChanged();
+    void coordinateRoleChanged();
+    void radiusRoleChanged();
+    void colorRoleChanged();
+    void radiusChanged(qreal radius);
+    void radiusUnitChanged();
+    void colorChanged(const QColor &color);
+    void countChanged();
+
+protected:
+    void updatePolish();
+
+protected Q_SLOTS:
+    virtual void updateMapItem();
+    void afterViewportChanged(const QGeoMapViewportChangeEvent &event);
+
+private Q_SLOTS:
+    void markCirclesDirty();
+    void updateMaterial();
+
+private:
+    void updateCircles();
+
+    QVariant modelVariant_;
+    QPointer<QAbstractItemModel> itemModel_;
+    QString coordinateRole_;
+    QString radiusRole_;
+    QString colorRole_;
+    qreal radius_;
+    QColor color_;
+    QDeclarativeMapLineProperties border_;
+
+    QGeoMapCircleBatch batch_;
+    QVector<int> rows_;
+    bool circlesDirty_;
+};
+
+QT_END_NAMESPACE
+
+QML_DECLARE_TYPE(QDeclarativeCircleCollectionMapItem)
+
+#endif /* QDECLARATIVECIRCLECOLLECTIONMAPITEM_H */
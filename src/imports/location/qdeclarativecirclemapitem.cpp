@@ -364,6 +364,7 @@ void QDeclarativeCircleMapItem::setCenter(const QGeoCoordinate &center)
 
     center_ = center;
 
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     borderGeometry_.markSourceDirty();
     updateMapItem();
@@ -409,6 +410,7 @@ void QDeclarativeCircleMapItem::setRadius(qreal radius)
         return;
 
     radius_ = radius;
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     borderGeometry_.markSourceDirty();
     updateMapItem();
@@ -569,6 +571,28 @@ bool QDeclarativeCircleMapItem::contains(const QPointF &point) const
     return (geometry_.contains(point) || borderGeometry_.contains(point));
 }
 
+/*!
+    \internal
+    Circles around a pole have no box of their own and are always updated.
+*/
+QRectF QDeclarativeCircleMapItem::mercatorBoundingBox() const
+{
+    if (!center_.isValid() || crossEarthPole(center_, radius_))
+        return QRectF();
+
+    // the widest point of a circle on the sphere is this far in longitude
+    // from its center
+    qreal ratio = radius_ / (qgeocoordinate_EARTH_MEAN_RADIUS * 1000.0);
+    qreal sinHalfWidth = sin(ratio) / cos(qgeocoordinate_degToRad(center_.latitude()));
+    qreal halfWidth = asin(qMin<qreal>(sinHalfWidth, 1.0)) / (2.0 * M_PI);
+
+    QDoubleVector2D c = QGeoProjection::coordToMercator(center_);
+    qreal top = QGeoProjection::coordToMercator(center_.atDistanceAndAzimuth(radius_, 0.0)).y();
+    qreal bottom = QGeoProjection::coordToMercator(center_.atDistanceAndAzimuth(radius_, 180.0)).y();
+
+    return QRectF(QPointF(c.x() - halfWidth, top), QPointF(c.x() + halfWidth, bottom));
+}
+
 
 bool QDeclarativeCircleMapItem::preserveCircleGeometry (QList<QGeoCoordinate> &path,
                                     const QGeoCoordinate &center, qreal distance,
@@ -615,11 +639,13 @@ void QDeclarativeCircleMapItem::updateCirclePathForRendering(QList<QGeoCoordinat
         geoDistance += 360;
     qreal mapWidth = 360.0 / geoDistance;
     mapWidth = qMin(static_cast<int>(mapWidth), map()->width());
-    QPointF prev = map()->coordinateToScreenPosition(path.at(0), false);
+    QVector<double> screen;
+    QGeoMapItemGeometry::projectPath(*map(), path, screen);
+    QPointF prev(screen.at(0), screen.at(1));
     // find the points in path where wrapping occurs
     for (int i = 1; i <= path.count(); ++i) {
         int index = i % path.count();
-        QPointF point = map()->coordinateToScreenPosition(path.at(index), false);
+        QPointF point(screen.at(2 * index), screen.at(2 * index + 1));
         if ( (qAbs(point.x() - prev.x())) >= mapWidth/2.0 ) {
             wrapPathIndex << index;
             if (wrapPathIndex.size() == 2 || !(crossNorthPole && crossSouthPole))
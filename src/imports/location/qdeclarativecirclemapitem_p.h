@@ -99,6 +99,9 @@ Q_SIGNALS:
     void radiusChanged(qreal radius);
     void colorChanged(const QColor &color);
 
+protected:
+    QRectF mercatorBoundingBox() const;
+
 protected Q_SLOTS:
     virtual void updateMapItem();
     void updateMapItemAssumeDirty();
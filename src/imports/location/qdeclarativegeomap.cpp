@@ -49,12 +49,15 @@
 #include "qdeclarativegeoserviceprovider_p.h"
 #include <QtCore/QCoreApplication>
 #include <QtCore/qnumeric.h>
+#include <QtCore/qmath.h>
 #include <QThread>
 
 #include "qgeotilecache_p.h"
 #include "qgeocameradata_p.h"
 #include "qgeocameracapabilities_p.h"
 #include "qgeomapcontroller_p.h"
+#include "qgeoprojection_p.h"
+#include "qdoublevector2d_p.h"
 #include "mapnode_p.h"
 #include <cmath>
 
@@ -155,6 +158,12 @@ QT_BEGIN_NAMESPACE
     Further, more detailed notes on this are in the documentation for each
     map item type.
 
+    Map items that are well away from the visible area of the map are not
+    updated or drawn as the map moves, so a map can hold many thousands of
+    circles, rectangles, polylines and polygons as long as only some of them
+    are in view at a time. MapQuickItem and other items without a fixed
+    geographic extent are always updated.
+
     \section2 Example Usage
 
     The following snippet shows a simple Map and the necessary Plugin type
@@ -493,6 +502,10 @@ void QDeclarativeGeoMap::mappingManagerInitialized()
             SIGNAL(updateRequired()),
             this,
             SLOT(update()));
+    connect(map_,
+            SIGNAL(cameraDataChanged(QGeoCameraData)),
+            this,
+            SLOT(mapCameraDataChanged(QGeoCameraData)));
     connect(map_->mapController(),
             SIGNAL(centerChanged(AnimatableCoordinate)),
             this,
@@ -863,6 +876,21 @@ void QDeclarativeGeoMap::cameraStopped()
     map_->cameraStopped();
 }
 
+/*!
+    \qmlmethod object QtLocation5::Map::cacheStatistics()
+
+    Returns the hit, miss and eviction counters of the plugin's tile caches
+    along with decode and disk read latencies, for monitoring and for tuning
+    the cache sizes. Returns an empty object for plugins without a tile
+    cache or before the map is initialized.
+*/
+QVariantMap QDeclarativeGeoMap::cacheStatistics() const
+{
+    if (!mappingManagerInitialized_)
+        return QVariantMap();
+    return map_->cacheStatistics();
+}
+
 /*!
     \internal
 */
@@ -919,6 +947,144 @@ void QDeclarativeGeoMap::addMapItem(QDeclarativeGeoMapItemBase *item)
     updateMutex_.unlock();
 }
 
+/*!
+    \internal
+    Queues \a item to have its mercator bounding box read into the index.
+    Until that happens the item is treated as being in view.
+*/
+void QDeclarativeGeoMap::mapItemBoundsChanged(QDeclarativeGeoMapItemBase *item)
+{
+    if (dirtyMapItems_.isEmpty())
+        QMetaObject::invokeMethod(this, "updateMapItemIndex", Qt::QueuedConnection);
+    dirtyMapItems_.insert(item);
+
+    if (!viewportMapItems_.contains(item)) {
+        viewportMapItems_.insert(item);
+        item->setCulled(false);
+    }
+}
+
+/*!
+    \internal
+*/
+void QDeclarativeGeoMap::unindexMapItem(QDeclarativeGeoMapItemBase *item)
+{
+    mapItemIndex_.remove(item);
+    unboundedMapItems_.remove(item);
+    dirtyMapItems_.remove(item);
+    viewportMapItems_.remove(item);
+}
+
+/*!
+    \internal
+*/
+void QDeclarativeGeoMap::updateMapItemIndex()
+{
+    if (!dirtyMapItems_.isEmpty())
+        cullMapItems(false);
+}
+
+/*!
+    \internal
+*/
+void QDeclarativeGeoMap::mapCameraDataChanged(const QGeoCameraData &cameraData)
+{
+    Q_UNUSED(cameraData);
+    cullMapItems(true);
+}
+
+/*!
+    \internal
+    Finds the items around the viewport, culls the ones that left it and
+    brings back the ones that entered it. With \a cameraChanged the items
+    that stay in view get the viewport change as well. The work done is in
+    proportion to the items in view rather than to all items on the map.
+*/
+void QDeclarativeGeoMap::cullMapItems(bool cameraChanged)
+{
+    foreach (QDeclarativeGeoMapItemBase *item, dirtyMapItems_) {
+        QRectF bounds = item->mercatorBoundingBox();
+        if (bounds.isNull()) {
+            mapItemIndex_.remove(item);
+            unboundedMapItems_.insert(item);
+        } else {
+            unboundedMapItems_.remove(item);
+            mapItemIndex_.insert(item, bounds);
+        }
+    }
+    dirtyMapItems_.clear();
+
+    QSet<QDeclarativeGeoMapItemBase *> visible = unboundedMapItems_;
+    QRectF viewport = mercatorViewport();
+    if (viewport.isNull())
+        viewport = QRectF(0.0, 0.0, 1.0, 1.0);
+    mapItemIndex_.intersecting(viewport, &visible);
+
+    foreach (QDeclarativeGeoMapItemBase *item, viewportMapItems_) {
+        if (!visible.contains(item))
+            item->setCulled(true);
+    }
+
+    QGeoCameraData cameraData = map_->cameraData();
+    foreach (QDeclarativeGeoMapItemBase *item, visible) {
+        if (item->culled_)
+            item->setCulled(false);
+        else if (cameraChanged)
+            item->baseCameraDataChanged(cameraData);
+    }
+
+    viewportMapItems_ = visible;
+}
+
+/*!
+    \internal
+    Returns the mercator box of the viewport grown by half its size on each
+    side, so that items just outside it are ready when the map pans, or a
+    null rectangle when there is no telling what is in view, such as with
+    the horizon on screen or the whole world fitting in the viewport.
+*/
+QRectF QDeclarativeGeoMap::mercatorViewport() const
+{
+    if (!map_ || map_->width() <= 0 || map_->height() <= 0)
+        return QRectF();
+
+    QPointF screenCenter(map_->width() / 2.0, map_->height() / 2.0);
+    QGeoCoordinate center = map_->screenPositionToCoordinate(screenCenter, false);
+    QGeoCoordinate nextToCenter = map_->screenPositionToCoordinate(screenCenter + QPointF(1.0, 0.0), false);
+    if (!center.isValid() || !nextToCenter.isValid())
+        return QRectF();
+
+    QDoubleVector2D c = QGeoProjection::coordToMercator(center);
+
+    // corners are only unwrapped right if the world is much wider
+    // than the viewport
+    QDoubleVector2D next = QGeoProjection::coordToMercator(nextToCenter) - c;
+    double perPixel = qAbs(next.x() - qFloor(next.x() + 0.5)) + qAbs(next.y());
+    if (perPixel * (map_->width() + map_->height()) * 2.0 >= 1.0)
+        return QRectF();
+
+    double left = c.x(), right = c.x(), top = c.y(), bottom = c.y();
+    const QPointF corners[4] = { QPointF(0.0, 0.0),
+                                 QPointF(map_->width(), 0.0),
+                                 QPointF(0.0, map_->height()),
+                                 QPointF(map_->width(), map_->height()) };
+    for (int i = 0; i < 4; ++i) {
+        QGeoCoordinate coord = map_->screenPositionToCoordinate(corners[i], false);
+        if (!coord.isValid())
+            return QRectF();
+        QDoubleVector2D m = QGeoProjection::coordToMercator(coord);
+        double x = m.x() - qFloor(m.x() - c.x() + 0.5);
+        left = qMin(left, x);
+        right = qMax(right, x);
+        top = qMin(top, m.y());
+        bottom = qMax(bottom, m.y());
+    }
+
+    double width = right - left;
+    double height = bottom - top;
+    return QRectF(left - width / 2.0, top - height / 2.0, 2.0 * width, 2.0 * height);
+}
+
 /*!
     \qmlproperty list<MapItem> QtLocation5::Map::mapItems
 
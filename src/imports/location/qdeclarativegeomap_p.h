@@ -72,7 +72,9 @@
 #include "qgeocameradata_p.h"
 #include "qgeomap_p.h"
 #include "qdeclarativegeomaptype_p.h"
+#include "qgeospatialindex_p.h"
 #include <QWeakPointer>
+#include <QSet>
 
 QT_BEGIN_NAMESPACE
 
@@ -165,6 +167,7 @@ public:
     Q_INVOKABLE void fitViewportToMapItems();
     Q_INVOKABLE void pan(int dx, int dy);
     Q_INVOKABLE void cameraStopped(); // optional hint for prefetch
+    Q_INVOKABLE QVariantMap cacheStatistics() const;
 
 protected:
     void mousePressEvent(QMouseEvent *event);
@@ -196,12 +199,19 @@ private Q_SLOTS:
     void mapCenterChanged(AnimatableCoordinate center);
     void pluginReady();
     void onMapChildrenChanged();
+    void mapCameraDataChanged(const QGeoCameraData &cameraData);
+    void updateMapItemIndex();
 
 private:
     void setupMapView(QDeclarativeGeoMapItemView *view);
     void populateMap();
     void fitViewportToMapItemsRefine(bool refine);
 
+    void mapItemBoundsChanged(QDeclarativeGeoMapItemBase *item);
+    void unindexMapItem(QDeclarativeGeoMapItemBase *item);
+    void cullMapItems(bool cameraChanged);
+    QRectF mercatorViewport() const;
+
     QDeclarativeGeoServiceProvider *plugin_;
     QGeoServiceProvider *serviceProvider_;
     QGeoMappingManager *mappingManager_;
@@ -231,8 +241,15 @@ private:
 
     QList<QPointer<QDeclarativeGeoMapItemBase> > mapItems_;
 
+    // only the items around the viewport follow the camera
+    QGeoSpatialIndex<QDeclarativeGeoMapItemBase *> mapItemIndex_;
+    QSet<QDeclarativeGeoMapItemBase *> unboundedMapItems_;
+    QSet<QDeclarativeGeoMapItemBase *> dirtyMapItems_;
+    QSet<QDeclarativeGeoMapItemBase *> viewportMapItems_;
+
     QMutex updateMutex_;
     friend class QDeclarativeGeoMapItem;
+    friend class QDeclarativeGeoMapItemBase;
     friend class QDeclarativeGeoMapItemView;
     friend class QDeclarativeGeoMapGestureArea;
     Q_DISABLE_COPY(QDeclarativeGeoMap)
@@ -52,6 +52,8 @@
 #include <QDebug>
 #include "math.h"
 #include "qgeomap_p.h"
+#include "qgeoprojection_p.h"
+#include "qdoublevector2d_p.h"
 
 #define QML_MAP_FLICK_DEFAULTMAXVELOCITY 2500
 #define QML_MAP_FLICK_MINIMUMDECELERATION 500
@@ -345,6 +347,7 @@ QDeclarativeGeoMapGestureArea::QDeclarativeGeoMapGestureArea(QDeclarativeGeoMap
     pan_.maxVelocity_ = QML_MAP_FLICK_DEFAULTMAXVELOCITY;
     pan_.deceleration_ = QML_MAP_FLICK_DEFAULTDECELERATION;
     pan_.animation_ = 0;
+    pan_.hintZoom_ = -1;
 #if defined(TOUCH_EVENT_WORKAROUND)
     mouseBeingUsed_ = true;
 #endif
@@ -676,9 +679,58 @@ void QDeclarativeGeoMapGestureArea::updateVelocityList(const QPointF &pos)
         qreal velY = qreal(dyFromLastPos) / elapsed;
         velocityX_ = qBound<qreal>(-pan_.maxVelocity_, velX, pan_.maxVelocity_);
         velocityY_ = qBound<qreal>(-pan_.maxVelocity_, velY, pan_.maxVelocity_);
+
+        // while dragging, prefetch towards where a flick would end if the
+        // finger was lifted now
+        if (panState_ == panActive && (activeGestures_ & FlickGesture)
+                && (qAbs(velocityX_) > MinimumFlickVelocity || qAbs(velocityY_) > MinimumFlickVelocity)) {
+            qreal deceleration = qAbs(pan_.deceleration_);
+            qreal dx = velocityX_ * qAbs(velocityX_) / (2.0 * deceleration);
+            qreal dy = velocityY_ * qAbs(velocityY_) / (2.0 * deceleration);
+            QPointF end(declarativeMap_->width() / 2.0 - dx, declarativeMap_->height() / 2.0 - dy);
+            QGeoCoordinate target = map_->screenPositionToCoordinate(end, false);
+            qreal zoomLevel = map_->mapController()->zoom();
+
+            // the tiles on the way only change with the tile the flick would
+            // end on, so only hint again once that is a different one
+            QGeoCoordinate clamped(qBound(-85.05, target.latitude(), 85.05), target.longitude());
+            QDoubleVector2D mercator = QGeoProjection::coordToMercator(clamped);
+            int zoom = static_cast<int>(floor(zoomLevel));
+            double side = pow(2.0, zoom);
+            QPoint tile(static_cast<int>(floor(mercator.x() * side)),
+                        static_cast<int>(floor(mercator.y() * side)));
+            if (zoom != pan_.hintZoom_ || tile != pan_.hintTile_) {
+                pan_.hintZoom_ = zoom;
+                pan_.hintTile_ = tile;
+                hintCameraTarget(target, zoomLevel);
+            }
+        }
     }
 }
 
+/*!
+    \internal
+    Tells the map where the camera is heading so the tiles on the way can
+    be fetched ahead of time.
+*/
+void QDeclarativeGeoMapGestureArea::hintCameraTarget(QGeoCoordinate center, qreal zoomLevel)
+{
+    if (!map_)
+        return;
+
+    // the flick animation is allowed to run past the dateline and the poles
+    double lon = fmod(center.longitude() + 180.0, 360.0);
+    if (lon < 0.0)
+        lon += 360.0;
+    center.setLongitude(lon - 180.0);
+    center.setLatitude(qBound(-85.05, center.latitude(), 85.05));
+
+    QGeoCameraData target = map_->cameraData();
+    target.setCenter(center);
+    target.setZoomLevel(zoomLevel);
+    map_->cameraMovingTo(target);
+}
+
 /*!
     \internal
 */
@@ -902,6 +954,7 @@ void QDeclarativeGeoMapGestureArea::startPinch()
     pinch_.lastPoint2 = touchPoints_.at(1).scenePos();
 
     pinch_.zoom.start = declarativeMap_->zoomLevel();
+    pinch_.zoom.direction = 0;
     pinch_.rotation.start = declarativeMap_->bearing();
     pinch_.tilt.start = declarativeMap_->tilt();
 }
@@ -946,7 +999,17 @@ void QDeclarativeGeoMapGestureArea::updatePinch()
         qreal perPinchMinimumZoomLevel = qMax(pinch_.zoom.start - pinch_.zoom.maximumChange, pinch_.zoom.minimum);
         qreal perPinchMaximumZoomLevel = qMin(pinch_.zoom.start + pinch_.zoom.maximumChange, pinch_.zoom.maximum);
         newZoomLevel = qMin(qMax(perPinchMinimumZoomLevel, newZoomLevel), perPinchMaximumZoomLevel);
+
+        // the pinch can't go past its limit, prefetch towards it whenever
+        // the direction changes
+        qreal oldZoomLevel = declarativeMap_->zoomLevel();
+        int direction = newZoomLevel > oldZoomLevel ? 1 : (newZoomLevel < oldZoomLevel ? -1 : 0);
         declarativeMap_->setZoomLevel(newZoomLevel);
+        if (direction != 0 && direction != pinch_.zoom.direction) {
+            pinch_.zoom.direction = direction;
+            hintCameraTarget(map_->cameraData().center(),
+                             direction > 0 ? perPinchMaximumZoomLevel : perPinchMinimumZoomLevel);
+        }
     }
     if (activeGestures_ & TiltGesture && pinch_.zoom.minimum >= 0 && pinch_.zoom.maximum >= 0) {
         // Note: tilt is not yet supported.
@@ -1036,8 +1099,10 @@ void QDeclarativeGeoMapGestureArea::panStateMachine()
     case panActive:
         updatePan();
         // this ensures 'panStarted' occurs after the pan has actually started
-        if (lastState != panActive)
+        if (lastState != panActive) {
+            pan_.hintZoom_ = -1;
             emit panStarted();
+        }
         break;
     case panFlick:
         break;
@@ -1143,6 +1208,7 @@ void QDeclarativeGeoMapGestureArea::startFlick(int dx, int dy, int timeMs)
     animationEndCoordinate.setCoordinate(coordinate);
     pan_.animation_->setStartValue(QVariant::fromValue(animationStartCoordinate));
     pan_.animation_->setEndValue(QVariant::fromValue(animationEndCoordinate));
+    hintCameraTarget(coordinate, map_->mapController()->zoom());
     pan_.animation_->start();
     emit flickStarted();
 }
@@ -221,6 +221,7 @@ private:
     void stopPan();
     void clearTouchData();
     void updateVelocityList(const QPointF &pos);
+    void hintCameraTarget(QGeoCoordinate center, qreal zoomLevel);
 
 private:
     QGeoMap *map_;
@@ -236,12 +237,13 @@ private:
         struct Zoom
         {
             Zoom() : minimum(-1.0), maximum(-1.0), start(0.0), previous(0.0),
-                     maximumChange(2.0) {}
+                     maximumChange(2.0), direction(0) {}
             qreal minimum;
             qreal maximum;
             qreal start;
             qreal previous;
             qreal maximumChange;
+            int direction; // of the last prefetch hint, -1 out, 1 in
         } zoom;
         struct Rotation
         {
@@ -276,6 +278,10 @@ private:
         qreal deceleration_;
         QPropertyAnimation *animation_;
         bool enabled_;
+        // tile a flick would have ended on at the last prefetch hint,
+        // hintZoom_ is -1 if there was none in this pan
+        QPoint hintTile_;
+        int hintZoom_;
     } pan_;
 
     // these are calculated regardless of gesture or number of touch points
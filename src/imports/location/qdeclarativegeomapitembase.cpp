@@ -82,7 +82,8 @@ QGeoMapViewportChangeEvent &QGeoMapViewportChangeEvent::operator=(const QGeoMapV
 QDeclarativeGeoMapItemBase::QDeclarativeGeoMapItemBase(QQuickItem *parent)
     : QQuickItem(parent),
       map_(0),
-      quickMap_(0)
+      quickMap_(0),
+      culled_(false)
 {
     connect(this, SIGNAL(childrenChanged()),
             this, SLOT(afterChildrenChanged()));
@@ -141,22 +142,66 @@ void QDeclarativeGeoMapItemBase::setMap(QDeclarativeGeoMap *quickMap, QGeoMap *m
         return;
     if (quickMap && quickMap_)
         return; // don't allow association to more than one map
-    if (quickMap_)
+    if (quickMap_) {
         quickMap_->disconnect(this);
+        quickMap_->unindexMapItem(this);
+    }
     if (map_)
         map_->disconnect(this);
 
     quickMap_ = quickMap;
     map_ = map;
+    culled_ = false;
 
+    // the map passes camera changes on to the items that are in view
     if (map_ && quickMap_) {
-        connect(map_, SIGNAL(cameraDataChanged(QGeoCameraData)),
-                this, SLOT(baseCameraDataChanged(QGeoCameraData)));
         lastSize_ = QSizeF(quickMap_->width(), quickMap_->height());
         lastCameraData_ = map_->cameraData();
+        mercatorBoundingBoxChanged();
     }
 }
 
+/*!
+    \internal
+    Returns the box the item covers in mercator space, which the map uses to
+    leave the item alone while it is far from the viewport. Items returning
+    a null rectangle, the default, are updated whatever the map shows.
+*/
+QRectF QDeclarativeGeoMapItemBase::mercatorBoundingBox() const
+{
+    return QRectF();
+}
+
+/*!
+    \internal
+    Tells the map that mercatorBoundingBox() has changed. The map asks for
+    the new box once the current changes are done, and keeps the item in
+    view until then.
+*/
+void QDeclarativeGeoMapItemBase::mercatorBoundingBoxChanged()
+{
+    if (quickMap_)
+        quickMap_->mapItemBoundsChanged(this);
+}
+
+/*!
+    \internal
+    Called by the map as the item leaves or enters the area around the
+    viewport. A culled item gets no viewport changes and no paint node, and
+    catches up with the camera when it comes back. It is moved once more on
+    its way out, so it does not stay at its old place on the screen.
+*/
+void QDeclarativeGeoMapItemBase::setCulled(bool culled)
+{
+    if (culled_ == culled)
+        return;
+
+    if (map_)
+        baseCameraDataChanged(map_->cameraData());
+    culled_ = culled;
+    update();
+}
+
 /*!
     \internal
 */
@@ -217,7 +262,7 @@ float QDeclarativeGeoMapItemBase::zoomLevelOpacity() const
 */
 QSGNode *QDeclarativeGeoMapItemBase::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *pd)
 {
-    if (!map_ || !quickMap_) {
+    if (!map_ || !quickMap_ || culled_) {
         delete oldNode;
         return 0;
     }
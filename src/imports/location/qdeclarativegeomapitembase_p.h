@@ -93,15 +93,23 @@ protected Q_SLOTS:
 protected:
     float zoomLevelOpacity() const;
 
+    virtual QRectF mercatorBoundingBox() const;
+    void mercatorBoundingBoxChanged();
+
 private Q_SLOTS:
     void baseCameraDataChanged(const QGeoCameraData &camera);
 
 private:
+    void setCulled(bool culled);
+
     QGeoMap *map_;
     QDeclarativeGeoMap *quickMap_;
 
     QSizeF lastSize_;
     QGeoCameraData lastCameraData_;
+    bool culled_;
+
+    friend class QDeclarativeGeoMap;
 };
 
 QT_END_NAMESPACE
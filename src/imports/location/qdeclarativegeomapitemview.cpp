@@ -74,11 +74,28 @@ QT_BEGIN_NAMESPACE
     \snippet snippets/declarative/maps.qml QtLocation import
     \codeline
     \snippet snippets/declarative/maps.qml MapRoute
+
+    \section2 Performance
+
+    Delegate instances are kept when the model changes. After a reset of
+    the model, such as a PlaceSearchModel receiving new results, the
+    instances already on the map are given the new rows instead of being
+    destroyed and created again, and instances left over are kept aside
+    for rows added later. Setting \l keyRole to a role that identifies a
+    row, such as a title or an identifier, gives each instance the row
+    with the key it showed before, so that its bindings need not be
+    evaluated again.
+
+    Rows inserted into the model are added to the map together once
+    control returns to the event loop, so a model which adds its rows one
+    at a time does not create and add a delegate for each of them in
+    turn. Rows that are removed, and resets of the model, are applied at
+    once.
 */
 
 QDeclarativeGeoMapItemView::QDeclarativeGeoMapItemView(QQuickItem *parent)
     : QObject(parent), componentCompleted_(false), delegate_(0),
-      itemModel_(0), map_(0), fitViewport_(false)
+      map_(0), fitViewport_(false), updatePending_(false)
 {
 }
 
@@ -118,6 +135,9 @@ void QDeclarativeGeoMapItemView::setModel(const QVariant &model)
     if (!itemModel)
         return;
 
+    if (itemModel_)
+        itemModel_->disconnect(this);
+
     modelVariant_ = model;
     itemModel_ = itemModel;
     QObject::connect(itemModel_, SIGNAL(modelReset()),
@@ -140,23 +160,17 @@ void QDeclarativeGeoMapItemView::itemModelReset()
 
 /*!
     \internal
+    Reserves a place for each inserted row; the delegates are bound to
+    them on the next update.
 */
 void QDeclarativeGeoMapItemView::itemModelRowsInserted(QModelIndex, int start, int end)
 {
     if (!componentCompleted_ || !map_ || !delegate_ || !itemModel_)
         return;
 
-    QDeclarativeGeoMapItemBase *mapItem;
-    for (int i = start; i <= end; ++i) {
-        mapItem = createItem(i);
-        if (!mapItem) {
-            break;
-        }
-        mapItemList_.append(mapItem);
-        map_->addMapItem(mapItem);
-    }
-    if (fitViewport_)
-        fitViewport();
+    for (int i = start; i <= end; ++i)
+        items_.insert(i, DelegateInstance());
+    scheduleUpdate();
 }
 
 /*!
@@ -167,15 +181,14 @@ void QDeclarativeGeoMapItemView::itemModelRowsRemoved(QModelIndex, int start, in
     if (!componentCompleted_ || !map_ || !delegate_ || !itemModel_)
         return;
 
+    bool removed = false;
     for (int i = end; i >= start; --i) {
-        QDeclarativeGeoMapItemBase *mapItem = mapItemList_.takeAt(i);
-        Q_ASSERT(mapItem);
-        if (!mapItem) // bad
-            break;
-        map_->removeMapItem(mapItem);
-        delete mapItem;
+        DelegateInstance instance = items_.takeAt(i);
+        removed = removed || instance.item != 0;
+        releaseItem(instance);
     }
-    if (fitViewport_)
+    trimPool();
+    if (removed && fitViewport_)
         fitViewport();
 }
 
@@ -194,14 +207,42 @@ QQmlComponent *QDeclarativeGeoMapItemView::delegate() const
 
 void QDeclarativeGeoMapItemView::setDelegate(QQmlComponent *delegate)
 {
-    if (!delegate)
+    if (!delegate || delegate == delegate_)
         return;
+
+    // instances of the old delegate can not be reused
+    removeInstantiatedItems();
     delegate_ = delegate;
 
     repopulate();
     emit delegateChanged();
 }
 
+/*!
+    \qmlproperty string QtLocation5::MapItemView::keyRole
+
+    This property holds the name of a model role which identifies a row,
+    such as an identifier or a title. When the model is reset, each row is
+    given the delegate instance that showed the row with the same key
+    before, if there was one.
+
+    By default no key role is set, and the instances are given to the
+    rows in order.
+*/
+QString QDeclarativeGeoMapItemView::keyRole() const
+{
+    return keyRole_;
+}
+
+void QDeclarativeGeoMapItemView::setKeyRole(const QString &keyRole)
+{
+    if (keyRole == keyRole_)
+        return;
+    keyRole_ = keyRole;
+    repopulate();
+    emit keyRoleChanged();
+}
+
 /*!
     \qmlproperty Component QtLocation5::MapItemView::autoFitViewport
 
@@ -248,99 +289,240 @@ void QDeclarativeGeoMapItemView::setMapData(QDeclarativeGeoMap *map)
 
 /*!
     \internal
+    Removes and deletes all delegate instances, including the unused ones.
 */
 void QDeclarativeGeoMapItemView::removeInstantiatedItems()
 {
     if (!map_)
         return;
-    for (int i = 0; i < mapItemList_.count(); ++ i) {
-        map_->removeMapItem(mapItemList_.at(i));
+    for (int i = 0; i < items_.count(); ++i) {
+        if (items_.at(i).item) {
+            map_->removeMapItem(items_.at(i).item);
+            delete items_.at(i).item;
+        }
     }
-    qDeleteAll(mapItemList_);
-    mapItemList_.clear();
+    items_.clear();
+    for (int i = 0; i < pool_.count(); ++i)
+        delete pool_.at(i).item;
+    pool_.clear();
 }
 
 /*!
     \internal
-    Removes and repopulates all items.
+    Binds the delegates to all rows of the model again.
 */
 void QDeclarativeGeoMapItemView::repopulate()
 {
     if (!componentCompleted_ || !map_ || !delegate_ || !itemModel_)
         return;
-    // Free any earlier instances
-    removeInstantiatedItems();
+    reconcileItems();
+    if (fitViewport_)
+        fitViewport();
+}
 
-    // Iterate model data and instantiate delegates.
-    QDeclarativeGeoMapItemBase *mapItem;
-    for (int i = 0; i < itemModel_->rowCount(); ++i) {
-        mapItem = createItem(i);
-        Q_ASSERT(mapItem);
-        if (!mapItem) // bad
-            break;
-        mapItemList_.append(mapItem);
-        map_->addMapItem(mapItem);
+/*!
+    \internal
+*/
+void QDeclarativeGeoMapItemView::scheduleUpdate()
+{
+    if (updatePending_)
+        return;
+    updatePending_ = true;
+    QMetaObject::invokeMethod(this, "updateItems", Qt::QueuedConnection);
+}
+
+/*!
+    \internal
+    Binds delegates to the rows inserted since the last update.
+*/
+void QDeclarativeGeoMapItemView::updateItems()
+{
+    updatePending_ = false;
+    if (!componentCompleted_ || !map_ || !delegate_ || !itemModel_)
+        return;
+
+    bool added = false;
+    for (int i = 0; i < items_.count(); ++i) {
+        if (items_.at(i).item)
+            continue;
+        DelegateInstance &instance = items_[i];
+        if (!pool_.isEmpty())
+            instance = pool_.takeLast();
+        if (!bindItem(instance, i)) {
+            releaseItem(instance);
+            instance = DelegateInstance();
+            continue;
+        }
+        map_->addMapItem(instance.item);
+        added = true;
     }
-    if (fitViewport_)
+
+    if (added && fitViewport_)
         fitViewport();
 }
 
-QDeclarativeGeoMapItemBase *QDeclarativeGeoMapItemView::createItem(int modelRow)
+/*!
+    \internal
+    Binds a delegate instance to every row of the model, reusing the
+    instances already on the map, first those with the same key, then
+    those kept aside, before creating new ones.
+*/
+void QDeclarativeGeoMapItemView::reconcileItems()
 {
-    if (itemModel_)
-        return createItemFromItemModel(modelRow);
-    return 0;
+    QList<DelegateInstance> previous = items_;
+    items_.clear();
+
+    int rows = itemModel_->rowCount();
+    QVector<DelegateInstance> instances(rows);
+
+    int keyRole = keyRole_.isEmpty() ? -1 : itemModel_->roleNames().key(keyRole_.toLatin1(), -1);
+    if (keyRole >= 0) {
+        QMultiHash<QString, int> previousByKey;
+        for (int i = previous.count() - 1; i >= 0; --i) {
+            if (!previous.at(i).key.isEmpty())
+                previousByKey.insert(previous.at(i).key, i);
+        }
+        for (int row = 0; row < rows && !previousByKey.isEmpty(); ++row) {
+            QString key = itemModel_->data(itemModel_->index(row, 0), keyRole).toString();
+            QMultiHash<QString, int>::iterator it = previousByKey.find(key);
+            if (it == previousByKey.end())
+                continue;
+            instances[row] = previous.at(it.value());
+            previous[it.value()].item = 0;
+            previousByKey.erase(it);
+        }
+    }
+
+    int next = 0;
+    for (int row = 0; row < rows; ++row) {
+        DelegateInstance &instance = instances[row];
+        if (!instance.item) {
+            while (next < previous.count() && !previous.at(next).item)
+                ++next;
+            if (next < previous.count()) {
+                instance = previous.at(next);
+                previous[next++].item = 0;
+            } else if (!pool_.isEmpty()) {
+                instance = pool_.takeLast();
+            }
+        }
+
+        // adding an item already on the map does nothing
+        if (bindItem(instance, row)) {
+            map_->addMapItem(instance.item);
+        } else {
+            releaseItem(instance);
+            instance = DelegateInstance();
+        }
+        items_.append(instance);
+    }
+
+    for (int i = 0; i < previous.count(); ++i)
+        releaseItem(previous.at(i));
+    trimPool();
 }
 
+/*!
+    \internal
+    Takes \a instance off the map and keeps it for a later row.
+*/
+void QDeclarativeGeoMapItemView::releaseItem(const DelegateInstance &instance)
+{
+    if (!instance.item)
+        return;
+    map_->removeMapItem(instance.item);
+    pool_.append(instance);
+}
 
 /*!
     \internal
+    Deletes the unused instances beyond the number of rows of the model,
+    so that a model which shrank doesn't keep the delegates of its
+    largest size around.
 */
-QDeclarativeGeoMapItemBase *QDeclarativeGeoMapItemView::createItemFromItemModel(int modelRow)
+void QDeclarativeGeoMapItemView::trimPool()
+{
+    int keep = itemModel_ ? itemModel_->rowCount() : 0;
+    while (pool_.count() > keep)
+        delete pool_.takeLast().item;
+}
+
+/*!
+    \internal
+    Sets the context of \a instance to the data of \a modelRow, creating
+    the delegate if \a instance has none yet. Properties that keep their
+    value are not set again, so bindings on them are not evaluated again.
+*/
+bool QDeclarativeGeoMapItemView::bindItem(DelegateInstance &instance, int modelRow)
 {
     if (!delegate_ || !itemModel_)
-        return 0;
+        return false;
 
     QModelIndex index = itemModel_->index(modelRow, 0); // column 0
     if (!index.isValid()) {
         qWarning() << "QDeclarativeGeoMapItemView Index is not valid: " << modelRow;
-        return 0;
+        return false;
+    }
+
+    bool create = !instance.item;
+    if (create) {
+        instance.modelObject = new QObject(this);
+        instance.modelMetaObject = new QQmlOpenMetaObject(instance.modelObject);
+        instance.context = new QQmlContext(qmlContext(this));
     }
 
-    QObject *model = new QObject(this);
-    QQmlOpenMetaObject *modelMetaObject = new QQmlOpenMetaObject(model);
+    QByteArray keyRole = keyRole_.toLatin1();
+    instance.key.clear();
 
     QHashIterator<int, QByteArray> iterator(itemModel_->roleNames());
-    QQmlContext *itemContext = new QQmlContext(qmlContext(this));
     while (iterator.hasNext()) {
         iterator.next();
         QVariant modelData = itemModel_->data(index, iterator.key());
-        if (!modelData.isValid())
+        if (!keyRole.isEmpty() && iterator.value() == keyRole)
+            instance.key = modelData.toString();
+
+        QString name = QString::fromLatin1(iterator.value().constData());
+        if (create) {
+            if (!modelData.isValid())
+                continue;
+        } else if (modelData.userType() != QMetaType::QObjectStar
+                   && instance.context->contextProperty(name) == modelData) {
+            // objects are always set again, a new one may have the
+            // address of a deleted one
             continue;
+        }
 
-        itemContext->setContextProperty(QString::fromLatin1(iterator.value().constData()),
-                                        modelData);
-
-        modelMetaObject->setValue(iterator.value(), modelData);
+        instance.context->setContextProperty(name, modelData);
+        instance.modelMetaObject->setValue(iterator.value(), modelData);
     }
-    itemContext->setContextProperty(QLatin1String("model"), model);
 
-    QObject *obj = delegate_->create(itemContext);
+    if (!create)
+        return true;
+
+    instance.context->setContextProperty(QLatin1String("model"), instance.modelObject);
+
+    QObject *obj = delegate_->create(instance.context);
 
     if (!obj) {
         qWarning() << "QDeclarativeGeoMapItemView map item creation failed.";
-        delete itemContext;
-        return 0;
+        delete instance.context;
+        delete instance.modelObject;
+        instance = DelegateInstance();
+        return false;
     }
     QDeclarativeGeoMapItemBase *declMapObj = qobject_cast<QDeclarativeGeoMapItemBase *>(obj);
     if (!declMapObj) {
         qWarning() << "QDeclarativeGeoMapItemView map item delegate is of unsupported type.";
-        delete itemContext;
-        return 0;
+        delete obj;
+        delete instance.context;
+        delete instance.modelObject;
+        instance = DelegateInstance();
+        return false;
     }
-    itemContext->setParent(declMapObj);
-    model->setParent(declMapObj);
-    return declMapObj;
+    instance.context->setParent(declMapObj);
+    instance.modelObject->setParent(declMapObj);
+    instance.item = declMapObj;
+    return true;
 }
 
 #include "moc_qdeclarativegeomapitemview_p.cpp"
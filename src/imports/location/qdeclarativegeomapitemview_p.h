@@ -53,6 +53,8 @@ QT_BEGIN_NAMESPACE
 class QAbstractItemModel;
 class QDeclarativeGeoMap;
 class QDeclarativeGeoMapItemBase;
+class QQmlContext;
+class QQmlOpenMetaObject;
 
 class QDeclarativeGeoMapItemView : public QObject, public QQmlParserStatus
 {
@@ -62,6 +64,7 @@ class QDeclarativeGeoMapItemView : public QObject, public QQmlParserStatus
 
     Q_PROPERTY(QVariant model READ model WRITE setModel NOTIFY modelChanged)
     Q_PROPERTY(QQmlComponent *delegate READ delegate WRITE setDelegate NOTIFY delegateChanged)
+    Q_PROPERTY(QString keyRole READ keyRole WRITE setKeyRole NOTIFY keyRoleChanged)
     Q_PROPERTY(bool autoFitViewport READ autoFitViewport WRITE setAutoFitViewport NOTIFY autoFitViewportChanged)
 
 public:
@@ -74,6 +77,9 @@ public:
     QQmlComponent *delegate() const;
     void setDelegate(QQmlComponent *);
 
+    QString keyRole() const;
+    void setKeyRole(const QString &keyRole);
+
     bool autoFitViewport() const;
     void setAutoFitViewport(const bool &);
 
@@ -86,7 +92,6 @@ public:
 
     bool isVisible() const;
 
-    QDeclarativeGeoMapItemBase *createItem(int modelRow);
     // From QQmlParserStatus
     virtual void componentComplete();
     void classBegin() {}
@@ -94,10 +99,28 @@ public:
 Q_SIGNALS:
     void modelChanged();
     void delegateChanged();
+    void keyRoleChanged();
     void autoFitViewportChanged();
 
 private:
-    QDeclarativeGeoMapItemBase *createItemFromItemModel(int modelRow);
+    // A delegate instance together with the context it reads the model
+    // row from, so that it can be moved to another row.
+    struct DelegateInstance
+    {
+        DelegateInstance() : item(0), context(0), modelObject(0), modelMetaObject(0) {}
+
+        QDeclarativeGeoMapItemBase *item;
+        QQmlContext *context;
+        QObject *modelObject;
+        QQmlOpenMetaObject *modelMetaObject;
+        QString key;
+    };
+
+    bool bindItem(DelegateInstance &instance, int modelRow);
+    void releaseItem(const DelegateInstance &instance);
+    void trimPool();
+    void reconcileItems();
+    void scheduleUpdate();
 
     void fitViewport();
 
@@ -105,16 +128,20 @@ private Q_SLOTS:
     void itemModelReset();
     void itemModelRowsInserted(QModelIndex, int start, int end);
     void itemModelRowsRemoved(QModelIndex, int start, int end);
+    void updateItems();
 
 private:
     bool visible_;
     bool componentCompleted_;
     QQmlComponent *delegate_;
     QVariant modelVariant_;
-    QAbstractItemModel *itemModel_;
+    QPointer<QAbstractItemModel> itemModel_;
+    QString keyRole_;
     QDeclarativeGeoMap *map_;
-    QList<QDeclarativeGeoMapItemBase *> mapItemList_;
+    QList<DelegateInstance> items_;
+    QList<DelegateInstance> pool_;
     bool fitViewport_;
+    bool updatePending_;
 };
 
 QT_END_NAMESPACE
@@ -47,6 +47,7 @@
 #include <QtQml/qqmlinfo.h>
 #include <QtQml/private/qqmlengine_p.h>
 #include <QtLocation/QGeoRectangle>
+#include "qgeoroute_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -106,9 +107,9 @@ void QDeclarativeGeoRoute::init()
 /*!
     \internal
 */
-QList<QGeoCoordinate> QDeclarativeGeoRoute::routePath()
+QGeoCoordinateArray QDeclarativeGeoRoute::routePath() const
 {
-    return route_.path();
+    return QGeoRoutePrivate::get(route_)->path;
 }
 
 /*!
@@ -168,9 +169,10 @@ QJSValue QDeclarativeGeoRoute::path() const
     QV8Engine *v8Engine = QQmlEnginePrivate::getV8Engine(engine);
     QV8ValueTypeWrapper *valueTypeWrapper = v8Engine->valueTypeWrapper();
 
-    v8::Local<v8::Array> pathArray = v8::Array::New(route_.path().length());
-    for (int i = 0; i < route_.path().length(); ++i) {
-        const QGeoCoordinate &c = route_.path().at(i);
+    const QGeoCoordinateArray &path = QGeoRoutePrivate::get(route_)->path;
+    v8::Local<v8::Array> pathArray = v8::Array::New(path.size());
+    for (int i = 0; i < path.size(); ++i) {
+        const QGeoCoordinate c = path.at(i);
 
         QQmlValueType *vt = QQmlValueTypeFactory::valueType(qMetaTypeId<QGeoCoordinate>());
         v8::Local<v8::Object> cv = valueTypeWrapper->newValueType(QVariant::fromValue(c), vt);
@@ -186,8 +188,9 @@ void QDeclarativeGeoRoute::setPath(const QJSValue &value)
     if (!value.isArray())
         return;
 
-    QList<QGeoCoordinate> pathList;
+    QGeoCoordinateArray pathList;
     quint32 length = value.property(QStringLiteral("length")).toUInt();
+    pathList.reserve(length);
     for (quint32 i = 0; i < length; ++i) {
         bool ok;
         QGeoCoordinate c = parseCoordinate(value.property(i), &ok);
@@ -200,10 +203,11 @@ void QDeclarativeGeoRoute::setPath(const QJSValue &value)
         pathList.append(c);
     }
 
-    if (route_.path() == pathList)
+    QGeoCoordinateArray &path = QGeoRoutePrivate::get(route_)->path;
+    if (path == pathList)
         return;
 
-    route_.setPath(pathList);
+    path = pathList;
 
     emit pathChanged();
 }
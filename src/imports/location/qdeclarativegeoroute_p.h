@@ -47,6 +47,7 @@
 #include <QtCore/QObject>
 #include <QtQml/private/qv8engine_p.h>
 #include <QtLocation/QGeoRoute>
+#include "qgeocoordinatearray_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -87,7 +88,7 @@ private:
     static void segments_clear(QQmlListProperty<QDeclarativeGeoRouteSegment> *prop);
 
     void init();
-    QList<QGeoCoordinate> routePath();
+    QGeoCoordinateArray routePath() const;
 
     QGeoRoute route_;
     QList<QDeclarativeGeoRouteSegment *> segments_;
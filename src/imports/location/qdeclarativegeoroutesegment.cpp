@@ -44,6 +44,7 @@
 #include <QtQml/QQmlEngine>
 #include <QtQml/QQmlContext>
 #include <QtQml/private/qqmlengine_p.h>
+#include "qgeoroutesegment_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -154,9 +155,10 @@ QJSValue QDeclarativeGeoRouteSegment::path() const
     QV8Engine *v8Engine = QQmlEnginePrivate::getV8Engine(engine);
     QV8ValueTypeWrapper *valueTypeWrapper = v8Engine->valueTypeWrapper();
 
-    v8::Local<v8::Array> pathArray = v8::Array::New(segment_.path().length());
-    for (int i = 0; i < segment_.path().length(); ++i) {
-        const QGeoCoordinate &c = segment_.path().at(i);
+    const QGeoCoordinateArray &path = QGeoRouteSegmentPrivate::get(segment_)->path;
+    v8::Local<v8::Array> pathArray = v8::Array::New(path.size());
+    for (int i = 0; i < path.size(); ++i) {
+        const QGeoCoordinate c = path.at(i);
 
         QQmlValueType *vt = QQmlValueTypeFactory::valueType(qMetaTypeId<QGeoCoordinate>());
         v8::Local<v8::Object> cv = valueTypeWrapper->newValueType(QVariant::fromValue(c), vt);
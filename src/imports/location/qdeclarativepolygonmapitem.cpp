@@ -40,6 +40,7 @@
  ****************************************************************************/
 
 #include "qdeclarativepolygonmapitem_p.h"
+#include "qgeomapgeometryjob_p.h"
 #include "qgeocameracapabilities_p.h"
 #include "qlocationutils_p.h"
 #include "error_messages.h"
@@ -53,10 +54,6 @@
 #include <QPainterPath>
 #include <qnumeric.h>
 
-/* poly2tri triangulator includes */
-#include "../../3rdparty/poly2tri/common/shapes.h"
-#include "../../3rdparty/poly2tri/sweep/cdt.h"
-
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -106,8 +103,9 @@ QT_BEGIN_NAMESPACE
     of vertices. This means that the per frame cost of having a Polygon on the
     Map grows in direct proportion to the number of points on the Polygon. There
     is an additional triangulation cost (approximately O(n log n)) which is
-    currently paid with each frame, but in future may be paid only upon adding
-    or removing points.
+    paid when the points or the zoom level change. For polygons with many
+    points it is paid on a worker thread, and the previous triangles are
+    drawn, moved along with the map, until the new ones are ready.
 
     Like the other map objects, MapPolygon is normally drawn without a smooth
     appearance. Setting the \l {QtQuick2::Item::opacity}{opacity} property will force the object to
@@ -140,16 +138,103 @@ struct Vertex
     QVector2D position;
 };
 
+// polygons with fewer points than this are triangulated right away, larger
+// ones on a worker thread once they have been drawn once. Circles stay
+// below it, their inverted fill is built from the current path.
+static const int TriangulateJobMinimumPoints = 256;
+
+/*
+    Returns the outline of \a polygon, made simple unless \a assumeSimple is
+    set, and triangulates it into \a triangles. This runs on worker threads
+    as well as on the GUI thread.
+*/
+static QPainterPath triangulatePolygon(const QPolygonF &polygon, bool assumeSimple,
+                                       QGeoMapPolygonTriangles &triangles)
+{
+    QPainterPath path;
+    if (!polygon.isEmpty()) {
+        path.moveTo(polygon.first());
+        for (int i = 1; i < polygon.size(); ++i)
+            path.lineTo(polygon.at(i));
+        path.closeSubpath();
+    }
+
+    if (!assumeSimple)
+        path = path.simplified();
+
+    triangles.triangulate(path);
+    return path;
+}
+
+class QGeoPolygonTriangulateJob : public QGeoMapGeometryJob
+{
+public:
+    QGeoPolygonTriangulateJob(QGeoMapPolygonGeometry *geometry, const QPolygonF &polygon,
+                              bool assumeSimple, const QGeoMapCameraSnapshot &camera)
+        : QGeoMapGeometryJob(geometry, "triangulationFinished"),
+          polygon(polygon), assumeSimple(assumeSimple), camera(camera) {}
+
+    QPolygonF polygon;
+    bool assumeSimple;
+    QGeoMapCameraSnapshot camera;
+    QPainterPath path;
+    QGeoMapPolygonTriangles triangles;
+
+protected:
+    void run()
+    {
+        path = triangulatePolygon(polygon, assumeSimple, triangles);
+    }
+};
+
 QGeoMapPolygonGeometry::QGeoMapPolygonGeometry(QObject *parent) :
-    QGeoMapItemGeometry(parent), assumeSimple_(false)
+    QGeoMapItemGeometry(parent), assumeSimple_(false), trianglesCurrent_(false)
 {
 }
 
+QGeoMapPolygonGeometry::~QGeoMapPolygonGeometry()
+{
+    cancelTriangulation();
+}
+
 /*!
     \internal
 */
+void QGeoMapPolygonGeometry::cancelTriangulation()
+{
+    if (triangulateJob_) {
+        triangulateJob_->cancel();
+        triangulateJob_.clear();
+    }
+}
+
+/*!
+    \internal
+*/
+void QGeoMapPolygonGeometry::triangulationFinished()
+{
+    if (!triangulateJob_ || !triangulateJob_->isFinished())
+        return;
+
+    srcPath_ = triangulateJob_->path;
+    srcTriangles_ = triangulateJob_->triangles;
+    trianglesCamera_ = triangulateJob_->camera;
+    trianglesCurrent_ = true;
+    triangulateJob_.clear();
+
+    // keeps clipToViewport_ as it is
+    screenDirty_ = true;
+    emit updated();
+}
+
+/*!
+    \internal
+    Large polygons are triangulated on a worker thread. Until the triangles
+    are ready the last ones are drawn, moved to where the camera shows them
+    now.
+*/
 void QGeoMapPolygonGeometry::updateSourcePoints(const QGeoMap &map,
-                                                const QList<QGeoCoordinate> &path)
+                                                const QGeoCoordinateArray &path)
 {
     if (!sourceDirty_)
         return;
@@ -159,53 +244,69 @@ void QGeoMapPolygonGeometry::updateSourcePoints(const QGeoMap &map,
     // build the actual path
     QPointF origin;
     QPointF lastPoint;
-    srcPath_ = QPainterPath();
+    QPolygonF polygon;
+    polygon.reserve(path.size());
 
     double unwrapBelowX = 0;
     if (preserveGeometry_ )
         unwrapBelowX = map.coordinateToScreenPosition(geoLeftBound_, false).x();
 
-    for (int i = 0; i < path.size(); ++i) {
-        const QGeoCoordinate &coord = path.at(i);
+    QVector<double> screen;
+    projectPath(map, path, screen);
 
-        if (!coord.isValid())
+    for (int i = 0; i < path.size(); ++i) {
+        if (!path.isValid(i))
             continue;
 
-        QPointF point = map.coordinateToScreenPosition(coord, false);
+        QPointF point(screen.at(2 * i), screen.at(2 * i + 1));
 
         // We can get NaN if the map isn't set up correctly, or the projection
         // is faulty -- probably best thing to do is abort
-        if (!qIsFinite(point.x()) || !qIsFinite(point.y()))
+        if (!qIsFinite(point.x()) || !qIsFinite(point.y())) {
+            cancelTriangulation();
+            srcPath_ = QPainterPath();
+            srcTriangles_.clear();
+            trianglesCamera_ = QGeoMapCameraSnapshot();
+            trianglesCurrent_ = false;
             return;
+        }
 
         // unwrap x to preserve geometry if moved to border of map
         if (preserveGeometry_ && point.x() < unwrapBelowX && !qFuzzyCompare(point.x(), unwrapBelowX))
-            point.setX(unwrapBelowX + geoDistanceToScreenWidth(map, geoLeftBound_, coord));
+            point.setX(unwrapBelowX + geoDistanceToScreenWidth(map, geoLeftBound_, path.at(i)));
 
         if (i == 0) {
             origin = point;
             minX = point.x();
-            srcOrigin_ = coord;
-            srcPath_.moveTo(point - origin);
+            srcOrigin_ = path.at(i);
+            polygon << point - origin;
             lastPoint = point;
         } else {
             if (point.x() <= minX)
                 minX = point.x();
             const QPointF diff = (point - lastPoint);
             if (diff.x() * diff.x() + diff.y() * diff.y() >= 3.0) {
-                srcPath_.lineTo(point - origin);
+                polygon << point - origin;
                 lastPoint = point;
             }
         }
     }
 
-    srcPath_.closeSubpath();
-
-    if (!assumeSimple_)
-        srcPath_ = srcPath_.simplified();
-
-    sourceBounds_ = srcPath_.boundingRect();
+    sourceBounds_ = polygon.boundingRect();
     geoLeftBound_ = map.screenPositionToCoordinate(QPointF(minX, 0), false);
+
+    cancelTriangulation();
+    QGeoMapCameraSnapshot camera(map, srcOrigin_);
+    if (polygon.size() < TriangulateJobMinimumPoints || !trianglesCamera_.isValid()) {
+        srcPath_ = triangulatePolygon(polygon, assumeSimple_, srcTriangles_);
+        trianglesCamera_ = camera;
+        trianglesCurrent_ = true;
+    } else {
+        triangulateJob_ = QSharedPointer<QGeoPolygonTriangulateJob>(
+                    new QGeoPolygonTriangulateJob(this, polygon, assumeSimple_, camera));
+        QGeoMapGeometryJob::start(triangulateJob_);
+        trianglesCurrent_ = false;
+    }
 }
 
 /*!
@@ -228,92 +329,47 @@ void QGeoMapPolygonGeometry::updateScreenPoints(const QGeoMap &map)
     QRectF viewport(0, 0, map.width(), map.height());
     viewport.translate(-1 * origin);
 
-    QPainterPath vpPath;
-    vpPath.addRect(viewport);
-
-    QPainterPath ppi;
-    if (clipToViewport_)
-        ppi = srcPath_.intersected(vpPath); // get the clipped version of the path
-    else ppi = srcPath_;
-
     clear();
 
-    // a polygon requires at least 3 points;
-    if (ppi.elementCount() < 3)
-        return;
+    // triangles of an older source are drawn through the camera they were
+    // made under until the new ones are ready
+    QTransform transform;
+    if (!trianglesCurrent_) {
+        transform = trianglesCamera_.toScreen(map)
+                * QTransform::fromTranslate(-origin.x(), -origin.y());
+    }
 
-    // Intersection between the viewport and a concave polygon can create multiple polygons
-    // joined by a line at the viewport border, and poly2tri does not triangulate this very well
-    // so use the full src path if the resulting polygon is concave.
+    // the source path was triangulated along with building it, only cut
+    // the triangles to the viewport here
+    QRectF bb;
     if (clipToViewport_) {
-        int changeInX = 0;
-        int changeInY = 0;
-        QPainterPath::Element e1 = ppi.elementAt(1);
-        QPainterPath::Element e = ppi.elementAt(0);
-        QVector2D edgeA(e1.x - e.x ,e1.y - e.y);
-        for (int i = 2; i <= ppi.elementCount(); ++i) {
-            e = ppi.elementAt(i % ppi.elementCount());
-            if (e.x == e1.x && e.y == e1.y)
-                continue;
-            QVector2D edgeB(e.x - e1.x, e.y - e1.y);
-            if ((edgeA.x() < 0) == (edgeB.x() >= 0))
-                changeInX++;
-            if ((edgeA.y() < 0) == (edgeB.y() >= 0))
-                changeInY++;
-            edgeA = edgeB;
-            e1 = e;
-        }
-        if (changeInX > 2 || changeInY > 2) // polygon is concave
-            ppi = srcPath_;
+        bb = srcTriangles_.clip(transform.inverted().mapRect(viewport), screenVertices_);
+    } else {
+        screenVertices_ = srcTriangles_.vertices();
+        bb = srcTriangles_.bounds();
     }
 
-    // translate the path into top-left-centric coordinates
-    QRectF bb = ppi.boundingRect();
-    ppi.translate(-bb.left(), -bb.top());
-    firstPointOffset_ = -1 * bb.topLeft();
+    if (screenVertices_.isEmpty())
+        return;
 
-    ppi.closeSubpath();
-
-    screenOutline_ = ppi;
-
-    std::vector<p2t::Point*> curPts;
-    curPts.reserve(ppi.elementCount());
-    for (int i = 0; i < ppi.elementCount(); ++i) {
-        const QPainterPath::Element e = ppi.elementAt(i);
-        if (e.isMoveTo() || i == ppi.elementCount() - 1
-                || (qAbs(e.x - curPts.front()->x) < 0.1
-                    && qAbs(e.y - curPts.front()->y) < 0.1)) {
-            if (curPts.size() > 2) {
-                p2t::CDT *cdt = new p2t::CDT(curPts);
-                cdt->Triangulate();
-                std::vector<p2t::Triangle*> tris = cdt->GetTriangles();
-                screenVertices_.reserve(screenVertices_.size() + int(tris.size()));
-                for (size_t i = 0; i < tris.size(); ++i) {
-                    p2t::Triangle *t = tris.at(i);
-                    for (int j = 0; j < 3; ++j) {
-                        p2t::Point *p = t->GetPoint(j);
-                        screenVertices_ << Point(p->x, p->y);
-                    }
-                }
-                delete cdt;
-            }
-            curPts.clear();
-            curPts.reserve(ppi.elementCount() - i);
-            curPts.push_back(new p2t::Point(e.x, e.y));
-        } else if (e.isLineTo()) {
-            curPts.push_back(new p2t::Point(e.x, e.y));
-        } else {
-            qWarning("Unhandled element type in polygon painterpath");
+    if (!transform.isIdentity()) {
+        QPolygonF mapped(screenVertices_.size());
+        for (int i = 0; i < screenVertices_.size(); ++i) {
+            mapped[i] = transform.map(QPointF(screenVertices_[i].x, screenVertices_[i].y));
+            screenVertices_[i] = Point(mapped[i]);
         }
+        bb = mapped.boundingRect();
     }
 
-    if (curPts.size() > 0) {
-        qDeleteAll(curPts.begin(), curPts.end());
-        curPts.clear();
+    // translate the triangles into top-left-centric coordinates
+    for (int i = 0; i < screenVertices_.size(); ++i) {
+        screenVertices_[i].x -= bb.left();
+        screenVertices_[i].y -= bb.top();
     }
+    firstPointOffset_ = -1 * bb.topLeft();
 
-    screenBounds_ = ppi.boundingRect();
-
+    screenOutline_ = transform.map(srcPath_).translated(firstPointOffset_);
+    screenBounds_ = QRectF(QPointF(0, 0), bb.size());
 }
 
 QDeclarativePolygonMapItem::QDeclarativePolygonMapItem(QQuickItem *parent) :
@@ -326,6 +382,10 @@ QDeclarativePolygonMapItem::QDeclarativePolygonMapItem(QQuickItem *parent) :
                      this, SLOT(handleBorderUpdated()));
     QObject::connect(&border_, SIGNAL(widthChanged(qreal)),
                      this, SLOT(handleBorderUpdated()));
+    QObject::connect(&geometry_, SIGNAL(updated()),
+                     this, SLOT(updateMapItem()));
+    QObject::connect(&borderGeometry_, SIGNAL(updated()),
+                     this, SLOT(updateMapItem()));
 }
 
 /*!
@@ -385,9 +445,9 @@ QJSValue QDeclarativePolygonMapItem::path() const
     QV8Engine *v8Engine = QQmlEnginePrivate::getV8Engine(engine);
     QV8ValueTypeWrapper *valueTypeWrapper = v8Engine->valueTypeWrapper();
 
-    v8::Local<v8::Array> pathArray = v8::Array::New(path_.length());
-    for (int i = 0; i < path_.length(); ++i) {
-        const QGeoCoordinate &c = path_.at(i);
+    v8::Local<v8::Array> pathArray = v8::Array::New(path_.size());
+    for (int i = 0; i < path_.size(); ++i) {
+        QGeoCoordinate c = path_.at(i);
 
         QQmlValueType *vt = QQmlValueTypeFactory::valueType(qMetaTypeId<QGeoCoordinate>());
         v8::Local<v8::Object> cv = valueTypeWrapper->newValueType(QVariant::fromValue(c), vt);
@@ -403,8 +463,9 @@ void QDeclarativePolygonMapItem::setPath(const QJSValue &value)
     if (!value.isArray())
         return;
 
-    QList<QGeoCoordinate> pathList;
+    QGeoCoordinateArray pathList;
     quint32 length = value.property(QStringLiteral("length")).toUInt();
+    pathList.reserve(length);
     for (quint32 i = 0; i < length; ++i) {
         bool ok;
         QGeoCoordinate c = parseCoordinate(value.property(i), &ok);
@@ -422,6 +483,8 @@ void QDeclarativePolygonMapItem::setPath(const QJSValue &value)
 
     path_ = pathList;
 
+    updateBorderPath();
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     borderGeometry_.markSourceDirty();
     updateMapItem();
@@ -440,6 +503,8 @@ void QDeclarativePolygonMapItem::addCoordinate(const QGeoCoordinate &coordinate)
 {
     path_.append(coordinate);
 
+    updateBorderPath();
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     borderGeometry_.markSourceDirty();
     updateMapItem();
@@ -471,6 +536,8 @@ void QDeclarativePolygonMapItem::removeCoordinate(const QGeoCoordinate &coordina
     }
     path_.removeAt(index);
 
+    updateBorderPath();
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     borderGeometry_.markSourceDirty();
     updateMapItem();
@@ -524,6 +591,19 @@ QSGNode *QDeclarativePolygonMapItem::updateMapItemPaintNode(QSGNode *oldNode, Up
     return node;
 }
 
+/*!
+    \internal
+    Closes the path for the border. The closed copy is only made when the
+    path changes, so that the border geometry keeps finding its simplified
+    path built for the same array.
+*/
+void QDeclarativePolygonMapItem::updateBorderPath()
+{
+    borderPath_ = path_;
+    if (!borderPath_.isEmpty())
+        borderPath_.append(borderPath_.at(0));
+}
+
 /*!
     \internal
 */
@@ -536,9 +616,7 @@ void QDeclarativePolygonMapItem::updateMapItem()
     geometry_.updateScreenPoints(*map());
 
     if (border_.color() != Qt::transparent && border_.width() > 0) {
-        QList<QGeoCoordinate> closedPath = path_;
-        closedPath << closedPath.first();
-        borderGeometry_.updateSourcePoints(*map(), closedPath);
+        borderGeometry_.updateSourcePoints(*map(), borderPath_);
         borderGeometry_.updateScreenPoints(*map(), border_.width());
 
         QList<QGeoMapItemGeometry *> geoms;
@@ -600,6 +678,14 @@ bool QDeclarativePolygonMapItem::contains(const QPointF &point) const
     return (geometry_.contains(point) || borderGeometry_.contains(point));
 }
 
+/*!
+    \internal
+*/
+QRectF QDeclarativePolygonMapItem::mercatorBoundingBox() const
+{
+    return QGeoMapItemGeometry::mercatorBoundingBox(path_);
+}
+
 /*!
     \internal
 */
@@ -618,12 +704,12 @@ void QDeclarativePolygonMapItem::dragEnded()
     QPointF newPoint = QPointF(x(),y()) + geometry_.firstPointOffset();
     QGeoCoordinate newCoordinate = map()->screenPositionToCoordinate(newPoint, false);
     if (newCoordinate.isValid()) {
-        double firstLongitude = path_.at(0).longitude();
-        double firstLatitude = path_.at(0).latitude();
+        double firstLongitude = path_.longitude(0);
+        double firstLatitude = path_.latitude(0);
         double minMaxLatitude = firstLatitude;
         // prevent dragging over valid min and max latitudes
         for (int i = 0; i < path_.count(); ++i) {
-            double newLatitude = path_.at(i).latitude()
+            double newLatitude = path_.latitude(i)
                     + newCoordinate.latitude() - firstLatitude;
             if (!QLocationUtils::isValidLat(newLatitude)) {
                 if (qAbs(newLatitude) > qAbs(minMaxLatitude)) {
@@ -649,6 +735,8 @@ void QDeclarativePolygonMapItem::dragEnded()
                            + newCoordinate.longitude() - firstLongitude));
         geometry_.setPreserveGeometry(true, leftBoundCoord);
         borderGeometry_.setPreserveGeometry(true, leftBoundCoord);
+        updateBorderPath();
+        mercatorBoundingBoxChanged();
         geometry_.markSourceDirty();
         borderGeometry_.markSourceDirty();
         updateMapItem();
@@ -45,14 +45,17 @@
 #include "qdeclarativegeomapitembase_p.h"
 #include "qdeclarativepolylinemapitem_p.h"
 #include "qgeomapitemgeometry_p.h"
+#include "qgeomappolygontriangles_p.h"
 
 #include <QtQml/private/qv8engine_p.h>
+#include <QSharedPointer>
 #include <QSGGeometryNode>
 #include <QSGFlatColorMaterial>
 
 QT_BEGIN_NAMESPACE
 
 class MapPolygonNode;
+class QGeoPolygonTriangulateJob;
 
 class QGeoMapPolygonGeometry : public QGeoMapItemGeometry
 {
@@ -60,17 +63,32 @@ class QGeoMapPolygonGeometry : public QGeoMapItemGeometry
 
 public:
     explicit QGeoMapPolygonGeometry(QObject *parent = 0);
+    ~QGeoMapPolygonGeometry();
 
     inline void setAssumeSimple(bool value) { assumeSimple_ = value; }
 
     void updateSourcePoints(const QGeoMap &map,
-                            const QList<QGeoCoordinate> &path);
+                            const QGeoCoordinateArray &path);
+    inline void updateSourcePoints(const QGeoMap &map,
+                                   const QList<QGeoCoordinate> &path)
+    { updateSourcePoints(map, QGeoCoordinateArray(path)); }
 
     void updateScreenPoints(const QGeoMap &map);
 
+private Q_SLOTS:
+    void triangulationFinished();
+
 protected:
     QPainterPath srcPath_;
+    QGeoMapPolygonTriangles srcTriangles_;
     bool assumeSimple_;
+
+private:
+    void cancelTriangulation();
+
+    QGeoMapCameraSnapshot trianglesCamera_;
+    bool trianglesCurrent_;
+    QSharedPointer<QGeoPolygonTriangulateJob> triangulateJob_;
 };
 
 class QDeclarativePolygonMapItem : public QDeclarativeGeoMapItemBase
@@ -108,6 +126,9 @@ Q_SIGNALS:
     void pathChanged();
     void colorChanged(const QColor &color);
 
+protected:
+    QRectF mercatorBoundingBox() const;
+
 protected Q_SLOTS:
     virtual void updateMapItem();
     void handleBorderUpdated();
@@ -115,9 +136,11 @@ protected Q_SLOTS:
 
 private:
     void pathPropertyChanged();
+    void updateBorderPath();
 
     QDeclarativeMapLineProperties border_;
-    QList<QGeoCoordinate> path_;
+    QGeoCoordinateArray path_;
+    QGeoCoordinateArray borderPath_;
     QColor color_;
     bool dirtyMaterial_;
     QGeoMapPolygonGeometry geometry_;
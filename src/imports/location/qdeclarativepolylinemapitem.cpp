@@ -40,8 +40,10 @@
  ****************************************************************************/
 
 #include "qdeclarativepolylinemapitem_p.h"
+#include "qgeomapgeometryjob_p.h"
 #include "qgeocameracapabilities_p.h"
 #include "qlocationutils_p.h"
+#include "qgeoprojection_p.h"
 #include "error_messages.h"
 #include "locationvaluetypeprovider.h"
 
@@ -53,6 +55,8 @@
 #include <QPainterPathStroker>
 #include <qnumeric.h>
 
+#include <cmath>
+
 #include <QtGui/private/qvectorpath_p.h>
 #include <QtGui/private/qtriangulatingstroker_p.h>
 #include <QtGui/private/qtriangulator_p.h>
@@ -90,6 +94,8 @@ QT_BEGIN_NAMESPACE
     MapPolylines have a rendering cost that is O(n) with respect to the number
     of vertices. This means that the per frame cost of having a polyline on
     the Map grows in direct proportion to the number of points in the polyline.
+    Polylines with many points are stroked on a worker thread, and the previous
+    stroke is drawn, moved along with the map, until the new one is ready.
 
     Like the other map objects, MapPolyline is normally drawn without a smooth
     appearance. Setting the \l {QtQuick2::Item::opacity}{opacity} property will force the object to
@@ -176,16 +182,129 @@ struct Vertex
     QVector2D position;
 };
 
+// paths shorter than this are projected whole on every update
+static const int SimplifyMinimumPoints = 1000;
+// how far, in pixels, the simplified line may stray from the path
+static const double SimplifyTolerance = 1.0;
+
+// paths with fewer points than this are stroked right away, longer ones on
+// a worker thread once they have been drawn once
+static const int StrokeJobMinimumPoints = 500;
+
+class QGeoPolylineSimplifyJob : public QGeoMapGeometryJob
+{
+public:
+    QGeoPolylineSimplifyJob(QGeoMapPolylineGeometry *geometry,
+                            const QGeoCoordinateArray &path)
+        : QGeoMapGeometryJob(geometry, "simplificationFinished"), path(path) {}
+
+    QGeoCoordinateArray path;
+    QGeoSimplifiedPath result;
+
+protected:
+    void run()
+    {
+        result = QGeoSimplifiedPath(path);
+    }
+};
+
+class QGeoPolylineStrokeJob : public QGeoMapGeometryJob
+{
+public:
+    QGeoPolylineStrokeJob(QGeoMapPolylineGeometry *geometry,
+                          const QVector<qreal> &points,
+                          const QVector<QPainterPath::ElementType> &types,
+                          const QGeoPolylineStroke &stroke)
+        : QGeoMapGeometryJob(geometry, "strokeFinished"),
+          points(points), types(types), stroke(stroke) {}
+
+    QVector<qreal> points;
+    QVector<QPainterPath::ElementType> types;
+    QGeoPolylineStroke stroke;
+
+protected:
+    void run();
+};
+
 QGeoMapPolylineGeometry::QGeoMapPolylineGeometry(QObject *parent) :
-    QGeoMapItemGeometry(parent)
+    QGeoMapItemGeometry(parent),
+    sourceSerial_(0),
+    screenWidth_(0)
+{
+}
+
+QGeoMapPolylineGeometry::~QGeoMapPolylineGeometry()
+{
+    if (simplifyJob_)
+        simplifyJob_->cancel();
+    if (strokeJob_)
+        strokeJob_->cancel();
+}
+
+/*!
+    \internal
+*/
+void QGeoMapPolylineGeometry::simplificationFinished()
+{
+    if (!simplifyJob_ || !simplifyJob_->isFinished())
+        return;
+
+    simplified_ = simplifyJob_->result;
+    simplifyJob_.clear();
+
+    markSourceDirty();
+    emit updated();
+}
+
+/*!
+    \internal
+    Returns the points of \a path to draw at the current zoom level of
+    \a map, or 0 to draw all of them. The first time a long path is seen
+    it is simplified on a worker thread and drawn whole until that is done,
+    updated() is emitted then.
+*/
+const QVector<int> *QGeoMapPolylineGeometry::simplifiedIndices(const QGeoMap &map,
+                                                               const QGeoCoordinateArray &path)
 {
+    if (path.size() < SimplifyMinimumPoints) {
+        simplified_ = QGeoSimplifiedPath();
+        return 0;
+    }
+
+    if (!simplified_.isBuiltFor(path)) {
+        if (!simplifyJob_ || !simplifyJob_->path.isSharedWith(path)) {
+            if (simplifyJob_)
+                simplifyJob_->cancel();
+            simplifyJob_ = QSharedPointer<QGeoPolylineSimplifyJob>(
+                        new QGeoPolylineSimplifyJob(this, path));
+            QGeoMapGeometryJob::start(simplifyJob_);
+        }
+        return 0;
+    }
+
+    // how many pixels one mercator unit takes around the middle of the path
+    const double step = 1.0e-4;
+    QDoubleVector2D center = simplified_.center();
+    if (center.x() > 0.5)
+        center.setX(center.x() - step);
+    QGeoCoordinate from = QGeoProjection::mercatorToCoord(center);
+    QGeoCoordinate to = QGeoProjection::mercatorToCoord(center + QDoubleVector2D(step, 0.0));
+
+    double probe[4] = { from.latitude(), from.longitude(), to.latitude(), to.longitude() };
+    map.coordinatesToScreenPositions(probe, probe, 2);
+    double scale = std::sqrt((probe[2] - probe[0]) * (probe[2] - probe[0])
+                             + (probe[3] - probe[1]) * (probe[3] - probe[1])) / step;
+    if (!qIsFinite(scale) || scale <= 0.0)
+        return 0;
+
+    return &simplified_.indicesForTolerance(SimplifyTolerance / scale);
 }
 
 /*!
     \internal
 */
 void QGeoMapPolylineGeometry::updateSourcePoints(const QGeoMap &map,
-                                                 const QList<QGeoCoordinate> &path)
+                                                 const QGeoCoordinateArray &path)
 {
     bool foundValid = false;
     qreal minX = -1.0;
@@ -196,6 +315,10 @@ void QGeoMapPolylineGeometry::updateSourcePoints(const QGeoMap &map,
     if (!sourceDirty_)
         return;
 
+    // strokes of the points this replaces can only be drawn as stand-ins
+    ++sourceSerial_;
+    hitGrid_.clear();
+
     // clear the old data and reserve enough memory
     srcPoints_.clear();
     srcPoints_.reserve(path.size() * 2);
@@ -208,13 +331,21 @@ void QGeoMapPolylineGeometry::updateSourcePoints(const QGeoMap &map,
     if (preserveGeometry_)
         unwrapBelowX = map.coordinateToScreenPosition(geoLeftBound_, false).x();
 
-    for (int i = 0; i < path.size(); ++i) {
-        const QGeoCoordinate &coord = path.at(i);
+    const QVector<int> *indices = simplifiedIndices(map, path);
+    int count = indices ? indices->size() : path.size();
 
-        if (!coord.isValid())
+    QVector<double> screen;
+    if (indices)
+        projectPath(map, path, *indices, screen);
+    else
+        projectPath(map, path, screen);
+
+    for (int j = 0; j < count; ++j) {
+        int i = indices ? indices->at(j) : j;
+        if (!path.isValid(i))
             continue;
 
-        QPointF point = map.coordinateToScreenPosition(coord, false);
+        QPointF point(screen.at(2 * j), screen.at(2 * j + 1));
 
         // We can get NaN if the map isn't set up correctly, or the projection
         // is faulty -- probably best thing to do is abort
@@ -223,11 +354,11 @@ void QGeoMapPolylineGeometry::updateSourcePoints(const QGeoMap &map,
 
         // unwrap x to preserve geometry if moved to border of map
         if (preserveGeometry_ && point.x() < unwrapBelowX && !qFuzzyCompare(point.x(), unwrapBelowX))
-            point.setX(unwrapBelowX + geoDistanceToScreenWidth(map, geoLeftBound_, coord));
+            point.setX(unwrapBelowX + geoDistanceToScreenWidth(map, geoLeftBound_, path.at(i)));
 
         if (!foundValid) {
             foundValid = true;
-            srcOrigin_ = coord;
+            srcOrigin_ = path.at(i);
             origin = point;
             point = QPointF(0,0);
 
@@ -250,7 +381,7 @@ void QGeoMapPolylineGeometry::updateSourcePoints(const QGeoMap &map,
             maxY = qMax(point.y(), maxY);
 
             if ((point - lastAddedPoint).manhattanLength() > 3 ||
-                    i == path.size() - 1) {
+                    j == count - 1) {
                 srcPoints_ << point.x() << point.y();
                 srcPointTypes_ << QPainterPath::LineToElement;
                 lastAddedPoint = point;
@@ -379,9 +510,89 @@ static void clipPathToRect(const QVector<qreal> &points,
     }
 }
 
+/*
+    Clips the source \a points and \a types to the rectangle of \a stroke if
+    it asks for that and strokes them into its vertices with its width. This
+    runs on worker threads as well as on the GUI thread.
+*/
+static void strokePath(const QVector<qreal> &points,
+                       const QVector<QPainterPath::ElementType> &types,
+                       QGeoPolylineStroke &stroke)
+{
+    QVector<qreal> clippedPoints;
+    QVector<QPainterPath::ElementType> clippedTypes;
+
+    if (stroke.clipped) {
+        clipPathToRect(points, types, stroke.clipRect, clippedPoints, clippedTypes);
+    } else {
+        clippedPoints = points;
+        clippedTypes = types;
+    }
+
+    QVectorPath vp(clippedPoints.data(), clippedTypes.size(), clippedTypes.data());
+    QTriangulatingStroker ts;
+    ts.process(vp, QPen(QBrush(Qt::black), stroke.width), stroke.clipRect,
+               QPainter::Qt4CompatiblePainting);
+
+    stroke.vertices.clear();
+    stroke.bounds = QRectF();
+
+    // QTriangulatingStroker#vertexCount is actually the length of the array,
+    // not the number of vertices
+    int count = ts.vertexCount() / 2;
+    stroke.vertices.reserve(count);
+
+    const float *vs = ts.vertices();
+    qreal minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for (int i = 0; i < count; ++i) {
+        qreal x = vs[2 * i];
+        qreal y = vs[2 * i + 1];
+        if (!qIsFinite(x) || !qIsFinite(y))
+            break;
+
+        if (i == 0) {
+            minX = maxX = x;
+            minY = maxY = y;
+        } else {
+            minX = qMin(minX, x);
+            maxX = qMax(maxX, x);
+            minY = qMin(minY, y);
+            maxY = qMax(maxY, y);
+        }
+        stroke.vertices << QGeoMapItemGeometry::Point(x, y);
+    }
+
+    if (!stroke.vertices.isEmpty())
+        stroke.bounds = QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+}
+
+void QGeoPolylineStrokeJob::run()
+{
+    strokePath(points, types, stroke);
+}
+
 /*!
     \internal
 */
+void QGeoMapPolylineGeometry::strokeFinished()
+{
+    if (!strokeJob_ || !strokeJob_->isFinished())
+        return;
+
+    stroke_ = strokeJob_->stroke;
+    strokeJob_.clear();
+
+    // keeps clipToViewport_ as it is
+    screenDirty_ = true;
+    emit updated();
+}
+
+/*!
+    \internal
+    Long paths are stroked on a worker thread, with room around the viewport
+    to pan in before they have to be stroked again. Until the new stroke is
+    ready the last one is drawn, moved to where the camera shows it now.
+*/
 void QGeoMapPolylineGeometry::updateScreenPoints(const QGeoMap &map,
                                                  qreal strokeWidth)
 {
@@ -401,51 +612,106 @@ void QGeoMapPolylineGeometry::updateScreenPoints(const QGeoMap &map,
     viewport.adjust(-strokeWidth, -strokeWidth, strokeWidth, strokeWidth);
     viewport.translate(-1 * origin);
 
-    // Perform clipping to the viewport limits
-    QVector<qreal> points;
-    QVector<QPainterPath::ElementType> types;
-
-    if (clipToViewport_) {
-        clipPathToRect(srcPoints_, srcPointTypes_, viewport, points, types);
-    } else {
-        points = srcPoints_;
-        types = srcPointTypes_;
+    QTransform transform;
+    if (!stroke_.covers(sourceSerial_, strokeWidth, clipToViewport_, viewport)) {
+        QGeoPolylineStroke request;
+        request.serial = sourceSerial_;
+        request.width = strokeWidth;
+        request.clipped = clipToViewport_;
+        request.clipRect = viewport;
+
+        if (srcPointTypes_.size() < StrokeJobMinimumPoints || !stroke_.camera.isValid()) {
+            if (strokeJob_) {
+                strokeJob_->cancel();
+                strokeJob_.clear();
+            }
+            strokePath(srcPoints_, srcPointTypes_, request);
+            request.camera = QGeoMapCameraSnapshot(map, srcOrigin_);
+            stroke_ = request;
+        } else {
+            if (!strokeJob_ || !strokeJob_->stroke.covers(sourceSerial_, strokeWidth,
+                                                          clipToViewport_, viewport)) {
+                if (strokeJob_)
+                    strokeJob_->cancel();
+                request.clipRect.adjust(-viewport.width() / 2, -viewport.height() / 2,
+                                        viewport.width() / 2, viewport.height() / 2);
+                request.camera = QGeoMapCameraSnapshot(map, srcOrigin_);
+                strokeJob_ = QSharedPointer<QGeoPolylineStrokeJob>(
+                            new QGeoPolylineStrokeJob(this, srcPoints_, srcPointTypes_, request));
+                QGeoMapGeometryJob::start(strokeJob_);
+            }
+            transform = stroke_.camera.toScreen(map)
+                    * QTransform::fromTranslate(-origin.x(), -origin.y());
+        }
     }
 
-    QVectorPath vp(points.data(), types.size(), types.data());
-    QTriangulatingStroker ts;
-    ts.process(vp, QPen(QBrush(Qt::black), strokeWidth), viewport, QPainter::Qt4CompatiblePainting);
-
     clear();
 
     // Nothing is on the screen
-    if (ts.vertexCount() == 0)
+    if (stroke_.vertices.isEmpty())
         return;
 
-    // QTriangulatingStroker#vertexCount is actually the length of the array,
-    // not the number of vertices
-    screenVertices_.reserve(ts.vertexCount());
+    // the stroke is only moved into place as it is written out to the
+    // scene graph, by allocateAndFill()
+    screenStroke_ = stroke_.vertices;
+    screenTransform_ = transform;
+    screenWidth_ = strokeWidth;
+    screenBounds_ = transform.mapRect(stroke_.bounds);
+    this->translate( -1 * sourceBounds_.topLeft());
+}
+
+/*!
+    \internal
+    Hit-tests \a screenPoint against the source path rather than the
+    triangles of the stroke. The segments are sorted into a grid the first
+    time a point is tested after the path changed.
+*/
+bool QGeoMapPolylineGeometry::contains(const QPointF &screenPoint) const
+{
+    if (screenStroke_.isEmpty())
+        return false;
 
-    screenOutline_ = QPainterPath();
+    if (!hitGrid_.isBuilt())
+        hitGrid_.build(srcPoints_, srcPointTypes_);
 
-    QPolygonF tri;
-    const float *vs = ts.vertices();
-    for (int i = 0; i < (ts.vertexCount()/2*2); i += 2) {
-        screenVertices_ << Point(vs[i], vs[i + 1]);
+    return hitGrid_.contains(screenPoint - firstPointOffset_, screenWidth_ / 2);
+}
 
-        if (!qIsFinite(vs[i]) || !qIsFinite(vs[i + 1]))
-            break;
+/*!
+    \internal
+*/
+quint32 QGeoMapPolylineGeometry::size() const
+{
+    return screenStroke_.size() / 3;
+}
 
-        tri << QPointF(vs[i], vs[i + 1]);
-        if (tri.size() == 4) {
-            tri.remove(0);
-            screenOutline_.addPolygon(tri);
-        }
-    }
+/*!
+    \internal
+*/
+void QGeoMapPolylineGeometry::clear()
+{
+    QGeoMapItemGeometry::clear();
+    screenStroke_.clear();
+    screenTransform_.reset();
+}
 
-    QRectF bb = screenOutline_.boundingRect();
-    screenBounds_ = bb;
-    this->translate( -1 * sourceBounds_.topLeft());
+/*!
+    \internal
+*/
+void QGeoMapPolylineGeometry::allocateAndFill(QSGGeometry *geom) const
+{
+    geom->allocate(screenStroke_.size());
+
+    QTransform transform = screenTransform_
+            * QTransform::fromTranslate(firstPointOffset_.x(), firstPointOffset_.y());
+
+    QSGGeometry::Point2D *pts = geom->vertexDataAsPoint2D();
+    const Point *vertices = screenStroke_.constData();
+    for (int i = 0; i < screenStroke_.size(); ++i) {
+        qreal x, y;
+        transform.map(vertices[i].x, vertices[i].y, &x, &y);
+        pts[i].set(x, y);
+    }
 }
 
 QDeclarativePolylineMapItem::QDeclarativePolylineMapItem(QQuickItem *parent) :
@@ -457,6 +723,8 @@ QDeclarativePolylineMapItem::QDeclarativePolylineMapItem(QQuickItem *parent) :
                      this, SLOT(updateAfterLinePropertiesChanged()));
     QObject::connect(&line_, SIGNAL(widthChanged(qreal)),
                      this, SLOT(updateAfterLinePropertiesChanged()));
+    QObject::connect(&geometry_, SIGNAL(updated()),
+                     this, SLOT(updateMapItem()));
 }
 
 QDeclarativePolylineMapItem::~QDeclarativePolylineMapItem()
@@ -499,9 +767,9 @@ QJSValue QDeclarativePolylineMapItem::path() const
     QV8Engine *v8Engine = QQmlEnginePrivate::getV8Engine(engine);
     QV8ValueTypeWrapper *valueTypeWrapper = v8Engine->valueTypeWrapper();
 
-    v8::Local<v8::Array> pathArray = v8::Array::New(path_.length());
-    for (int i = 0; i < path_.length(); ++i) {
-        const QGeoCoordinate &c = path_.at(i);
+    v8::Local<v8::Array> pathArray = v8::Array::New(path_.size());
+    for (int i = 0; i < path_.size(); ++i) {
+        QGeoCoordinate c = path_.at(i);
 
         QQmlValueType *vt = QQmlValueTypeFactory::valueType(qMetaTypeId<QGeoCoordinate>());
         v8::Local<v8::Object> cv = valueTypeWrapper->newValueType(QVariant::fromValue(c), vt);
@@ -517,8 +785,9 @@ void QDeclarativePolylineMapItem::setPath(const QJSValue &value)
     if (!value.isArray())
         return;
 
-    QList<QGeoCoordinate> pathList;
+    QGeoCoordinateArray pathList;
     quint32 length = value.property(QStringLiteral("length")).toUInt();
+    pathList.reserve(length);
     for (quint32 i = 0; i < length; ++i) {
         bool ok;
         QGeoCoordinate c = parseCoordinate(value.property(i), &ok);
@@ -536,6 +805,7 @@ void QDeclarativePolylineMapItem::setPath(const QJSValue &value)
 
     path_ = pathList;
 
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     updateMapItem();
     emit pathChanged();
@@ -553,6 +823,7 @@ void QDeclarativePolylineMapItem::addCoordinate(const QGeoCoordinate &coordinate
 {
     path_.append(coordinate);
 
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     updateMapItem();
     emit pathChanged();
@@ -582,6 +853,7 @@ void QDeclarativePolylineMapItem::removeCoordinate(const QGeoCoordinate &coordin
     }
     path_.removeAt(index);
 
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     updateMapItem();
     emit pathChanged();
@@ -680,6 +952,14 @@ bool QDeclarativePolylineMapItem::contains(const QPointF &point) const
     return geometry_.contains(point);
 }
 
+/*!
+    \internal
+*/
+QRectF QDeclarativePolylineMapItem::mercatorBoundingBox() const
+{
+    return QGeoMapItemGeometry::mercatorBoundingBox(path_);
+}
+
 /*!
     \internal
 */
@@ -697,12 +977,12 @@ void QDeclarativePolylineMapItem::dragEnded()
     QPointF newPoint = QPointF(x(),y()) + geometry_.firstPointOffset();
     QGeoCoordinate newCoordinate = map()->screenPositionToCoordinate(newPoint, false);
     if (newCoordinate.isValid()) {
-        double firstLongitude = path_.at(0).longitude();
-        double firstLatitude = path_.at(0).latitude();
+        double firstLongitude = path_.longitude(0);
+        double firstLatitude = path_.latitude(0);
         double minMaxLatitude = firstLatitude;
         // prevent dragging over valid min and max latitudes
         for (int i = 0; i < path_.count(); ++i) {
-            double newLatitude = path_.at(i).latitude()
+            double newLatitude = path_.latitude(i)
                     + newCoordinate.latitude() - firstLatitude;
             if (!QLocationUtils::isValidLat(newLatitude)) {
                 if (qAbs(newLatitude) > qAbs(minMaxLatitude)) {
@@ -726,6 +1006,7 @@ void QDeclarativePolylineMapItem::dragEnded()
         leftBoundCoord.setLongitude(QLocationUtils::wrapLong(leftBoundCoord.longitude()
                            + newCoordinate.longitude() - firstLongitude));
         geometry_.setPreserveGeometry(true, leftBoundCoord);
+        mercatorBoundingBoxChanged();
         geometry_.markSourceDirty();
         updateMapItem();
         emit pathChanged();
@@ -44,15 +44,20 @@
 
 #include "qdeclarativegeomapitembase_p.h"
 #include "qgeomapitemgeometry_p.h"
+#include "qgeomappolylinehitgrid_p.h"
+#include "qgeosimplifiedpath_p.h"
 
 #include <QtQml/private/qv8engine_p.h>
 
+#include <QSharedPointer>
 #include <QSGGeometryNode>
 #include <QSGFlatColorMaterial>
 
 QT_BEGIN_NAMESPACE
 
 class MapPolylineNode;
+class QGeoPolylineSimplifyJob;
+class QGeoPolylineStrokeJob;
 
 class QDeclarativeMapLineProperties : public QObject
 {
@@ -79,24 +84,75 @@ private:
     QColor color_;
 };
 
+/*
+ * The triangles a polyline was stroked into, with what they were made of:
+ * the source points of one update, a pen width and the rectangle the path
+ * was clipped to, in the coordinates of the source points.
+ */
+struct QGeoPolylineStroke
+{
+    QGeoPolylineStroke() : serial(-1), width(0), clipped(false) {}
+
+    inline bool covers(int sourceSerial, qreal strokeWidth, bool clip,
+                       const QRectF &viewport) const
+    {
+        return serial == sourceSerial && width == strokeWidth
+                && (!clipped || (clip && clipRect.contains(viewport)));
+    }
+
+    QVector<QGeoMapItemGeometry::Point> vertices;
+    QRectF bounds;
+    QGeoMapCameraSnapshot camera;
+    QRectF clipRect;
+    int serial;
+    qreal width;
+    bool clipped;
+};
+
 class QGeoMapPolylineGeometry : public QGeoMapItemGeometry
 {
     Q_OBJECT
 
 public:
     explicit QGeoMapPolylineGeometry(QObject *parent = 0);
+    ~QGeoMapPolylineGeometry();
 
     void updateSourcePoints(const QGeoMap &map,
-                            const QList<QGeoCoordinate> &path);
+                            const QGeoCoordinateArray &path);
+    inline void updateSourcePoints(const QGeoMap &map,
+                                   const QList<QGeoCoordinate> &path)
+    { updateSourcePoints(map, QGeoCoordinateArray(path)); }
 
     void updateScreenPoints(const QGeoMap &map,
                             qreal strokeWidth);
 
+    bool contains(const QPointF &screenPoint) const;
+    quint32 size() const;
+    void clear();
+    void allocateAndFill(QSGGeometry *geom) const;
+
+private Q_SLOTS:
+    void simplificationFinished();
+    void strokeFinished();
+
 private:
+    const QVector<int> *simplifiedIndices(const QGeoMap &map,
+                                          const QGeoCoordinateArray &path);
+
     QVector<qreal> srcPoints_;
     QVector<QPainterPath::ElementType> srcPointTypes_;
+    int sourceSerial_;
 
+    QGeoSimplifiedPath simplified_;
+    QSharedPointer<QGeoPolylineSimplifyJob> simplifyJob_;
 
+    QGeoPolylineStroke stroke_;
+    QSharedPointer<QGeoPolylineStrokeJob> strokeJob_;
+
+    QVector<Point> screenStroke_;
+    QTransform screenTransform_;
+    qreal screenWidth_;
+    mutable QGeoMapPolylineHitGrid hitGrid_;
 };
 
 class QDeclarativePolylineMapItem : public QDeclarativeGeoMapItemBase
@@ -130,6 +186,9 @@ public:
 Q_SIGNALS:
     void pathChanged();
 
+protected:
+    QRectF mercatorBoundingBox() const;
+
 protected Q_SLOTS:
     virtual void updateMapItem();
     void updateAfterLinePropertiesChanged();
@@ -139,7 +198,7 @@ private:
     void pathPropertyChanged();
 
     QDeclarativeMapLineProperties line_;
-    QList<QGeoCoordinate> path_;
+    QGeoCoordinateArray path_;
     QColor color_;
     bool dirtyMaterial_;
     QGeoMapPolylineGeometry geometry_;
@@ -43,6 +43,7 @@
 #include "qdeclarativepolygonmapitem_p.h"
 #include "qgeocameracapabilities_p.h"
 #include "qlocationutils_p.h"
+#include "qgeoprojection_p.h"
 #include <QPainterPath>
 #include <qnumeric.h>
 #include <QRectF>
@@ -232,6 +233,7 @@ void QDeclarativeRectangleMapItem::setTopLeft(const QGeoCoordinate &topLeft)
 
     topLeft_ = topLeft;
 
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     borderGeometry_.markSourceDirty();
     updateMapItem();
@@ -266,6 +268,7 @@ void QDeclarativeRectangleMapItem::setBottomRight(const QGeoCoordinate &bottomRi
 
     bottomRight_ = bottomRight;
 
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     borderGeometry_.markSourceDirty();
     updateMapItem();
@@ -415,6 +418,25 @@ bool QDeclarativeRectangleMapItem::contains(const QPointF &point) const
     return (geometry_.contains(point) || borderGeometry_.contains(point));
 }
 
+/*!
+    \internal
+*/
+QRectF QDeclarativeRectangleMapItem::mercatorBoundingBox() const
+{
+    if (!topLeft_.isValid() || !bottomRight_.isValid())
+        return QRectF();
+
+    QDoubleVector2D topLeft = QGeoProjection::coordToMercator(topLeft_);
+    QDoubleVector2D bottomRight = QGeoProjection::coordToMercator(bottomRight_);
+
+    // a rectangle whose right edge is west of its left one crosses the dateline
+    double right = bottomRight.x();
+    if (right < topLeft.x())
+        right += 1.0;
+
+    return QRectF(QPointF(topLeft.x(), topLeft.y()), QPointF(right, bottomRight.y()));
+}
+
 /*!
     \internal
 */
@@ -452,6 +474,7 @@ void QDeclarativeRectangleMapItem::dragEnded()
         bottomRight_ = newBottomRight;
         geometry_.setPreserveGeometry(true, newTopLeft);
         borderGeometry_.setPreserveGeometry(true, newTopLeft);
+        mercatorBoundingBoxChanged();
         geometry_.markSourceDirty();
         borderGeometry_.markSourceDirty();
         updateMapItem();
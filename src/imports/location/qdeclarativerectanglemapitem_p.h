@@ -101,6 +101,9 @@ Q_SIGNALS:
     void bottomRightChanged(const QGeoCoordinate &bottomRight);
     void colorChanged(const QColor &color);
 
+protected:
+    QRectF mercatorBoundingBox() const;
+
 protected Q_SLOTS:
     virtual void updateMapItem();
     void updateMapItemAssumeDirty();
@@ -91,6 +91,8 @@ QDeclarativeRouteMapItem::QDeclarativeRouteMapItem(QQuickItem *parent):
                      this, SLOT(updateAfterLinePropertiesChanged()));
     QObject::connect(&line_, SIGNAL(widthChanged(qreal)),
                      this, SLOT(updateAfterLinePropertiesChanged()));
+    QObject::connect(&geometry_, SIGNAL(updated()),
+                     this, SLOT(updateMapItem()));
 }
 
 QDeclarativeRouteMapItem::~QDeclarativeRouteMapItem()
@@ -140,9 +142,10 @@ void QDeclarativeRouteMapItem::setRoute(QDeclarativeGeoRoute *route)
     if (route_) {
         path_ = route_->routePath();
     } else {
-        path_ = QList<QGeoCoordinate>();
+        path_.clear();
     }
 
+    mercatorBoundingBoxChanged();
     geometry_.markSourceDirty();
     updateMapItem();
     emit routeChanged(route_);
@@ -242,3 +245,11 @@ bool QDeclarativeRouteMapItem::contains(const QPointF &point) const
 {
     return geometry_.contains(point);
 }
+
+/*!
+    \internal
+*/
+QRectF QDeclarativeRouteMapItem::mercatorBoundingBox() const
+{
+    return QGeoMapItemGeometry::mercatorBoundingBox(path_);
+}
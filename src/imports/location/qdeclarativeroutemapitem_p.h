@@ -78,6 +78,9 @@ public:
 Q_SIGNALS:
     void routeChanged(const QDeclarativeGeoRoute *route);
 
+protected:
+    QRectF mercatorBoundingBox() const;
+
 protected Q_SLOTS:
     virtual void updateMapItem();
     void updateAfterLinePropertiesChanged();
@@ -86,7 +89,7 @@ protected Q_SLOTS:
 private:
     QDeclarativeMapLineProperties line_;
     QDeclarativeGeoRoute *route_;
-    QList<QGeoCoordinate> path_;
+    QGeoCoordinateArray path_;
     bool dirtyMaterial_;
     bool dragActive_;
     QGeoMapPolylineGeometry geometry_;
@@ -0,0 +1,237 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgeomapcirclebatch_p.h"
+#include "qgeoprojection_p.h"
+
+#include <QLineF>
+#include <QPolygonF>
+#include <QtCore/qmath.h>
+#include <QtCore/qnumeric.h>
+
+QT_BEGIN_NAMESPACE
+
+static const double qgeomapcirclebatch_EARTH_CIRCUMFERENCE = 2.0 * M_PI * 6371007.2;
+
+// float centers lose about a quarter of a pixel this far from the origin
+static const double qgeomapcirclebatch_MAX_ORIGIN_DISTANCE = 1 << 22;
+
+// meters to mercator units at mercator latitude y; the mercator scale
+// factor 1 / cos(latitude) is cosh(pi * (1 - 2y))
+static inline double metersToMercator(double meters, double y)
+{
+    double t = M_PI * (1.0 - 2.0 * y);
+    return meters * 0.5 * (qExp(t) + qExp(-t)) / qgeomapcirclebatch_EARTH_CIRCUMFERENCE;
+}
+
+// \a x moved by whole worlds to within half a world of \a reference
+static inline double unwrap(double x, double reference)
+{
+    return x - qFloor(x - reference + 0.5);
+}
+
+QGeoMapCircleBatch::QGeoMapCircleBatch()
+    : unit_(Meters),
+      pixelsPerUnit_(0.0),
+      hasProjection_(false),
+      vertexDataDirty_(true)
+{
+}
+
+void QGeoMapCircleBatch::clear()
+{
+    centers_.clear();
+    radii_.clear();
+    colors_.clear();
+    vertexDataDirty_ = true;
+}
+
+void QGeoMapCircleBatch::reserve(int size)
+{
+    centers_.reserve(size);
+    radii_.reserve(size);
+    colors_.reserve(size);
+}
+
+/*
+    Adds a circle around \a center. \a radius is in the unit radiusUnit()
+    has when the vertices are filled.
+*/
+void QGeoMapCircleBatch::append(const QGeoCoordinate &center, qreal radius, const QColor &color)
+{
+    centers_.append(QGeoProjection::coordToMercator(center));
+    radii_.append(radius);
+    colors_.append(color.rgba());
+    vertexDataDirty_ = true;
+}
+
+void QGeoMapCircleBatch::setRadiusUnit(RadiusUnit unit)
+{
+    if (unit_ == unit)
+        return;
+    unit_ = unit;
+    vertexDataDirty_ = true;
+}
+
+/*
+    Sets the transform from mercator space to the screen, from the four
+    points \a mercator which show on the screen at \a screen. The map is a
+    plane, so the four points fix the transform even when it is tilted.
+
+    Returns true if the vertices need filling again, because the camera
+    has moved too far from the origin for the floats to keep up.
+*/
+bool QGeoMapCircleBatch::setProjection(const QDoubleVector2D *mercator, const QPointF *screen)
+{
+    QPointF from[4];
+    for (int i = 0; i < 4; ++i)
+        from[i] = QPointF(unwrap(mercator[i].x(), mercator[0].x()), mercator[i].y());
+
+    // the points are close together in mercator space, so the transform
+    // is fitted in pixel sized units and scaled back after
+    double scale = QLineF(screen[0], screen[1]).length() / QLineF(from[0], from[1]).length();
+    if (!(scale > 0.0) || qIsInf(scale)) {
+        hasProjection_ = false;
+        return false;
+    }
+
+    QPointF offset(from[0].x() - unwrap(origin_.x(), from[0].x()), from[0].y() - origin_.y());
+    if (vertexDataDirty_ || qAbs(offset.x()) * scale > qgeomapcirclebatch_MAX_ORIGIN_DISTANCE
+            || qAbs(offset.y()) * scale > qgeomapcirclebatch_MAX_ORIGIN_DISTANCE) {
+        origin_ = QDoubleVector2D(unwrap(from[0].x(), 0.5), from[0].y());
+        vertexDataDirty_ = true;
+    }
+
+    QPolygonF fromQuad;
+    QPolygonF toQuad;
+    for (int i = 0; i < 4; ++i) {
+        fromQuad << QPointF(unwrap(from[i].x(), origin_.x()) - origin_.x(),
+                            from[i].y() - origin_.y()) * scale;
+        toQuad << screen[i];
+    }
+
+    QTransform fit;
+    if (!QTransform::quadToQuad(fromQuad, toQuad, fit)) {
+        hasProjection_ = false;
+        return false;
+    }
+
+    transform_ = QTransform::fromScale(scale, scale) * fit;
+    pixelsPerUnit_ = scale;
+    hasProjection_ = true;
+    return vertexDataDirty_;
+}
+
+/*
+    Writes two triangles for each circle to \a vertices, which must have
+    room for vertexCount() of them.
+*/
+void QGeoMapCircleBatch::fillVertices(Vertex *vertices)
+{
+    static const float corners[6][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { -1.0f, 1.0f },
+                                         { -1.0f, 1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f } };
+
+    for (int i = 0; i < size(); ++i) {
+        const QDoubleVector2D &center = centers_.at(i);
+        float x = unwrap(center.x(), origin_.x()) - origin_.x();
+        float y = center.y() - origin_.y();
+        float radius = unit_ == Meters ? metersToMercator(radii_.at(i), center.y()) : radii_.at(i);
+
+        QRgb color = colors_.at(i);
+        int alpha = qAlpha(color);
+        Vertex v;
+        v.x = x;
+        v.y = y;
+        v.radius = radius;
+        v.r = qRed(color) * alpha / 255;
+        v.g = qGreen(color) * alpha / 255;
+        v.b = qBlue(color) * alpha / 255;
+        v.a = alpha;
+
+        for (int k = 0; k < 6; ++k) {
+            v.cornerX = corners[k][0];
+            v.cornerY = corners[k][1];
+            *vertices++ = v;
+        }
+    }
+    vertexDataDirty_ = false;
+}
+
+/*
+    Returns where the center of circle \a i is on the screen.
+*/
+QPointF QGeoMapCircleBatch::screenPosition(int i) const
+{
+    const QDoubleVector2D &center = centers_.at(i);
+    return transform_.map(QPointF(unwrap(center.x(), origin_.x()) - origin_.x(),
+                                  center.y() - origin_.y()));
+}
+
+/*
+    Returns the radius of circle \a i in pixels, as it is near the middle
+    of the screen.
+*/
+qreal QGeoMapCircleBatch::screenRadius(int i) const
+{
+    if (unit_ == Pixels)
+        return radii_.at(i);
+    return metersToMercator(radii_.at(i), centers_.at(i).y()) * pixelsPerUnit_;
+}
+
+/*
+    Returns the index of the topmost, that is last, circle that covers the
+    screen position \a point, or -1 if there is none.
+*/
+int QGeoMapCircleBatch::indexAt(const QPointF &point) const
+{
+    if (!hasProjection_)
+        return -1;
+
+    for (int i = size() - 1; i >= 0; --i) {
+        QPointF d = screenPosition(i) - point;
+        qreal radius = screenRadius(i);
+        if (d.x() * d.x() + d.y() * d.y() <= radius * radius)
+            return i;
+    }
+    return -1;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,120 @@
+/****************************************************************************
+ **
+ ** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+ ** Contact: http://www.qt-project.org/legal
+ **
+ ** This file is part of the QtLocation module of the Qt Toolkit.
+ **
+ ** $QT_BEGIN_LICENSE:LGPL$
+ ** Commercial License Usage
+ ** Licensees holding valid commercial Qt licenses may use this file in
+ ** accordance with the commercial license agreement provided with the
+ ** Software or, alternatively, in accordance with the terms contained in
+ ** a written agreement between you and Digia.  For licensing terms and
+ ** conditions see http://qt.digia.com/licensing.  For further information
+ ** use the contact form at http://qt.digia.com/contact-us.
+ **
+ ** GNU Lesser General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU Lesser
+ ** General Public License version 2.1 as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.LGPL included in the
+ ** packaging of this file.  Please review the following information to
+ ** ensure the GNU Lesser General Public License version 2.1 requirements
+ ** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ **
+ ** In addition, as a special exception, Digia gives you certain additional
+ ** rights.  These rights are described in the Digia Qt LGPL Exception
+ ** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+ **
+ ** GNU General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU
+ ** General Public License version 3.0 as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.GPL included in the
+ ** packaging of this file.  Please review the following information to
+ ** ensure the GNU General Public License version 3.0 requirements will be
+ ** met: http://www.gnu.org/copyleft/gpl.html.
+ **
+ **
+ ** $QT_END_LICENSE$
+ **
+ ****************************************************************************/
+
+#ifndef QGEOMAPCIRCLEBATCH_P_H
+#define QGEOMAPCIRCLEBATCH_P_H
+
+#include <QColor>
+#include <QPointF>
+#include <QTransform>
+#include <QVector>
+#include <QGeoCoordinate>
+
+#include "qdoublevector2d_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * QGeoMapCircleBatch
+ *
+ * Many circles drawn as one vertex buffer: a quad per circle holding its
+ * center and radius, which the shader places on the screen through a
+ * single projective transform. The centers are kept relative to an origin
+ * near the camera, so they stay precise as floats; moving the camera only
+ * changes the transform until it gets far from the origin, at which point
+ * the vertices are filled again around a new one.
+ */
+class QGeoMapCircleBatch
+{
+public:
+    enum RadiusUnit {
+        Meters,
+        Pixels
+    };
+
+    struct Vertex
+    {
+        float x, y;             // center, mercator relative to the origin
+        float cornerX, cornerY; // -1 or 1
+        float radius;           // mercator units or pixels
+        unsigned char r, g, b, a; // premultiplied
+    };
+
+    QGeoMapCircleBatch();
+
+    void clear();
+    void reserve(int size);
+    void append(const QGeoCoordinate &center, qreal radius, const QColor &color);
+    inline int size() const { return centers_.size(); }
+
+    void setRadiusUnit(RadiusUnit unit);
+    inline RadiusUnit radiusUnit() const { return unit_; }
+
+    bool setProjection(const QDoubleVector2D *mercator, const QPointF *screen);
+    inline bool hasProjection() const { return hasProjection_; }
+    inline QTransform transform() const { return transform_; }
+    inline double pixelsPerUnit() const { return pixelsPerUnit_; }
+    inline QDoubleVector2D origin() const { return origin_; }
+
+    inline bool isVertexDataDirty() const { return vertexDataDirty_; }
+    inline int vertexCount() const { return 6 * size(); }
+    void fillVertices(Vertex *vertices);
+
+    QPointF screenPosition(int i) const;
+    qreal screenRadius(int i) const;
+    int indexAt(const QPointF &point) const;
+
+private:
+    QVector<QDoubleVector2D> centers_;
+    QVector<float> radii_;
+    QVector<QRgb> colors_;
+    RadiusUnit unit_;
+
+    QDoubleVector2D origin_;
+    QTransform transform_;
+    double pixelsPerUnit_;
+    bool hasProjection_;
+    bool vertexDataDirty_;
+};
+
+QT_END_NAMESPACE
+
+#endif // QGEOMAPCIRCLEBATCH_P_H
@@ -0,0 +1,126 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgeomapgeometryjob_p.h"
+
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+
+QT_BEGIN_NAMESPACE
+
+class QGeoMapGeometryJobRunner : public QRunnable
+{
+public:
+    explicit QGeoMapGeometryJobRunner(const QSharedPointer<QGeoMapGeometryJob> &job)
+        : job_(job) {}
+
+    void run()
+    {
+        job_->execute();
+    }
+
+private:
+    QSharedPointer<QGeoMapGeometryJob> job_;
+};
+
+/*
+    Creates a job that calls \a member of \a receiver, by name, once it has
+    run.
+*/
+QGeoMapGeometryJob::QGeoMapGeometryJob(QObject *receiver, const char *member)
+    : receiver_(receiver),
+      member_(member),
+      finished_(false)
+{
+}
+
+QGeoMapGeometryJob::~QGeoMapGeometryJob()
+{
+}
+
+/*
+    Queues \a job on the global thread pool.
+*/
+void QGeoMapGeometryJob::start(const QSharedPointer<QGeoMapGeometryJob> &job)
+{
+    QThreadPool::globalInstance()->start(new QGeoMapGeometryJobRunner(job));
+}
+
+/*
+    Drops the result of the job. A job that has not started yet is skipped,
+    one that is running finishes but does not call its receiver.
+*/
+void QGeoMapGeometryJob::cancel()
+{
+    QMutexLocker locker(&mutex_);
+    receiver_ = 0;
+}
+
+bool QGeoMapGeometryJob::isCancelled() const
+{
+    QMutexLocker locker(&mutex_);
+    return !receiver_;
+}
+
+bool QGeoMapGeometryJob::isFinished() const
+{
+    QMutexLocker locker(&mutex_);
+    return finished_;
+}
+
+void QGeoMapGeometryJob::execute()
+{
+    if (isCancelled())
+        return;
+
+    run();
+
+    // the lock orders the result written by run() before the receiver
+    // reads it, and keeps the receiver alive until the call is queued
+    QMutexLocker locker(&mutex_);
+    if (!receiver_)
+        return;
+    finished_ = true;
+    QMetaObject::invokeMethod(receiver_, member_, Qt::QueuedConnection);
+}
+
+QT_END_NAMESPACE
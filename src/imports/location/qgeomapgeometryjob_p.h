@@ -0,0 +1,90 @@
+/****************************************************************************
+ **
+ ** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+ ** Contact: http://www.qt-project.org/legal
+ **
+ ** This file is part of the QtLocation module of the Qt Toolkit.
+ **
+ ** $QT_BEGIN_LICENSE:LGPL$
+ ** Commercial License Usage
+ ** Licensees holding valid commercial Qt licenses may use this file in
+ ** accordance with the commercial license agreement provided with the
+ ** Software or, alternatively, in accordance with the terms contained in
+ ** a written agreement between you and Digia.  For licensing terms and
+ ** conditions see http://qt.digia.com/licensing.  For further information
+ ** use the contact form at http://qt.digia.com/contact-us.
+ **
+ ** GNU Lesser General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU Lesser
+ ** General Public License version 2.1 as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.LGPL included in the
+ ** packaging of this file.  Please review the following information to
+ ** ensure the GNU Lesser General Public License version 2.1 requirements
+ ** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ **
+ ** In addition, as a special exception, Digia gives you certain additional
+ ** rights.  These rights are described in the Digia Qt LGPL Exception
+ ** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+ **
+ ** GNU General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU
+ ** General Public License version 3.0 as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.GPL included in the
+ ** packaging of this file.  Please review the following information to
+ ** ensure the GNU General Public License version 3.0 requirements will be
+ ** met: http://www.gnu.org/copyleft/gpl.html.
+ **
+ **
+ ** $QT_END_LICENSE$
+ **
+ ****************************************************************************/
+
+#ifndef QGEOMAPGEOMETRYJOB_P_H
+#define QGEOMAPGEOMETRYJOB_P_H
+
+#include <QMutex>
+#include <QSharedPointer>
+
+QT_BEGIN_NAMESPACE
+
+class QObject;
+
+/*
+ * QGeoMapGeometryJob
+ *
+ * Work on the geometry of a map item that is done on the global thread
+ * pool. When run() returns, the job calls a slot of its receiver through a
+ * queued connection, unless it was cancelled before; a geometry cancels
+ * its job when it starts a newer one or goes away, so that only the latest
+ * result is ever delivered. The receiver reads the result from the job
+ * once isFinished() is true.
+ */
+class QGeoMapGeometryJob
+{
+public:
+    QGeoMapGeometryJob(QObject *receiver, const char *member);
+    virtual ~QGeoMapGeometryJob();
+
+    static void start(const QSharedPointer<QGeoMapGeometryJob> &job);
+
+    void cancel();
+    bool isCancelled() const;
+    bool isFinished() const;
+
+protected:
+    virtual void run() = 0;
+
+private:
+    Q_DISABLE_COPY(QGeoMapGeometryJob)
+    friend class QGeoMapGeometryJobRunner;
+    void execute();
+
+    mutable QMutex mutex_;
+    QObject *receiver_;
+    const char *member_;
+    bool finished_;
+};
+
+QT_END_NAMESPACE
+
+#endif // QGEOMAPGEOMETRYJOB_P_H
@@ -42,10 +42,83 @@
 #include "qgeomapitemgeometry_p.h"
 #include "qdeclarativegeomap_p.h"
 #include "qlocationutils_p.h"
+#include "qgeoprojection_p.h"
 #include <QtQuick/QSGGeometry>
+#include <QtCore/qmath.h>
+#include <QtCore/qnumeric.h>
 
 QT_BEGIN_NAMESPACE
 
+// how far from the origin the points of a camera snapshot are, in pixels
+static const qreal SnapshotSpread = 256.0;
+
+QGeoMapCameraSnapshot::QGeoMapCameraSnapshot()
+    : valid_(false)
+{
+}
+
+/*!
+    \internal
+    Takes the screen positions around \a origin on \a map, relative to the
+    position of \a origin itself, which is how the item geometries lay out
+    their points.
+*/
+QGeoMapCameraSnapshot::QGeoMapCameraSnapshot(const QGeoMap &map, const QGeoCoordinate &origin)
+    : valid_(false)
+{
+    QPointF center = map.coordinateToScreenPosition(origin, false);
+    if (!qIsFinite(center.x()) || !qIsFinite(center.y()))
+        return;
+
+    static const qreal corners[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+    for (int i = 0; i < 4; ++i) {
+        points_[i] = QPointF(corners[i][0], corners[i][1]) * SnapshotSpread;
+        coordinates_[i] = map.screenPositionToCoordinate(center + points_[i], false);
+        if (!coordinates_[i].isValid())
+            return;
+    }
+    valid_ = true;
+}
+
+/*!
+    \internal
+    Returns the transform from the points laid out when the snapshot was
+    taken to where they show on \a map now. The map is a plane, so this is
+    exact for pans, zooms and rotations and for tilting as well.
+*/
+QTransform QGeoMapCameraSnapshot::toScreen(const QGeoMap &map) const
+{
+    QTransform transform;
+    if (!valid_)
+        return transform;
+
+    QPolygonF from;
+    QPolygonF to;
+    for (int i = 0; i < 4; ++i) {
+        QPointF point = map.coordinateToScreenPosition(coordinates_[i], false);
+        if (!qIsFinite(point.x()) || !qIsFinite(point.y()))
+            return transform;
+        from << points_[i];
+        to << point;
+    }
+
+    // a point wrapped around the dateline folds the quad over, and then it
+    // has nothing to do with the plane it came from
+    qreal turn = 0;
+    for (int i = 0; i < 4; ++i) {
+        QPointF a = to.at((i + 1) % 4) - to.at(i);
+        QPointF b = to.at((i + 2) % 4) - to.at((i + 1) % 4);
+        qreal cross = a.x() * b.y() - a.y() * b.x();
+        if (cross == 0 || (turn != 0 && (cross > 0) != (turn > 0)))
+            return transform;
+        turn = cross;
+    }
+
+    if (!QTransform::quadToQuad(from, to, transform))
+        return QTransform();
+    return transform;
+}
+
 QGeoMapItemGeometry::QGeoMapItemGeometry(QObject *parent) :
     QObject(parent),
     sourceDirty_(true),
@@ -124,6 +197,106 @@ QRectF QGeoMapItemGeometry::translateToCommonOrigin(const QList<QGeoMapItemGeome
     return brects.boundingRect();
 }
 
+/*!
+    \internal
+    Projects the whole \a path in one go into \a screen, with the x and y of
+    each coordinate at twice its index in the path. Invalid coordinates are
+    projected as if they were at 0, 0 and have to be skipped by the caller.
+*/
+void QGeoMapItemGeometry::projectPath(const QGeoMap &map, const QList<QGeoCoordinate> &path,
+                                      QVector<double> &screen)
+{
+    screen.resize(2 * path.size());
+    double *p = screen.data();
+    for (int i = 0; i < path.size(); ++i) {
+        const QGeoCoordinate &coord = path.at(i);
+        bool valid = coord.isValid();
+        p[2 * i] = valid ? coord.latitude() : 0.0;
+        p[2 * i + 1] = valid ? coord.longitude() : 0.0;
+    }
+    map.coordinatesToScreenPositions(p, p, path.size());
+}
+
+/*!
+    \internal
+*/
+void QGeoMapItemGeometry::projectPath(const QGeoMap &map, const QGeoCoordinateArray &path,
+                                      QVector<double> &screen)
+{
+    screen.resize(2 * path.size());
+    double *p = screen.data();
+    const double *lat = path.latitudes();
+    const double *lon = path.longitudes();
+    for (int i = 0; i < path.size(); ++i) {
+        bool valid = path.isValid(i);
+        p[2 * i] = valid ? lat[i] : 0.0;
+        p[2 * i + 1] = valid ? lon[i] : 0.0;
+    }
+    map.coordinatesToScreenPositions(p, p, path.size());
+}
+
+/*!
+    \internal
+    Projects only the coordinates of \a path at \a indices, which must all be
+    valid, writing them to \a screen in the order of \a indices.
+*/
+void QGeoMapItemGeometry::projectPath(const QGeoMap &map, const QGeoCoordinateArray &path,
+                                      const QVector<int> &indices, QVector<double> &screen)
+{
+    screen.resize(2 * indices.size());
+    double *p = screen.data();
+    const double *lat = path.latitudes();
+    const double *lon = path.longitudes();
+    for (int i = 0; i < indices.size(); ++i) {
+        int index = indices.at(i);
+        p[2 * i] = lat[index];
+        p[2 * i + 1] = lon[index];
+    }
+    map.coordinatesToScreenPositions(p, p, indices.size());
+}
+
+/*!
+    \internal
+    Returns the box the valid coordinates of \a path cover in mercator space,
+    or a null rectangle if there are none. Consecutive coordinates are joined
+    the short way around the world, as the items draw them, so the box of a
+    path crossing the dateline runs past x = 1.
+*/
+QRectF QGeoMapItemGeometry::mercatorBoundingBox(const QGeoCoordinateArray &path)
+{
+    QVector<double> mercator;
+    mercator.reserve(2 * path.size());
+    const double *lat = path.latitudes();
+    const double *lon = path.longitudes();
+    for (int i = 0; i < path.size(); ++i) {
+        if (path.isValid(i)) {
+            mercator.append(lat[i]);
+            mercator.append(lon[i]);
+        }
+    }
+
+    int count = mercator.size() / 2;
+    if (count == 0)
+        return QRectF();
+
+    double *p = mercator.data();
+    QGeoProjection::coordinatesToMercator(p, p, count);
+
+    double x = p[0];
+    double left = x, right = x, top = p[1], bottom = p[1];
+    for (int i = 1; i < count; ++i) {
+        double next = p[2 * i];
+        next -= qFloor(next - x + 0.5);
+        x = next;
+        left = qMin(left, x);
+        right = qMax(right, x);
+        top = qMin(top, p[2 * i + 1]);
+        bottom = qMax(bottom, p[2 * i + 1]);
+    }
+
+    return QRectF(QPointF(left, top), QPointF(right, bottom));
+}
+
 /*!
     \internal
 */
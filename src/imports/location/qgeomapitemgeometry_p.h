@@ -48,14 +48,39 @@
 #include <QRectF>
 #include <QVector>
 #include <QGeoCoordinate>
+#include "qgeocoordinatearray_p.h"
 #include <QVector2D>
 #include <QList>
+#include <QTransform>
 
 QT_BEGIN_NAMESPACE
 
 class QSGGeometry;
 class QGeoMap;
 
+/*
+ * QGeoMapCameraSnapshot
+ *
+ * Where a few points around a coordinate showed on the screen at one
+ * moment, kept with geometry built off the GUI thread so that it can be
+ * drawn under the camera of a later frame until newer geometry is ready.
+ */
+class QGeoMapCameraSnapshot
+{
+public:
+    QGeoMapCameraSnapshot();
+    QGeoMapCameraSnapshot(const QGeoMap &map, const QGeoCoordinate &origin);
+
+    inline bool isValid() const { return valid_; }
+
+    QTransform toScreen(const QGeoMap &map) const;
+
+private:
+    QGeoCoordinate coordinates_[4];
+    QPointF points_[4];
+    bool valid_;
+};
+
 class QGeoMapItemGeometry : public QObject
 {
     Q_OBJECT
@@ -95,7 +120,7 @@ public:
 
     inline const QGeoCoordinate &origin() const { return srcOrigin_; }
 
-    inline bool contains(const QPointF &screenPoint) const {
+    virtual bool contains(const QPointF &screenPoint) const {
         return screenOutline_.contains(screenPoint);
     }
 
@@ -109,7 +134,7 @@ public:
     inline bool isIndexed() const { return (!screenIndices_.isEmpty()); }
 
     /* Size is # of triangles */
-    inline quint32 size() const
+    virtual quint32 size() const
     {
         if (isIndexed())
             return screenIndices_.size() / 3;
@@ -117,10 +142,10 @@ public:
             return screenVertices_.size() / 3;
     }
 
-    inline void clear() { firstPointOffset_ = QPointF(0,0);
-                          screenVertices_.clear(); screenIndices_.clear(); }
+    virtual void clear() { firstPointOffset_ = QPointF(0,0);
+                           screenVertices_.clear(); screenIndices_.clear(); }
 
-    void allocateAndFill(QSGGeometry *geom) const;
+    virtual void allocateAndFill(QSGGeometry *geom) const;
 
     double geoDistanceToScreenWidth(const QGeoMap &map,
                                            const QGeoCoordinate &fromCoord,
@@ -128,6 +153,18 @@ public:
 
     static QRectF translateToCommonOrigin(const QList<QGeoMapItemGeometry *> &geoms);
 
+    static void projectPath(const QGeoMap &map, const QList<QGeoCoordinate> &path,
+                            QVector<double> &screen);
+    static void projectPath(const QGeoMap &map, const QGeoCoordinateArray &path,
+                            QVector<double> &screen);
+    static void projectPath(const QGeoMap &map, const QGeoCoordinateArray &path,
+                            const QVector<int> &indices, QVector<double> &screen);
+
+    static QRectF mercatorBoundingBox(const QGeoCoordinateArray &path);
+
+Q_SIGNALS:
+    // emitted when work done on a worker thread changed the geometry
+    void updated();
 
 protected:
     bool sourceDirty_;
@@ -0,0 +1,207 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgeomappolygontriangles_p.h"
+
+#include <QtGlobal>
+#include <QScopedPointer>
+
+/* poly2tri triangulator includes */
+#include "../../3rdparty/poly2tri/common/shapes.h"
+#include "../../3rdparty/poly2tri/sweep/cdt.h"
+
+QT_BEGIN_NAMESPACE
+
+typedef QGeoMapPolygonTriangles::Point Point;
+
+static inline QRectF verticesBounds(const Point *vertices, int count)
+{
+    if (count == 0)
+        return QRectF();
+
+    qreal minX = vertices[0].x;
+    qreal maxX = minX;
+    qreal minY = vertices[0].y;
+    qreal maxY = minY;
+    for (int i = 1; i < count; ++i) {
+        minX = qMin(minX, vertices[i].x);
+        maxX = qMax(maxX, vertices[i].x);
+        minY = qMin(minY, vertices[i].y);
+        maxY = qMax(maxY, vertices[i].y);
+    }
+    return QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+}
+
+// Sutherland-Hodgman against one side of a rectangle: keeps the part of the
+// polygon where coordinate axis (0 for x, 1 for y) is on the inner side of
+// edge, which is below it if upper is set.
+static int clipPolygon(const Point *in, int count, Point *out, int axis, qreal edge, bool upper)
+{
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        const Point &a = in[i];
+        const Point &b = in[(i + 1) % count];
+        qreal va = axis == 0 ? a.x : a.y;
+        qreal vb = axis == 0 ? b.x : b.y;
+        bool aInside = upper ? va <= edge : va >= edge;
+        bool bInside = upper ? vb <= edge : vb >= edge;
+
+        if (aInside)
+            out[n++] = a;
+        if (aInside != bInside) {
+            qreal t = (edge - va) / (vb - va);
+            out[n++] = Point(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+        }
+    }
+    return n;
+}
+
+QGeoMapPolygonTriangles::QGeoMapPolygonTriangles()
+{
+}
+
+/*!
+    \internal
+    Triangulates the closed subpaths of \a path, replacing the triangles
+    kept so far.
+*/
+void QGeoMapPolygonTriangles::triangulate(const QPainterPath &path)
+{
+    vertices_.clear();
+
+    // All points live in one array, which never grows past the element
+    // count, and one CDT is reset for each subpath. That way poly2tri only
+    // allocates when a subpath needs more than the ones before it.
+    std::vector<p2t::Point> points;
+    points.reserve(path.elementCount());
+    std::vector<p2t::Point*> curPts;
+    curPts.reserve(path.elementCount());
+    std::vector<int> indices;
+    QScopedPointer<p2t::CDT> cdt;
+
+    for (int i = 0; i < path.elementCount(); ++i) {
+        const QPainterPath::Element e = path.elementAt(i);
+        if (e.isMoveTo() || i == path.elementCount() - 1
+                || (qAbs(e.x - curPts.front()->x) < 0.1
+                    && qAbs(e.y - curPts.front()->y) < 0.1)) {
+            if (curPts.size() > 2) {
+                if (cdt)
+                    cdt->Reset(curPts);
+                else
+                    cdt.reset(new p2t::CDT(curPts));
+                cdt->Triangulate();
+                cdt->GetTriangleIndices(&points[0], indices);
+
+                vertices_.reserve(vertices_.size() + int(indices.size()));
+                for (size_t j = 0; j < indices.size(); ++j) {
+                    const p2t::Point &p = points[indices[j]];
+                    vertices_ << Point(p.x, p.y);
+                }
+            }
+            curPts.clear();
+            points.push_back(p2t::Point(e.x, e.y));
+            curPts.push_back(&points.back());
+        } else if (e.isLineTo()) {
+            points.push_back(p2t::Point(e.x, e.y));
+            curPts.push_back(&points.back());
+        } else {
+            qWarning("Unhandled element type in polygon painterpath");
+        }
+    }
+
+    bounds_ = verticesBounds(vertices_.constData(), vertices_.size());
+}
+
+void QGeoMapPolygonTriangles::clear()
+{
+    vertices_.clear();
+    bounds_ = QRectF();
+}
+
+/*!
+    \internal
+    Appends the triangles cut to \a rect to \a vertices and returns the
+    bounds of what was appended. Triangles inside \a rect are copied as they
+    are, those across its border are clipped and split up again as fans.
+*/
+QRectF QGeoMapPolygonTriangles::clip(const QRectF &rect, QVector<Point> &vertices) const
+{
+    const qreal left = rect.left();
+    const qreal right = rect.right();
+    const qreal top = rect.top();
+    const qreal bottom = rect.bottom();
+
+    int first = vertices.size();
+    const Point *v = vertices_.constData();
+    for (int i = 0; i + 2 < vertices_.size(); i += 3) {
+        const Point *t = v + i;
+        qreal minX = qMin(t[0].x, qMin(t[1].x, t[2].x));
+        qreal maxX = qMax(t[0].x, qMax(t[1].x, t[2].x));
+        qreal minY = qMin(t[0].y, qMin(t[1].y, t[2].y));
+        qreal maxY = qMax(t[0].y, qMax(t[1].y, t[2].y));
+
+        if (maxX < left || minX > right || maxY < top || minY > bottom)
+            continue;
+
+        if (minX >= left && maxX <= right && minY >= top && maxY <= bottom) {
+            vertices << t[0] << t[1] << t[2];
+            continue;
+        }
+
+        // a triangle clipped by the four sides has at most 7 corners
+        Point a[8];
+        Point b[8];
+        a[0] = t[0];
+        a[1] = t[1];
+        a[2] = t[2];
+        int n = clipPolygon(a, 3, b, 0, left, false);
+        n = clipPolygon(b, n, a, 0, right, true);
+        n = clipPolygon(a, n, b, 1, top, false);
+        n = clipPolygon(b, n, a, 1, bottom, true);
+
+        for (int j = 1; j + 1 < n; ++j)
+            vertices << a[0] << a[j] << a[j + 1];
+    }
+
+    return verticesBounds(vertices.constData() + first, vertices.size() - first);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,195 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgeomappolylinehitgrid_p.h"
+
+#include <QtCore/qmath.h>
+
+QT_BEGIN_NAMESPACE
+
+// the grid has about as many cells as the line has segments, up to this
+// many on each side
+static const int MaximumGridSide = 256;
+
+static inline qreal squaredDistanceToSegment(qreal px, qreal py,
+                                             qreal ax, qreal ay, qreal bx, qreal by)
+{
+    qreal dx = bx - ax;
+    qreal dy = by - ay;
+    qreal length = dx * dx + dy * dy;
+    qreal t = 0;
+    if (length > 0)
+        t = qBound(qreal(0), ((px - ax) * dx + (py - ay) * dy) / length, qreal(1));
+    qreal x = ax + t * dx - px;
+    qreal y = ay + t * dy - py;
+    return x * x + y * y;
+}
+
+QGeoMapPolylineHitGrid::QGeoMapPolylineHitGrid()
+    : cellWidth_(1),
+      cellHeight_(1),
+      columns_(0),
+      rows_(0),
+      built_(false)
+{
+}
+
+/*!
+    \internal
+    Sorts the segments of the path made of \a points and \a types into the
+    grid. Each point is two values in \a points, a segment joins a point to
+    the one before it unless it is a MoveToElement.
+*/
+void QGeoMapPolylineHitGrid::build(const QVector<qreal> &points,
+                                   const QVector<QPainterPath::ElementType> &types)
+{
+    clear();
+    built_ = true;
+    points_ = points;
+
+    QVector<int> segments;
+    segments.reserve(types.size());
+    qreal minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for (int i = 0; i < types.size(); ++i) {
+        qreal x = points.at(2 * i);
+        qreal y = points.at(2 * i + 1);
+        if (i == 0) {
+            minX = maxX = x;
+            minY = maxY = y;
+        } else {
+            minX = qMin(minX, x);
+            maxX = qMax(maxX, x);
+            minY = qMin(minY, y);
+            maxY = qMax(maxY, y);
+            if (types.at(i) != QPainterPath::MoveToElement)
+                segments << i - 1;
+        }
+    }
+
+    if (segments.isEmpty())
+        return;
+
+    bounds_ = QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+    int side = qBound(1, int(qCeil(qSqrt(qreal(segments.size())))), MaximumGridSide);
+    columns_ = side;
+    rows_ = side;
+    cellWidth_ = qMax(bounds_.width() / columns_, qreal(1));
+    cellHeight_ = qMax(bounds_.height() / rows_, qreal(1));
+
+    // count the segments of each cell first, then fill each cell in from
+    // its end, which leaves the start of the cell behind, so that all of
+    // them end up in one array
+    cellStarts_.fill(0, columns_ * rows_ + 1);
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) {
+            for (int i = 1; i < cellStarts_.size(); ++i)
+                cellStarts_[i] += cellStarts_[i - 1];
+            cellSegments_.resize(cellStarts_.last());
+        }
+
+        foreach (int segment, segments) {
+            const qreal *a = points_.constData() + 2 * segment;
+            int left = qBound(0, int((qMin(a[0], a[2]) - minX) / cellWidth_), columns_ - 1);
+            int right = qBound(0, int((qMax(a[0], a[2]) - minX) / cellWidth_), columns_ - 1);
+            int top = qBound(0, int((qMin(a[1], a[3]) - minY) / cellHeight_), rows_ - 1);
+            int bottom = qBound(0, int((qMax(a[1], a[3]) - minY) / cellHeight_), rows_ - 1);
+
+            for (int row = top; row <= bottom; ++row) {
+                for (int column = left; column <= right; ++column) {
+                    int cell = row * columns_ + column;
+                    if (pass == 0)
+                        ++cellStarts_[cell];
+                    else
+                        cellSegments_[--cellStarts_[cell]] = segment;
+                }
+            }
+        }
+    }
+}
+
+void QGeoMapPolylineHitGrid::clear()
+{
+    points_.clear();
+    cellStarts_.clear();
+    cellSegments_.clear();
+    bounds_ = QRectF();
+    columns_ = 0;
+    rows_ = 0;
+    built_ = false;
+}
+
+/*!
+    \internal
+    Returns whether \a point is no further than \a distance from one of the
+    segments of the path.
+*/
+bool QGeoMapPolylineHitGrid::contains(const QPointF &point, qreal distance) const
+{
+    if (cellSegments_.isEmpty())
+        return false;
+
+    const qreal px = point.x();
+    const qreal py = point.y();
+    if (px < bounds_.left() - distance || px > bounds_.right() + distance
+            || py < bounds_.top() - distance || py > bounds_.bottom() + distance)
+        return false;
+
+    int left = qBound(0, int((px - distance - bounds_.left()) / cellWidth_), columns_ - 1);
+    int right = qBound(0, int((px + distance - bounds_.left()) / cellWidth_), columns_ - 1);
+    int top = qBound(0, int((py - distance - bounds_.top()) / cellHeight_), rows_ - 1);
+    int bottom = qBound(0, int((py + distance - bounds_.top()) / cellHeight_), rows_ - 1);
+
+    const qreal squaredDistance = distance * distance;
+    const qreal *p = points_.constData();
+    for (int row = top; row <= bottom; ++row) {
+        for (int column = left; column <= right; ++column) {
+            int cell = row * columns_ + column;
+            for (int i = cellStarts_.at(cell); i < cellStarts_.at(cell + 1); ++i) {
+                const qreal *a = p + 2 * cellSegments_.at(i);
+                if (squaredDistanceToSegment(px, py, a[0], a[1], a[2], a[3]) <= squaredDistance)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,87 @@
+/****************************************************************************
+ **
+ ** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+ ** Contact: http://www.qt-project.org/legal
+ **
+ ** This file is part of the QtLocation module of the Qt Toolkit.
+ **
+ ** $QT_BEGIN_LICENSE:LGPL$
+ ** Commercial License Usage
+ ** Licensees holding valid commercial Qt licenses may use this file in
+ ** accordance with the commercial license agreement provided with the
+ ** Software or, alternatively, in accordance with the terms contained in
+ ** a written agreement between you and Digia.  For licensing terms and
+ ** conditions see http://qt.digia.com/licensing.  For further information
+ ** use the contact form at http://qt.digia.com/contact-us.
+ **
+ ** GNU Lesser General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU Lesser
+ ** General Public License version 2.1 as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.LGPL included in the
+ ** packaging of this file.  Please review the following information to
+ ** ensure the GNU Lesser General Public License version 2.1 requirements
+ ** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+ **
+ ** In addition, as a special exception, Digia gives you certain additional
+ ** rights.  These rights are described in the Digia Qt LGPL Exception
+ ** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+ **
+ ** GNU General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU
+ ** General Public License version 3.0 as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.GPL included in the
+ ** packaging of this file.  Please review the following information to
+ ** ensure the GNU General Public License version 3.0 requirements will be
+ ** met: http://www.gnu.org/copyleft/gpl.html.
+ **
+ **
+ ** $QT_END_LICENSE$
+ **
+ ****************************************************************************/
+
+#ifndef QGEOMAPPOLYLINEHITGRID_P_H
+#define QGEOMAPPOLYLINEHITGRID_P_H
+
+#include <QPainterPath>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * QGeoMapPolylineHitGrid
+ *
+ * Answers whether a point is within some distance of the segments of a
+ * polyline. The segments are sorted into a grid of cells when it is built,
+ * so a query only measures the distance to the few segments around the
+ * point.
+ */
+class QGeoMapPolylineHitGrid
+{
+public:
+    QGeoMapPolylineHitGrid();
+
+    void build(const QVector<qreal> &points,
+               const QVector<QPainterPath::ElementType> &types);
+    void clear();
+
+    inline bool isBuilt() const { return built_; }
+
+    bool contains(const QPointF &point, qreal distance) const;
+
+private:
+    QVector<qreal> points_;
+    QVector<int> cellStarts_;
+    QVector<int> cellSegments_;
+    QRectF bounds_;
+    qreal cellWidth_;
+    qreal cellHeight_;
+    int columns_;
+    int rows_;
+    bool built_;
+};
+
+QT_END_NAMESPACE
+
+#endif // QGEOMAPPOLYLINEHITGRID_P_H
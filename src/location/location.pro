@@ -36,7 +36,8 @@ PRIVATE_HEADERS += \
                     qlocationutils_p.h \
                     qnmeapositioninfosource_p.h \
                     qgeoareamonitor_polling_p.h \
-                    qgeocoordinate_p.h
+                    qgeocoordinate_p.h \
+                    qgeocoordinatearray_p.h
 
 
 HEADERS += $$PUBLIC_HEADERS $$PRIVATE_HEADERS
@@ -48,6 +49,7 @@ SOURCES += \
             qgeorectangle.cpp \
             qgeocircle.cpp \
             qgeocoordinate.cpp \
+            qgeocoordinatearray.cpp \
             qgeolocation.cpp \
             qgeopositioninfo.cpp \
             qgeopositioninfosource.cpp \
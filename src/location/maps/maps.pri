@@ -31,6 +31,7 @@ PRIVATE_HEADERS += \
                     maps/qgeomapcontroller_p.h \
                     maps/qgeomapscene_p.h \
                     maps/qgeotilerequestmanager_p.h \
+                    maps/qgeotilerequestqueue_p.h \
                     maps/qgeomap_p.h \
                     maps/qgeomapdata_p.h \
                     maps/qgeomapdata_p_p.h \
@@ -48,6 +49,8 @@ PRIVATE_HEADERS += \
                     maps/qgeomaptype_p_p.h \
                     maps/qgeoprojection_p.h \
                     maps/qgeoroute_p.h \
+                    maps/qgeosimplifiedpath_p.h \
+                    maps/qgeospatialindex_p.h \
                     maps/qgeoroutereply_p.h \
                     maps/qgeorouterequest_p.h \
                     maps/qgeoroutesegment_p.h \
@@ -57,9 +60,12 @@ PRIVATE_HEADERS += \
                     maps/qgeotilecache_p.h \
                     maps/qgeotiledmapreply_p.h \
                     maps/qgeotiledmapreply_p_p.h \
+                    maps/qgeotilekey_p.h \
+                    maps/qgeotilepackstore_p.h \
                     maps/qgeotilespec_p.h \
                     maps/qgeotilespec_p_p.h \
-                    maps/qcache3q_p.h
+                    maps/qcache3q_p.h \
+                    maps/qshardedcache3q_p.h
 
 SOURCES += \
             maps/qdoublevector2d.cpp \
@@ -84,6 +90,7 @@ SOURCES += \
             maps/qgeotilefetcher.cpp \
             maps/qgeomaptype.cpp \
             maps/qgeoprojection.cpp \
+            maps/qgeosimplifiedpath.cpp \
             maps/qgeoroute.cpp \
             maps/qgeoroutereply.cpp \
             maps/qgeorouterequest.cpp \
@@ -93,6 +100,7 @@ SOURCES += \
             maps/qgeoserviceprovider.cpp \
             maps/qgeoserviceproviderfactory.cpp \
             maps/qgeotilecache.cpp \
+            maps/qgeotilepackstore.cpp \
             maps/qgeotiledmapreply.cpp \
             maps/qgeotilespec.cpp
 
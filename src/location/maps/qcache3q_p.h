@@ -85,6 +85,37 @@ void QCache3QDefaultEvictionPolicy<Key,T>::aboutToBeRemoved(const Key &key, QSha
     Q_UNUSED(obj);
 }
 
+/*
+ * Counters kept by QCache3Q, see QCache3Q::stats(). The counters run from
+ * construction or the last resetStats(), the sizes are a snapshot.
+ */
+struct QCache3QStats
+{
+    QCache3QStats()
+        : hits(0), misses(0), ghostHits(0), promotions(0), evictions(0),
+          costIn(0), costOut(0), count(0), cost(0), maxCost(0),
+          newbies(0), regulars(0), hobos(0), ghosts(0),
+          minRecent(0), maxOldPopular(0) {}
+
+    quint64 hits;
+    quint64 misses;
+    quint64 ghostHits;      // lookups or inserts of recently evicted keys
+    quint64 promotions;     // newbie or ghost to regular, regular to hobo
+    quint64 evictions;
+    qint64 costIn;          // total cost inserted
+    qint64 costOut;         // total cost evicted
+
+    int count;
+    int cost;
+    int maxCost;
+    int newbies;
+    int regulars;
+    int hobos;
+    int ghosts;
+    int minRecent;          // current tweakables, which move in adaptive mode
+    int maxOldPopular;
+};
+
 /*
  * QCache3Q
  *
@@ -111,6 +142,14 @@ void QCache3QDefaultEvictionPolicy<Key,T>::aboutToBeRemoved(const Key &key, QSha
  *                    from it takes place
  *  * promoteAt = minimum popularity necessary to promote a node from
  *                "newbie" to "regular"
+ *
+ * In adaptive mode minRecent and maxOldPopular are tuned online, much like
+ * ARC tunes its recency target: the ghosts remember which queue they were
+ * evicted from, and a lookup hitting a ghost moves the partition in favour
+ * of that queue. A ghost of a newbie grows minRecent, a ghost of a regular
+ * shrinks minRecent and maxOldPopular, and a ghost of a hobo (hobos only
+ * leave ghosts in this mode) grows maxOldPopular. Both stay within bounds
+ * that always leave room for the regulars.
  */
 template <class Key, class T, class EvPolicy = QCache3QDefaultEvictionPolicy<Key,T> >
 class QCache3Q : public EvPolicy
@@ -120,7 +159,7 @@ private:
     class Node
     {
     public:
-        inline explicit Node() : q(0), n(0), p(0), pop(0), cost(0) {}
+        inline explicit Node() : q(0), n(0), p(0), pop(0), cost(0), ghostOf(0) {}
 
         Queue *q;
         Node *n;
@@ -129,6 +168,7 @@ private:
         QSharedPointer<T> v;
         quint64 pop;                // popularity, incremented each ping
         int cost;
+        int ghostOf;                // for ghosts, the queue (1-3) they were evicted from
     };
 
     class Queue
@@ -159,6 +199,14 @@ public:
     inline int promoteAt() const { return promote_; }
     inline void setPromoteAt(int p) { promote_ = p; }
 
+    inline int minRecent() const { return minRecent_; }
+    inline int maxOldPopular() const { return maxOldPopular_; }
+
+    // Turning adaptive mode off keeps minRecent and maxOldPopular where
+    // they were tuned to
+    inline bool isAdaptive() const { return adaptive_; }
+    void setAdaptive(bool adaptive);
+
     inline int totalCost() const { return q1_->cost + q2_->cost + q3_->cost; }
 
     void clear();
@@ -167,10 +215,16 @@ public:
     QSharedPointer<T> operator[](const Key &key) const;
 
     void remove(const Key &key);
+    // true if the object is cached, ghosts of evicted objects don't count.
+    // Unlike object() this doesn't count as a hit
+    bool contains(const Key &key) const;
 
     void printStats();
+    QCache3QStats stats() const;
+    void resetStats();
 
-    // Copy data directly into a queue. Designed for single use after construction
+    // Copy data directly onto the back of a queue, skipping keys already in
+    // the cache. Can be called repeatedly to restore a queue in chunks
     void deserializeQueue(int queueNumber, const QList<Key> &keys,
                           const QList<QSharedPointer<T> > &values, const QList<int> &costs);
     // Copy data from specific queue into list
@@ -178,11 +232,18 @@ public:
 
 private:
     int maxCost_, minRecent_, maxOldPopular_;
-    int hitCount_, missCount_, promote_;
+    quint64 hitCount_, missCount_;
+    int promote_;
+    quint64 ghostHitCount_, promotionCount_, evictionCount_;
+    qint64 costIn_, costOut_;
+    bool adaptive_;
 
     void rebalance();
+    void adapt(const Node *ghost);
+    void boundTweakables();
     void unlink(Node *n);
     void link_front(Node *n, Queue *q);
+    void link_back(Node *n, Queue *q);
 
 private:
     // make these private so they can't be used
@@ -194,8 +255,8 @@ template <class Key, class T, class EvPolicy>
 void QCache3Q<Key,T,EvPolicy>::printStats()
 {
     qDebug("\n=== cache %p ===", this);
-    qDebug("hits: %d (%.2f%%)\tmisses: %d\tfill: %.2f%%", hitCount_,
-           100.0 * float(hitCount_) / (float(hitCount_ + missCount_)),
+    qDebug("hits: %llu (%.2f%%)\tmisses: %llu\tfill: %.2f%%", hitCount_,
+           100.0 * double(hitCount_) / double(hitCount_ + missCount_),
            missCount_,
            100.0 * float(totalCost()) / float(maxCost()));
     qDebug("q1g: size=%d, pop=%llu", q1_evicted_->size, q1_evicted_->pop);
@@ -204,11 +265,44 @@ void QCache3Q<Key,T,EvPolicy>::printStats()
     qDebug("q3:  cost=%d, size=%d, pop=%llu", q3_->cost, q3_->size, q3_->pop);
 }
 
+template <class Key, class T, class EvPolicy>
+QCache3QStats QCache3Q<Key,T,EvPolicy>::stats() const
+{
+    QCache3QStats s;
+    s.hits = hitCount_;
+    s.misses = missCount_;
+    s.ghostHits = ghostHitCount_;
+    s.promotions = promotionCount_;
+    s.evictions = evictionCount_;
+    s.costIn = costIn_;
+    s.costOut = costOut_;
+    s.count = q1_->size + q2_->size + q3_->size;
+    s.cost = totalCost();
+    s.maxCost = maxCost_;
+    s.newbies = q1_->size;
+    s.regulars = q2_->size;
+    s.hobos = q3_->size;
+    s.ghosts = q1_evicted_->size;
+    s.minRecent = minRecent_;
+    s.maxOldPopular = maxOldPopular_;
+    return s;
+}
+
+template <class Key, class T, class EvPolicy>
+void QCache3Q<Key,T,EvPolicy>::resetStats()
+{
+    hitCount_ = missCount_ = 0;
+    ghostHitCount_ = promotionCount_ = evictionCount_ = 0;
+    costIn_ = costOut_ = 0;
+}
+
 template <class Key, class T, class EvPolicy>
 QCache3Q<Key,T,EvPolicy>::QCache3Q(int maxCost, int minRecent, int maxOldPopular)
     : q1_(new Queue), q2_(new Queue), q3_(new Queue), q1_evicted_(new Queue),
       maxCost_(maxCost), minRecent_(minRecent), maxOldPopular_(maxOldPopular),
-      hitCount_(0), missCount_(0), promote_(0)
+      hitCount_(0), missCount_(0), promote_(0),
+      ghostHitCount_(0), promotionCount_(0), evictionCount_(0),
+      costIn_(0), costOut_(0), adaptive_(false)
 {
     if (minRecent_ < 0)
         minRecent_ = maxCost_ / 3;
@@ -236,35 +330,93 @@ void QCache3Q<Key,T,EvPolicy>::deserializeQueue(int queueNumber, const QList<Key
     int bufferSize = keys.size();
     if (bufferSize == 0)
         return;
-    clear();
     Queue *queue = queueNumber == 1 ? q1_ :
                    queueNumber == 2 ? q2_ :
                    queueNumber == 3 ? q3_ :
                                       q1_evicted_;
-    for (int i = 0; i<bufferSize; ++i) {
+    for (int i = 0; i < bufferSize; ++i) {
+        if (lookup_.contains(keys[i]))
+            continue;
         Node *node = new Node;
-        node->v = values[i];
         node->k = keys[i];
-        node->cost = costs[i];
-        link_front(node, queue);
+        if (queue != q1_evicted_) {
+            node->v = values[i];
+            node->cost = costs[i];
+        }
+        link_back(node, queue);
         lookup_[keys[i]] = node;
     }
+    rebalance();
 }
 
 
 template <class Key, class T, class EvPolicy>
 inline void QCache3Q<Key,T,EvPolicy>::setMaxCost(int maxCost, int minRecent, int maxOldPopular)
 {
+    // in adaptive mode what was learnt so far is scaled to the new size
+    // rather than thrown away
+    const int oldMaxCost = maxCost_;
+    const bool scale = adaptive_ && oldMaxCost > 0;
+
     maxCost_ = maxCost;
-    minRecent_ = minRecent;
-    maxOldPopular_ = maxOldPopular;
-    if (minRecent_ < 0)
+    if (minRecent >= 0)
+        minRecent_ = minRecent;
+    else if (scale)
+        minRecent_ = int(qint64(minRecent_) * maxCost_ / oldMaxCost);
+    else
         minRecent_ = maxCost_ / 3;
-    if (maxOldPopular_ < 0)
+
+    if (maxOldPopular >= 0)
+        maxOldPopular_ = maxOldPopular;
+    else if (scale)
+        maxOldPopular_ = int(qint64(maxOldPopular_) * maxCost_ / oldMaxCost);
+    else
         maxOldPopular_ = maxCost_ / 5;
+
+    if (adaptive_)
+        boundTweakables();
     rebalance();
 }
 
+template <class Key, class T, class EvPolicy>
+void QCache3Q<Key,T,EvPolicy>::setAdaptive(bool adaptive)
+{
+    adaptive_ = adaptive;
+    if (adaptive_)
+        boundTweakables();
+}
+
+template <class Key, class T, class EvPolicy>
+void QCache3Q<Key,T,EvPolicy>::boundTweakables()
+{
+    // together at most 11/12 of maxCost, so the regulars are never squeezed
+    // out entirely
+    minRecent_ = qBound(maxCost_ / 10, minRecent_, (maxCost_ * 2) / 3);
+    maxOldPopular_ = qBound(maxCost_ / 20, maxOldPopular_, maxCost_ / 4);
+}
+
+template <class Key, class T, class EvPolicy>
+void QCache3Q<Key,T,EvPolicy>::adapt(const Node *ghost)
+{
+    const int step = qMax(1, maxCost_ / 64);
+
+    switch (ghost->ghostOf) {
+    case 1:
+        minRecent_ += step;
+        break;
+    case 2:
+        minRecent_ -= step;
+        maxOldPopular_ -= step / 2;
+        break;
+    case 3:
+        maxOldPopular_ += step;
+        break;
+    default:
+        return;
+    }
+    boundTweakables();
+}
+
 template <class Key, class T, class EvPolicy>
 bool QCache3Q<Key,T,EvPolicy>::insert(const Key &key, QSharedPointer<T> object, int cost)
 {
@@ -272,6 +424,8 @@ bool QCache3Q<Key,T,EvPolicy>::insert(const Key &key, QSharedPointer<T> object,
         return false;
     }
 
+    costIn_ += cost;
+
     if (lookup_.contains(key)) {
         Node *n = lookup_[key];
         n->v = object;
@@ -280,11 +434,18 @@ bool QCache3Q<Key,T,EvPolicy>::insert(const Key &key, QSharedPointer<T> object,
         n->q->cost += cost;
 
         if (n->q == q1_evicted_) {
+            ghostHitCount_++;
             if (n->pop > (uint)promote_) {
                 unlink(n);
                 link_front(n, q2_);
-                rebalance();
+                promotionCount_++;
+            } else {
+                // not popular enough to skip the newbies, but it can't stay
+                // on the ghost list holding a value either
+                unlink(n);
+                link_front(n, q1_);
             }
+            rebalance();
         } else if (n->q != q1_) {
             Queue *q = n->q;
             unlink(n);
@@ -376,6 +537,23 @@ void QCache3Q<Key,T,EvPolicy>::link_front(Node *n, Queue *q)
     q->size++;
 }
 
+template <class Key, class T, class EvPolicy>
+void QCache3Q<Key,T,EvPolicy>::link_back(Node *n, Queue *q)
+{
+    n->n = 0;
+    n->p = q->l;
+    n->q = q;
+    if (q->l)
+        q->l->n = n;
+    q->l = n;
+    if (!q->f)
+        q->f = n;
+
+    q->pop += n->pop;
+    q->cost += n->cost;
+    q->size++;
+}
+
 template <class Key, class T, class EvPolicy>
 void QCache3Q<Key,T,EvPolicy>::rebalance()
 {
@@ -390,25 +568,41 @@ void QCache3Q<Key,T,EvPolicy>::rebalance()
         if (q3_->cost > maxOldPopular_) {
             Node *n = q3_->l;
             unlink(n);
+            evictionCount_++;
+            costOut_ += n->cost;
             EvPolicy::aboutToBeEvicted(n->k, n->v);
-            lookup_.remove(n->k);
-            delete n;
+            if (adaptive_) {
+                n->v.clear();
+                n->cost = 0;
+                n->ghostOf = 3;
+                link_front(n, q1_evicted_);
+            } else {
+                lookup_.remove(n->k);
+                delete n;
+            }
         } else if (q1_->cost > minRecent_) {
             Node *n = q1_->l;
             unlink(n);
+            evictionCount_++;
+            costOut_ += n->cost;
             EvPolicy::aboutToBeEvicted(n->k, n->v);
             n->v.clear();
             n->cost = 0;
+            n->ghostOf = 1;
             link_front(n, q1_evicted_);
         } else {
             Node *n = q2_->l;
             unlink(n);
             if (n->pop > (q2_->pop / q2_->size)) {
                 link_front(n, q3_);
+                promotionCount_++;
             } else {
+                evictionCount_++;
+                costOut_ += n->cost;
                 EvPolicy::aboutToBeEvicted(n->k, n->v);
                 n->v.clear();
                 n->cost = 0;
+                n->ghostOf = 2;
                 link_front(n, q1_evicted_);
             }
         }
@@ -429,6 +623,13 @@ void QCache3Q<Key,T,EvPolicy>::remove(const Key &key)
     delete n;
 }
 
+template <class Key, class T, class EvPolicy>
+bool QCache3Q<Key,T,EvPolicy>::contains(const Key &key) const
+{
+    Node *n = lookup_.value(key, 0);
+    return n && n->q != q1_evicted_;
+}
+
 template <class Key, class T, class EvPolicy>
 QSharedPointer<T> QCache3Q<Key,T,EvPolicy>::object(const Key &key) const
 {
@@ -449,6 +650,7 @@ QSharedPointer<T> QCache3Q<Key,T,EvPolicy>::object(const Key &key) const
         if (n->pop > (quint64)promote_) {
             me->unlink(n);
             me->link_front(n, q2_);
+            me->promotionCount_++;
             me->rebalance();
         }
     } else if (n->q != q1_evicted_) {
@@ -460,6 +662,9 @@ QSharedPointer<T> QCache3Q<Key,T,EvPolicy>::object(const Key &key) const
         me->rebalance();
     } else {
         me->missCount_++;
+        me->ghostHitCount_++;
+        if (adaptive_)
+            me->adapt(n);
     }
 
     return n->v;
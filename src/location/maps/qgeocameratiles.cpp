@@ -43,12 +43,16 @@
 #include "qgeocameradata_p.h"
 #include "qgeoprojection_p.h"
 #include "qgeotilespec_p.h"
+#include "qgeotilekey_p.h"
 
 #include "qdoublevector2d_p.h"
 #include "qdoublevector3d_p.h"
 
 #include "qgeomaptype_p.h"
 
+#include "qgeorectangle.h"
+#include "qgeocircle.h"
+
 #include <QVector>
 #include <QMap>
 #include <QPair>
@@ -78,6 +82,10 @@ struct Frustum
 
 typedef QVector<QDoubleVector3D> Polygon;
 
+// runs of tiles [minX, maxX] on each row of tiles, sorted and disjoint
+typedef QVector<QPair<int, int> > TileRuns;
+typedef QMap<int, TileRuns> SpanMap;
+
 class QGeoCameraTilesPrivate
 {
 public:
@@ -85,6 +93,7 @@ public:
     ~QGeoCameraTilesPrivate();
 
     QString pluginString_;
+    int pluginId_;
     QGeoMapType mapType_;
     QGeoCameraData camera_;
     QSize screenSize_;
@@ -95,9 +104,30 @@ public:
     int intZoomLevel_;
     int sideLength_;
 
+    // the scanline spans behind tiles_, valid unless prefetching added to it
+    SpanMap spans_;
+    bool spansValid_;
+
+    // unclipped footprint of the last full update and the camera center
+    // (in tiles) it was computed for, pans only translate it
+    Polygon footprint_;
+    QDoubleVector2D footprintCenter_;
+
+    // changes to tiles_ since the delta was last cleared
+    QSet<QGeoTileSpec> added_;
+    QSet<QGeoTileSpec> removed_;
+
     void updateMetadata();
     void updateGeometry(double viewExpansion = 1.0);
 
+    QDoubleVector2D cameraCenter() const;
+    void updateCameraTiles();
+    void panCameraTiles();
+    SpanMap spansFromFootprint(const Polygon &footprint) const;
+    void setSpans(const SpanMap &spans);
+    void subtractSpans(const SpanMap &from, const SpanMap &spans, QSet<QGeoTileSpec> *tiles) const;
+    void recordDelta(const QSet<QGeoTileSpec> &added, const QSet<QGeoTileSpec> &removed);
+
     Frustum frustum(double fieldOfViewGradient) const;
 
     class LengthSorter
@@ -112,12 +142,12 @@ public:
 
     void appendZIntersects(const QDoubleVector3D &start, const QDoubleVector3D &end, double z, QVector<QDoubleVector3D> &results) const;
     Polygon frustumFootprint(const Frustum &frustum) const;
+    Polygon areaFootprint(const QGeoShape &area) const;
 
     QPair<Polygon, Polygon> splitPolygonAtAxisValue(const Polygon &polygon, int axis, double value) const;
     QPair<Polygon, Polygon> clipFootprintToMap(const Polygon &footprint) const;
 
     QList<QPair<double, int> > tileIntersections(double p1, int t1, double p2, int t2) const;
-    QSet<QGeoTileSpec> tilesFromPolygon(const Polygon &polygon) const;
 
     struct TileMap
     {
@@ -127,6 +157,9 @@ public:
 
         QMap<int, QPair<int, int> > data;
     };
+
+    TileMap spansFromPolygon(const Polygon &polygon) const;
+    QSet<QGeoTileSpec> tilesFromPolygon(const Polygon &polygon) const;
 };
 
 QGeoCameraTiles::QGeoCameraTiles()
@@ -142,7 +175,9 @@ void QGeoCameraTiles::findPrefetchTiles()
 #if defined(ENABLE_PREFETCHING)
     Q_D(QGeoCameraTiles);
 
+    QSet<QGeoTileSpec> oldTiles = d->tiles_;
     d->tiles_.clear();
+    d->spansValid_ = false;
 
     // qDebug() << "prefetch called";
     int zoom = static_cast<int>(std::floor(d->camera_.zoomLevel()));
@@ -193,6 +228,8 @@ void QGeoCameraTiles::findPrefetchTiles()
     d->sideLength_ = 1 << d->intZoomLevel_;
     d->camera_.setZoomLevel(oldZoom);
 #endif
+
+    d->recordDelta(d->tiles_ - oldTiles, oldTiles - d->tiles_);
 #endif
 }
 
@@ -203,13 +240,20 @@ void QGeoCameraTiles::setCamera(const QGeoCameraData &camera)
 
     if (d->camera_ == camera)
         return;
+
+    // the footprint only depends on the center for a fixed zoom level, so a
+    // pan can reuse the previous one
+    bool pan = d->spansValid_ && camera.zoomLevel() == d->camera_.zoomLevel();
+
     d->camera_ = camera;
 
     d->intZoomLevel_ = static_cast<int>(std::floor(d->camera_.zoomLevel()));
     d->sideLength_ = 1 << d->intZoomLevel_;
 
-    d->tiles_.clear();
-    d->updateGeometry();
+    if (pan)
+        d->panCameraTiles();
+    else
+        d->updateCameraTiles();
 }
 
 void QGeoCameraTiles::setScreenSize(const QSize &size)
@@ -220,8 +264,7 @@ void QGeoCameraTiles::setScreenSize(const QSize &size)
         return;
 
     d->screenSize_ = size;
-    d->tiles_.clear();
-    d->updateGeometry();
+    d->updateCameraTiles();
 }
 
 void QGeoCameraTiles::setPluginString(const QString &pluginString)
@@ -232,6 +275,7 @@ void QGeoCameraTiles::setPluginString(const QString &pluginString)
         return;
 
     d->pluginString_ = pluginString;
+    d->pluginId_ = QGeoTileSpec::internPlugin(pluginString);
     d->updateMetadata();
 }
 
@@ -254,8 +298,7 @@ void QGeoCameraTiles::setTileSize(int tileSize)
         return;
 
     d->tileSize_ = tileSize;
-    d->tiles_.clear();
-    d->updateGeometry();
+    d->updateCameraTiles();
 }
 
 int QGeoCameraTiles::tileSize() const
@@ -272,8 +315,7 @@ void QGeoCameraTiles::setMaximumZoomLevel(int maxZoom)
         return;
 
     d->maxZoom_ = maxZoom;
-    d->tiles_.clear();
-    d->updateGeometry();
+    d->updateCameraTiles();
 }
 
 QSet<QGeoTileSpec> QGeoCameraTiles::tiles() const
@@ -282,11 +324,202 @@ QSet<QGeoTileSpec> QGeoCameraTiles::tiles() const
     return d->tiles_;
 }
 
+/*
+    Returns the tiles which were added to tiles() since the delta was last
+    cleared with clearTileDelta(). Together with removedTiles() this lets
+    the scene and the request manager follow the camera without diffing
+    the whole tile set on every frame.
+*/
+QSet<QGeoTileSpec> QGeoCameraTiles::addedTiles() const
+{
+    Q_D(const QGeoCameraTiles);
+    return d->added_;
+}
+
+/*
+    Returns the tiles which were removed from tiles() since the delta was
+    last cleared with clearTileDelta().
+*/
+QSet<QGeoTileSpec> QGeoCameraTiles::removedTiles() const
+{
+    Q_D(const QGeoCameraTiles);
+    return d->removed_;
+}
+
+void QGeoCameraTiles::clearTileDelta()
+{
+    Q_D(QGeoCameraTiles);
+    d->added_.clear();
+    d->removed_.clear();
+}
+
+/*
+    Returns the tiles at \a zoom which cover \a area, for the plugin and map
+    type set on this object. The outline of the area is walked the same way
+    as the camera footprint, so the result matches what a camera looking at
+    the area would request. Only rectangles and circles are supported, and
+    only zoom levels the tile keys can hold, up to QGeoTileKey::MaxZoom.
+*/
+QSet<QGeoTileSpec> QGeoCameraTiles::tilesForArea(const QGeoShape &area, int zoom) const
+{
+    Q_D(const QGeoCameraTiles);
+
+    if (!area.isValid() || zoom < 0 || zoom > QGeoTileKey::MaxZoom)
+        return QSet<QGeoTileSpec>();
+
+    // work on a copy, the tiles of the camera are left alone
+    QGeoCameraTilesPrivate p;
+    p.pluginId_ = d->pluginId_;
+    p.mapType_ = d->mapType_;
+    p.intZoomLevel_ = zoom;
+    p.sideLength_ = 1 << zoom;
+
+    Polygon footprint = p.areaFootprint(area);
+    if (footprint.isEmpty())
+        return QSet<QGeoTileSpec>();
+
+    QPair<Polygon, Polygon> polygons = p.clipFootprintToMap(footprint);
+
+    QSet<QGeoTileSpec> results;
+    if (!polygons.first.isEmpty())
+        results.unite(p.tilesFromPolygon(polygons.first));
+    if (!polygons.second.isEmpty())
+        results.unite(p.tilesFromPolygon(polygons.second));
+    return results;
+}
+
+/*
+    Returns an upper bound for the number of tiles tilesForArea() returns
+    for \a area at \a zoom, from the rows and columns spanned by the
+    bounding box of its outline. Unlike tilesForArea() this doesn't
+    enumerate the tiles, so it is cheap for any area at any zoom level.
+*/
+qint64 QGeoCameraTiles::tileCountForArea(const QGeoShape &area, int zoom) const
+{
+    if (!area.isValid() || zoom < 0 || zoom > QGeoTileKey::MaxZoom)
+        return 0;
+
+    QGeoCameraTilesPrivate p;
+    p.intZoomLevel_ = zoom;
+    p.sideLength_ = 1 << zoom;
+
+    Polygon footprint = p.areaFootprint(area);
+    if (footprint.isEmpty())
+        return 0;
+
+    double minX = footprint.at(0).x();
+    double maxX = minX;
+    double minY = footprint.at(0).y();
+    double maxY = minY;
+    for (int i = 1; i < footprint.size(); ++i) {
+        minX = qMin(minX, footprint.at(i).x());
+        maxX = qMax(maxX, footprint.at(i).x());
+        minY = qMin(minY, footprint.at(i).y());
+        maxY = qMax(maxY, footprint.at(i).y());
+    }
+
+    // the outline may run past the dateline, but never covers a column twice
+    qint64 side = p.sideLength_;
+    qint64 columns = qMin(side, qint64(std::floor(maxX)) - qint64(std::floor(minX)) + 1);
+    qint64 firstRow = qBound(qint64(0), qint64(std::floor(minY)), side - 1);
+    qint64 lastRow = qBound(qint64(0), qint64(std::floor(maxY)), side - 1);
+    return columns * (lastRow - firstRow + 1);
+}
+
+/*
+    Returns the tiles the camera will need on its way from where it is now
+    to \a target, such as the end point of a flick or the goal of a zoom
+    animation, nearest first. The path is sampled at intervals of about
+    half a screen, interpolating the center in mercator space (the short
+    way round the dateline) and the zoom level linearly. Tiles already in
+    tiles() are left out and at most \a budget tiles are returned.
+*/
+QList<QGeoTileSpec> QGeoCameraTiles::tilesAlongPath(const QGeoCameraData &target, int budget) const
+{
+    Q_D(const QGeoCameraTiles);
+
+    QList<QGeoTileSpec> results;
+
+    if (budget <= 0 || d->tileSize_ <= 0 || d->screenSize_.isEmpty()
+            || !target.center().isValid())
+        return results;
+
+    QDoubleVector2D from = QGeoProjection::coordToMercator(d->camera_.center());
+    QDoubleVector2D to = QGeoProjection::coordToMercator(target.center());
+    double dx = to.x() - from.x();
+    if (dx > 0.5)
+        dx -= 1.0;
+    else if (dx < -0.5)
+        dx += 1.0;
+    double dy = to.y() - from.y();
+
+    double fromZoom = d->camera_.zoomLevel();
+    double toZoom = qBound(0.0, target.zoomLevel(), 1.0 * d->maxZoom_);
+
+    // distance in screens at the current zoom, and zoom levels to cross
+    double screen = qMax(d->screenSize_.width(), d->screenSize_.height())
+            / (d->tileSize_ * std::pow(2.0, fromZoom));
+    double screens = std::sqrt(dx * dx + dy * dy) / screen;
+    int steps = qBound(1, static_cast<int>(std::ceil(qMax(2.0 * screens, 2.0 * qAbs(toZoom - fromZoom)))), 16);
+
+    QGeoCameraTilesPrivate p;
+    p.pluginId_ = d->pluginId_;
+    p.mapType_ = d->mapType_;
+    p.screenSize_ = d->screenSize_;
+    p.tileSize_ = d->tileSize_;
+    p.maxZoom_ = d->maxZoom_;
+    p.camera_ = d->camera_;
+
+    QSet<QGeoTileSpec> seen = d->tiles_;
+
+    for (int step = 1; step <= steps; ++step) {
+        double t = 1.0 * step / steps;
+
+        QDoubleVector2D center(from.x() + t * dx, from.y() + t * dy);
+        if (center.x() < 0.0)
+            center.setX(center.x() + 1.0);
+        else if (center.x() >= 1.0)
+            center.setX(center.x() - 1.0);
+        center.setY(qBound(0.0, center.y(), 1.0));
+
+        p.camera_.setCenter(QGeoProjection::mercatorToCoord(center));
+        p.camera_.setZoomLevel(fromZoom + t * (toZoom - fromZoom));
+        p.intZoomLevel_ = static_cast<int>(std::floor(p.camera_.zoomLevel()));
+        p.sideLength_ = 1 << p.intZoomLevel_;
+
+        p.tiles_.clear();
+        p.updateGeometry();
+
+        // nearer tiles of this sample first
+        QList<QGeoTileSpec> sample = (p.tiles_ - seen).toList();
+        QDoubleVector2D c = p.sideLength_ * center;
+        QList<QPair<double, int> > order;
+        for (int i = 0; i < sample.size(); ++i) {
+            double tx = sample.at(i).x() + 0.5 - c.x();
+            double ty = sample.at(i).y() + 0.5 - c.y();
+            order.append(QPair<double, int>(tx * tx + ty * ty, i));
+        }
+        qSort(order);
+
+        for (int i = 0; i < order.size(); ++i) {
+            results.append(sample.at(order.at(i).second));
+            if (results.size() >= budget)
+                return results;
+        }
+
+        seen.unite(p.tiles_);
+    }
+
+    return results;
+}
+
 QGeoCameraTilesPrivate::QGeoCameraTilesPrivate()
-    : tileSize_(0),
+    : pluginId_(0),
+      tileSize_(0),
       maxZoom_(0),
       intZoomLevel_(0),
-      sideLength_(0) {}
+      sideLength_(0),
+      spansValid_(false) {}
 
 QGeoCameraTilesPrivate::~QGeoCameraTilesPrivate() {}
 
@@ -301,9 +534,10 @@ void QGeoCameraTilesPrivate::updateMetadata()
 
     for (; i != end; ++i) {
         QGeoTileSpec tile = *i;
-        newTiles.insert(QGeoTileSpec(pluginString_, mapType_.mapId(), tile.zoom(), tile.x(), tile.y()));
+        newTiles.insert(QGeoTileSpec(QGeoTileKey(pluginId_, mapType_.mapId(), tile.zoom(), tile.x(), tile.y())));
     }
 
+    recordDelta(newTiles, tiles_);
     tiles_ = newTiles;
 }
 
@@ -330,6 +564,156 @@ void QGeoCameraTilesPrivate::updateGeometry(double viewExpansion)
     }
 }
 
+QDoubleVector2D QGeoCameraTilesPrivate::cameraCenter() const
+{
+    return sideLength_ * QGeoProjection::coordToMercator(camera_.center());
+}
+
+void QGeoCameraTilesPrivate::updateCameraTiles()
+{
+    // the zoom level or the view may have changed, diff the tile sets
+    spansValid_ = false;
+
+    footprint_ = frustumFootprint(frustum(1.0));
+    footprintCenter_ = cameraCenter();
+    setSpans(spansFromFootprint(footprint_));
+}
+
+void QGeoCameraTilesPrivate::panCameraTiles()
+{
+    // the camera looks straight down, so moving the center translates the
+    // footprint without changing its shape
+    QDoubleVector2D shift = cameraCenter() - footprintCenter_;
+
+    Polygon footprint = footprint_;
+    for (int i = 0; i < footprint.size(); ++i) {
+        QDoubleVector3D &p = footprint[i];
+        p.setX(p.x() + shift.x());
+        p.setY(p.y() + shift.y());
+    }
+
+    setSpans(spansFromFootprint(footprint));
+}
+
+static void addRun(TileRuns &runs, int minX, int maxX)
+{
+    int i = 0;
+    while (i < runs.size() && runs.at(i).second + 1 < minX)
+        ++i;
+
+    // merge with the runs it overlaps or touches
+    while (i < runs.size() && runs.at(i).first <= maxX + 1) {
+        minX = qMin(minX, runs.at(i).first);
+        maxX = qMax(maxX, runs.at(i).second);
+        runs.remove(i);
+    }
+
+    runs.insert(i, QPair<int, int>(minX, maxX));
+}
+
+SpanMap QGeoCameraTilesPrivate::spansFromFootprint(const Polygon &footprint) const
+{
+    // Clip the polygon to the map, split it up if it cross the dateline
+    QPair<Polygon, Polygon> polygons = clipFootprintToMap(footprint);
+
+    SpanMap spans;
+
+    typedef QMap<int, QPair<int, int> >::const_iterator iter;
+
+    if (!polygons.first.isEmpty()) {
+        TileMap map = spansFromPolygon(polygons.first);
+        for (iter i = map.data.constBegin(); i != map.data.constEnd(); ++i)
+            addRun(spans[i.key()], i->first, i->second);
+    }
+
+    if (!polygons.second.isEmpty()) {
+        TileMap map = spansFromPolygon(polygons.second);
+        for (iter i = map.data.constBegin(); i != map.data.constEnd(); ++i)
+            addRun(spans[i.key()], i->first, i->second);
+    }
+
+    return spans;
+}
+
+/*
+    Adds the tiles covered by \a from but not by \a spans to \a tiles.
+    Only the runs which differ are walked tile by tile.
+*/
+void QGeoCameraTilesPrivate::subtractSpans(const SpanMap &from, const SpanMap &spans,
+                                           QSet<QGeoTileSpec> *tiles) const
+{
+    int mapId = mapType_.mapId();
+
+    SpanMap::const_iterator i = from.constBegin();
+    SpanMap::const_iterator end = from.constEnd();
+
+    for (; i != end; ++i) {
+        int y = i.key();
+        const TileRuns &runs = i.value();
+        const TileRuns others = spans.value(y);
+
+        for (int r = 0; r < runs.size(); ++r) {
+            int x = runs.at(r).first;
+            int maxX = runs.at(r).second;
+
+            for (int o = 0; o < others.size() && x <= maxX; ++o) {
+                if (others.at(o).second < x)
+                    continue;
+                if (others.at(o).first > maxX)
+                    break;
+                for (; x < others.at(o).first; ++x)
+                    tiles->insert(QGeoTileSpec(QGeoTileKey(pluginId_, mapId, intZoomLevel_, x, y)));
+                x = others.at(o).second + 1;
+            }
+
+            for (; x <= maxX; ++x)
+                tiles->insert(QGeoTileSpec(QGeoTileKey(pluginId_, mapId, intZoomLevel_, x, y)));
+        }
+    }
+}
+
+void QGeoCameraTilesPrivate::setSpans(const SpanMap &spans)
+{
+    QSet<QGeoTileSpec> added;
+    QSet<QGeoTileSpec> removed;
+
+    if (spansValid_) {
+        // only reached when panning, both span sets are at intZoomLevel_
+        subtractSpans(spans_, spans, &removed);
+        subtractSpans(spans, spans_, &added);
+        tiles_.subtract(removed);
+        tiles_.unite(added);
+    } else {
+        QSet<QGeoTileSpec> newTiles;
+        subtractSpans(spans, SpanMap(), &newTiles);
+        added = newTiles - tiles_;
+        removed = tiles_ - newTiles;
+        tiles_ = newTiles;
+    }
+
+    spans_ = spans;
+    spansValid_ = true;
+
+    recordDelta(added, removed);
+}
+
+void QGeoCameraTilesPrivate::recordDelta(const QSet<QGeoTileSpec> &added,
+                                         const QSet<QGeoTileSpec> &removed)
+{
+    typedef QSet<QGeoTileSpec>::const_iterator iter;
+
+    // a tile which comes back before the delta is consumed cancels out
+    for (iter i = removed.constBegin(); i != removed.constEnd(); ++i) {
+        if (!added_.remove(*i))
+            removed_.insert(*i);
+    }
+
+    for (iter i = added.constBegin(); i != added.constEnd(); ++i) {
+        if (!removed_.remove(*i))
+            added_.insert(*i);
+    }
+}
+
 Frustum QGeoCameraTilesPrivate::frustum(double fieldOfViewGradient) const
 {
     QDoubleVector3D center = sideLength_ * QGeoProjection::coordToMercator(camera_.center());
@@ -481,6 +865,49 @@ Polygon QGeoCameraTilesPrivate::frustumFootprint(const Frustum &frustum) const
     return points;
 }
 
+Polygon QGeoCameraTilesPrivate::areaFootprint(const QGeoShape &area) const
+{
+    double side = 1.0 * sideLength_;
+    Polygon results;
+
+    if (area.type() == QGeoShape::RectangleType) {
+        QGeoRectangle rect(area);
+        QDoubleVector2D topLeft = QGeoProjection::coordToMercator(rect.topLeft()) * side;
+        QDoubleVector2D bottomRight = QGeoProjection::coordToMercator(rect.bottomRight()) * side;
+
+        // a rectangle crossing the dateline ends up beyond the right edge,
+        // clipFootprintToMap() splits it up again
+        double right = bottomRight.x();
+        if (right <= topLeft.x())
+            right += side;
+
+        results.append(QDoubleVector3D(topLeft.x(), topLeft.y(), 0.0));
+        results.append(QDoubleVector3D(right, topLeft.y(), 0.0));
+        results.append(QDoubleVector3D(right, bottomRight.y(), 0.0));
+        results.append(QDoubleVector3D(topLeft.x(), bottomRight.y(), 0.0));
+    } else if (area.type() == QGeoShape::CircleType) {
+        QGeoCircle circle(area);
+        const int segments = 32;
+        for (int i = 0; i < segments; ++i) {
+            QGeoCoordinate c = circle.center().atDistanceAndAzimuth(circle.radius(), i * 360.0 / segments);
+            QDoubleVector2D p = QGeoProjection::coordToMercator(c) * side;
+
+            // keep the outline continuous across the dateline
+            double x = p.x();
+            if (!results.isEmpty()) {
+                double previous = results.last().x();
+                if (x - previous > side / 2)
+                    x -= side;
+                else if (previous - x > side / 2)
+                    x += side;
+            }
+            results.append(QDoubleVector3D(x, p.y(), 0.0));
+        }
+    }
+
+    return results;
+}
+
 QPair<Polygon, Polygon> QGeoCameraTilesPrivate::splitPolygonAtAxisValue(const Polygon &polygon, int axis, double value) const
 {
     Polygon polygonBelow;
@@ -724,11 +1151,37 @@ QList<QPair<double, int> > QGeoCameraTilesPrivate::tileIntersections(double p1,
 }
 
 QSet<QGeoTileSpec> QGeoCameraTilesPrivate::tilesFromPolygon(const Polygon &polygon) const
+{
+    TileMap map = spansFromPolygon(polygon);
+
+    QSet<QGeoTileSpec> results;
+
+    int z = intZoomLevel_;
+
+    typedef QMap<int, QPair<int, int> >::const_iterator iter;
+    iter i = map.data.constBegin();
+    iter end = map.data.constEnd();
+
+    for (; i != end; ++i) {
+        int y = i.key();
+        int minX = i->first;
+        int maxX = i->second;
+        for (int x = minX; x <= maxX; ++x) {
+            results.insert(QGeoTileSpec(QGeoTileKey(pluginId_, mapType_.mapId(), z, x, y)));
+        }
+    }
+
+    return results;
+}
+
+QGeoCameraTilesPrivate::TileMap QGeoCameraTilesPrivate::spansFromPolygon(const Polygon &polygon) const
 {
     int numPoints = polygon.size();
 
+    QGeoCameraTilesPrivate::TileMap map;
+
     if (numPoints == 0)
-        return QSet<QGeoTileSpec>();
+        return map;
 
     QVector<int> tilesX(polygon.size());
     QVector<int> tilesY(polygon.size());
@@ -761,8 +1214,6 @@ QSet<QGeoTileSpec> QGeoCameraTilesPrivate::tilesFromPolygon(const Polygon &polyg
         tilesY[i] = y;
     }
 
-    QGeoCameraTilesPrivate::TileMap map;
-
     // walk along the edges of the polygon and add all tiles covered by them
     for (int i1 = 0; i1 < numPoints; ++i1) {
         int i2 = (i1 + 1) % numPoints;
@@ -907,24 +1358,7 @@ QSet<QGeoTileSpec> QGeoCameraTilesPrivate::tilesFromPolygon(const Polygon &polyg
         }
     }
 
-    QSet<QGeoTileSpec> results;
-
-    int z = intZoomLevel_;
-
-    typedef QMap<int, QPair<int, int> >::const_iterator iter;
-    iter i = map.data.constBegin();
-    iter end = map.data.constEnd();
-
-    for (; i != end; ++i) {
-        int y = i.key();
-        int minX = i->first;
-        int maxX = i->second;
-        for (int x = minX; x <= maxX; ++x) {
-            results.insert(QGeoTileSpec(pluginString_, mapType_.mapId(), z, x, y));
-        }
-    }
-
-    return results;
+    return map;
 }
 
 QGeoCameraTilesPrivate::TileMap::TileMap() {}
@@ -54,6 +54,7 @@
 
 #include <QtLocation/qlocationglobal.h>
 #include <QSet>
+#include <QList>
 #include <QSize>
 #include <QSizeF>
 #include <QPair>
@@ -63,6 +64,7 @@ QT_BEGIN_NAMESPACE
 class QGeoCameraData;
 class QGeoTileSpec;
 class QGeoMapType;
+class QGeoShape;
 
 class QGeoCameraTilesPrivate;
 
@@ -84,6 +86,14 @@ public:
     QSet<QGeoTileSpec> tiles() const;
     void findPrefetchTiles();
 
+    QSet<QGeoTileSpec> addedTiles() const;
+    QSet<QGeoTileSpec> removedTiles() const;
+    void clearTileDelta();
+
+    QSet<QGeoTileSpec> tilesForArea(const QGeoShape &area, int zoom) const;
+    qint64 tileCountForArea(const QGeoShape &area, int zoom) const;
+    QList<QGeoTileSpec> tilesAlongPath(const QGeoCameraData &target, int budget) const;
+
 private:
     QGeoCameraTilesPrivate *d_ptr;
     Q_DECLARE_PRIVATE(QGeoCameraTiles)
@@ -134,6 +134,21 @@ void QGeoMap::cameraStopped()
     mapData_->prefetchData();
 }
 
+/*
+    Tells the map that the camera is on its way to \a target, for example
+    at the start of a flick, so it can fetch what it will need ahead of
+    time. Like cameraStopped() this is only a hint.
+*/
+void QGeoMap::cameraMovingTo(const QGeoCameraData &target)
+{
+    mapData_->prefetchPath(target);
+}
+
+QVariantMap QGeoMap::cacheStatistics() const
+{
+    return mapData_->cacheStatistics();
+}
+
 QGeoCameraData QGeoMap::cameraData() const
 {
     return mapData_->cameraData();
@@ -149,6 +164,15 @@ QPointF QGeoMap::coordinateToScreenPosition(const QGeoCoordinate &coordinate, bo
     return mapData_->coordinateToScreenPosition(coordinate, clipToViewport);
 }
 
+/*
+    Projects \a count coordinates at once, see
+    QGeoMapData::coordinatesToScreenPositions().
+*/
+void QGeoMap::coordinatesToScreenPositions(const double *latLon, double *screen, int count) const
+{
+    mapData_->coordinatesToScreenPositions(latLon, screen, count);
+}
+
 void QGeoMap::update()
 {
     emit mapData_->update();
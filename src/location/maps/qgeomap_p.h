@@ -53,6 +53,7 @@
 //
 
 #include <QObject>
+#include <QVariantMap>
 
 #include "qgeocameradata_p.h"
 #include "qgeomaptype_p.h"
@@ -100,15 +101,18 @@ public:
 
     QGeoCoordinate screenPositionToCoordinate(const QPointF &pos, bool clipToViewport = true) const;
     QPointF coordinateToScreenPosition(const QGeoCoordinate &coordinate, bool clipToViewport = true) const;
+    void coordinatesToScreenPositions(const double *latLon, double *screen, int count) const;
 
     void setActiveMapType(const QGeoMapType mapType);
     const QGeoMapType activeMapType() const;
 
     QString pluginString();
+    QVariantMap cacheStatistics() const;
 
 public Q_SLOTS:
     void update();
     void cameraStopped(); // optional hint for prefetch
+    void cameraMovingTo(const QGeoCameraData &target); // optional hint for prefetch
 
 Q_SIGNALS:
     void cameraDataChanged(const QGeoCameraData &cameraData);
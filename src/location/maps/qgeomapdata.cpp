@@ -45,6 +45,7 @@
 #include "qgeotilecache_p.h"
 #include "qgeotilespec_p.h"
 #include "qgeoprojection_p.h"
+#include "qgeocoordinate.h"
 #include "qgeocameracapabilities_p.h"
 #include "qgeomapcontroller_p.h"
 #include "qdoublevector2d_p.h"
@@ -151,6 +152,25 @@ const QGeoMapType QGeoMapData::activeMapType() const
     return d->activeMapType();
 }
 
+/*
+    Projects \a count coordinates to screen positions at once, like
+    coordinateToScreenPosition() without clipping to the viewport.
+    \a latLon holds the latitude and longitude of each coordinate in turn
+    and \a screen receives the x and y of each in the same layout. The two
+    may be the same buffer. All coordinates must be valid.
+
+    This implementation projects one coordinate at a time; subclasses
+    should provide a faster one.
+*/
+void QGeoMapData::coordinatesToScreenPositions(const double *latLon, double *screen, int count) const
+{
+    for (int i = 0; i < count; ++i) {
+        QPointF pos = coordinateToScreenPosition(QGeoCoordinate(latLon[2 * i], latLon[2 * i + 1]), false);
+        screen[2 * i] = pos.x();
+        screen[2 * i + 1] = pos.y();
+    }
+}
+
 QString QGeoMapData::pluginString()
 {
     Q_D(QGeoMapData);
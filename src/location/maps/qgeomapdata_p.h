@@ -53,6 +53,7 @@
 //
 
 #include <QObject>
+#include <QVariantMap>
 
 #include "qgeocameradata_p.h"
 #include "qgeomaptype_p.h"
@@ -102,11 +103,14 @@ public:
 
     virtual QGeoCoordinate screenPositionToCoordinate(const QPointF &pos, bool clipToViewport = true) const = 0;
     virtual QPointF coordinateToScreenPosition(const QGeoCoordinate &coordinate, bool clipToViewport = true) const = 0;
+    virtual void coordinatesToScreenPositions(const double *latLon, double *screen, int count) const;
 
     QString pluginString();
     QGeoCameraCapabilities cameraCapabilities();
     QGeoMappingManagerEngine *engine();
     virtual void prefetchData() {}
+    virtual void prefetchPath(const QGeoCameraData &target) { Q_UNUSED(target); }
+    virtual QVariantMap cacheStatistics() const { return QVariantMap(); }
 
 protected:
     void setCoordinateInterpolator(QSharedPointer<QGeoCoordinateInterpolator> interpolator);
@@ -44,23 +44,24 @@
 #include "qgeoprojection_p.h"
 #include "qgeotilecache_p.h"
 #include "qgeotilespec_p.h"
+#include "qgeotilekey_p.h"
 
 #include "qdoublevector2d_p.h"
 #include "qdoublevector3d_p.h"
 
-#include <Qt3D/qglscenenode.h>
-#include <Qt3D/qglbuilder.h>
+#include <Qt3D/qarray.h>
 #include <Qt3D/qglmaterial.h>
 #include <Qt3D/qgltexture2d.h>
-#include <Qt3D/qgeometrydata.h>
 #include <Qt3D/qglcamera.h>
 #include <Qt3D/qglpainter.h>
 #include <Qt3D/QGLLightParameters>
 
 
 #include <QHash>
+#include <QVector>
 
 #include <QPointF>
+#include <QRectF>
 
 #include <cmath>
 
@@ -78,7 +79,7 @@ public:
     QSet<QGeoTileSpec> visibleTiles_;
 
     QGLCamera *camera_;
-    QGLSceneNode *sceneNode_;
+    QGLMaterial *material_;
     QGLLightParameters* light_;
 
     // scales up the tile geometry and the camera altitude, resulting in no visible effect
@@ -93,10 +94,37 @@ public:
     // it is 1<<zoomLevel
     int sideLength_;
 
-    QHash<QGeoTileSpec, QGLSceneNode *> nodes_;
-    QHash<QGeoTileSpec, QSharedPointer<QGeoTileTexture> > textures_;
+    // All tiles share one mesh, a quad of 4 vertices per slot drawn as a
+    // triangle fan. Without an index array there's no 16 bit limit on the
+    // number of slots. Slots of tiles which went out of view are reused,
+    // and a pan only writes the quads of the tiles it brings in.
+    QHash<QGeoTileKey, int> slots_;
+    QVector<QGeoTileSpec> slotSpecs_;
+    QVector<QSharedPointer<QGeoTileTexture> > slotTextures_;  // null for free slots
+    QVector<int> freeSlots_;
+    QArray<QVector3D> positions_;
+    QArray<QVector3D> normals_;
+    QArray<QVector2D> texCoords_;
+
+    QHash<QGeoTileKey, QSharedPointer<QGeoTileTexture> > textures_;
     QList<QSharedPointer<QGeoTileTexture> > newUploads_;
 
+    // Visible tiles still waiting for their texture are drawn from that of
+    // an ancestor, cropped through the texture coordinates, or from those of
+    // their children. These are the slots used for each such tile.
+    QHash<QGeoTileKey, QVector<int> > fallbacks_;
+
+    // the mesh and the camera are relative to this tile, which keeps the
+    // coordinates small enough for floats without rewriting every quad
+    // each time the tile bounds move
+    int originX_;
+    int originY_;
+    int originZ_;
+    int originWrap_;
+
+    int quadWrites_;
+    int slotAllocations_;
+
     // tilesToGrid transform
     int minTileX_; // the minimum tile index, i.e. 0 to sideLength which is 1<< zoomLevel
     int minTileY_;
@@ -123,18 +151,30 @@ public:
     bool linearScaling_;
 
     void addTile(const QGeoTileSpec &spec, QSharedPointer<QGeoTileTexture> texture);
+    void addFallback(const QGeoTileSpec &spec,
+                     const QList<QSharedPointer<QGeoTileTexture> > &textures);
+    void removeFallback(const QGeoTileKey &key);
 
     QDoubleVector2D screenPositionToMercator(const QPointF &pos) const;
     QPointF mercatorToScreenPosition(const QDoubleVector2D &mercator) const;
+    void mercatorToScreenPositions(const double *mercator, double *screen, int count) const;
 
     void setVisibleTiles(const QSet<QGeoTileSpec> &tiles);
+    void updateVisibleTiles(const QSet<QGeoTileSpec> &tiles,
+                            const QSet<QGeoTileSpec> &added,
+                            const QSet<QGeoTileSpec> &removed);
     void removeTiles(const QSet<QGeoTileSpec> &oldTiles);
-    void updateTiles(const QSet<QGeoTileSpec> &tiles);
-    QGeometryData buildGeometry(const QGeoTileSpec &spec);
-    QGLSceneNode *buildSceneNodeFromGeometry(const QGeometryData &geom);
+    bool isInBounds(const QGeoTileSpec &spec) const;
+    bool isInBounds(int zoom, int x, int y) const;
+    int allocateSlot();
+    void freeSlot(int slot);
+    void writeQuad(int slot, const QGeoTileSpec &spec);
+    void writeTexCoords(int slot, const QRectF &rect);
+    void updateOrigin();
     void setTileBounds(const QSet<QGeoTileSpec> &tiles);
     void setupCamera();
     void setScalingOnTextures();
+    QList<int> visibleCopies() const;
 
     void paintGL(QGLPainter *painter);
 
@@ -192,12 +232,38 @@ void QGeoMapScene::setVisibleTiles(const QSet<QGeoTileSpec> &tiles)
     d->setVisibleTiles(tiles);
 }
 
+/*
+    Sets the visible tiles to \a tiles, given that they differ from the
+    previous ones by the \a added and \a removed tiles. This avoids diffing
+    the two sets when the camera only pans.
+*/
+void QGeoMapScene::updateVisibleTiles(const QSet<QGeoTileSpec> &tiles,
+                                      const QSet<QGeoTileSpec> &added,
+                                      const QSet<QGeoTileSpec> &removed)
+{
+    Q_D(QGeoMapScene);
+    d->updateVisibleTiles(tiles, added, removed);
+}
+
 void QGeoMapScene::addTile(const QGeoTileSpec &spec, QSharedPointer<QGeoTileTexture> texture)
 {
     Q_D(QGeoMapScene);
     d->addTile(spec, texture);
 }
 
+/*
+    Draws the visible tile \a spec, which has no texture yet, from the
+    \a textures of either one of its ancestors or some of its children
+    until addTile() is called for it. An ancestor is upscaled and cropped to
+    the part covering \a spec. Replaces any earlier fallback for the tile.
+*/
+void QGeoMapScene::addFallback(const QGeoTileSpec &spec,
+                               const QList<QSharedPointer<QGeoTileTexture> > &textures)
+{
+    Q_D(QGeoMapScene);
+    d->addFallback(spec, textures);
+}
+
 QDoubleVector2D QGeoMapScene::screenPositionToMercator(const QPointF &pos) const
 {
     Q_D(const QGeoMapScene);
@@ -210,16 +276,42 @@ QPointF QGeoMapScene::mercatorToScreenPosition(const QDoubleVector2D &mercator)
     return d->mercatorToScreenPosition(mercator);
 }
 
+/*
+    Converts \a count mercator coordinates, given as x and y in turn, to
+    screen positions in the same layout. \a mercator and \a screen may be
+    the same buffer.
+*/
+void QGeoMapScene::mercatorToScreenPositions(const double *mercator, double *screen, int count) const
+{
+    Q_D(const QGeoMapScene);
+    d->mercatorToScreenPositions(mercator, screen, count);
+}
+
 QGLCamera *QGeoMapScene::camera() const
 {
     Q_D(const QGeoMapScene);
     return d->camera_;
 }
 
-QGLSceneNode *QGeoMapScene::sceneNode() const
+QGeoMapSceneStats QGeoMapScene::stats() const
 {
     Q_D(const QGeoMapScene);
-    return d->sceneNode_;
+    QGeoMapSceneStats s;
+    s.tiles = d->slots_.size();
+    s.fallbackTiles = d->fallbacks_.size();
+    int quads = d->slotTextures_.size() - d->freeSlots_.size();
+    s.copies = quads == 0 ? 0 : d->visibleCopies().size();
+    s.drawCalls = quads * s.copies;
+    s.quadWrites = d->quadWrites_;
+    s.slotAllocations = d->slotAllocations_;
+    return s;
+}
+
+void QGeoMapScene::resetStats()
+{
+    Q_D(QGeoMapScene);
+    d->quadWrites_ = 0;
+    d->slotAllocations_ = 0;
 }
 
 bool QGeoMapScene::verticalLock() const
@@ -238,8 +330,8 @@ QSet<QGeoTileSpec> QGeoMapScene::texturedTiles()
 {
     Q_D(QGeoMapScene);
     QSet<QGeoTileSpec> textured;
-    foreach (const QGeoTileSpec &tile, d->textures_.keys()) {
-        textured += tile;
+    foreach (const QSharedPointer<QGeoTileTexture> &tex, d->textures_) {
+        textured += tex->spec;
     }
     return textured;
 }
@@ -247,11 +339,17 @@ QSet<QGeoTileSpec> QGeoMapScene::texturedTiles()
 QGeoMapScenePrivate::QGeoMapScenePrivate(QGeoMapScene *scene)
     : tileSize_(0),
       camera_(new QGLCamera()),
-      sceneNode_(new QGLSceneNode()),
+      material_(new QGLMaterial()),
       light_(new QGLLightParameters()),
       scaleFactor_(10.0),
       intZoomLevel_(0),
       sideLength_(0),
+      originX_(0),
+      originY_(0),
+      originZ_(-1),
+      originWrap_(0),
+      quadWrites_(0),
+      slotAllocations_(0),
       minTileX_(-1),
       minTileY_(-1),
       maxTileX_(-1),
@@ -273,7 +371,7 @@ QGeoMapScenePrivate::QGeoMapScenePrivate(QGeoMapScene *scene)
 
 QGeoMapScenePrivate::~QGeoMapScenePrivate()
 {
-    delete sceneNode_;
+    delete material_;
     delete camera_;
     delete light_;
 }
@@ -299,8 +397,14 @@ QDoubleVector2D QGeoMapScenePrivate::screenPositionToMercator(const QPointF &pos
 
 QPointF QGeoMapScenePrivate::mercatorToScreenPosition(const QDoubleVector2D &mercator) const
 {
-    double mx = sideLength_ * mercator.x();
+    double in[2] = { mercator.x(), mercator.y() };
+    double out[2];
+    mercatorToScreenPositions(in, out, 1);
+    return QPointF(out[0], out[1]);
+}
 
+void QGeoMapScenePrivate::mercatorToScreenPositions(const double *mercator, double *screen, int count) const
+{
     double lb = mercatorCenterX_ - mercatorWidth_ / 2.0;
     if (lb < 0.0)
         lb += sideLength_;
@@ -308,95 +412,175 @@ QPointF QGeoMapScenePrivate::mercatorToScreenPosition(const QDoubleVector2D &mer
     if (sideLength_ < ub)
         ub -= sideLength_;
 
-    double m = (mx - mercatorCenterX_) / mercatorWidth_;
+    bool crossesDateline = qFuzzyCompare(ub - lb + 1.0, 1.0) || (ub < lb);
 
-    double mWrapLower = (mx - mercatorCenterX_ - sideLength_) / mercatorWidth_;
-    double mWrapUpper = (mx - mercatorCenterX_ + sideLength_) / mercatorWidth_;
+    for (int i = 0; i < count; ++i) {
+        double mx = sideLength_ * mercator[2 * i];
+        double my = mercator[2 * i + 1];
 
-    // correct for crossing dateline
-    if (qFuzzyCompare(ub - lb + 1.0, 1.0) || (ub < lb) ) {
-        if (mercatorCenterX_ < ub) {
-            if (lb < mx) {
-                 m = mWrapLower;
-            }
-        } else if (lb < mercatorCenterX_) {
-            if (mx <= ub) {
-                m = mWrapUpper;
+        double m = (mx - mercatorCenterX_) / mercatorWidth_;
+
+        double mWrapLower = (mx - mercatorCenterX_ - sideLength_) / mercatorWidth_;
+        double mWrapUpper = (mx - mercatorCenterX_ + sideLength_) / mercatorWidth_;
+
+        // correct for crossing dateline
+        if (crossesDateline) {
+            if (mercatorCenterX_ < ub) {
+                if (lb < mx) {
+                     m = mWrapLower;
+                }
+            } else if (lb < mercatorCenterX_) {
+                if (mx <= ub) {
+                    m = mWrapUpper;
+                }
             }
         }
-    }
 
-    // apply wrapping if necessary so we don't return unreasonably large pos/neg screen positions
-    // also allows map items to be drawn properly if some of their coords are out of the screen
-    if ( qAbs(mWrapLower) < qAbs(m) )
-        m = mWrapLower;
-    if ( qAbs(mWrapUpper) < qAbs(m) )
-        m = mWrapUpper;
+        // apply wrapping if necessary so we don't return unreasonably large pos/neg screen positions
+        // also allows map items to be drawn properly if some of their coords are out of the screen
+        if ( qAbs(mWrapLower) < qAbs(m) )
+            m = mWrapLower;
+        if ( qAbs(mWrapUpper) < qAbs(m) )
+            m = mWrapUpper;
 
-    double x = screenWidth_ * (0.5 + m);
-    double y = screenHeight_ * (0.5 + (sideLength_ * mercator.y() - mercatorCenterY_) / mercatorHeight_);
-
-    return QPointF(x + screenOffsetX_, y + screenOffsetY_);
+        screen[2 * i] = screenWidth_ * (0.5 + m) + screenOffsetX_;
+        screen[2 * i + 1] = screenHeight_ * (0.5 + (sideLength_ * my - mercatorCenterY_) / mercatorHeight_)
+                + screenOffsetY_;
+    }
 }
 
-QGeometryData QGeoMapScenePrivate::buildGeometry(const QGeoTileSpec &spec)
+bool QGeoMapScenePrivate::isInBounds(const QGeoTileSpec &spec) const
 {
-    int x = spec.x();
+    return isInBounds(spec.zoom(), spec.x(), spec.y());
+}
 
+bool QGeoMapScenePrivate::isInBounds(int zoom, int x, int y) const
+{
     if (x < tileXWrapsBelow_)
         x += sideLength_;
 
-    if ((x < minTileX_)
-            || (maxTileX_ < x)
-            || (spec.y() < minTileY_)
-            || (maxTileY_ < spec.y())
-            || (spec.zoom() != tileZ_)) {
-        return 0;
-    }
+    return (minTileX_ <= x)
+            && (x <= maxTileX_)
+            && (minTileY_ <= y)
+            && (y <= maxTileY_)
+            && (zoom == tileZ_);
+}
 
-    double edge = scaleFactor_ * tileSize_;
+int QGeoMapScenePrivate::allocateSlot()
+{
+    if (!freeSlots_.isEmpty()) {
+        int slot = freeSlots_.last();
+        freeSlots_.pop_back();
+        return slot;
+    }
 
-    double x1 = (x - minTileX_);
-    double x2 = x1 + 1.0;
+    int slot = slotTextures_.size();
+    slotSpecs_.append(QGeoTileSpec());
+    slotTextures_.append(QSharedPointer<QGeoTileTexture>());
 
-    double y1 = (minTileY_ - spec.y());
-    double y2 = y1 - 1.0;
+    const QVector3D n(0.0, 0.0, 1.0);
+    for (int i = 0; i < 4; ++i) {
+        positions_.append(QVector3D());
+        normals_.append(n);
+    }
+    texCoords_.append(QVector2D(0.0, 1.0));
+    texCoords_.append(QVector2D(0.0, 0.0));
+    texCoords_.append(QVector2D(1.0, 0.0));
+    texCoords_.append(QVector2D(1.0, 1.0));
 
-    x1 *= edge;
-    x2 *= edge;
-    y1 *= edge;
-    y2 *= edge;
+    ++slotAllocations_;
+    return slot;
+}
 
-    QGeometryData g;
+void QGeoMapScenePrivate::freeSlot(int slot)
+{
+    slotTextures_[slot].clear();
+    freeSlots_.append(slot);
+}
 
-    QDoubleVector3D n = QDoubleVector3D(0, 0, 1);
+// spec is either a tile of the current zoom level or, for fallbacks, one
+// of its children, which covers a quarter of it
+void QGeoMapScenePrivate::writeQuad(int slot, const QGeoTileSpec &spec)
+{
+    int dz = qMax(0, spec.zoom() - tileZ_);
+    double scale = 1.0 / (1 << dz);
 
-    g.appendVertex(QVector3D(x1, y1, 0.0));
-    g.appendNormal(n);
-    g.appendTexCoord(QVector2D(0.0, 1.0));
+    double x = spec.x() * scale;
+    if ((spec.x() >> dz) < tileXWrapsBelow_)
+        x += sideLength_;
 
-    g.appendVertex(QVector3D(x1, y2, 0.0));
-    g.appendNormal(n);
-    g.appendTexCoord(QVector2D(0.0, 0.0));
+    double edge = scaleFactor_ * tileSize_;
 
-    g.appendVertex(QVector3D(x2, y2, 0.0));
-    g.appendNormal(n);
-    g.appendTexCoord(QVector2D(1.0, 0.0));
+    double x1 = (x - originX_) * edge;
+    double x2 = x1 + edge * scale;
+    double y1 = (originY_ - spec.y() * scale) * edge;
+    double y2 = y1 - edge * scale;
 
-    g.appendVertex(QVector3D(x2, y1, 0.0));
-    g.appendNormal(n);
-    g.appendTexCoord(QVector2D(1.0, 1.0));
+    QVector3D *v = positions_.data() + slot * 4;
+    v[0] = QVector3D(x1, y1, 0.0);
+    v[1] = QVector3D(x1, y2, 0.0);
+    v[2] = QVector3D(x2, y2, 0.0);
+    v[3] = QVector3D(x2, y1, 0.0);
 
-    return g;
+    ++quadWrites_;
 }
 
-QGLSceneNode *QGeoMapScenePrivate::buildSceneNodeFromGeometry(const QGeometryData &geom)
+// rect is the part of the texture to draw, with y pointing down the image
+void QGeoMapScenePrivate::writeTexCoords(int slot, const QRectF &rect)
 {
-    QGLBuilder builder;
-    builder.addQuads(geom);
-    return builder.finalizedSceneNode();
+    QVector2D *t = texCoords_.data() + slot * 4;
+    t[0] = QVector2D(rect.left(), 1.0 - rect.top());
+    t[1] = QVector2D(rect.left(), 1.0 - rect.bottom());
+    t[2] = QVector2D(rect.right(), 1.0 - rect.bottom());
+    t[3] = QVector2D(rect.right(), 1.0 - rect.top());
 }
 
+// Moves the origin of the mesh when the zoom level or the dateline wrap
+// changed, or the view drifted far enough from it to cost float precision,
+// and rewrites the quads still in the mesh to match.
+void QGeoMapScenePrivate::updateOrigin()
+{
+    const int maxDrift = 64;
+
+    if (tileZ_ == originZ_
+            && tileXWrapsBelow_ == originWrap_
+            && qAbs(minTileX_ - originX_) <= maxDrift
+            && qAbs(minTileY_ - originY_) <= maxDrift) {
+        return;
+    }
+
+    originX_ = minTileX_;
+    originY_ = minTileY_;
+    originZ_ = tileZ_;
+    originWrap_ = tileXWrapsBelow_;
+
+    QHash<QGeoTileKey, int>::iterator i = slots_.begin();
+    while (i != slots_.end()) {
+        int slot = i.value();
+        if (isInBounds(slotSpecs_.at(slot))) {
+            writeQuad(slot, slotSpecs_.at(slot));
+            ++i;
+        } else {
+            textures_.remove(i.key());
+            freeSlot(slot);
+            i = slots_.erase(i);
+        }
+    }
+
+    QHash<QGeoTileKey, QVector<int> >::iterator f = fallbacks_.begin();
+    while (f != fallbacks_.end()) {
+        const QVector<int> &slots = f.value();
+        if (isInBounds(f.key().zoom(), f.key().x(), f.key().y())) {
+            for (int j = 0; j < slots.size(); ++j)
+                writeQuad(slots.at(j), slotSpecs_.at(slots.at(j)));
+            ++f;
+        } else {
+            for (int j = 0; j < slots.size(); ++j)
+                freeSlot(slots.at(j));
+            f = fallbacks_.erase(f);
+        }
+    }
+}
 
 void QGeoMapScenePrivate::setScalingOnTextures()
 {
@@ -425,33 +609,88 @@ void QGeoMapScenePrivate::addTile(const QGeoTileSpec &spec, QSharedPointer<QGeoT
                                          (~QGLTexture2D::LinearFilteringBindOption));
     }
 
-    QGLSceneNode *node = nodes_.value(spec, 0);
-    if (!node) {
-        QGeometryData geom = buildGeometry(spec);
-        node = buildSceneNodeFromGeometry(geom);
-        if (!node)
+    QGeoTileKey key = spec.key();
+    int slot = slots_.value(key, -1);
+    if (slot < 0) {
+        if (!isInBounds(spec))
             return;
 
-        QGLMaterial *mat = new QGLMaterial(node);
-        mat->setTexture(texture->texture);
-        node->setEffect(QGL::LitDecalTexture2D);
-        node->setMaterial(mat);
+        // the fallback goes first, so its slots can be reused right away
+        if (!fallbacks_.isEmpty())
+            removeFallback(key);
 
-        sceneNode_->addNode(node);
-        nodes_.insert(spec, node);
-        textures_.insert(spec, texture);
+        slot = allocateSlot();
+        writeQuad(slot, spec);
+        writeTexCoords(slot, QRectF(0.0, 0.0, 1.0, 1.0));
+        slotSpecs_[slot] = spec;
+        slotTextures_[slot] = texture;
+
+        slots_.insert(key, slot);
+        textures_.insert(key, texture);
         newUploads_ << texture;
 
-    } else {
-        // TODO handle texture updates when we make node removal more efficient
-        if (textures_[spec].data() != texture.data()) {
-            textures_.insert(spec, texture);
-            node->material()->setTexture(texture->texture);
-            newUploads_ << texture;
+    } else if (slotTextures_.at(slot).data() != texture.data()) {
+        slotTextures_[slot] = texture;
+        textures_.insert(key, texture);
+        newUploads_ << texture;
+    }
+}
+
+void QGeoMapScenePrivate::addFallback(const QGeoTileSpec &spec,
+                                      const QList<QSharedPointer<QGeoTileTexture> > &textures)
+{
+    if (!visibleTiles_.contains(spec) || !isInBounds(spec))
+        return;
+
+    QGeoTileKey key = spec.key();
+    if (slots_.contains(key))
+        return;
+
+    removeFallback(key);
+    if (textures.isEmpty())
+        return;
+
+    QVector<int> &slots = fallbacks_[key];
+    foreach (const QSharedPointer<QGeoTileTexture> &texture, textures) {
+        const QGeoTileSpec &from = texture->spec;
+        int dz = spec.zoom() - from.zoom();
+        int slot = allocateSlot();
+
+        if (dz > 0) {
+            // the part of the ancestor covering the tile
+            int mask = (1 << dz) - 1;
+            double size = 1.0 / (1 << dz);
+            writeQuad(slot, spec);
+            writeTexCoords(slot, QRectF((spec.x() & mask) * size, (spec.y() & mask) * size,
+                                        size, size));
+            slotSpecs_[slot] = spec;
+        } else {
+            writeQuad(slot, from);
+            writeTexCoords(slot, QRectF(0.0, 0.0, 1.0, 1.0));
+            slotSpecs_[slot] = from;
         }
+
+        // scaled either way, so filtered regardless of the zoom level
+        texture->texture->setBindOptions(texture->texture->bindOptions() |
+                                         (QGLTexture2D::LinearFilteringBindOption));
+        slotTextures_[slot] = texture;
+        newUploads_ << texture;
+        slots.append(slot);
     }
 }
 
+void QGeoMapScenePrivate::removeFallback(const QGeoTileKey &key)
+{
+    QHash<QGeoTileKey, QVector<int> >::iterator f = fallbacks_.find(key);
+    if (f == fallbacks_.end())
+        return;
+
+    const QVector<int> &slots = f.value();
+    for (int j = 0; j < slots.size(); ++j)
+        freeSlot(slots.at(j));
+    fallbacks_.erase(f);
+}
+
 // return true if new tiles introduced in [tiles]
 void QGeoMapScenePrivate::setVisibleTiles(const QSet<QGeoTileSpec> &tiles)
 {
@@ -463,57 +702,38 @@ void QGeoMapScenePrivate::setVisibleTiles(const QSet<QGeoTileSpec> &tiles)
     // work out the tile bounds for the new scene
     setTileBounds(tiles);
 
-    // set up the gl camera for the new scene
-    setupCamera();
-
     QSet<QGeoTileSpec> toRemove = visibleTiles_ - tiles;
-    QSet<QGeoTileSpec> toUpdate = visibleTiles_ - toRemove;
     if (!toRemove.isEmpty())
         removeTiles(toRemove);
 
-    // only need to update tiles when the bounds have changed,
-    if (visibleTiles_ != tiles && !toUpdate.isEmpty())
-        updateTiles(toUpdate);
+    // the tiles staying in view keep their quads unless the origin moves
+    updateOrigin();
+
+    // set up the gl camera for the new scene
+    setupCamera();
 
     visibleTiles_ = tiles;
     if (newTilesIntroduced)
         emit q->newTilesVisible(visibleTiles_);
 }
 
-void QGeoMapScenePrivate::updateTiles(const QSet<QGeoTileSpec> &tiles)
+void QGeoMapScenePrivate::updateVisibleTiles(const QSet<QGeoTileSpec> &tiles,
+                                             const QSet<QGeoTileSpec> &added,
+                                             const QSet<QGeoTileSpec> &removed)
 {
-    typedef QSet<QGeoTileSpec>::const_iterator iter;
-    iter i = tiles.constBegin();
-    iter end = tiles.constEnd();
-    for (; i != end; ++i) {
-        QGeoTileSpec tile = *i;
-        QGLSceneNode *node = nodes_.value(tile, 0);
-
-        if (node) {
-            QGeometryData geom = buildGeometry(tile);
-            // if the new geometry (after wrapping) is the same as the old one,
-            // it can be reused
-            if ( node->children().size() > 0) {
-                if (node->children().front()->geometry() == geom)
-                    continue;
-            }
+    Q_Q(QGeoMapScene);
 
-            sceneNode_->removeNode(node);
-            QGLSceneNode *newNode = buildSceneNodeFromGeometry(geom);
-            if (newNode) {
-                QGLMaterial *mat = new QGLMaterial(newNode);
-                mat->setTexture(textures_[tile]->texture);
-                newNode->setEffect(QGL::LitDecalTexture2D);
-                newNode->setMaterial(mat);
-                sceneNode_->addNode(newNode);
-                nodes_.insert(tile, newNode);
-            } else {
-                nodes_.remove(tile);
-                textures_.remove(tile);
-            }
-            delete node;
-        }
-    }
+    setTileBounds(tiles);
+
+    if (!removed.isEmpty())
+        removeTiles(removed);
+
+    updateOrigin();
+    setupCamera();
+
+    visibleTiles_ = tiles;
+    if (!added.isEmpty())
+        emit q->newTilesVisible(visibleTiles_);
 }
 
 void QGeoMapScenePrivate::removeTiles(const QSet<QGeoTileSpec> &oldTiles)
@@ -523,14 +743,14 @@ void QGeoMapScenePrivate::removeTiles(const QSet<QGeoTileSpec> &oldTiles)
     iter end = oldTiles.constEnd();
 
     for (; i != end; ++i) {
-        QGeoTileSpec tile = *i;
-        QGLSceneNode *node = nodes_.value(tile, 0);
-        if (node) {
-            // TODO protect with mutex?
-            sceneNode_->removeNode(node);
-            nodes_.remove(tile);
-            textures_.remove(tile);
-            delete node;
+        QGeoTileKey key = i->key();
+        int slot = slots_.value(key, -1);
+        if (slot >= 0) {
+            slots_.remove(key);
+            textures_.remove(key);
+            freeSlot(slot);
+        } else if (!fallbacks_.isEmpty()) {
+            removeFallback(key);
         }
     }
 }
@@ -656,13 +876,13 @@ void QGeoMapScenePrivate::setupCamera()
     mercatorCenterX_ = center.x();
     mercatorCenterY_ = center.y();
 
-    // work out where the camera center is w.r.t minimum tile bounds
-    center.setX(center.x() - 1.0 * minTileX_);
-    center.setY(1.0 * minTileY_ - center.y());
+    // work out where the camera center is w.r.t the origin of the mesh
+    center.setX(center.x() - 1.0 * originX_);
+    center.setY(1.0 * originY_ - center.y());
 
     // letter box vertically
     if (useVerticalLock_ && (mercatorHeight_ > 1.0 * sideLength_)) {
-        center.setY(-1.0 * sideLength_ / 2.0);
+        center.setY(1.0 * originY_ - sideLength_ / 2.0);
         mercatorCenterY_ = sideLength_ / 2.0;
         screenOffsetY_ = screenSize_.height() * (0.5 - sideLength_ / (2 * mercatorHeight_));
         screenHeight_ = screenSize_.height() - 2 * screenOffsetY_;
@@ -729,14 +949,26 @@ void QGeoMapScenePrivate::setupCamera()
     camera_->setFarPlane(farPlane);
 }
 
-void QGeoMapScenePrivate::paintGL(QGLPainter *painter)
+// The copies of the map one world to the left and right of the tiles, which
+// are needed around the dateline, are only drawn when they reach into view.
+QList<int> QGeoMapScenePrivate::visibleCopies() const
 {
-    // TODO protect with mutex?
+    QList<int> copies;
+
+    double viewLeft = mercatorCenterX_ - mercatorWidth_ / 2.0;
+    double viewRight = mercatorCenterX_ + mercatorWidth_ / 2.0;
 
-    // TODO add a shortcut here for when we don't need to repeat and clip the map
-    // NOTE- this is important as the repeat code below removes a lot of accuracy
-    // by converting to float and adding/removing large numbers when at high zoom
+    for (int copy = -1; copy <= 1; ++copy) {
+        double left = 1.0 * minTileX_ + copy * sideLength_;
+        double right = 1.0 * maxTileX_ + 1.0 + copy * sideLength_;
+        if (left < viewRight && viewLeft < right)
+            copies.append(copy);
+    }
+    return copies;
+}
 
+void QGeoMapScenePrivate::paintGL(QGLPainter *painter)
+{
     // do any pending upload/releases
     while (!newUploads_.isEmpty()) {
         if (!newUploads_.front()->textureBound) {
@@ -747,6 +979,9 @@ void QGeoMapScenePrivate::paintGL(QGLPainter *painter)
         newUploads_.pop_front();
     }
 
+    if (slots_.isEmpty() && fallbacks_.isEmpty())
+        return;
+
     glEnable(GL_SCISSOR_TEST);
 
     painter->setScissor(QRect(screenOffsetX_, screenOffsetY_, screenWidth_, screenHeight_));
@@ -755,46 +990,37 @@ void QGeoMapScenePrivate::paintGL(QGLPainter *painter)
 
     painter->setMainLight(light_);
 
-    sceneNode_->draw(painter);
-
-    QGLCamera *camera = camera_;
-
-    bool old = camera->blockSignals(true);
-
     glDisable(GL_DEPTH_TEST);
 
-    double sideLength = scaleFactor_ * tileSize_ * sideLength_;
-
-    QDoubleVector3D c = QDoubleVector3D(camera->center());
-    c.setX(c.x() + sideLength);
-    camera->setCenter(c);
-
-    QDoubleVector3D e = QDoubleVector3D(camera->eye());
-    e.setX(e.x() + sideLength);
-    camera->setEye(e);
+    // the whole mesh is set up once, each tile is then a texture switch
+    // and a draw of its 4 vertices
+    painter->clearAttributes();
+    painter->setStandardEffect(QGL::LitDecalTexture2D);
+    painter->setFaceMaterial(QGL::AllFaces, material_);
+    painter->setVertexAttribute(QGL::Position, QGLAttributeValue(positions_));
+    painter->setVertexAttribute(QGL::Normal, QGLAttributeValue(normals_));
+    painter->setVertexAttribute(QGL::TextureCoord0, QGLAttributeValue(texCoords_));
 
-    painter->setCamera(camera);
-    sceneNode_->draw(painter);
-
-    c.setX(c.x() - 2 * sideLength);
-    camera->setCenter(c);
-    e.setX(e.x() - 2 * sideLength);
-    camera->setEye(e);
-
-    painter->setCamera(camera);
-    sceneNode_->draw(painter);
-
-    c.setX(c.x() + sideLength);
-    camera->setCenter(c);
-    e.setX(e.x() + sideLength);
-    camera->setEye(e);
+    double sideLength = scaleFactor_ * tileSize_ * sideLength_;
+    QList<int> copies = visibleCopies();
+
+    for (int i = 0; i < copies.size(); ++i) {
+        painter->modelViewMatrix().push();
+        if (copies.at(i) != 0)
+            painter->modelViewMatrix().translate(copies.at(i) * sideLength, 0.0, 0.0);
+
+        for (int slot = 0; slot < slotTextures_.size(); ++slot) {
+            const QSharedPointer<QGeoTileTexture> &tex = slotTextures_.at(slot);
+            if (!tex)
+                continue;
+            tex->texture->bind();
+            painter->draw(QGL::TriangleFan, 4, slot * 4);
+        }
 
-    painter->setCamera(camera);
-    sceneNode_->draw(painter);
+        painter->modelViewMatrix().pop();
+    }
 
     glEnable(GL_DEPTH_TEST);
-
-    camera->blockSignals(old);
 }
 
 QT_END_NAMESPACE
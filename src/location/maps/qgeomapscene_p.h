@@ -53,6 +53,7 @@
 //
 
 #include <QObject>
+#include <QList>
 #include <QSet>
 #include <QSharedPointer>
 #include <QSize>
@@ -66,7 +67,6 @@ class QGeoTileSpec;
 
 class QDoubleVector2D;
 
-class QGLSceneNode;
 class QGLCamera;
 class QGLPainter;
 class QGLTexture2D;
@@ -76,6 +76,22 @@ class QPointF;
 
 class QGeoMapScenePrivate;
 
+/* What the scene holds and what drawing it costs, for profiling. The counts
+ * of quad writes and slot allocations run from construction or the last
+ * resetStats(), the rest describe the next paintGL(). */
+struct QGeoMapSceneStats
+{
+    QGeoMapSceneStats()
+        : tiles(0), fallbackTiles(0), copies(0), drawCalls(0), quadWrites(0), slotAllocations(0) {}
+
+    int tiles;              // textured tiles in the mesh
+    int fallbackTiles;      // tiles drawn from an ancestor or their children
+    int copies;             // copies of the map drawn, to cover the dateline
+    int drawCalls;          // one per quad in the mesh and copy
+    int quadWrites;         // tile quads (re)written into the mesh
+    int slotAllocations;    // times the mesh had to grow
+};
+
 class Q_LOCATION_EXPORT QGeoMapScene : public QObject
 {
     Q_OBJECT
@@ -88,21 +104,29 @@ public:
     void setCameraData(const QGeoCameraData &cameraData_);
 
     void setVisibleTiles(const QSet<QGeoTileSpec> &tiles);
+    void updateVisibleTiles(const QSet<QGeoTileSpec> &tiles,
+                            const QSet<QGeoTileSpec> &added,
+                            const QSet<QGeoTileSpec> &removed);
 
     void setUseVerticalLock(bool lock);
 
     void addTile(const QGeoTileSpec &spec, QSharedPointer<QGeoTileTexture> texture);
+    void addFallback(const QGeoTileSpec &spec,
+                     const QList<QSharedPointer<QGeoTileTexture> > &textures);
 
     QDoubleVector2D screenPositionToMercator(const QPointF &pos) const;
     QPointF mercatorToScreenPosition(const QDoubleVector2D &mercator) const;
+    void mercatorToScreenPositions(const double *mercator, double *screen, int count) const;
 
     QGLCamera *camera() const;
-    QGLSceneNode *sceneNode() const;
     void paintGL(QGLPainter *painter);
 
     bool verticalLock() const;
     QSet<QGeoTileSpec> texturedTiles();
 
+    QGeoMapSceneStats stats() const;
+    void resetStats();
+
 Q_SIGNALS:
     void newTilesVisible(const QSet<QGeoTileSpec> &newTiles);
 
@@ -50,6 +50,10 @@
 #include "qdoublevector2d_p.h"
 #include "qdoublevector3d_p.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 QT_BEGIN_NAMESPACE
 
 QDoubleVector2D QGeoProjection::coordToMercator(const QGeoCoordinate &coord)
@@ -66,6 +70,124 @@ QDoubleVector2D QGeoProjection::coordToMercator(const QGeoCoordinate &coord)
     return QDoubleVector2D(lon, lat);
 }
 
+#ifdef __SSE2__
+
+// Both kernels below are only accurate on the ranges they are used for
+// here, which is enough to match the results of std::sin and std::log to
+// about 1e-15.
+
+// sin(x) for |x| <= pi / 2, from its Taylor series up to x^19
+static inline __m128d sinHalfPi(__m128d x)
+{
+    static const double c[] = {
+        -1.0 / 121645100408832000.0,  // -1/19!
+        1.0 / 355687428096000.0,
+        -1.0 / 1307674368000.0,
+        1.0 / 6227020800.0,
+        -1.0 / 39916800.0,
+        1.0 / 362880.0,
+        -1.0 / 5040.0,
+        1.0 / 120.0,
+        -1.0 / 6.0,
+        1.0
+    };
+
+    __m128d x2 = _mm_mul_pd(x, x);
+    __m128d r = _mm_set1_pd(c[0]);
+    for (int i = 1; i < 10; ++i)
+        r = _mm_add_pd(_mm_mul_pd(r, x2), _mm_set1_pd(c[i]));
+    return _mm_mul_pd(r, x);
+}
+
+// log(v) for positive, finite and normal v. v is split into m * 2^e with m
+// in [sqrt(1/2), sqrt(2)), and log(m) = 2 atanh((m - 1) / (m + 1)) from
+// the series of atanh up to z^15.
+static inline __m128d logPositive(__m128d v)
+{
+    const __m128i mantissaMask = _mm_set_epi32(0x000fffff, 0xffffffff, 0x000fffff, 0xffffffff);
+    const __m128i exponentOne = _mm_set_epi32(0x3ff00000, 0, 0x3ff00000, 0);
+
+    __m128i bits = _mm_castpd_si128(v);
+
+    // the biased exponents, moved to the low 32 bits of both halves and
+    // from there into doubles
+    __m128i biased = _mm_srli_epi64(bits, 52);
+    __m128d e = _mm_cvtepi32_pd(_mm_shuffle_epi32(biased, _MM_SHUFFLE(3, 1, 2, 0)));
+    e = _mm_sub_pd(e, _mm_set1_pd(1023.0));
+
+    __m128d m = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, mantissaMask), exponentOne));
+
+    __m128d big = _mm_cmpgt_pd(m, _mm_set1_pd(1.4142135623730951));
+    m = _mm_or_pd(_mm_and_pd(big, _mm_mul_pd(m, _mm_set1_pd(0.5))), _mm_andnot_pd(big, m));
+    e = _mm_add_pd(e, _mm_and_pd(big, _mm_set1_pd(1.0)));
+
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d z = _mm_div_pd(_mm_sub_pd(m, one), _mm_add_pd(m, one));
+    __m128d z2 = _mm_mul_pd(z, z);
+
+    __m128d r = _mm_set1_pd(1.0 / 15.0);
+    for (int k = 13; k >= 1; k -= 2)
+        r = _mm_add_pd(_mm_mul_pd(r, z2), _mm_set1_pd(1.0 / k));
+    r = _mm_mul_pd(_mm_mul_pd(r, z), _mm_set1_pd(2.0));
+
+    return _mm_add_pd(r, _mm_mul_pd(e, _mm_set1_pd(0.69314718055994531)));
+}
+
+#endif
+
+/*
+    Projects \a count coordinates at once, which is much cheaper than calling
+    coordToMercator() for each of them. \a latLon holds the latitude and
+    longitude of each coordinate in turn, in degrees, and \a mercator
+    receives the x and y of each in the same layout. The two may be the
+    same buffer. All coordinates must be valid.
+*/
+void QGeoProjection::coordinatesToMercator(const double *latLon, double *mercator, int count)
+{
+    const double pi = M_PI;
+
+    int i = 0;
+
+#ifdef __SSE2__
+    // y = 0.5 - atanh(sin(lat)) / (2 pi), which is what coordToMercator()
+    // works out through tan. Latitudes are clamped to where y is clamped
+    // anyway, keeping 1 - sin(lat) well away from 0.
+    const __m128d maxLat = _mm_set1_pd(86.0 * pi / 180.0);
+    const __m128d minLat = _mm_set1_pd(-86.0 * pi / 180.0);
+    const __m128d toRadians = _mm_set1_pd(pi / 180.0);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d zero = _mm_setzero_pd();
+
+    for (; i + 2 <= count; i += 2) {
+        __m128d a = _mm_loadu_pd(latLon + 2 * i);      // lat0, lon0
+        __m128d b = _mm_loadu_pd(latLon + 2 * i + 2);  // lat1, lon1
+        __m128d lat = _mm_unpacklo_pd(a, b);
+        __m128d lon = _mm_unpackhi_pd(a, b);
+
+        __m128d x = _mm_add_pd(_mm_mul_pd(lon, _mm_set1_pd(1.0 / 360.0)), half);
+
+        lat = _mm_min_pd(_mm_max_pd(_mm_mul_pd(lat, toRadians), minLat), maxLat);
+        __m128d s = sinHalfPi(lat);
+        __m128d y = logPositive(_mm_div_pd(_mm_add_pd(one, s), _mm_sub_pd(one, s)));
+        y = _mm_sub_pd(half, _mm_mul_pd(y, _mm_set1_pd(1.0 / (4.0 * pi))));
+        y = _mm_min_pd(_mm_max_pd(y, zero), one);
+
+        _mm_storeu_pd(mercator + 2 * i, _mm_unpacklo_pd(x, y));
+        _mm_storeu_pd(mercator + 2 * i + 2, _mm_unpackhi_pd(x, y));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        double lat = latLon[2 * i];
+        double lon = latLon[2 * i + 1];
+
+        double y = 0.5 - (std::log(std::tan((pi / 4.0) + (pi / 2.0) * lat / 180.0)) / pi) / 2.0;
+        mercator[2 * i] = lon / 360.0 + 0.5;
+        mercator[2 * i + 1] = qMin(1.0, qMax(0.0, y));
+    }
+}
+
 double QGeoProjection::realmod(const double a, const double b)
 {
     quint64 div = static_cast<quint64>(a / b);
@@ -70,6 +70,8 @@ public:
     static QDoubleVector2D coordToMercator(const QGeoCoordinate &coord);
     static QGeoCoordinate mercatorToCoord(const QDoubleVector2D &mercator);
 
+    static void coordinatesToMercator(const double *latLon, double *mercator, int count);
+
 private:
     static double realmod(const double a, const double b);
 };
@@ -262,7 +262,7 @@ QGeoRouteRequest::TravelMode QGeoRoute::travelMode() const
 */
 void QGeoRoute::setPath(const QList<QGeoCoordinate> &path)
 {
-    d_ptr->path = path;
+    d_ptr->path = QGeoCoordinateArray(path);
 }
 
 /*!
@@ -273,7 +273,7 @@ void QGeoRoute::setPath(const QList<QGeoCoordinate> &path)
 */
 QList<QGeoCoordinate> QGeoRoute::path() const
 {
-    return d_ptr->path;
+    return d_ptr->path.toList();
 }
 
 /*******************************************************************************
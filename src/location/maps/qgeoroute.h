@@ -94,6 +94,7 @@ public:
 
 private:
     QExplicitlySharedDataPointer<QGeoRoutePrivate> d_ptr;
+    friend class QGeoRoutePrivate;
 };
 
 QT_END_NAMESPACE
@@ -57,6 +57,7 @@
 #include "qgeorouterequest.h"
 #include "qgeorectangle.h"
 #include "qgeoroutesegment.h"
+#include "qgeocoordinatearray_p.h"
 
 #include <QSharedData>
 
@@ -84,9 +85,13 @@ public:
 
     QGeoRouteRequest::TravelMode travelMode;
 
-    QList<QGeoCoordinate> path;
+    QGeoCoordinateArray path;
 
     QGeoRouteSegment firstSegment;
+
+    // for reading and setting the path without converting it to a list
+    static QGeoRoutePrivate *get(QGeoRoute &route) { return route.d_ptr.data(); }
+    static const QGeoRoutePrivate *get(const QGeoRoute &route) { return route.d_ptr.constData(); }
 };
 
 QT_END_NAMESPACE
@@ -207,7 +207,7 @@ qreal QGeoRouteSegment::distance() const
 void QGeoRouteSegment::setPath(const QList<QGeoCoordinate> &path)
 {
     d_ptr->valid = true;
-    d_ptr->path = path;
+    d_ptr->path = QGeoCoordinateArray(path);
 }
 
 /*!
@@ -219,7 +219,7 @@ void QGeoRouteSegment::setPath(const QList<QGeoCoordinate> &path)
 
 QList<QGeoCoordinate> QGeoRouteSegment::path() const
 {
-    return d_ptr->path;
+    return d_ptr->path.toList();
 }
 
 /*!
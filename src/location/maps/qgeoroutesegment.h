@@ -87,6 +87,7 @@ protected:
 
 private:
     QExplicitlySharedDataPointer<QGeoRouteSegmentPrivate> d_ptr;
+    friend class QGeoRouteSegmentPrivate;
 };
 
 QT_END_NAMESPACE
@@ -54,6 +54,8 @@
 //
 
 #include "qgeomaneuver.h"
+#include "qgeoroutesegment.h"
+#include "qgeocoordinatearray_p.h"
 
 #include <QSharedData>
 #include <QList>
@@ -76,10 +78,16 @@ public:
 
     int travelTime;
     qreal distance;
-    QList<QGeoCoordinate> path;
+    QGeoCoordinateArray path;
     QGeoManeuver maneuver;
 
     QExplicitlySharedDataPointer<QGeoRouteSegmentPrivate> nextSegment;
+
+    // for reading and setting the path without converting it to a list
+    static QGeoRouteSegmentPrivate *get(QGeoRouteSegment &segment)
+    { return segment.d_ptr.data(); }
+    static const QGeoRouteSegmentPrivate *get(const QGeoRouteSegment &segment)
+    { return segment.d_ptr.constData(); }
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,205 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgeosimplifiedpath_p.h"
+#include "qgeoprojection_p.h"
+
+#include <QPair>
+
+#include <cmath>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+// distance from p to the segment a-b
+static double segmentDistance(const double *p, const double *a, const double *b)
+{
+    double dx = b[0] - a[0];
+    double dy = b[1] - a[1];
+    double px = p[0] - a[0];
+    double py = p[1] - a[1];
+
+    double length2 = dx * dx + dy * dy;
+    if (length2 > 0.0) {
+        double t = (px * dx + py * dy) / length2;
+        if (t >= 1.0) {
+            px = p[0] - b[0];
+            py = p[1] - b[1];
+        } else if (t > 0.0) {
+            px -= t * dx;
+            py -= t * dy;
+        }
+    }
+    return std::sqrt(px * px + py * py);
+}
+
+QGeoSimplifiedPath::QGeoSimplifiedPath()
+{
+}
+
+QGeoSimplifiedPath::QGeoSimplifiedPath(const QGeoCoordinateArray &path)
+    : path_(path)
+{
+    // the valid points in mercator, with x unwrapped so that no segment is
+    // longer than half the world and crossing the dateline doesn't read as
+    // a jump across the whole map
+    QVector<int> valid;
+    QVector<double> mercator;
+    valid.reserve(path.size());
+    mercator.reserve(2 * path.size());
+    for (int i = 0; i < path.size(); ++i) {
+        if (!path.isValid(i))
+            continue;
+        valid.append(i);
+        mercator << path.latitude(i) << path.longitude(i);
+    }
+
+    const int count = valid.size();
+    if (count == 0)
+        return;
+
+    double *m = mercator.data();
+    QGeoProjection::coordinatesToMercator(m, m, count);
+
+    double minX = m[0];
+    double maxX = m[0];
+    double minY = m[1];
+    double maxY = m[1];
+    for (int i = 1; i < count; ++i) {
+        double dx = m[2 * i] - m[2 * i - 2];
+        if (dx > 0.5)
+            m[2 * i] -= std::floor(dx + 0.5);
+        else if (dx < -0.5)
+            m[2 * i] += std::floor(-dx + 0.5);
+        minX = qMin(minX, m[2 * i]);
+        maxX = qMax(maxX, m[2 * i]);
+        minY = qMin(minY, m[2 * i + 1]);
+        maxY = qMax(maxY, m[2 * i + 1]);
+    }
+
+    double centerX = 0.5 * (minX + maxX);
+    centerX -= std::floor(centerX);
+    center_ = QDoubleVector2D(centerX, 0.5 * (minY + maxY));
+
+    // the Douglas-Peucker distance at which each point gets dropped, never
+    // more than that of the point that split its range, so that the points
+    // kept at a tolerance always include those kept at a larger one
+    const double infinity = std::numeric_limits<double>::infinity();
+    QVector<double> significance(count, 0.0);
+    significance[0] = infinity;
+    significance[count - 1] = infinity;
+
+    QVector<QPair<int, int> > ranges;
+    ranges.append(qMakePair(0, count - 1));
+    while (!ranges.isEmpty()) {
+        QPair<int, int> range = ranges.takeLast();
+        int first = range.first;
+        int last = range.second;
+        if (last - first < 2)
+            continue;
+
+        int split = first + 1;
+        double distance = -1.0;
+        for (int i = first + 1; i < last; ++i) {
+            double d = segmentDistance(m + 2 * i, m + 2 * first, m + 2 * last);
+            if (d > distance) {
+                distance = d;
+                split = i;
+            }
+        }
+
+        significance[split] = qMin(distance, qMin(significance.at(first), significance.at(last)));
+        ranges.append(qMakePair(first, split));
+        ranges.append(qMakePair(split, last));
+    }
+
+    // halve the tolerance from the size of the path down, skipping
+    // tolerances that keep no more points than the last. Once a level would
+    // keep more than half of the points the full path is used instead, which
+    // bounds the memory of all levels together to about that of the path.
+    const double extent = qMax(maxX - minX, maxY - minY);
+    int kept = 0;
+    for (int level = 0; level < 52; ++level) {
+        double tolerance = std::ldexp(extent, -level);
+        QVector<int> indices;
+        for (int i = 0; i < count; ++i) {
+            if (significance.at(i) >= tolerance)
+                indices.append(valid.at(i));
+        }
+        if (indices.size() > count / 2)
+            break;
+        if (indices.size() > kept) {
+            kept = indices.size();
+            tolerances_.append(tolerance);
+            levels_.append(indices);
+        }
+    }
+
+    tolerances_.append(0.0);
+    levels_.append(valid);
+}
+
+/*
+    Returns true if this was built from path, or an unmodified copy of it.
+*/
+bool QGeoSimplifiedPath::isBuiltFor(const QGeoCoordinateArray &path) const
+{
+    return path_.isSharedWith(path);
+}
+
+/*
+    Returns the indices of the coarsest level whose tolerance is at most
+    \a tolerance, in mercator units.
+*/
+const QVector<int> &QGeoSimplifiedPath::indicesForTolerance(double tolerance) const
+{
+    static const QVector<int> empty;
+    if (levels_.isEmpty())
+        return empty;
+
+    for (int i = 0; i < tolerances_.size(); ++i) {
+        if (tolerances_.at(i) <= tolerance)
+            return levels_.at(i);
+    }
+    return levels_.last();
+}
+
+QT_END_NAMESPACE
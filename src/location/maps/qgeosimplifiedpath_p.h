@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGEOSIMPLIFIEDPATH_P_H
+#define QGEOSIMPLIFIEDPATH_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtLocation/qlocationglobal.h>
+#include <QVector>
+
+#include "qgeocoordinatearray_p.h"
+#include "qdoublevector2d_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * QGeoSimplifiedPath
+ *
+ * Douglas-Peucker simplifications of a path at a series of tolerances, for
+ * drawing it at any zoom level without going through every point.
+ *
+ * Building it works in mercator space and is independent of the map, so it
+ * can be done once per path and on any thread. Each level holds the indices
+ * of the points that stay when every dropped point may be off the
+ * simplified line by less than the level's tolerance, in mercator units.
+ * Levels go from coarsest to finest, each one containing the points of the
+ * ones before; the last keeps every valid point and has a tolerance of 0.
+ */
+class Q_LOCATION_EXPORT QGeoSimplifiedPath
+{
+public:
+    QGeoSimplifiedPath();
+    explicit QGeoSimplifiedPath(const QGeoCoordinateArray &path);
+
+    bool isBuiltFor(const QGeoCoordinateArray &path) const;
+    inline const QGeoCoordinateArray &path() const { return path_; }
+
+    // center of the valid points' bounding box, in mercator
+    inline QDoubleVector2D center() const { return center_; }
+
+    inline int levelCount() const { return levels_.size(); }
+    inline double tolerance(int level) const { return tolerances_.at(level); }
+    inline const QVector<int> &indices(int level) const { return levels_.at(level); }
+
+    const QVector<int> &indicesForTolerance(double tolerance) const;
+
+private:
+    QGeoCoordinateArray path_;
+    QDoubleVector2D center_;
+    QVector<double> tolerances_;
+    QVector<QVector<int> > levels_;
+};
+
+Q_DECLARE_TYPEINFO(QGeoSimplifiedPath, Q_MOVABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QGEOSIMPLIFIEDPATH_P_H
@@ -0,0 +1,327 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGEOSPATIALINDEX_P_H
+#define QGEOSPATIALINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qhash.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qset.h>
+#include <QtCore/qvarlengtharray.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qmath.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    A quadtree over rectangles in mercator space, where x and y run from 0
+    to 1 and x wraps around at the dateline.
+
+    Each value is kept in the deepest node whose box fully contains its
+    rectangle, so a query only looks at the nodes its rectangle touches.
+    Rectangles may extend past x = 1, for values that cross the dateline,
+    and are matched against a query rectangle on either side of it.
+*/
+template <class T>
+class QGeoSpatialIndex
+{
+public:
+    QGeoSpatialIndex();
+
+    void insert(const T &value, const QRectF &rect);
+    bool remove(const T &value);
+    void clear();
+
+    bool contains(const T &value) const;
+    QRectF rect(const T &value) const;
+    int size() const;
+    bool isEmpty() const;
+
+    void intersecting(const QRectF &rect, QSet<T> *result) const;
+    QSet<T> intersecting(const QRectF &rect) const;
+
+private:
+    enum { MaximumDepth = 20 };
+
+    struct Entry
+    {
+        double x0, y0, x1, y1;
+        T value;
+    };
+
+    struct Node
+    {
+        Node() { children[0] = children[1] = children[2] = children[3] = -1; }
+        int children[4];
+        QVector<Entry> entries;
+    };
+
+    struct Location
+    {
+        int node;
+        int entry;
+    };
+
+    void query(double x0, double y0, double x1, double y1, QSet<T> *result) const;
+
+    QVector<Node> nodes_;
+    QHash<T, Location> locations_;
+};
+
+template <class T>
+QGeoSpatialIndex<T>::QGeoSpatialIndex()
+{
+    clear();
+}
+
+/*
+    Adds \a value with the bounding rectangle \a rect, or moves it there if
+    it is in the index already.
+*/
+template <class T>
+void QGeoSpatialIndex<T>::insert(const T &value, const QRectF &rect)
+{
+    remove(value);
+
+    Entry entry;
+    entry.value = value;
+    entry.x0 = rect.left();
+    entry.x1 = rect.right();
+    entry.y0 = qBound(0.0, rect.top(), 1.0);
+    entry.y1 = qBound(0.0, rect.bottom(), 1.0);
+
+    // the root spans two worlds, so that anything starting in the first
+    // fits however far it runs past the dateline
+    if (entry.x1 - entry.x0 >= 1.0) {
+        entry.x0 = 0.0;
+        entry.x1 = 2.0;
+    } else {
+        double shift = qFloor(entry.x0);
+        entry.x0 -= shift;
+        entry.x1 -= shift;
+    }
+
+    int node = 0;
+    double bx0 = 0.0, by0 = 0.0, bx1 = 2.0, by1 = 1.0;
+    for (int depth = 0; depth < MaximumDepth; ++depth) {
+        double mx = 0.5 * (bx0 + bx1);
+        double my = 0.5 * (by0 + by1);
+        int quadrant;
+        if (entry.x1 <= mx)
+            quadrant = 0;
+        else if (entry.x0 >= mx)
+            quadrant = 1;
+        else
+            break;
+        if (entry.y1 <= my)
+            by1 = my;
+        else if (entry.y0 >= my)
+            quadrant += 2;
+        else
+            break;
+        if (quadrant & 1)
+            bx0 = mx;
+        else
+            bx1 = mx;
+        if (quadrant & 2)
+            by0 = my;
+
+        int child = nodes_.at(node).children[quadrant];
+        if (child < 0) {
+            child = nodes_.size();
+            nodes_.append(Node());
+            nodes_[node].children[quadrant] = child;
+        }
+        node = child;
+    }
+
+    Location location;
+    location.node = node;
+    location.entry = nodes_.at(node).entries.size();
+    nodes_[node].entries.append(entry);
+    locations_.insert(value, location);
+}
+
+/*
+    Removes \a value from the index. Returns false if it was not there.
+*/
+template <class T>
+bool QGeoSpatialIndex<T>::remove(const T &value)
+{
+    typename QHash<T, Location>::iterator it = locations_.find(value);
+    if (it == locations_.end())
+        return false;
+
+    Location location = it.value();
+    locations_.erase(it);
+
+    QVector<Entry> &entries = nodes_[location.node].entries;
+    int last = entries.size() - 1;
+    if (location.entry != last) {
+        entries[location.entry] = entries.at(last);
+        locations_[entries.at(location.entry).value].entry = location.entry;
+    }
+    entries.resize(last);
+    return true;
+}
+
+template <class T>
+void QGeoSpatialIndex<T>::clear()
+{
+    nodes_.clear();
+    nodes_.append(Node());
+    locations_.clear();
+}
+
+template <class T>
+bool QGeoSpatialIndex<T>::contains(const T &value) const
+{
+    return locations_.contains(value);
+}
+
+template <class T>
+QRectF QGeoSpatialIndex<T>::rect(const T &value) const
+{
+    typename QHash<T, Location>::const_iterator it = locations_.find(value);
+    if (it == locations_.end())
+        return QRectF();
+    const Entry &entry = nodes_.at(it.value().node).entries.at(it.value().entry);
+    return QRectF(QPointF(entry.x0, entry.y0), QPointF(entry.x1, entry.y1));
+}
+
+template <class T>
+int QGeoSpatialIndex<T>::size() const
+{
+    return locations_.size();
+}
+
+template <class T>
+bool QGeoSpatialIndex<T>::isEmpty() const
+{
+    return locations_.isEmpty();
+}
+
+/*
+    Adds the values whose rectangles overlap \a rect to \a result. Touching
+    edges count as overlapping, so points and lines are found as well.
+*/
+template <class T>
+void QGeoSpatialIndex<T>::intersecting(const QRectF &rect, QSet<T> *result) const
+{
+    if (rect.width() >= 1.0) {
+        query(0.0, rect.top(), 2.0, rect.bottom(), result);
+        return;
+    }
+
+    double shift = qFloor(rect.left());
+    double x0 = rect.left() - shift;
+    double x1 = rect.right() - shift;
+
+    // values are stored starting in [0, 1) and end before 2
+    query(x0, rect.top(), x1, rect.bottom(), result);
+    query(x0 + 1.0, rect.top(), x1 + 1.0, rect.bottom(), result);
+    if (x1 > 1.0)
+        query(x0 - 1.0, rect.top(), x1 - 1.0, rect.bottom(), result);
+}
+
+template <class T>
+QSet<T> QGeoSpatialIndex<T>::intersecting(const QRectF &rect) const
+{
+    QSet<T> result;
+    intersecting(rect, &result);
+    return result;
+}
+
+template <class T>
+void QGeoSpatialIndex<T>::query(double x0, double y0, double x1, double y1, QSet<T> *result) const
+{
+    struct Box
+    {
+        int node;
+        double x0, y0, x1, y1;
+    };
+
+    QVarLengthArray<Box, 4 * MaximumDepth> stack;
+    Box root = { 0, 0.0, 0.0, 2.0, 1.0 };
+    stack.append(root);
+
+    while (!stack.isEmpty()) {
+        Box box = stack.last();
+        stack.removeLast();
+
+        const Node &node = nodes_.at(box.node);
+        const Entry *entries = node.entries.constData();
+        for (int i = 0; i < node.entries.size(); ++i) {
+            const Entry &e = entries[i];
+            if (e.x0 <= x1 && x0 <= e.x1 && e.y0 <= y1 && y0 <= e.y1)
+                result->insert(e.value);
+        }
+
+        double mx = 0.5 * (box.x0 + box.x1);
+        double my = 0.5 * (box.y0 + box.y1);
+        for (int quadrant = 0; quadrant < 4; ++quadrant) {
+            if (node.children[quadrant] < 0)
+                continue;
+            Box child = { node.children[quadrant],
+                          (quadrant & 1) ? mx : box.x0,
+                          (quadrant & 2) ? my : box.y0,
+                          (quadrant & 1) ? box.x1 : mx,
+                          (quadrant & 2) ? box.y1 : my };
+            if (child.x0 <= x1 && x0 <= child.x1 && child.y0 <= y1 && y0 <= child.y1)
+                stack.append(child);
+        }
+    }
+}
+
+QT_END_NAMESPACE
+
+#endif // QGEOSPATIALINDEX_P_H
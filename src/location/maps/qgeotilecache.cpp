@@ -41,12 +41,18 @@
 #include "qgeotilecache_p.h"
 
 #include "qgeotilespec_p.h"
+#include "qgeotilekey_p.h"
+#include "qgeotilepackstore_p.h"
 
 #include "qgeomappingmanager_p.h"
 
 #include <QDir>
 #include <QMetaType>
-#include <QPixmap>
+#include <QImage>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QThread>
 #include <QDebug>
 
 #include <Qt3D/qgltexture2d.h>
@@ -55,8 +61,33 @@ Q_DECLARE_METATYPE(QList<QGeoTileSpec>)
 Q_DECLARE_METATYPE(QSet<QGeoTileSpec>)
 
 QT_BEGIN_NAMESPACE
-QMutex QGeoTileCache::cleanupMutex_;
-QList<QGLTexture2D*> QGeoTileCache::cleanupList_;
+
+namespace {
+
+// the texture of an evicted tile, waiting to be deleted in a GL context
+struct QGeoTileTextureCleanup
+{
+    QGLTexture2D *texture;
+    QGeoTileTextureCleanup *next;
+};
+
+}
+
+// Tiles are evicted on whichever thread drops the last reference to them,
+// their textures are deleted by the next render thread which calls
+// GLContextAvailable(). As with QGeoTileRequestQueue this stack is pushed
+// to with a compare-and-swap and only ever emptied as a whole, so evicting
+// a tile never waits for a render thread.
+static QBasicAtomicPointer<QGeoTileTextureCleanup> textureCleanup = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+static void pushTextureCleanup(QGeoTileTextureCleanup *first, QGeoTileTextureCleanup *last)
+{
+    QGeoTileTextureCleanup *head;
+    do {
+        head = textureCleanup.loadAcquire();
+        last->next = head;
+    } while (!textureCleanup.testAndSetRelease(head, first));
+}
 
 class QGeoCachedTileMemory
 {
@@ -71,20 +102,231 @@ public:
     QGeoTileCache *cache;
     QByteArray bytes;
     QString format;
+    bool compressed;    // bytes went through qCompress()
 };
 
+/* Decoded tiles, so that a texture cache miss doesn't have to decode again */
+class QGeoCachedTileImage
+{
+public:
+    QGeoTileSpec spec;
+    QImage image;
+};
+
+/* Reads (if needed) and decodes a single tile on the decode pool. Only the
+ * encoded bytes, the files to try or the pack store are handed over, the
+ * cache queues themselves are never touched from the worker thread. */
+class QGeoTileDecodeTask : public QRunnable
+{
+public:
+    QGeoTileDecodeTask(QGeoTileCache *cache, const QGeoTileSpec &spec)
+        : cache(cache), spec(spec), compressed(false), packStore(0) {}
+
+    void run();
+
+    QGeoTileCache *cache;
+    QGeoTileSpec spec;
+    QString format;
+
+    // exactly one of these is the source of the tile
+    QByteArray bytes;
+    bool compressed;
+    QStringList filenames;  // the first one that exists is read
+    QGeoTilePackStore *packStore;
+};
+
+void QGeoTileDecodeTask::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    bool fromDisk = false;
+    QString filename;
+    qint64 readTime = -1;
+    if (packStore) {
+        bytes = packStore->read(spec);
+        fromDisk = true;
+    } else if (!filenames.isEmpty()) {
+        for (int i = 0; i < filenames.size() && filename.isEmpty(); ++i) {
+            QFile file(filenames.at(i));
+            if (file.open(QIODevice::ReadOnly)) {
+                filename = filenames.at(i);
+                bytes = file.readAll();
+            }
+        }
+        if (format.isEmpty())
+            format = QFileInfo(filename).suffix();
+        fromDisk = true;
+    } else if (compressed) {
+        bytes = qUncompress(bytes);
+    }
+    if (fromDisk) {
+        readTime = timer.nsecsElapsed() / 1000;
+        timer.restart();
+    }
+
+    QImage image;
+    if (!bytes.isEmpty()) {
+        QByteArray formatName = format.toLatin1();
+        image.loadFromData(bytes, formatName.isEmpty() ? 0 : formatName.constData());
+    }
+    qint64 decodeTime = timer.nsecsElapsed() / 1000;
+
+    QMetaObject::invokeMethod(cache, "decodeFinished", Qt::QueuedConnection,
+                              Q_ARG(QGeoTileSpec, spec),
+                              Q_ARG(QImage, image),
+                              Q_ARG(QByteArray, bytes),
+                              Q_ARG(QString, format),
+                              Q_ARG(QString, filename),
+                              Q_ARG(bool, fromDisk),
+                              Q_ARG(qint64, readTime),
+                              Q_ARG(qint64, decodeTime));
+}
+
+/* Builds the index of a file storage disk cache on the index pool: lists the
+ * directory, reads the queue files and stats the tiles, then hands the result
+ * to the cache's thread in chunks through indexChunkReady(). */
+class QGeoTileIndexLoader : public QRunnable
+{
+public:
+    struct Item
+    {
+        QGeoTileSpec spec;
+        QString filename;
+        int cost;
+    };
+
+    struct Chunk
+    {
+        int queue;  // 1-3, or 0 for tiles which are not on any queue
+        QList<Item> items;
+    };
+
+    QGeoTileIndexLoader(QGeoTileCache *cache, const QString &directory)
+        : cache_(cache), directory_(directory), cancelled_(0), finished_(false)
+    {
+        setAutoDelete(false);
+    }
+
+    void run();
+
+    void cancel() { cancelled_.store(1); }
+    bool isFinished() const
+    {
+        QMutexLocker ml(&mutex_);
+        return finished_ && chunks_.isEmpty();
+    }
+    bool takeChunk(Chunk *chunk)
+    {
+        QMutexLocker ml(&mutex_);
+        if (chunks_.isEmpty())
+            return false;
+        *chunk = chunks_.takeFirst();
+        return true;
+    }
+
+private:
+    void post(Chunk *chunk, bool last = false);
+
+    static const int ChunkSize = 256;
+
+    QGeoTileCache *cache_;
+    QString directory_;
+    QAtomicInt cancelled_;
+
+    mutable QMutex mutex_;
+    QList<Chunk> chunks_;
+    bool finished_;
+};
+
+void QGeoTileIndexLoader::run()
+{
+    QDir dir(directory_);
+    QSet<QString> files = QSet<QString>::fromList(dir.entryList(QDir::Files));
+
+    // Method:
+    // 1. read each queue file then, if each file exists, hand the tiles over
+    // to be appended to the appropriate cache queue.
+    for (int i = 1; i <= 3 && !cancelled_.load(); ++i) {
+        files.remove(QString::fromLatin1("queue") + QString::number(i));
+
+        QFile file(dir.filePath(QString::fromLatin1("queue") + QString::number(i)));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        Chunk chunk;
+        chunk.queue = i;
+        while (!file.atEnd() && !cancelled_.load()) {
+            QByteArray line = file.readLine().trimmed();
+            QString filename = QString::fromLatin1(line.constData(), line.length());
+            if (!files.remove(filename))
+                continue;
+            QGeoTileSpec spec = QGeoTileCache::filenameToTileSpec(filename);
+            if (spec.zoom() == -1)
+                continue;
+
+            Item item;
+            item.spec = spec;
+            item.filename = dir.filePath(filename);
+            item.cost = QFileInfo(item.filename).size();
+            chunk.items.append(item);
+            if (chunk.items.size() == ChunkSize)
+                post(&chunk);
+        }
+        post(&chunk);
+    }
+    // queue4 held the ghosts, which have no files
+    files.remove(QLatin1String("queue4"));
+
+    // 2. remaining tiles that aren't registered in a queue get pushed into cache here
+    // this is a backup, in case the queue manifest files get deleted or out of sync due to
+    // the application not closing down properly
+    Chunk chunk;
+    chunk.queue = 0;
+    QSet<QString>::const_iterator it = files.constBegin();
+    for (; it != files.constEnd() && !cancelled_.load(); ++it) {
+        QGeoTileSpec spec = QGeoTileCache::filenameToTileSpec(*it);
+        if (spec.zoom() == -1)
+            continue;
+
+        Item item;
+        item.spec = spec;
+        item.filename = dir.filePath(*it);
+        item.cost = QFileInfo(item.filename).size();
+        chunk.items.append(item);
+        if (chunk.items.size() == ChunkSize)
+            post(&chunk);
+    }
+    post(&chunk, true);
+}
+
+void QGeoTileIndexLoader::post(Chunk *chunk, bool last)
+{
+    if (chunk->items.isEmpty() && !last)
+        return;
+
+    {
+        QMutexLocker ml(&mutex_);
+        chunks_.append(*chunk);
+        finished_ = last;
+    }
+    chunk->items.clear();
+
+    QMetaObject::invokeMethod(cache_, "indexChunkReady", Qt::QueuedConnection);
+}
+
 QGeoTileTexture::QGeoTileTexture()
     : texture(0),
       textureBound(false) {}
 
-void QCache3QTileEvictionPolicy::aboutToBeRemoved(const QGeoTileSpec &key, QSharedPointer<QGeoCachedTileDisk> obj)
+void QCache3QTileEvictionPolicy::aboutToBeRemoved(const QGeoTileKey &key, QSharedPointer<QGeoCachedTileDisk> obj)
 {
     Q_UNUSED(key);
     // set the cache pointer to zero so we can't call evictFromDiskCache
     obj->cache = 0;
 }
 
-void QCache3QTileEvictionPolicy::aboutToBeEvicted(const QGeoTileSpec &key, QSharedPointer<QGeoCachedTileDisk> obj)
+void QCache3QTileEvictionPolicy::aboutToBeEvicted(const QGeoTileKey &key, QSharedPointer<QGeoCachedTileDisk> obj)
 {
     Q_UNUSED(key);
     Q_UNUSED(obj);
@@ -102,10 +344,102 @@ QGeoTileTexture::~QGeoTileTexture()
     QGeoTileCache::evictFromTextureCache(this);
 }
 
+QGeoTileLatencyHistogram::QGeoTileLatencyHistogram()
+{
+    reset();
+}
+
+void QGeoTileLatencyHistogram::add(qint64 usecs)
+{
+    if (usecs < 0)
+        return;
+
+    int bucket = 0;
+    for (quint64 v = quint64(usecs) >> 1; v && bucket < BucketCount - 1; v >>= 1)
+        ++bucket;
+
+    ++buckets_[bucket];
+    ++count_;
+    total_ += usecs;
+    max_ = qMax(max_, usecs);
+}
+
+void QGeoTileLatencyHistogram::reset()
+{
+    for (int i = 0; i < BucketCount; ++i)
+        buckets_[i] = 0;
+    count_ = 0;
+    total_ = 0;
+    max_ = 0;
+}
+
+quint64 QGeoTileLatencyHistogram::count() const
+{
+    return count_;
+}
+
+qint64 QGeoTileLatencyHistogram::total() const
+{
+    return total_;
+}
+
+/* "buckets" holds the counts from the lowest bucket up to the highest one
+ * in use, the lower bound of bucket i being 2^i us (0 for the first). */
+QVariantMap QGeoTileLatencyHistogram::toVariantMap() const
+{
+    int used = BucketCount;
+    while (used > 0 && buckets_[used - 1] == 0)
+        --used;
+
+    QVariantList buckets;
+    for (int i = 0; i < used; ++i)
+        buckets << buckets_[i];
+
+    QVariantMap map;
+    map[QLatin1String("count")] = count_;
+    map[QLatin1String("total")] = total_;
+    map[QLatin1String("mean")] = count_ ? total_ / qint64(count_) : qint64(0);
+    map[QLatin1String("max")] = max_;
+    map[QLatin1String("buckets")] = buckets;
+    return map;
+}
+
 QGeoTileCache::QGeoTileCache(const QString &directory, QObject *parent)
-    : QObject(parent), directory_(directory),
-      minTextureUsage_(0), extraTextureUsage_(0)
+    : QObject(parent), directory_(directory), packStore_(0),
+      minTextureUsage_(0), extraTextureUsage_(0), memoryCompression_(false),
+      indexLoaded_(false), indexLoadTime_(-1), timeToFirstTile_(-1), traceFile_(0)
+{
+    init(QGeoTiledMappingManagerEngine::FileStorage);
+}
+
+QGeoTileCache::QGeoTileCache(const QString &directory,
+                             QGeoTiledMappingManagerEngine::DiskCacheStorage storage,
+                             QObject *parent)
+    : QObject(parent), directory_(directory), packStore_(0),
+      minTextureUsage_(0), extraTextureUsage_(0), memoryCompression_(false),
+      indexLoaded_(false), indexLoadTime_(-1), timeToFirstTile_(-1), traceFile_(0)
 {
+    init(storage);
+}
+
+void QGeoTileCache::init(QGeoTiledMappingManagerEngine::DiskCacheStorage storage)
+{
+    startTime_.start();
+    connect(&statsTimer_, SIGNAL(timeout()), this, SLOT(emitStats()));
+
+    QString tracePath = QString::fromLocal8Bit(qgetenv("QT_LOCATION_TILE_TRACE"));
+    if (!tracePath.isEmpty()) {
+        traceFile_ = new QFile(tracePath, this);
+        if (!traceFile_->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+            qWarning() << "Unable to open tile trace file" << tracePath;
+            delete traceFile_;
+            traceFile_ = 0;
+        } else {
+            connect(&traceTimer_, SIGNAL(timeout()), this, SLOT(flushTrace()));
+            traceTimer_.start(1000);
+        }
+    }
+
     qRegisterMetaType<QGeoTileSpec>();
     qRegisterMetaType<QList<QGeoTileSpec> >();
     qRegisterMetaType<QSet<QGeoTileSpec> >();
@@ -125,66 +459,129 @@ QGeoTileCache::QGeoTileCache(const QString &directory, QObject *parent)
     // default values
     setMaxDiskUsage(20 * 1024 * 1024);
     setMaxMemoryUsage(3 * 1024 * 1024);
+    setMaxImageUsage(0);
     setExtraTextureUsage(6 * 1024 * 1024);
 
-    loadTiles();
+    // leave a core for the GUI / render threads
+    decodePool_.setMaxThreadCount(qBound(1, QThread::idealThreadCount() - 1, 4));
+
+    if (storage == QGeoTiledMappingManagerEngine::PackStorage) {
+        packStore_ = new QGeoTilePackStore(directory_, this);
+        if (!packStore_->open()) {
+            delete packStore_;
+            packStore_ = 0;
+        }
+    }
+
+    if (packStore_) {
+        // the pack index is a single sequential read, no need to defer it
+        loadPackedTiles();
+        indexLoaded_ = true;
+        indexLoadTime_ = startTime_.elapsed();
+        return;
+    }
+
+    probeFormats_ << QLatin1String("png") << QLatin1String("jpg");
+
+    indexPool_.setMaxThreadCount(1);
+    indexLoader_ = QSharedPointer<QGeoTileIndexLoader>(new QGeoTileIndexLoader(this, directory_));
+    indexPool_.start(indexLoader_.data());
 }
 
-void QGeoTileCache::loadTiles()
+void QGeoTileCache::indexChunkReady()
 {
-    QStringList formats;
-    formats << QLatin1String("*.*");
-
-    QDir dir(directory_);
-    QStringList files = dir.entryList(formats, QDir::Files);
+    if (!indexLoader_)
+        return;
+
+    QGeoTileIndexLoader::Chunk chunk;
+    if (!indexLoader_->takeChunk(&chunk))
+        return;
+
+    // tiles inserted or probed in the meantime are already where they belong
+    QList<QSharedPointer<QGeoCachedTileDisk> > values;
+    QList<QGeoTileKey> keys;
+    QList<int> costs;
+    for (int i = 0; i < chunk.items.size(); ++i) {
+        const QGeoTileIndexLoader::Item &item = chunk.items.at(i);
+        QGeoTileKey key = item.spec.key();
+        if (diskCache_.contains(key))
+            continue;
 
-    // Method:
-    // 1. read each queue file then, if each file exists, deserialize the data into the appropriate
-    // cache queue.
-    for (int i = 1; i<=4; i++) {
-        QString filename = dir.filePath(QString::fromLatin1("queue") + QString::number(i));
-        QFile file(filename);
-        if (!file.open(QIODevice::ReadOnly))
+        if (chunk.queue == 0) {
+            addToDiskCache(item.spec, item.filename, QString(), item.cost);
             continue;
-        QList<QSharedPointer<QGeoCachedTileDisk> > queue;
-        QList<QGeoTileSpec> specs;
-        QList<int> costs;
-        while (!file.atEnd()) {
-            QByteArray line = file.readLine().trimmed();
-            QString filename = QString::fromLatin1(line.constData(), line.length());
-            if (dir.exists(filename)){
-                files.removeOne(filename);
-                QGeoTileSpec spec = filenameToTileSpec(filename);
-                if (spec.zoom() == -1)
-                    continue;
-                QSharedPointer<QGeoCachedTileDisk> tileDisk(new QGeoCachedTileDisk);
-                tileDisk->filename = dir.filePath(filename);
-                tileDisk->cache = this;
-                tileDisk->spec = spec;
-                QFileInfo fi(tileDisk->filename);
-                specs.append(spec);
-                queue.append(tileDisk);
-                costs.append(fi.size());
-            }
         }
 
-        diskCache_.deserializeQueue(i, specs, queue, costs);
-        file.close();
+        QSharedPointer<QGeoCachedTileDisk> tileDisk(new QGeoCachedTileDisk);
+        tileDisk->filename = item.filename;
+        tileDisk->cache = this;
+        tileDisk->spec = item.spec;
+        keys.append(key);
+        values.append(tileDisk);
+        costs.append(item.cost);
+    }
+    if (chunk.queue != 0)
+        diskCache_.deserializeQueue(chunk.queue, keys, values, costs);
+
+    if (indexLoader_->isFinished()) {
+        indexLoader_.clear();
+        indexLoaded_ = true;
+        indexLoadTime_ = startTime_.elapsed();
+        emit indexLoaded();
     }
+}
 
-    // 2. remaining tiles that aren't registered in a queue get pushed into cache here
-    // this is a backup, in case the queue manifest files get deleted or out of sync due to
-    // the application not closing down properly
-    for (int i = 0; i < files.size(); ++i) {
-        QGeoTileSpec spec = filenameToTileSpec(files.at(i));
-        if (spec.zoom() == -1)
-            continue;
-        QString filename = dir.filePath(files.at(i));
-        addToDiskCache(spec, filename);
+void QGeoTileCache::loadPackedTiles()
+{
+    // the index lists the tiles queue by queue, front to back
+    QList<QGeoTilePackStore::Entry> entries = packStore_->entries();
+
+    QList<QSharedPointer<QGeoCachedTileDisk> > queues[4];
+    QList<QGeoTileKey> keys[4];
+    QList<int> costs[4];
+
+    for (int i = 0; i < entries.size(); ++i) {
+        const QGeoTilePackStore::Entry &entry = entries.at(i);
+        QSharedPointer<QGeoCachedTileDisk> tileDisk(new QGeoCachedTileDisk);
+        tileDisk->spec = entry.spec;
+        tileDisk->format = entry.format;
+        tileDisk->cache = this;
+
+        int queue = qBound(0, entry.queue, 3);
+        queues[queue].append(tileDisk);
+        keys[queue].append(entry.spec.key());
+        costs[queue].append(entry.size);
     }
+
+    for (int i = 1; i <= 3; ++i)
+        diskCache_.deserializeQueue(i, keys[i], queues[i], costs[i]);
+
+    // tiles added after the queues were last saved
+    for (int i = 0; i < queues[0].size(); ++i)
+        diskCache_.insert(keys[0].at(i), queues[0].at(i), costs[0].at(i));
 }
 
 QGeoTileCache::~QGeoTileCache()
+{
+    // any decodes still running post their results to this object, which the
+    // event loop discards once it is gone
+    decodePool_.waitForDone();
+
+    if (indexLoader_) {
+        indexLoader_->cancel();
+        indexPool_.waitForDone();
+    }
+
+    if (packStore_)
+        savePackedTiles();
+    else if (indexLoaded_)
+        saveTiles();
+    // else the queues only hold part of the tiles, keep the old queue files
+
+    flushTrace();
+}
+
+void QGeoTileCache::saveTiles()
 {
     // write disk cache queues to disk
     QDir dir(directory_);
@@ -199,6 +596,9 @@ QGeoTileCache::~QGeoTileCache()
         diskCache_.serializeQueue(i, queue);
         int queueLength = queue.size();
         for (int j = 0; j<queueLength; j++) {
+            // ghosts have no tile (and no file) left
+            if (!queue[j])
+                continue;
             // we just want the filename here, not the full path
             int index = queue[j]->filename.lastIndexOf(QLatin1Char('/'));
             QByteArray filename = queue[j]->filename.mid(index + 1).toLatin1() + '\n';
@@ -208,9 +608,132 @@ QGeoTileCache::~QGeoTileCache()
     }
 }
 
+void QGeoTileCache::savePackedTiles()
+{
+    QList<QList<QGeoTileSpec> > queues;
+    for (int i = 1; i <= 3; ++i) {
+        QList<QSharedPointer<QGeoCachedTileDisk> > queue;
+        diskCache_.serializeQueue(i, queue);
+
+        QList<QGeoTileSpec> specs;
+        for (int j = 0; j < queue.size(); ++j)
+            specs.append(queue.at(j)->spec);
+        queues.append(specs);
+    }
+
+    if (!packStore_->writeIndex(queues))
+        qWarning() << "Unable to write tile cache index in" << directory_;
+}
+
+static QVariantMap tierStats(const QCache3QStats &s)
+{
+    QVariantMap map;
+    map[QLatin1String("hits")] = s.hits;
+    map[QLatin1String("misses")] = s.misses;
+    map[QLatin1String("ghostHits")] = s.ghostHits;
+    map[QLatin1String("promotions")] = s.promotions;
+    map[QLatin1String("evictions")] = s.evictions;
+    map[QLatin1String("bytesIn")] = s.costIn;
+    map[QLatin1String("bytesOut")] = s.costOut;
+    map[QLatin1String("count")] = s.count;
+    map[QLatin1String("bytes")] = s.cost;
+    map[QLatin1String("maxBytes")] = s.maxCost;
+    map[QLatin1String("newbies")] = s.newbies;
+    map[QLatin1String("regulars")] = s.regulars;
+    map[QLatin1String("hobos")] = s.hobos;
+    map[QLatin1String("ghosts")] = s.ghosts;
+    map[QLatin1String("minRecent")] = s.minRecent;
+    map[QLatin1String("maxOldPopular")] = s.maxOldPopular;
+    return map;
+}
+
+/*
+    Returns a snapshot of the cache counters, for telemetry and for tuning
+    the disk, memory, image and texture budgets:
+
+    \list
+    \li "disk", "memory", "image" and "texture" each map to the counters of
+        that tier: hits, misses, ghostHits (lookups of tiles evicted not long
+        ago), promotions, evictions, bytesIn, bytesOut, and the current
+        count, bytes, maxBytes, queue sizes and the minRecent and
+        maxOldPopular queue limits.
+    \li "decodeTime" and "diskReadTime" are latency histograms in
+        microseconds (count, total, mean, max and log2 buckets).
+    \li "indexLoadTime" and "timeToFirstTile" are in milliseconds, see
+        indexLoadTime() and timeToFirstTile().
+    \endlist
+
+    Counters run from construction or the last resetStats().
+*/
+QVariantMap QGeoTileCache::stats() const
+{
+    QVariantMap map;
+    map[QLatin1String("disk")] = tierStats(diskCache_.stats());
+    map[QLatin1String("memory")] = tierStats(memoryCache_.stats());
+    map[QLatin1String("image")] = tierStats(imageCache_.stats());
+    map[QLatin1String("texture")] = tierStats(textureCache_.stats());
+    map[QLatin1String("decodeTime")] = decodeTime_.toVariantMap();
+    map[QLatin1String("diskReadTime")] = diskReadTime_.toVariantMap();
+    map[QLatin1String("indexLoadTime")] = indexLoadTime_;
+    map[QLatin1String("timeToFirstTile")] = timeToFirstTile_;
+    return map;
+}
+
+void QGeoTileCache::resetStats()
+{
+    diskCache_.resetStats();
+    memoryCache_.resetStats();
+    imageCache_.resetStats();
+    textureCache_.resetStats();
+    decodeTime_.reset();
+    diskReadTime_.reset();
+}
+
+/*
+    Emits statsUpdated() every \a msecs milliseconds, or never if \a msecs
+    is 0 (the default).
+*/
+void QGeoTileCache::setStatsInterval(int msecs)
+{
+    if (msecs > 0)
+        statsTimer_.start(msecs);
+    else
+        statsTimer_.stop();
+}
+
+int QGeoTileCache::statsInterval() const
+{
+    return statsTimer_.isActive() ? statsTimer_.interval() : 0;
+}
+
+void QGeoTileCache::emitStats()
+{
+    emit statsUpdated(stats());
+}
+
+void QGeoTileCache::flushTrace()
+{
+    if (!traceFile_ || traceBuffer_.isEmpty())
+        return;
+
+    QByteArray lines;
+    lines.reserve(traceBuffer_.size() * 24);
+    for (int i = 0; i < traceBuffer_.size(); ++i) {
+        const QGeoTileKey &key = traceBuffer_.at(i);
+        lines += QByteArray::number(key.mapId()) + ' ' + QByteArray::number(key.zoom()) + ' '
+                + QByteArray::number(key.x()) + ' ' + QByteArray::number(key.y()) + '\n';
+    }
+    traceBuffer_.clear();
+
+    traceFile_->write(lines);
+    traceFile_->flush();
+}
+
 void QGeoTileCache::printStats()
 {
+    qDebug("index load: %lld ms, first tile: %lld ms", indexLoadTime_, timeToFirstTile_);
     textureCache_.printStats();
+    imageCache_.printStats();
     memoryCache_.printStats();
     diskCache_.printStats();
 }
@@ -230,6 +753,12 @@ int QGeoTileCache::diskUsage() const
     return diskCache_.totalCost();
 }
 
+QGeoTiledMappingManagerEngine::DiskCacheStorage QGeoTileCache::diskStorage() const
+{
+    return packStore_ ? QGeoTiledMappingManagerEngine::PackStorage
+                      : QGeoTiledMappingManagerEngine::FileStorage;
+}
+
 void QGeoTileCache::setMaxMemoryUsage(int memoryUsage)
 {
     memoryCache_.setMaxCost(memoryUsage);
@@ -245,6 +774,61 @@ int QGeoTileCache::memoryUsage() const
     return memoryCache_.totalCost();
 }
 
+/*
+    Enables compression of the tiles held in the memory cache. Tiles which
+    don't shrink by at least an eighth (most PNG and JPEG tiles) are kept as
+    they are, so this only pays off for plugins serving uncompressed formats.
+    Only affects tiles inserted afterwards.
+*/
+void QGeoTileCache::setMemoryCompression(bool enabled)
+{
+    memoryCompression_ = enabled;
+}
+
+bool QGeoTileCache::memoryCompression() const
+{
+    return memoryCompression_;
+}
+
+/*
+    Sets the budget, in bytes, of the tier holding decoded tile images
+    between the memory and the texture cache. With a budget of 0 (the
+    default) there is no such tier and every texture cache miss decodes
+    the tile again.
+*/
+void QGeoTileCache::setMaxImageUsage(int imageUsage)
+{
+    imageCache_.setMaxCost(qMax(0, imageUsage));
+}
+
+/*
+    Lets each tier tune the split between its newbie, regular and hobo
+    queues to the access pattern, instead of the fixed thirds and fifths.
+    See QCache3Q.
+*/
+void QGeoTileCache::setAdaptive(bool adaptive)
+{
+    diskCache_.setAdaptive(adaptive);
+    memoryCache_.setAdaptive(adaptive);
+    imageCache_.setAdaptive(adaptive);
+    textureCache_.setAdaptive(adaptive);
+}
+
+bool QGeoTileCache::isAdaptive() const
+{
+    return memoryCache_.isAdaptive();
+}
+
+int QGeoTileCache::maxImageUsage() const
+{
+    return imageCache_.maxCost();
+}
+
+int QGeoTileCache::imageUsage() const
+{
+    return imageCache_.totalCost();
+}
+
 void QGeoTileCache::setExtraTextureUsage(int textureUsage)
 {
     extraTextureUsage_ = textureUsage;
@@ -275,71 +859,351 @@ int QGeoTileCache::textureUsage() const
 
 void QGeoTileCache::GLContextAvailable()
 {
-    QMutexLocker ml(&cleanupMutex_);
+    QGeoTileTextureCleanup *node = textureCleanup.fetchAndStoreAcquire(0);
 
     /* Throttle the cleanup to 10 items/frame to avoid blocking the render
      * for too long. Normally only 6-20 tiles are on screen at a time so
      * eviction rates shouldn't be much higher than this. */
-    int todo = qMin(cleanupList_.size(), 10);
-    for (int i = 0; i < todo; ++i) {
-        QGLTexture2D *texture = cleanupList_.front();
-        if (texture) {
-            texture->release();
-            texture->cleanupResources();
-            delete texture;
-        }
-        cleanupList_.pop_front();
+    for (int i = 0; node && i < 10; ++i) {
+        node->texture->release();
+        node->texture->cleanupResources();
+        delete node->texture;
+
+        QGeoTileTextureCleanup *next = node->next;
+        delete node;
+        node = next;
+    }
+
+    // the rest waits for the next frame
+    if (node) {
+        QGeoTileTextureCleanup *last = node;
+        while (last->next)
+            last = last->next;
+        pushTextureCleanup(node, last);
     }
 }
 
-QSharedPointer<QGeoTileTexture> QGeoTileCache::get(const QGeoTileSpec &spec)
+QSharedPointer<QGeoTileTexture> QGeoTileCache::get(const QGeoTileSpec &spec, LoadMode mode)
 {
-    QSharedPointer<QGeoTileTexture> tt = textureCache_.object(spec);
-    if (tt)
+    QGeoTileKey key = spec.key();
+
+    if (traceFile_)
+        traceBuffer_.append(key);
+
+    QSharedPointer<QGeoTileTexture> tt = textureCache_.object(key);
+    if (tt) {
+        tileServed();
         return tt;
+    }
+
+    if (mode == NonBlockingLoad && pendingDecodes_.contains(key))
+        return QSharedPointer<QGeoTileTexture>();
+
+    // no decode needed, so this is done right away in either mode
+    if (imageCache_.maxCost() > 0) {
+        QSharedPointer<QGeoCachedTileImage> ti = imageCache_.object(key);
+        if (ti) {
+            tt = addToTextureCache(spec, ti->image);
+            if (tt) {
+                tileServed();
+                return tt;
+            }
+        }
+    }
 
-    QSharedPointer<QGeoCachedTileMemory> tm = memoryCache_.object(spec);
+    QSharedPointer<QGeoCachedTileMemory> tm = memoryCache_.object(key);
     if (tm) {
-        QPixmap pixmap;
-        if (!pixmap.loadFromData(tm->bytes)) {
+        if (mode == NonBlockingLoad) {
+            QGeoTileDecodeTask *task = new QGeoTileDecodeTask(this, spec);
+            task->format = tm->format;
+            task->bytes = tm->bytes;
+            task->compressed = tm->compressed;
+            queueDecode(task);
+            return QSharedPointer<QGeoTileTexture>();
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QImage image;
+        if (!image.loadFromData(tm->compressed ? qUncompress(tm->bytes) : tm->bytes)) {
             handleError(spec, QLatin1String("Problem with tile image"));
             return QSharedPointer<QGeoTileTexture>(0);
         }
-        QSharedPointer<QGeoTileTexture> tt = addToTextureCache(spec, pixmap);
-        if (tt)
+        decodeTime_.add(timer.nsecsElapsed() / 1000);
+        addToImageCache(spec, image);
+        QSharedPointer<QGeoTileTexture> tt = addToTextureCache(spec, image);
+        if (tt) {
+            tileServed();
             return tt;
+        }
     }
 
-    QSharedPointer<QGeoCachedTileDisk> td = diskCache_.object(spec);
-    if (td) {
+    QSharedPointer<QGeoCachedTileDisk> td = diskCache_.object(key);
+    if (!td && !indexLoaded_) {
+        if (mode == NonBlockingLoad) {
+            // the tile may be on disk without being indexed yet, let the
+            // decode thread look for it
+            QGeoTileDecodeTask *task = new QGeoTileDecodeTask(this, spec);
+            for (int i = 0; i < probeFormats_.size(); ++i)
+                task->filenames.append(tileSpecToFilename(spec, probeFormats_.at(i), directory_));
+            queueDecode(task);
+            return QSharedPointer<QGeoTileTexture>();
+        }
+        td = probeDiskCache(spec);
+    }
+    if (td && packStore_) {
+        if (mode == NonBlockingLoad) {
+            QGeoTileDecodeTask *task = new QGeoTileDecodeTask(this, spec);
+            task->format = td->format;
+            task->packStore = packStore_;
+            queueDecode(task);
+            return QSharedPointer<QGeoTileTexture>();
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QByteArray bytes = packStore_->read(spec);
+        diskReadTime_.add(timer.nsecsElapsed() / 1000);
+        if (bytes.isEmpty()) {
+            handleError(spec, QLatin1String("Tile missing from the disk cache"));
+            return QSharedPointer<QGeoTileTexture>(0);
+        }
+        addToMemoryCache(spec, bytes, td->format);
+
+        timer.restart();
+        QImage image;
+        QByteArray formatName = td->format.toLatin1();
+        if (!image.loadFromData(bytes, formatName.isEmpty() ? 0 : formatName.constData())) {
+            handleError(spec, QLatin1String("Problem with tile image"));
+            return QSharedPointer<QGeoTileTexture>(0);
+        }
+        decodeTime_.add(timer.nsecsElapsed() / 1000);
+        addToImageCache(spec, image);
+        tt = addToTextureCache(td->spec, image);
+        if (tt)
+            tileServed();
+        return tt;
+    } else if (td) {
         QStringList parts = td->filename.split('.');
+        QString format = (parts.size() == 2 ? parts.at(1) : QLatin1String(""));
+
+        if (mode == NonBlockingLoad) {
+            QGeoTileDecodeTask *task = new QGeoTileDecodeTask(this, spec);
+            task->format = format;
+            task->filenames.append(td->filename);
+            queueDecode(task);
+            return QSharedPointer<QGeoTileTexture>();
+        }
+
+        QElapsedTimer timer;
+        timer.start();
         QFile file(td->filename);
         file.open(QIODevice::ReadOnly);
         QByteArray bytes = file.readAll();
         file.close();
+        diskReadTime_.add(timer.nsecsElapsed() / 1000);
 
-        QPixmap pixmap;
-        const char *format = (parts.size() == 2 ? parts.at(1).toLocal8Bit().constData() : 0);
-        if (!pixmap.loadFromData(bytes, format)) {
+        timer.restart();
+        QImage image;
+        QByteArray formatName = format.toLatin1();
+        if (!image.loadFromData(bytes, formatName.isEmpty() ? 0 : formatName.constData())) {
             handleError(spec, QLatin1String("Problem with tile image"));
             return QSharedPointer<QGeoTileTexture>(0);
         }
+        decodeTime_.add(timer.nsecsElapsed() / 1000);
+
+        addToMemoryCache(spec, bytes, format);
+        addToImageCache(spec, image);
+        QSharedPointer<QGeoTileTexture> tt = addToTextureCache(td->spec, image);
+        if (tt) {
+            tileServed();
+            return tt;
+        }
+    }
 
-        addToMemoryCache(spec, bytes, (parts.size() == 2 ? parts.at(1) : QLatin1String("")));
-        QSharedPointer<QGeoTileTexture> tt = addToTextureCache(td->spec, pixmap);
+    return QSharedPointer<QGeoTileTexture>();
+}
+
+bool QGeoTileCache::isDecodePending(const QGeoTileSpec &spec) const
+{
+    return pendingDecodes_.contains(spec.key());
+}
+
+/*
+    Returns true if \a spec is in the disk cache. Neither reads nor decodes
+    the tile and doesn't count as a use of it. Until the index has loaded
+    only the tiles inserted or looked up since are known.
+*/
+bool QGeoTileCache::isInDiskCache(const QGeoTileSpec &spec) const
+{
+    return diskCache_.contains(spec.key());
+}
+
+/*
+    Returns the texture of the closest ancestor of \a spec, at most
+    \a maxLevels zoom levels up, that can be had without decoding anything:
+    one in the texture cache or, when it has a budget, the image cache.
+    Ancestors further down the tiers are skipped, so a miss is as cheap as a
+    few hash lookups. Returns a null pointer if there is no such ancestor.
+*/
+QSharedPointer<QGeoTileTexture> QGeoTileCache::bestAncestor(const QGeoTileSpec &spec, int maxLevels)
+{
+    int levels = qMin(maxLevels, spec.zoom());
+    for (int dz = 1; dz <= levels; ++dz) {
+        QGeoTileKey key(spec.pluginId(), spec.mapId(), spec.zoom() - dz,
+                        spec.x() >> dz, spec.y() >> dz);
+        QSharedPointer<QGeoTileTexture> tt = decodedTexture(key);
         if (tt)
             return tt;
     }
+    return QSharedPointer<QGeoTileTexture>();
+}
+
+/*
+    Returns the textures of those of the four children of \a spec that can
+    be had without decoding anything, see bestAncestor().
+*/
+QList<QSharedPointer<QGeoTileTexture> > QGeoTileCache::availableChildren(const QGeoTileSpec &spec)
+{
+    QList<QSharedPointer<QGeoTileTexture> > children;
+    for (int i = 0; i < 4; ++i) {
+        QGeoTileKey key(spec.pluginId(), spec.mapId(), spec.zoom() + 1,
+                        2 * spec.x() + (i & 1), 2 * spec.y() + (i >> 1));
+        QSharedPointer<QGeoTileTexture> tt = decodedTexture(key);
+        if (tt)
+            children.append(tt);
+    }
+    return children;
+}
+
+// The texture for key if it is cached or can be uploaded from a decoded
+// image. Lookups are guarded by contains() so misses don't skew the stats.
+QSharedPointer<QGeoTileTexture> QGeoTileCache::decodedTexture(const QGeoTileKey &key)
+{
+    if (textureCache_.contains(key))
+        return textureCache_.object(key);
+
+    if (imageCache_.maxCost() > 0 && imageCache_.contains(key)) {
+        QSharedPointer<QGeoCachedTileImage> ti = imageCache_.object(key);
+        return addToTextureCache(ti->spec, ti->image);
+    }
 
     return QSharedPointer<QGeoTileTexture>();
 }
 
+bool QGeoTileCache::isIndexLoaded() const
+{
+    return indexLoaded_;
+}
+
+/*
+    Returns the time in milliseconds it took to build the disk cache index,
+    or -1 if it is still loading.
+*/
+qint64 QGeoTileCache::indexLoadTime() const
+{
+    return indexLoadTime_;
+}
+
+/*
+    Returns the time in milliseconds from the construction of the cache until
+    the first tile texture was handed out, or -1 if there was none yet.
+*/
+qint64 QGeoTileCache::timeToFirstTile() const
+{
+    return timeToFirstTile_;
+}
+
+void QGeoTileCache::tileServed()
+{
+    if (timeToFirstTile_ < 0)
+        timeToFirstTile_ = startTime_.elapsed();
+}
+
+/* Looks for the tile's file directly while the index is still loading. The
+ * format is not part of the key, so every format seen so far is tried. */
+QSharedPointer<QGeoCachedTileDisk> QGeoTileCache::probeDiskCache(const QGeoTileSpec &spec)
+{
+    for (int i = 0; i < probeFormats_.size(); ++i) {
+        QString filename = tileSpecToFilename(spec, probeFormats_.at(i), directory_);
+        QFileInfo fi(filename);
+        if (fi.exists())
+            return addToDiskCache(spec, filename, QString(), fi.size());
+    }
+    return QSharedPointer<QGeoCachedTileDisk>();
+}
+
+void QGeoTileCache::queueDecode(QGeoTileDecodeTask *task)
+{
+    pendingDecodes_.insert(task->spec.key());
+    decodePool_.start(task);
+}
+
+void QGeoTileCache::decodeFinished(const QGeoTileSpec &spec, const QImage &image,
+                                   const QByteArray &bytes, const QString &format,
+                                   const QString &filename, bool fromDisk,
+                                   qint64 readTime, qint64 decodeTime)
+{
+    if (!pendingDecodes_.remove(spec.key()))
+        return;
+
+    diskReadTime_.add(readTime);
+    decodeTime_.add(decodeTime);
+
+    if (image.isNull()) {
+        // no bytes means the tile was not on disk after all
+        if (!bytes.isEmpty()) {
+            handleError(spec, QLatin1String("Problem with tile image"));
+            evictCorruptTile(spec, filename);
+        }
+        // the maps have been waiting for this decode instead of fetching
+        emit tileDecodeFailed(spec);
+        return;
+    }
+
+    if (fromDisk) {
+        // found by probing while the index was still loading
+        if (!filename.isEmpty() && !diskCache_.contains(spec.key()))
+            addToDiskCache(spec, filename, QString(), bytes.size());
+        addToMemoryCache(spec, bytes, format);
+    }
+
+    addToImageCache(spec, image);
+    if (addToTextureCache(spec, image))
+        emit tileDecoded(spec);
+}
+
+/* Drops a tile which could not be decoded from the memory and disk caches,
+ * together with its file or pack record, so it is fetched again. */
+void QGeoTileCache::evictCorruptTile(const QGeoTileSpec &spec, const QString &filename)
+{
+    QGeoTileKey key = spec.key();
+    memoryCache_.remove(key);
+
+    if (diskCache_.contains(key)) {
+        QSharedPointer<QGeoCachedTileDisk> td = diskCache_.object(key);
+        diskCache_.remove(key);
+        // a removal keeps the file, see QCache3QTileEvictionPolicy; this
+        // one is deleted with the last reference to td, like an eviction
+        td->cache = this;
+    } else if (!filename.isEmpty()) {
+        // found by probing, not in the index yet
+        QFile::remove(filename);
+    }
+}
+
 void QGeoTileCache::insert(const QGeoTileSpec &spec,
                            const QByteArray &bytes,
                            const QString &format,
                            QGeoTiledMappingManagerEngine::CacheAreas areas)
 {
-    if (areas & QGeoTiledMappingManagerEngine::DiskCache) {
+    if ((areas & QGeoTiledMappingManagerEngine::DiskCache) && packStore_) {
+        if (packStore_->insert(spec, bytes, format))
+            addToDiskCache(spec, QString(), format, bytes.size());
+    } else if (areas & QGeoTiledMappingManagerEngine::DiskCache) {
+        if (!indexLoaded_ && !probeFormats_.contains(format))
+            probeFormats_.append(format);
+
         QString filename = tileSpecToFilename(spec, format, directory_);
         QFile file(filename);
         file.open(QIODevice::WriteOnly);
@@ -360,7 +1224,10 @@ void QGeoTileCache::insert(const QGeoTileSpec &spec,
 
 void QGeoTileCache::evictFromDiskCache(QGeoCachedTileDisk *td)
 {
-    QFile::remove(td->filename);
+    if (td->cache && td->cache->packStore_)
+        td->cache->packStore_->remove(td->spec);
+    else
+        QFile::remove(td->filename);
 }
 
 void QGeoTileCache::evictFromMemoryCache(QGeoCachedTileMemory * /* tm  */)
@@ -369,20 +1236,29 @@ void QGeoTileCache::evictFromMemoryCache(QGeoCachedTileMemory * /* tm  */)
 
 void QGeoTileCache::evictFromTextureCache(QGeoTileTexture *tt)
 {
-    QMutexLocker ml(&cleanupMutex_);
-    cleanupList_ << tt->texture;
+    if (!tt->texture)
+        return;
+
+    QGeoTileTextureCleanup *node = new QGeoTileTextureCleanup;
+    node->texture = tt->texture;
+    pushTextureCleanup(node, node);
 }
 
-QSharedPointer<QGeoCachedTileDisk> QGeoTileCache::addToDiskCache(const QGeoTileSpec &spec, const QString &filename)
+QSharedPointer<QGeoCachedTileDisk> QGeoTileCache::addToDiskCache(const QGeoTileSpec &spec, const QString &filename,
+                                                                 const QString &format, int cost)
 {
     QSharedPointer<QGeoCachedTileDisk> td(new QGeoCachedTileDisk);
     td->spec = spec;
     td->filename = filename;
+    td->format = format;
     td->cache = this;
 
-    QFileInfo fi(filename);
-    int diskCost = fi.size();
-    diskCache_.insert(spec, td, diskCost);
+    int diskCost = cost;
+    if (diskCost < 0) {
+        QFileInfo fi(filename);
+        diskCost = fi.size();
+    }
+    diskCache_.insert(spec.key(), td, diskCost);
     return td;
 }
 
@@ -393,27 +1269,52 @@ QSharedPointer<QGeoCachedTileMemory> QGeoTileCache::addToMemoryCache(const QGeoT
     tm->cache = this;
     tm->bytes = bytes;
     tm->format = format;
+    tm->compressed = false;
+
+    // PNG and JPEG hardly shrink any further, only keep what pays off
+    if (memoryCompression_) {
+        QByteArray packed = qCompress(bytes, 1);
+        if (packed.size() < bytes.size() - bytes.size() / 8) {
+            tm->bytes = packed;
+            tm->compressed = true;
+        }
+    }
 
-    int cost = bytes.size();
-    memoryCache_.insert(spec, tm, cost);
+    int cost = tm->bytes.size();
+    memoryCache_.insert(spec.key(), tm, cost);
 
     return tm;
 }
 
-QSharedPointer<QGeoTileTexture> QGeoTileCache::addToTextureCache(const QGeoTileSpec &spec, const QPixmap &pixmap)
+QSharedPointer<QGeoCachedTileImage> QGeoTileCache::addToImageCache(const QGeoTileSpec &spec, const QImage &image)
+{
+    if (imageCache_.maxCost() <= 0)
+        return QSharedPointer<QGeoCachedTileImage>();
+
+    QSharedPointer<QGeoCachedTileImage> ti(new QGeoCachedTileImage);
+    ti->spec = spec;
+    ti->image = image;
+
+    int cost = image.byteCount();
+    imageCache_.insert(spec.key(), ti, cost);
+
+    return ti;
+}
+
+QSharedPointer<QGeoTileTexture> QGeoTileCache::addToTextureCache(const QGeoTileSpec &spec, const QImage &image)
 {
     QSharedPointer<QGeoTileTexture> tt(new QGeoTileTexture);
     tt->spec = spec;
     tt->texture = new QGLTexture2D();
-    tt->texture->setPixmap(pixmap);
+    tt->texture->setImage(image);
     tt->texture->setHorizontalWrap(QGL::ClampToEdge);
     tt->texture->setVerticalWrap(QGL::ClampToEdge);
 
     /* Do not bind/cleanImage on the texture here -- it needs to be done
      * in the render thread (by qgeomapscene) */
 
-    int textureCost = pixmap.width() * pixmap.height() * pixmap.depth() / 8;
-    textureCache_.insert(spec, tt, textureCost);
+    int textureCost = image.width() * image.height() * image.depth() / 8;
+    textureCache_.insert(spec.key(), tt, textureCost);
 
     return tt;
 }
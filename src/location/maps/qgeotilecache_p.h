@@ -60,20 +60,31 @@
 #include <QSet>
 #include <QMutex>
 #include <QTimer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include <QVariantMap>
 
 #include "qgeotilespec_p.h"
+#include "qgeotilekey_p.h"
 #include "qgeotiledmappingmanagerengine_p.h"
 
 QT_BEGIN_NAMESPACE
 
 class QGeoMappingManager;
+class QGeoTilePackStore;
+class QGeoTileDecodeTask;
+class QGeoTileIndexLoader;
 
 class QGeoTile;
 class QGeoCachedTileMemory;
+class QGeoCachedTileImage;
 class QGeoTileCache;
 class QGLTexture2D;
 
-class QPixmap;
+class QFile;
+class QImage;
 class QThread;
 
 /* This would be internal to qgeotilecache.cpp except that the eviction
@@ -104,28 +115,71 @@ public:
 
 /* Custom eviction policy for the disk cache, to avoid deleting all the files
  * when the application closes */
-class QCache3QTileEvictionPolicy : public QCache3QDefaultEvictionPolicy<QGeoTileSpec,QGeoCachedTileDisk>
+class QCache3QTileEvictionPolicy : public QCache3QDefaultEvictionPolicy<QGeoTileKey,QGeoCachedTileDisk>
 {
 protected:
-    void aboutToBeRemoved(const QGeoTileSpec &key, QSharedPointer<QGeoCachedTileDisk> obj);
-    void aboutToBeEvicted(const QGeoTileSpec &key, QSharedPointer<QGeoCachedTileDisk> obj);
+    void aboutToBeRemoved(const QGeoTileKey &key, QSharedPointer<QGeoCachedTileDisk> obj);
+    void aboutToBeEvicted(const QGeoTileKey &key, QSharedPointer<QGeoCachedTileDisk> obj);
+};
+
+/* Latency histogram with power of two buckets, in microseconds: bucket 0
+ * counts samples below 2us, bucket i samples in [2^i, 2^(i+1)) us and the
+ * last bucket everything from about 1s up. */
+class Q_LOCATION_EXPORT QGeoTileLatencyHistogram
+{
+public:
+    QGeoTileLatencyHistogram();
+
+    void add(qint64 usecs);
+    void reset();
+
+    quint64 count() const;
+    qint64 total() const;
+    QVariantMap toVariantMap() const;
+
+    static const int BucketCount = 21;
+
+private:
+    quint64 buckets_[BucketCount];
+    quint64 count_;
+    qint64 total_;
+    qint64 max_;
 };
 
 class Q_LOCATION_EXPORT QGeoTileCache : public QObject
 {
     Q_OBJECT
 public:
+    enum LoadMode {
+        BlockingLoad,
+        NonBlockingLoad
+    };
+
     QGeoTileCache(const QString &directory = QString(), QObject *parent = 0);
+    QGeoTileCache(const QString &directory,
+                  QGeoTiledMappingManagerEngine::DiskCacheStorage storage,
+                  QObject *parent = 0);
     ~QGeoTileCache();
 
     void setMaxDiskUsage(int diskUsage);
     int maxDiskUsage() const;
     int diskUsage() const;
+    QGeoTiledMappingManagerEngine::DiskCacheStorage diskStorage() const;
 
     void setMaxMemoryUsage(int memoryUsage);
     int maxMemoryUsage() const;
     int memoryUsage() const;
 
+    void setMemoryCompression(bool enabled);
+    bool memoryCompression() const;
+
+    void setMaxImageUsage(int imageUsage);
+    int maxImageUsage() const;
+    int imageUsage() const;
+
+    void setAdaptive(bool adaptive);
+    bool isAdaptive() const;
+
     void setMinTextureUsage(int textureUsage);
     void setExtraTextureUsage(int textureUsage);
     int maxTextureUsage() const;
@@ -134,7 +188,21 @@ public:
 
     void GLContextAvailable();
 
-    QSharedPointer<QGeoTileTexture> get(const QGeoTileSpec &spec);
+    QSharedPointer<QGeoTileTexture> get(const QGeoTileSpec &spec, LoadMode mode = BlockingLoad);
+    bool isDecodePending(const QGeoTileSpec &spec) const;
+    bool isInDiskCache(const QGeoTileSpec &spec) const;
+
+    QSharedPointer<QGeoTileTexture> bestAncestor(const QGeoTileSpec &spec, int maxLevels = 4);
+    QList<QSharedPointer<QGeoTileTexture> > availableChildren(const QGeoTileSpec &spec);
+
+    bool isIndexLoaded() const;
+    qint64 indexLoadTime() const;
+    qint64 timeToFirstTile() const;
+
+    QVariantMap stats() const;
+    void resetStats();
+    void setStatsInterval(int msecs);
+    int statsInterval() const;
 
     // can be called without a specific tileCache pointer
     static void evictFromDiskCache(QGeoCachedTileDisk *td);
@@ -150,26 +218,81 @@ public:
 public Q_SLOTS:
     void printStats();
 
+Q_SIGNALS:
+    void tileDecoded(const QGeoTileSpec &spec);
+    void tileDecodeFailed(const QGeoTileSpec &spec);
+    void indexLoaded();
+    void statsUpdated(const QVariantMap &stats);
+
+private Q_SLOTS:
+    void decodeFinished(const QGeoTileSpec &spec, const QImage &image,
+                        const QByteArray &bytes, const QString &format,
+                        const QString &filename, bool fromDisk,
+                        qint64 readTime, qint64 decodeTime);
+    void indexChunkReady();
+    void emitStats();
+    void flushTrace();
+
 private:
-    void loadTiles();
+    void init(QGeoTiledMappingManagerEngine::DiskCacheStorage storage);
+    void loadPackedTiles();
+    void saveTiles();
+    void savePackedTiles();
+    void queueDecode(QGeoTileDecodeTask *task);
+    void evictCorruptTile(const QGeoTileSpec &spec, const QString &filename);
+    QSharedPointer<QGeoCachedTileDisk> probeDiskCache(const QGeoTileSpec &spec);
+    QSharedPointer<QGeoTileTexture> decodedTexture(const QGeoTileKey &key);
+    void tileServed();
 
-    QSharedPointer<QGeoCachedTileDisk> addToDiskCache(const QGeoTileSpec &spec, const QString &filename);
+    QSharedPointer<QGeoCachedTileDisk> addToDiskCache(const QGeoTileSpec &spec, const QString &filename,
+                                                      const QString &format = QString(), int cost = -1);
     QSharedPointer<QGeoCachedTileMemory> addToMemoryCache(const QGeoTileSpec &spec, const QByteArray &bytes, const QString &format);
-    QSharedPointer<QGeoTileTexture> addToTextureCache(const QGeoTileSpec &spec, const QPixmap &pixmap);
+    QSharedPointer<QGeoCachedTileImage> addToImageCache(const QGeoTileSpec &spec, const QImage &image);
+    QSharedPointer<QGeoTileTexture> addToTextureCache(const QGeoTileSpec &spec, const QImage &image);
 
     static QString tileSpecToFilename(const QGeoTileSpec &spec, const QString &format, const QString &directory);
     static QGeoTileSpec filenameToTileSpec(const QString &filename);
 
     QString directory_;
-    QCache3Q<QGeoTileSpec, QGeoCachedTileDisk, QCache3QTileEvictionPolicy > diskCache_;
-    QCache3Q<QGeoTileSpec, QGeoCachedTileMemory > memoryCache_;
-    QCache3Q<QGeoTileSpec, QGeoTileTexture > textureCache_;
+    QCache3Q<QGeoTileKey, QGeoCachedTileDisk, QCache3QTileEvictionPolicy > diskCache_;
+    QGeoTilePackStore *packStore_;  // only set for PackStorage
+    QCache3Q<QGeoTileKey, QGeoCachedTileMemory > memoryCache_;
+    QCache3Q<QGeoTileKey, QGeoCachedTileImage > imageCache_;  // off unless given a budget
+    QCache3Q<QGeoTileKey, QGeoTileTexture > textureCache_;
 
     int minTextureUsage_;
     int extraTextureUsage_;
+    bool memoryCompression_;
+
+    // decodes for NonBlockingLoad requests run here, results come back
+    // to the cache's own thread through decodeFinished()
+    QThreadPool decodePool_;
+    QSet<QGeoTileKey> pendingDecodes_;
+
+    // the file storage index is read by indexLoader_ in the background and
+    // handed over in chunks; until it is done lookups probe the file system
+    QThreadPool indexPool_;
+    QSharedPointer<QGeoTileIndexLoader> indexLoader_;
+    bool indexLoaded_;
+    QStringList probeFormats_;
+
+    QElapsedTimer startTime_;
+    qint64 indexLoadTime_;
+    qint64 timeToFirstTile_;
+
+    // both in microseconds, see stats()
+    QGeoTileLatencyHistogram decodeTime_;
+    QGeoTileLatencyHistogram diskReadTime_;
+    QTimer statsTimer_;
+
+    // lookups are logged here for replaying them against QCache3Q, see
+    // tests/auto/qcache3q. get() only records the key, the lines are
+    // written out by traceTimer_
+    QFile *traceFile_;
+    QVector<QGeoTileKey> traceBuffer_;
+    QTimer traceTimer_;
 
-    static QMutex cleanupMutex_;
-    static QList<QGLTexture2D*> cleanupList_;
+    friend class QGeoTileIndexLoader;
 };
 
 QT_END_NAMESPACE
@@ -156,12 +156,31 @@ void QGeoTiledMapData::newTileFetched(const QGeoTileSpec &spec)
     d->newTileFetched(spec);
 }
 
+void QGeoTiledMapData::tileDecoded(const QGeoTileSpec &spec)
+{
+    Q_D(QGeoTiledMapData);
+    d->newTileFetched(spec);
+}
+
+void QGeoTiledMapData::tileDecodeFailed(const QGeoTileSpec &spec)
+{
+    Q_D(QGeoTiledMapData);
+    d->tileDecodeFailed(spec);
+}
+
 QGeoTileCache *QGeoTiledMapData::tileCache()
 {
     Q_D(QGeoTiledMapData);
     return d->tileCache();
 }
 
+QVariantMap QGeoTiledMapData::cacheStatistics() const
+{
+    Q_D(const QGeoTiledMapData);
+    QGeoTileCache *cache = const_cast<QGeoTiledMapDataPrivate *>(d)->tileCache();
+    return cache ? cache->stats() : QVariantMap();
+}
+
 void QGeoTiledMapData::paintGL(QGLPainter *painter)
 {
     Q_D(QGeoTiledMapData);
@@ -187,6 +206,29 @@ void QGeoTiledMapData::prefetchData()
     d->prefetchTiles();
 }
 
+void QGeoTiledMapData::prefetchPath(const QGeoCameraData &target)
+{
+    Q_D(QGeoTiledMapData);
+    d->prefetchPath(target);
+}
+
+/*
+    Sets the most tiles fetched ahead of a moving camera to \a tiles. They
+    are fetched after every visible tile, so a larger budget mostly costs
+    bandwidth. 0 turns fetching ahead off.
+*/
+void QGeoTiledMapData::setPathPrefetchBudget(int tiles)
+{
+    Q_D(QGeoTiledMapData);
+    d->pathPrefetchBudget_ = qMax(0, tiles);
+}
+
+int QGeoTiledMapData::pathPrefetchBudget() const
+{
+    Q_D(const QGeoTiledMapData);
+    return d->pathPrefetchBudget_;
+}
+
 void QGeoTiledMapData::changeActiveMapType(const QGeoMapType mapType)
 {
     Q_D(QGeoTiledMapData);
@@ -228,12 +270,20 @@ QPointF QGeoTiledMapData::coordinateToScreenPosition(const QGeoCoordinate &coord
     return pos;
 }
 
+void QGeoTiledMapData::coordinatesToScreenPositions(const double *latLon, double *screen, int count) const
+{
+    Q_D(const QGeoTiledMapData);
+    d->coordinatesToScreenPositions(latLon, screen, count);
+}
+
 QGeoTiledMapDataPrivate::QGeoTiledMapDataPrivate(QGeoTiledMapData *parent, QGeoTiledMappingManagerEngine *engine)
     : map_(parent),
       cache_(engine->tileCache()),
       engine_(engine),
       cameraTiles_(new QGeoCameraTiles()),
       mapScene_(new QGeoMapScene()),
+      prefetched_(false),
+      pathPrefetchBudget_(64),
       tileRequests_(new QGeoTileRequestManager(parent))
 {
     cameraTiles_->setMaximumZoomLevel(static_cast<int>(std::ceil(engine->cameraCapabilities().maximumZoomLevel())));
@@ -246,6 +296,15 @@ QGeoTiledMapDataPrivate::QGeoTiledMapDataPrivate(QGeoTiledMapData *parent, QGeoT
                      SIGNAL(newTilesVisible(const QSet<QGeoTileSpec>&)),
                      map_,
                      SLOT(evaluateCopyrights(const QSet<QGeoTileSpec>)));
+
+    QObject::connect(cache_,
+                     SIGNAL(tileDecoded(QGeoTileSpec)),
+                     map_,
+                     SLOT(tileDecoded(QGeoTileSpec)));
+    QObject::connect(cache_,
+                     SIGNAL(tileDecodeFailed(QGeoTileSpec)),
+                     map_,
+                     SLOT(tileDecodeFailed(QGeoTileSpec)));
 }
 
 QGeoTiledMapDataPrivate::~QGeoTiledMapDataPrivate()
@@ -273,11 +332,33 @@ QPointer<QGeoTiledMappingManagerEngine> QGeoTiledMapDataPrivate::engine() const
 void QGeoTiledMapDataPrivate::prefetchTiles()
 {
     cameraTiles_->findPrefetchTiles();
+    prefetched_ = true;
+
+    // the camera has arrived, whatever was fetched ahead for it is moot
+    if (engine_)
+        engine_.data()->prefetchTiles(map_, QList<QGeoTileSpec>());
 
     if (tileRequests_)
         tileRequests_->requestTiles(cameraTiles_->tiles() - mapScene_->texturedTiles());
 }
 
+void QGeoTiledMapDataPrivate::prefetchPath(const QGeoCameraData &target)
+{
+    if (!engine_)
+        return;
+
+    QList<QGeoTileSpec> tiles = cameraTiles_->tilesAlongPath(target, pathPrefetchBudget_);
+
+    // tiles on disk can be read quickly enough once they are needed
+    QList<QGeoTileSpec> wanted;
+    foreach (const QGeoTileSpec &tile, tiles) {
+        if (!cache_ || !cache_->isInDiskCache(tile))
+            wanted.append(tile);
+    }
+
+    engine_.data()->prefetchTiles(map_, wanted);
+}
+
 void QGeoTiledMapDataPrivate::changeCameraData(const QGeoCameraData &oldCameraData)
 {
     double lat = oldCameraData.center().latitude();
@@ -304,23 +385,85 @@ void QGeoTiledMapDataPrivate::changeCameraData(const QGeoCameraData &oldCameraDa
 
     cameraTiles_->setCamera(cam);
 
+    if (engine_ && cameraTiles_->tileSize() > 0) {
+        // radius of the screen in tiles of the integer zoom level, so the
+        // fetcher can send the tiles under the center of the view first
+        double w = map_->width();
+        double h = map_->height();
+        double scale = std::pow(2.0, cam.zoomLevel() - izl);
+        double radius = 0.5 * std::sqrt(w * w + h * h) / (scale * cameraTiles_->tileSize());
+        QDoubleVector2D center = QGeoProjection::coordToMercator(cam.center());
+        engine_.data()->updateTileRequestFocus(QPointF(center.x(), center.y()), izl, radius);
+    }
+
     mapScene_->setCameraData(cam);
-    mapScene_->setVisibleTiles(cameraTiles_->tiles());
+
+    // after a prefetch the tile delta is relative to the prefetched tiles,
+    // which the scene never saw, so fall back to the full sets once
+    bool full = prefetched_;
+    prefetched_ = false;
+
+    QSet<QGeoTileSpec> added = cameraTiles_->addedTiles();
+    QSet<QGeoTileSpec> removed = cameraTiles_->removedTiles();
+    cameraTiles_->clearTileDelta();
+
+    if (full)
+        mapScene_->setVisibleTiles(cameraTiles_->tiles());
+    else
+        mapScene_->updateVisibleTiles(cameraTiles_->tiles(), added, removed);
 
     if (tileRequests_) {
-        // don't request tiles that are already built and textured
-        QList<QSharedPointer<QGeoTileTexture> > cachedTiles =
-                tileRequests_->requestTiles(cameraTiles_->tiles() - mapScene_->texturedTiles());
+        // don't request tiles that are already built and textured, tiles
+        // just added to the view can't be textured yet
+        QSet<QGeoTileSpec> missing = full
+                ? cameraTiles_->tiles() - mapScene_->texturedTiles()
+                : added;
+        QList<QSharedPointer<QGeoTileTexture> > cachedTiles = full
+                ? tileRequests_->requestTiles(missing)
+                : tileRequests_->updateTiles(added, removed);
 
         foreach (const QSharedPointer<QGeoTileTexture> &tex, cachedTiles) {
             mapScene_->addTile(tex->spec, tex);
+            missing.remove(tex->spec);
         }
 
-        if (!cachedTiles.isEmpty())
+        bool fallbacks = addFallbacks(missing);
+
+        if (!cachedTiles.isEmpty() || fallbacks)
             map_->update();
     }
 }
 
+/*
+    Covers the visible \a tiles, which have no texture yet, with what the
+    cache holds of the neighbouring zoom levels: all four children if there
+    are, otherwise an ancestor, otherwise whichever children there are.
+    Nothing is decoded for this. Returns true if any tile was covered.
+*/
+bool QGeoTiledMapDataPrivate::addFallbacks(const QSet<QGeoTileSpec> &tiles)
+{
+    if (!cache_)
+        return false;
+
+    bool covered = false;
+    foreach (const QGeoTileSpec &tile, tiles) {
+        QList<QSharedPointer<QGeoTileTexture> > textures = cache_->availableChildren(tile);
+        if (textures.size() < 4) {
+            QSharedPointer<QGeoTileTexture> ancestor = cache_->bestAncestor(tile);
+            if (ancestor) {
+                textures.clear();
+                textures.append(ancestor);
+            }
+        }
+        if (textures.isEmpty())
+            continue;
+
+        mapScene_->addFallback(tile, textures);
+        covered = true;
+    }
+    return covered;
+}
+
 void QGeoTiledMapDataPrivate::changeActiveMapType(const QGeoMapType mapType)
 {
     cameraTiles_->setMapType(mapType);
@@ -362,6 +505,13 @@ void QGeoTiledMapDataPrivate::newTileFetched(const QGeoTileSpec &spec)
     }
 }
 
+void QGeoTiledMapDataPrivate::tileDecodeFailed(const QGeoTileSpec &spec)
+{
+    // the request manager left the tile to the cache, fetch it if still needed
+    if (cameraTiles_->tiles().contains(spec))
+        tileRequests_->tileDecodeFailed(spec);
+}
+
 QSet<QGeoTileSpec> QGeoTiledMapDataPrivate::visibleTiles()
 {
     return cameraTiles_->tiles();
@@ -383,4 +533,11 @@ QPointF QGeoTiledMapDataPrivate::coordinateToScreenPosition(const QGeoCoordinate
     return mapScene_->mercatorToScreenPosition(QGeoProjection::coordToMercator(coordinate));
 }
 
+void QGeoTiledMapDataPrivate::coordinatesToScreenPositions(const double *latLon, double *screen, int count) const
+{
+    // both steps work in place, so the mercator coordinates go through screen
+    QGeoProjection::coordinatesToMercator(latLon, screen, count);
+    mapScene_->mercatorToScreenPositions(screen, screen, count);
+}
+
 QT_END_NAMESPACE
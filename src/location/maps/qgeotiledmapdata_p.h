@@ -86,7 +86,12 @@ public:
 
     QGeoCoordinate screenPositionToCoordinate(const QPointF &pos, bool clipToViewport = true) const;
     QPointF coordinateToScreenPosition(const QGeoCoordinate &coordinate, bool clipToViewport = true) const;
+    void coordinatesToScreenPositions(const double *latLon, double *screen, int count) const;
     void prefetchTiles();
+    QVariantMap cacheStatistics() const;
+
+    void setPathPrefetchBudget(int tiles);
+    int pathPrefetchBudget() const;
 
     // Alternative to exposing this is to make tileFetched a slot, but then requestManager would
     // need to be a QObject
@@ -96,10 +101,15 @@ protected:
     void changeCameraData(const QGeoCameraData &oldCameraData);
     void changeActiveMapType(const QGeoMapType mapType);
     void prefetchData();
+    void prefetchPath(const QGeoCameraData &target);
 
 protected Q_SLOTS:
     virtual void evaluateCopyrights(const QSet<QGeoTileSpec> &visibleTiles);
 
+private Q_SLOTS:
+    void tileDecoded(const QGeoTileSpec &spec);
+    void tileDecodeFailed(const QGeoTileSpec &spec);
+
 private:
     QGeoTiledMapDataPrivate *d_ptr;
     Q_DECLARE_PRIVATE(QGeoTiledMapData)
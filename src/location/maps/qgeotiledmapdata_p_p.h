@@ -101,11 +101,15 @@ public:
 
     QGeoCoordinate screenPositionToCoordinate(const QPointF &pos) const;
     QPointF coordinateToScreenPosition(const QGeoCoordinate &coordinate) const;
+    void coordinatesToScreenPositions(const double *latLon, double *screen, int count) const;
 
     void newTileFetched(const QGeoTileSpec &spec);
+    void tileDecodeFailed(const QGeoTileSpec &spec);
+    bool addFallbacks(const QSet<QGeoTileSpec> &tiles);
     QSet<QGeoTileSpec> visibleTiles();
 
     void prefetchTiles();
+    void prefetchPath(const QGeoCameraData &target);
     QPointer<QGeoTiledMappingManagerEngine> engine() const;
 
 private:
@@ -115,6 +119,10 @@ private:
 
     QGeoCameraTiles *cameraTiles_;
     QGeoMapScene *mapScene_;
+    // the camera tiles hold prefetched tiles the scene has not seen
+    bool prefetched_;
+    // most tiles requested ahead of a moving camera
+    int pathPrefetchBudget_;
     Q_DISABLE_COPY(QGeoTiledMapDataPrivate)
 public:
     QGeoTileRequestManager *tileRequests_;
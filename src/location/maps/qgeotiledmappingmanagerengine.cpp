@@ -48,12 +48,17 @@
 #include "qgeotilerequestmanager_p.h"
 #include "qgeotilecache_p.h"
 #include "qgeotilespec_p.h"
+#include "qgeocameratiles_p.h"
+#include "qgeoshape.h"
 
 #include <QTimer>
 #include <QLocale>
 
 QT_BEGIN_NAMESPACE
 
+// tiles waiting to be seeded, a few MB of tile specs
+static const int MaxSeedQueue = 65536;
+
 QGeoTiledMappingManagerEngine::QGeoTiledMappingManagerEngine(QObject *parent)
     : QGeoMappingManagerEngine(parent),
       d_ptr(new QGeoTiledMappingManagerEnginePrivate)
@@ -133,23 +138,22 @@ void QGeoTiledMappingManagerEngine::registerMap(QGeoTiledMapData *map)
 void QGeoTiledMappingManagerEngine::deregisterMap(QGeoTiledMapData *map)
 {
     d_ptr->tileMaps_.remove(map);
-    d_ptr->mapHash_.remove(map);
-
-    QHash<QGeoTileSpec, QSet<QGeoTiledMapData *> > newTileHash = d_ptr->tileHash_;
-    typedef QHash<QGeoTileSpec, QSet<QGeoTiledMapData *> >::const_iterator h_iter;
-    h_iter hi = d_ptr->tileHash_.constBegin();
-    h_iter hend = d_ptr->tileHash_.constEnd();
-    for (; hi != hend; ++hi) {
-        QSet<QGeoTiledMapData *> maps = hi.value();
-        if (maps.contains(map)) {
-            maps.remove(map);
-            if (maps.isEmpty())
-                newTileHash.remove(hi.key());
-            else
-                newTileHash.insert(hi.key(), maps);
-        }
+    prefetchTiles(map, QList<QGeoTileSpec>());
+
+    // only the tiles of this map refer to it
+    QSet<QGeoTileKey> tiles = d_ptr->mapHash_.take(map);
+
+    typedef QSet<QGeoTileKey>::const_iterator key_iter;
+    key_iter i = tiles.constBegin();
+    key_iter end = tiles.constEnd();
+    for (; i != end; ++i) {
+        QHash<QGeoTileKey, QSet<QGeoTiledMapData *> >::iterator maps = d_ptr->tileHash_.find(*i);
+        if (maps == d_ptr->tileHash_.end())
+            continue;
+        maps->remove(map);
+        if (maps->isEmpty())
+            d_ptr->tileHash_.erase(maps);
     }
-    d_ptr->tileHash_ = newTileHash;
 }
 
 void QGeoTiledMappingManagerEngine::updateTileRequests(QGeoTiledMapData *map,
@@ -159,114 +163,380 @@ void QGeoTiledMappingManagerEngine::updateTileRequests(QGeoTiledMapData *map,
     Q_D(QGeoTiledMappingManagerEngine);
 
     typedef QSet<QGeoTileSpec>::const_iterator tile_iter;
+    typedef QHash<QGeoTileKey, QSet<QGeoTiledMapData *> >::iterator hash_iter;
+
+    // the tile set of this map and the map sets of the tiles are all
+    // updated in place
 
-    // add and remove tiles from tileset for this map
+    QSet<QGeoTileKey> &mapTiles = d->mapHash_[map];
 
-    QSet<QGeoTileSpec> oldTiles = d->mapHash_.value(map);
+    QVector<QGeoTileKey> reqTiles;
+    QVector<QGeoTileKey> cancelTiles;
+    // tiles in cancelTiles which are asked for again in the same call
+    QSet<QGeoTileKey> restored;
 
     tile_iter rem = tilesRemoved.constBegin();
     tile_iter remEnd = tilesRemoved.constEnd();
     for (; rem != remEnd; ++rem) {
-        oldTiles.remove(*rem);
+        QGeoTileKey key = rem->key();
+        mapTiles.remove(key);
+
+        hash_iter maps = d->tileHash_.find(key);
+        if (maps == d->tileHash_.end())
+            continue;
+        maps->remove(map);
+        if (maps->isEmpty()) {
+            d->tileHash_.erase(maps);
+            // still wanted for seeding the disk cache or ahead of a camera
+            if (!d->seedPending_.contains(key) && !d->prefetchCount_.contains(key))
+                cancelTiles.append(key);
+        }
+    }
+
+    QSet<QGeoTileKey> canceled;
+    if (!cancelTiles.isEmpty() && !tilesAdded.isEmpty()) {
+        canceled.reserve(cancelTiles.size());
+        for (int i = 0; i < cancelTiles.size(); ++i)
+            canceled.insert(cancelTiles.at(i));
     }
 
     tile_iter add = tilesAdded.constBegin();
     tile_iter addEnd = tilesAdded.constEnd();
     for (; add != addEnd; ++add) {
-        oldTiles.insert(*add);
+        QGeoTileKey key = add->key();
+        mapTiles.insert(key);
+
+        QSet<QGeoTiledMapData *> &maps = d->tileHash_[key];
+        if (maps.isEmpty()) {
+            if (canceled.contains(key))
+                restored.insert(key);
+            else
+                reqTiles.append(key);
+        }
+        maps.insert(map);
     }
 
-    d->mapHash_.insert(map, oldTiles);
+    if (mapTiles.isEmpty())
+        d->mapHash_.remove(map);
+
+    if (!restored.isEmpty()) {
+        QVector<QGeoTileKey> stillCanceled;
+        for (int i = 0; i < cancelTiles.size(); ++i) {
+            if (!restored.contains(cancelTiles.at(i)))
+                stillCanceled.append(cancelTiles.at(i));
+        }
+        cancelTiles = stillCanceled;
+    }
 
-    // add and remove map from mapset for the tiles
+    if (d->fetcher_)
+        d->fetcher_->postTileRequests(reqTiles, cancelTiles);
+}
 
-    QSet<QGeoTileSpec> reqTiles;
-    QSet<QGeoTileSpec> cancelTiles;
+/*
+    Replaces the tiles fetched ahead of the camera of \a map with \a tiles,
+    nearest first. They are fetched after everything any map can see, and
+    land in the cache without being handed to a map. Tiles of the previous
+    call which are no longer wanted are canceled unless a map needs them.
+*/
+void QGeoTiledMappingManagerEngine::prefetchTiles(QGeoTiledMapData *map, const QList<QGeoTileSpec> &tiles)
+{
+    Q_D(QGeoTiledMappingManagerEngine);
 
-    rem = tilesRemoved.constBegin();
-    for (; rem != remEnd; ++rem) {
-        QSet<QGeoTiledMapData *> mapSet = d->tileHash_.value(*rem);
-        mapSet.remove(map);
-        if (mapSet.isEmpty()) {
-            cancelTiles.insert(*rem);
-            d->tileHash_.remove(*rem);
-        } else {
-            d->tileHash_.insert(*rem, mapSet);
-        }
+    if (tiles.isEmpty() && !d->prefetchHash_.contains(map))
+        return;
+
+    QSet<QGeoTileKey> old = d->prefetchHash_.take(map);
+    QSet<QGeoTileKey> wanted;
+    QVector<QGeoTileKey> prefetched;
+    QVector<QGeoTileKey> canceled;
+
+    foreach (const QGeoTileSpec &tile, tiles) {
+        QGeoTileKey key = tile.key();
+        if (wanted.contains(key))
+            continue;
+        wanted.insert(key);
+        if (old.remove(key))
+            continue;
+
+        int &count = d->prefetchCount_[key];
+        if (count++ == 0 && !d->tileHash_.contains(key) && !d->seedPending_.contains(key))
+            prefetched.append(key);
     }
 
-    add = tilesAdded.constBegin();
-    for (; add != addEnd; ++add) {
-        QSet<QGeoTiledMapData *> mapSet = d->tileHash_.value(*add);
-        if (mapSet.isEmpty()) {
-            reqTiles.insert(*add);
-        }
-        mapSet.insert(map);
-        d->tileHash_.insert(*add, mapSet);
+    QSet<QGeoTileKey>::const_iterator i = old.constBegin();
+    for (; i != old.constEnd(); ++i) {
+        QHash<QGeoTileKey, int>::iterator count = d->prefetchCount_.find(*i);
+        if (count == d->prefetchCount_.end() || --count.value() > 0)
+            continue;
+        d->prefetchCount_.erase(count);
+        if (!d->tileHash_.contains(*i) && !d->seedPending_.contains(*i))
+            canceled.append(*i);
     }
 
-    cancelTiles -= reqTiles;
+    if (!wanted.isEmpty())
+        d->prefetchHash_.insert(map, wanted);
+
+    if (d->fetcher_)
+        d->fetcher_->postTileRequests(QVector<QGeoTileKey>(), canceled, prefetched);
+}
 
-    QMetaObject::invokeMethod(d->fetcher_, "updateTileRequests",
+/*
+    Tells the fetcher which part of the map the user is looking at so that
+    queued requests near \a center (in mercator space, 0 to 1) at integer
+    \a zoom are sent first. \a visibleRadius is in tiles.
+*/
+void QGeoTiledMappingManagerEngine::updateTileRequestFocus(const QPointF &center, int zoom, double visibleRadius)
+{
+    Q_D(QGeoTiledMappingManagerEngine);
+
+    if (!d->fetcher_)
+        return;
+
+    QMetaObject::invokeMethod(d->fetcher_, "updateTileRequestFocus",
                               Qt::QueuedConnection,
-                              Q_ARG(QSet<QGeoTileSpec>, reqTiles),
-                              Q_ARG(QSet<QGeoTileSpec>, cancelTiles));
+                              Q_ARG(QPointF, center),
+                              Q_ARG(int, zoom),
+                              Q_ARG(double, visibleRadius));
 }
 
 void QGeoTiledMappingManagerEngine::engineTileFinished(const QGeoTileSpec &spec, const QByteArray &bytes, const QString &format)
 {
     Q_D(QGeoTiledMappingManagerEngine);
 
-    QSet<QGeoTiledMapData *> maps = d->tileHash_.value(spec);
+    QGeoTileKey key = spec.key();
+    QSet<QGeoTiledMapData *> maps = d->tileHash_.take(key);
 
     typedef QSet<QGeoTiledMapData *>::const_iterator map_iter;
 
     map_iter map = maps.constBegin();
     map_iter mapEnd = maps.constEnd();
-    for (; map != mapEnd; ++map) {
-        QSet<QGeoTileSpec> tileSet = d->mapHash_.value(*map);
-        tileSet.remove(spec);
-        if (tileSet.isEmpty())
-            d->mapHash_.remove(*map);
-        else
-            d->mapHash_.insert(*map, tileSet);
-    }
+    for (; map != mapEnd; ++map)
+        d->removeMapTile(*map, key);
 
-    d->tileHash_.remove(spec);
-
-    tileCache()->insert(spec, bytes, format, d->cacheHint_);
+    bool seeded = d->seedPending_.contains(key);
+    if (seeded && maps.isEmpty())
+        tileCache()->insert(spec, bytes, format, DiskCache);
+    else if (seeded)
+        tileCache()->insert(spec, bytes, format, d->cacheHint_ | DiskCache);
+    else
+        tileCache()->insert(spec, bytes, format, d->cacheHint_);
 
     map = maps.constBegin();
     mapEnd = maps.constEnd();
     for (; map != mapEnd; ++map) {
         (*map)->getRequestManager()->tileFetched(spec);
     }
+
+    if (seeded)
+        seedTileDone(key, false);
 }
 
 void QGeoTiledMappingManagerEngine::engineTileError(const QGeoTileSpec &spec, const QString &errorString)
 {
     Q_D(QGeoTiledMappingManagerEngine);
 
-    QSet<QGeoTiledMapData *> maps = d->tileHash_.value(spec);
+    QGeoTileKey key = spec.key();
+    QSet<QGeoTiledMapData *> maps = d->tileHash_.take(key);
     typedef QSet<QGeoTiledMapData *>::const_iterator map_iter;
     map_iter map = maps.constBegin();
     map_iter mapEnd = maps.constEnd();
-    for (; map != mapEnd; ++map) {
-        QSet<QGeoTileSpec> tileSet = d->mapHash_.value(*map);
-
-        tileSet.remove(spec);
-        if (tileSet.isEmpty())
-            d->mapHash_.remove(*map);
-        else
-            d->mapHash_.insert(*map, tileSet);
-    }
-    d->tileHash_.remove(spec);
+    for (; map != mapEnd; ++map)
+        d->removeMapTile(*map, key);
 
     for (map = maps.constBegin(); map != mapEnd; ++map) {
         (*map)->getRequestManager()->tileError(spec, errorString);
     }
 
     emit tileError(spec, errorString);
+
+    if (d->seedPending_.contains(key))
+        seedTileDone(key, true);
+}
+
+/*
+    Downloads the tiles of \a mapType covering \a area at every zoom level
+    from \a minZoom to \a maxZoom into the disk cache, so that the area can
+    be shown without a network connection later. Tiles which are already on
+    disk are skipped. The tiles are requested at no more than seedingRate()
+    tiles a second and compete with the maps' own requests in the fetcher.
+
+    Progress is reported with seedingProgress() and the end with
+    seedingFinished(). Seeding another area while one is in progress adds
+    its tiles to the same run.
+
+    No more than 65536 tiles wait to be seeded at a time, as estimated from
+    the bounding box of \a area at each level. Zoom levels which don't fit
+    any more are left out, together with the finer ones, and can be asked
+    for again once seeding has finished.
+
+    Returns false if there is nothing to seed.
+*/
+bool QGeoTiledMappingManagerEngine::seedTiles(const QGeoShape &area, int minZoom, int maxZoom,
+                                              const QGeoMapType &mapType)
+{
+    Q_D(QGeoTiledMappingManagerEngine);
+
+    if (!d->fetcher_ || !area.isValid())
+        return false;
+
+    minZoom = qMax(minZoom, qRound(cameraCapabilities().minimumZoomLevel()));
+    maxZoom = qMin(maxZoom, qRound(cameraCapabilities().maximumZoomLevel()));
+
+    QGeoCameraTiles cameraTiles;
+    cameraTiles.setPluginString(managerName() + QLatin1String("_") + QString::number(managerVersion()));
+    cameraTiles.setMapType(mapType);
+    cameraTiles.setTileSize(tileSize().width());
+
+    // coarse levels first, they are the most useful ones if seeding stops early
+    int added = 0;
+    for (int zoom = minZoom; zoom <= maxZoom; ++zoom) {
+        // checked before the level is enumerated, the world at zoom level
+        // 15 alone is a billion tiles; each finer level has about four
+        // times the tiles of this one
+        if (d->seedQueue_.size() + cameraTiles.tileCountForArea(area, zoom) > MaxSeedQueue) {
+            qWarning("Not seeding zoom levels %d to %d of the area, more than %d tiles would be queued",
+                     zoom, maxZoom, MaxSeedQueue);
+            break;
+        }
+
+        QSet<QGeoTileSpec> tiles = cameraTiles.tilesForArea(area, zoom);
+        QSet<QGeoTileSpec>::const_iterator it = tiles.constBegin();
+        for (; it != tiles.constEnd(); ++it)
+            d->seedQueue_.append(*it);
+        added += tiles.size();
+    }
+
+    if (added == 0)
+        return false;
+
+    d->seedTotal_ += added;
+
+    if (!d->seedTimer_) {
+        d->seedTimer_ = new QTimer(this);
+        connect(d->seedTimer_, SIGNAL(timeout()), this, SLOT(seedNextTiles()));
+    }
+    setSeedingRate(d->seedRate_);
+    d->seedTimer_->start();
+
+    return true;
+}
+
+/*
+    Stops seeding. Requests which were already sent are canceled unless a
+    map needs the same tiles.
+*/
+void QGeoTiledMappingManagerEngine::cancelSeeding()
+{
+    Q_D(QGeoTiledMappingManagerEngine);
+
+    if (!isSeeding())
+        return;
+
+    QVector<QGeoTileKey> cancelTiles;
+    QSet<QGeoTileKey>::const_iterator it = d->seedPending_.constBegin();
+    for (; it != d->seedPending_.constEnd(); ++it) {
+        if (!d->tileHash_.contains(*it) && !d->prefetchCount_.contains(*it))
+            cancelTiles.append(*it);
+    }
+
+    d->seedQueue_.clear();
+    d->seedPending_.clear();
+    d->seedTotal_ = d->seedDone_ = d->seedFailed_ = 0;
+    d->seedTimer_->stop();
+
+    d->fetcher_->postTileRequests(QVector<QGeoTileKey>(), cancelTiles);
+
+    emit seedingFinished(true);
+}
+
+bool QGeoTiledMappingManagerEngine::isSeeding() const
+{
+    Q_D(const QGeoTiledMappingManagerEngine);
+    return !d->seedQueue_.isEmpty() || !d->seedPending_.isEmpty();
+}
+
+void QGeoTiledMappingManagerEngine::setSeedingRate(int tilesPerSecond)
+{
+    Q_D(QGeoTiledMappingManagerEngine);
+    d->seedRate_ = qMax(1, tilesPerSecond);
+    if (d->seedTimer_)
+        d->seedTimer_->setInterval(qMax(1, 1000 / d->seedRate_));
+}
+
+int QGeoTiledMappingManagerEngine::seedingRate() const
+{
+    Q_D(const QGeoTiledMappingManagerEngine);
+    return d->seedRate_;
+}
+
+void QGeoTiledMappingManagerEngine::seedNextTiles()
+{
+    Q_D(QGeoTiledMappingManagerEngine);
+
+    // tiles on disk are only known to the cache once its index has loaded,
+    // don't fetch them again in the meantime
+    if (!tileCache()->isIndexLoaded())
+        return;
+
+    // one timer tick is worth this many requests at the configured rate
+    int budget = qMax(1, d->seedRate_ * d->seedTimer_->interval() / 1000);
+    // don't fill the fetcher's queue up with seeding requests
+    int window = 2 * d->fetcher_->maximumConcurrentRequests();
+
+    QVector<QGeoTileKey> reqTiles;
+    int skipped = 0;
+    while (!d->seedQueue_.isEmpty() && budget > 0
+           && d->seedPending_.size() < window) {
+        QGeoTileSpec spec = d->seedQueue_.takeFirst();
+        QGeoTileKey key = spec.key();
+        if (d->seedPending_.contains(key))
+            continue;
+
+        if (tileCache()->isInDiskCache(spec)) {
+            ++skipped;
+            continue;
+        }
+
+        d->seedPending_.insert(key);
+        // a map has asked for it already
+        if (!d->tileHash_.contains(key))
+            reqTiles.append(key);
+        --budget;
+    }
+
+    if (!reqTiles.isEmpty())
+        d->fetcher_->postTileRequests(reqTiles, QVector<QGeoTileKey>());
+
+    if (d->seedQueue_.isEmpty())
+        d->seedTimer_->stop();
+
+    if (skipped > 0) {
+        d->seedDone_ += skipped;
+        emit seedingProgress(d->seedDone_, d->seedFailed_, d->seedTotal_);
+    }
+
+    if (!isSeeding()) {
+        d->seedTotal_ = d->seedDone_ = d->seedFailed_ = 0;
+        emit seedingFinished(false);
+    }
+}
+
+void QGeoTiledMappingManagerEngine::seedTileDone(const QGeoTileKey &key, bool failed)
+{
+    Q_D(QGeoTiledMappingManagerEngine);
+
+    if (!d->seedPending_.remove(key))
+        return;
+
+    ++d->seedDone_;
+    if (failed)
+        ++d->seedFailed_;
+    emit seedingProgress(d->seedDone_, d->seedFailed_, d->seedTotal_);
+
+    if (!isSeeding()) {
+        d->seedTotal_ = d->seedDone_ = d->seedFailed_ = 0;
+        emit seedingFinished(false);
+    }
 }
 
 void QGeoTiledMappingManagerEngine::setTileSize(const QSize &tileSize)
@@ -293,11 +563,12 @@ void QGeoTiledMappingManagerEngine::setCacheHint(QGeoTiledMappingManagerEngine::
     d->cacheHint_ = cacheHint;
 }
 
-QGeoTileCache *QGeoTiledMappingManagerEngine::createTileCacheWithDir(const QString &cacheDirectory)
+QGeoTileCache *QGeoTiledMappingManagerEngine::createTileCacheWithDir(const QString &cacheDirectory,
+                                                                     DiskCacheStorage storage)
 {
     Q_D(QGeoTiledMappingManagerEngine);
     Q_ASSERT_X(!d->tileCache_, Q_FUNC_INFO, "This should be called only once");
-    d->tileCache_ = new QGeoTileCache(cacheDirectory);
+    d->tileCache_ = new QGeoTileCache(cacheDirectory, storage);
     return d->tileCache_;
 }
 
@@ -309,9 +580,16 @@ QGeoTileCache *QGeoTiledMappingManagerEngine::tileCache()
     return d->tileCache_;
 }
 
+/*
+    Returns the texture for \a spec if it is already in the texture cache.
+    Tiles which are only in the memory or disk cache are decoded off the
+    calling thread and announced through QGeoTileCache::tileDecoded(), or
+    through QGeoTileCache::tileDecodeFailed() if they have to be fetched
+    after all.
+*/
 QSharedPointer<QGeoTileTexture> QGeoTiledMappingManagerEngine::getTileTexture(const QGeoTileSpec &spec)
 {
-    return d_ptr->tileCache_->get(spec);
+    return d_ptr->tileCache_->get(spec, QGeoTileCache::NonBlockingLoad);
 }
 
 /*******************************************************************************
@@ -321,7 +599,22 @@ QGeoTiledMappingManagerEnginePrivate::QGeoTiledMappingManagerEnginePrivate()
   : thread_(0),
     cacheHint_(QGeoTiledMappingManagerEngine::AllCaches),
     tileCache_(0),
-    fetcher_(0) {}
+    fetcher_(0),
+    seedTotal_(0),
+    seedDone_(0),
+    seedFailed_(0),
+    seedRate_(20),
+    seedTimer_(0) {}
+
+void QGeoTiledMappingManagerEnginePrivate::removeMapTile(QGeoTiledMapData *map, const QGeoTileKey &key)
+{
+    QHash<QGeoTiledMapData *, QSet<QGeoTileKey> >::iterator tiles = mapHash_.find(map);
+    if (tiles == mapHash_.end())
+        return;
+    tiles->remove(key);
+    if (tiles->isEmpty())
+        mapHash_.erase(tiles);
+}
 
 QGeoTiledMappingManagerEnginePrivate::~QGeoTiledMappingManagerEnginePrivate()
 {
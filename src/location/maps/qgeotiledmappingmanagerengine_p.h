@@ -52,6 +52,7 @@
 #include <QObject>
 #include <QSize>
 #include <QPair>
+#include <QPointF>
 #include <QtLocation/qlocationglobal.h>
 #include "qgeomaptype_p.h"
 #include "qgeomappingmanagerengine_p.h"
@@ -64,8 +65,10 @@ class QGeoTileFetcher;
 class QGeoTileTexture;
 
 class QGeoTileSpec;
+class QGeoTileKey;
 class QGeoTiledMapData;
 class QGeoTileCache;
+class QGeoShape;
 
 class Q_LOCATION_EXPORT QGeoTiledMappingManagerEngine : public QGeoMappingManagerEngine
 {
@@ -79,6 +82,11 @@ public:
     };
     Q_DECLARE_FLAGS(CacheAreas, CacheArea)
 
+    enum DiskCacheStorage {
+        FileStorage,    // one file per tile
+        PackStorage     // single data file plus index, see QGeoTilePackStore
+    };
+
     explicit QGeoTiledMappingManagerEngine(QObject *parent = 0);
     virtual ~QGeoTiledMappingManagerEngine();
 
@@ -94,6 +102,8 @@ public:
     void updateTileRequests(QGeoTiledMapData *map,
                             const QSet<QGeoTileSpec> &tilesAdded,
                             const QSet<QGeoTileSpec> &tilesRemoved);
+    void updateTileRequestFocus(const QPointF &center, int zoom, double visibleRadius);
+    void prefetchTiles(QGeoTiledMapData *map, const QList<QGeoTileSpec> &tiles);
 
     QGeoTileCache *tileCache(); // TODO: check this is still used
     QSharedPointer<QGeoTileTexture> getTileTexture(const QGeoTileSpec &spec);
@@ -101,21 +111,33 @@ public:
 
     QGeoTiledMappingManagerEngine::CacheAreas cacheHint() const;
 
+    bool seedTiles(const QGeoShape &area, int minZoom, int maxZoom, const QGeoMapType &mapType);
+    void cancelSeeding();
+    bool isSeeding() const;
+    void setSeedingRate(int tilesPerSecond);
+    int seedingRate() const;
+
 private Q_SLOTS:
     void engineTileFinished(const QGeoTileSpec &spec, const QByteArray &bytes, const QString &format);
     void engineTileError(const QGeoTileSpec &spec, const QString &errorString);
+    void seedNextTiles();
 
 Q_SIGNALS:
     void tileError(const QGeoTileSpec &spec, const QString &errorString);
+    void seedingProgress(int done, int failed, int total);
+    void seedingFinished(bool canceled);
 
 protected:
     void setTileFetcher(QGeoTileFetcher *fetcher);
     void setTileSize(const QSize &tileSize);
     void setCacheHint(QGeoTiledMappingManagerEngine::CacheAreas cacheHint);
 
-    QGeoTileCache *createTileCacheWithDir(const QString &cacheDirectory);
+    QGeoTileCache *createTileCacheWithDir(const QString &cacheDirectory,
+                                          DiskCacheStorage storage = FileStorage);
 
 private:
+    void seedTileDone(const QGeoTileKey &key, bool failed);
+
     QGeoTiledMappingManagerEnginePrivate *d_ptr;
 
     Q_DECLARE_PRIVATE(QGeoTiledMappingManagerEngine)
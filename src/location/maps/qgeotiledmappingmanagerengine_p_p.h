@@ -60,6 +60,7 @@
 #include <QSet>
 #include <QThread>
 #include "qgeotiledmappingmanagerengine_p.h"
+#include "qgeotilekey_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -67,6 +68,7 @@ class QGeoTiledMapData;
 class QGeoTileCache;
 class QGeoTileSpec;
 class QGeoTileFetcher;
+class QTimer;
 
 class QGeoTiledMappingManagerEnginePrivate
 {
@@ -74,15 +76,29 @@ public:
     QGeoTiledMappingManagerEnginePrivate();
     ~QGeoTiledMappingManagerEnginePrivate();
 
+    void removeMapTile(QGeoTiledMapData *map, const QGeoTileKey &key);
+
     QThread *thread_;
     QSize tileSize_;
     QSet<QGeoTiledMapData *> tileMaps_;
-    QHash<QGeoTiledMapData *, QSet<QGeoTileSpec> > mapHash_;
-    QHash<QGeoTileSpec, QSet<QGeoTiledMapData *> > tileHash_;
+    QHash<QGeoTiledMapData *, QSet<QGeoTileKey> > mapHash_;
+    QHash<QGeoTileKey, QSet<QGeoTiledMapData *> > tileHash_;
+    // tiles fetched ahead of moving cameras, see prefetchTiles()
+    QHash<QGeoTiledMapData *, QSet<QGeoTileKey> > prefetchHash_;
+    QHash<QGeoTileKey, int> prefetchCount_;
     QGeoTiledMappingManagerEngine::CacheAreas cacheHint_;
     QGeoTileCache *tileCache_;
     QGeoTileFetcher *fetcher_;
 
+    // bulk seeding of the disk cache, see seedTiles()
+    QList<QGeoTileSpec> seedQueue_;
+    QSet<QGeoTileKey> seedPending_;
+    int seedTotal_;
+    int seedDone_;
+    int seedFailed_;
+    int seedRate_;
+    QTimer *seedTimer_;
+
 private:
     Q_DISABLE_COPY(QGeoTiledMappingManagerEnginePrivate)
 };
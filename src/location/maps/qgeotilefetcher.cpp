@@ -46,6 +46,8 @@
 #include "qgeotilespec_p.h"
 #include "qgeotiledmapdata_p.h"
 
+#include <cmath>
+
 QT_BEGIN_NAMESPACE
 
 QGeoTileFetcher::QGeoTileFetcher(QGeoTiledMappingManagerEngine *engine, QObject *parent)
@@ -79,8 +81,9 @@ void QGeoTileFetcher::threadStarted()
             SLOT(requestNextTile()));
 
     d->started_ = true;
-    if (!d->queue_.isEmpty())
-        d->timer_->start();
+
+    QMutexLocker ml(&d->queueMutex_);
+    d->updateTimer();
 }
 
 bool QGeoTileFetcher::init()
@@ -104,44 +107,95 @@ void QGeoTileFetcher::threadFinished()
     this->deleteLater();
 }
 
-void QGeoTileFetcher::updateTileRequests(const QSet<QGeoTileSpec> &tilesAdded,
-                                                  const QSet<QGeoTileSpec> &tilesRemoved)
+void QGeoTileFetcher::setMaximumConcurrentRequests(int maxRequests)
 {
     Q_D(QGeoTileFetcher);
-
     QMutexLocker ml(&d->queueMutex_);
+    d->maxConcurrentRequests_ = qMax(1, maxRequests);
+}
 
-    if (d->stopped_)
-        return;
+int QGeoTileFetcher::maximumConcurrentRequests() const
+{
+    Q_D(const QGeoTileFetcher);
+    return d->maxConcurrentRequests_;
+}
 
-    cancelTileRequests(tilesRemoved);
+/*
+    Queues a change to the requested tiles: \a tilesAdded are fetched and
+    \a tilesRemoved canceled. \a tilesPrefetched are fetched after every
+    other queued tile, see QGeoTileFetchQueue. Safe to call from any thread without taking
+    the queue mutex; the deltas are applied on the fetcher thread in the
+    order they were posted, and deltas posted in quick succession share a
+    single wake-up of that thread.
+*/
+void QGeoTileFetcher::postTileRequests(const QVector<QGeoTileKey> &tilesAdded,
+                                       const QVector<QGeoTileKey> &tilesRemoved,
+                                       const QVector<QGeoTileKey> &tilesPrefetched)
+{
+    Q_D(QGeoTileFetcher);
+
+    if (tilesAdded.isEmpty() && tilesRemoved.isEmpty() && tilesPrefetched.isEmpty())
+        return;
 
-    d->queue_ += tilesAdded.toList();
+    QGeoTileRequestDelta *delta = new QGeoTileRequestDelta;
+    delta->added = tilesAdded;
+    delta->removed = tilesRemoved;
+    delta->prefetched = tilesPrefetched;
 
-    if (!d->queue_.empty())
-        d->timer_->start();
+    if (d->requests_.push(delta))
+        QMetaObject::invokeMethod(this, "processTileRequests", Qt::QueuedConnection);
 }
 
-void QGeoTileFetcher::cancelTileRequests(const QSet<QGeoTileSpec> &tiles)
+void QGeoTileFetcher::processTileRequests()
 {
     Q_D(QGeoTileFetcher);
 
-    typedef QSet<QGeoTileSpec>::const_iterator tile_iter;
-    tile_iter tile = tiles.constBegin();
-    tile_iter end = tiles.constEnd();
-    for (; tile != end; ++tile) {
-        QGeoTiledMapReply *reply = d->invmap_.value(*tile, 0);
-        if (reply) {
-            d->invmap_.remove(*tile);
-            reply->abort();
-            if (reply->isFinished())
-                reply->deleteLater();
+    QGeoTileRequestDelta *delta = d->requests_.takeAll();
+
+    QMutexLocker ml(&d->queueMutex_);
+
+    while (delta) {
+        if (!d->stopped_) {
+            for (int i = 0; i < delta->removed.size(); ++i)
+                d->cancelRequest(delta->removed.at(i));
+            for (int i = 0; i < delta->added.size(); ++i) {
+                const QGeoTileKey &key = delta->added.at(i);
+                // the tile may already be under way for a prefetch or for
+                // seeding, one reply serves everyone who asked for it
+                d->prefetching_.remove(key);
+                if (!d->invmap_.contains(key))
+                    d->queue_.enqueue(key.toTileSpec());
+            }
+            for (int i = 0; i < delta->prefetched.size(); ++i) {
+                if (!d->invmap_.contains(delta->prefetched.at(i)))
+                    d->queue_.enqueue(delta->prefetched.at(i).toTileSpec(), true);
+            }
         }
-        d->queue_.removeAll(*tile);
+
+        QGeoTileRequestDelta *next = delta->next;
+        delete delta;
+        delta = next;
     }
 
-    if (d->queue_.isEmpty())
-        d->timer_->stop();
+    d->updateTimer();
+}
+
+/*
+    Sets the point the user is looking at, as a mercator \a center (0 to 1)
+    at integer \a zoom. Queued tiles are reordered so that the ones within
+    \a visibleRadius tiles of the center are fetched first. With several
+    maps on one engine the most recently moved map wins.
+*/
+void QGeoTileFetcher::updateTileRequestFocus(const QPointF &center, int zoom, double visibleRadius)
+{
+    Q_D(QGeoTileFetcher);
+
+    QMutexLocker ml(&d->queueMutex_);
+
+    if (d->stopped_)
+        return;
+
+    d->queue_.setFocus(center, zoom, visibleRadius);
 }
 
 void QGeoTileFetcher::requestNextTile()
@@ -153,12 +207,13 @@ void QGeoTileFetcher::requestNextTile()
     if (d->stopped_)
         return;
 
-    if (d->queue_.isEmpty()) {
+    if (d->queue_.isEmpty() || d->invmap_.size() >= d->maxConcurrentRequests_) {
         d->timer_->stop();
         return;
     }
 
-    QGeoTileSpec ts = d->queue_.takeFirst();
+    bool prefetch = false;
+    QGeoTileSpec ts = d->queue_.takeFirst(&prefetch);
 
     QGeoTiledMapReply *reply = getTileImage(ts);
 
@@ -171,11 +226,12 @@ void QGeoTileFetcher::requestNextTile()
                 SLOT(finished()),
                 Qt::QueuedConnection);
 
-        d->invmap_.insert(ts, reply);
+        d->invmap_.insert(ts.key(), reply);
+        if (prefetch)
+            d->prefetching_.insert(ts.key());
     }
 
-    if (d->queue_.isEmpty())
-        d->timer_->stop();
+    d->updateTimer();
 }
 
 void QGeoTileFetcher::finished()
@@ -190,14 +246,16 @@ void QGeoTileFetcher::finished()
 
     QGeoTileSpec spec = reply->tileSpec();
 
-    if (!d->invmap_.contains(spec)) {
+    if (!d->invmap_.remove(spec.key())) {
         reply->deleteLater();
         return;
     }
-
-    d->invmap_.remove(spec);
+    d->prefetching_.remove(spec.key());
 
     handleReply(reply, spec);
+
+    // a slot in the request window has been freed
+    d->updateTimer();
 }
 
 void QGeoTileFetcher::handleReply(QGeoTiledMapReply *reply, const QGeoTileSpec &spec)
@@ -225,12 +283,167 @@ QGeoTileFetcherPrivate::QGeoTileFetcherPrivate(QGeoTiledMappingManagerEngine *en
     : engine_(engine),
       started_(false),
       stopped_(false),
-      timer_(0) {}
+      timer_(0),
+      maxConcurrentRequests_(6) {}
 
 QGeoTileFetcherPrivate::~QGeoTileFetcherPrivate()
 {
 }
 
+void QGeoTileFetcherPrivate::cancelRequest(const QGeoTileKey &key)
+{
+    QGeoTiledMapReply *reply = invmap_.take(key);
+    if (reply) {
+        prefetching_.remove(key);
+        reply->abort();
+        if (reply->isFinished())
+            reply->deleteLater();
+    }
+    queue_.remove(key);
+}
+
+// only keep the timer running while there is something it could do, so a
+// full request window or an empty queue doesn't spin the fetcher thread
+void QGeoTileFetcherPrivate::updateTimer()
+{
+    if (!timer_ || stopped_)
+        return;
+
+    if (queue_.isEmpty() || invmap_.size() >= maxConcurrentRequests_)
+        timer_->stop();
+    else if (!timer_->isActive())
+        timer_->start();
+}
+
+/*******************************************************************************
+*******************************************************************************/
+
+QGeoTileFetchQueue::QGeoTileFetchQueue()
+    : sequence_(0),
+      hasFocus_(false),
+      focusZoom_(0),
+      focusRadius_(0.0) {}
+
+bool QGeoTileFetchQueue::Priority::operator < (const Priority &rhs) const
+{
+    if (layer != rhs.layer)
+        return layer < rhs.layer;
+    if (ring != rhs.ring)
+        return ring < rhs.ring;
+    return sequence < rhs.sequence;
+}
+
+// behind every layer a normal request can be in
+static const int PrefetchLayer = 64;
+
+QGeoTileFetchQueue::Priority QGeoTileFetchQueue::priority(int zoom, int x, int y, quint64 sequence, bool prefetch) const
+{
+    Priority p;
+    p.layer = prefetch ? PrefetchLayer : 0;
+    p.ring = 0;
+    p.sequence = sequence;
+    p.prefetch = prefetch;
+
+    if (!hasFocus_)
+        return p;
+
+    // tile center in mercator space, measured against the focus with
+    // wrapping around the dateline
+    double side = std::pow(2.0, zoom);
+    double dx = qAbs((x + 0.5) / side - focusCenter_.x());
+    if (dx > 0.5)
+        dx = 1.0 - dx;
+    double dy = (y + 0.5) / side - focusCenter_.y();
+
+    double distance = std::sqrt(dx * dx + dy * dy) * (1 << focusZoom_);
+    p.ring = int(distance);
+
+    int zoomDelta = qAbs(zoom - focusZoom_);
+    if (zoomDelta == 0)
+        p.layer += (distance <= focusRadius_) ? 0 : 1;
+    else
+        p.layer += 1 + zoomDelta;
+
+    return p;
+}
+
+void QGeoTileFetchQueue::setFocus(const QPointF &center, int zoom, double visibleRadius)
+{
+    if (hasFocus_ && focusCenter_ == center && focusZoom_ == zoom
+            && focusRadius_ == visibleRadius)
+        return;
+
+    hasFocus_ = true;
+    focusCenter_ = center;
+    focusZoom_ = zoom;
+    focusRadius_ = visibleRadius;
+
+    reprioritize();
+}
+
+void QGeoTileFetchQueue::enqueue(const QGeoTileSpec &spec, bool prefetch)
+{
+    QGeoTileKey key = spec.key();
+    QHash<QGeoTileKey, Priority>::iterator it = index_.find(key);
+    if (it != index_.end()) {
+        if (prefetch || !it.value().prefetch)
+            return;
+        // wanted now, move it out of the prefetch layer
+        order_.remove(it.value());
+        index_.erase(it);
+    }
+
+    Priority p = priority(spec.zoom(), spec.x(), spec.y(), sequence_++, prefetch);
+    order_.insert(p, spec);
+    index_.insert(key, p);
+}
+
+bool QGeoTileFetchQueue::remove(const QGeoTileSpec &spec)
+{
+    return remove(spec.key());
+}
+
+bool QGeoTileFetchQueue::remove(const QGeoTileKey &key)
+{
+    QHash<QGeoTileKey, Priority>::iterator it = index_.find(key);
+    if (it == index_.end())
+        return false;
+
+    order_.remove(it.value());
+    index_.erase(it);
+    return true;
+}
+
+QGeoTileSpec QGeoTileFetchQueue::takeFirst(bool *prefetch)
+{
+    QMap<Priority, QGeoTileSpec>::iterator first = order_.begin();
+    QGeoTileSpec spec = first.value();
+    if (prefetch)
+        *prefetch = first.key().prefetch;
+    order_.erase(first);
+    index_.remove(spec.key());
+    return spec;
+}
+
+// only tiles which end up in another group or ring move in order_, the
+// relative order of the rest stays what it was
+void QGeoTileFetchQueue::reprioritize()
+{
+    QHash<QGeoTileKey, Priority>::iterator it = index_.begin();
+    QHash<QGeoTileKey, Priority>::iterator end = index_.end();
+    for (; it != end; ++it) {
+        const QGeoTileKey &key = it.key();
+        Priority p = priority(key.zoom(), key.x(), key.y(),
+                              it.value().sequence, it.value().prefetch);
+        if (p.layer == it.value().layer && p.ring == it.value().ring)
+            continue;
+
+        QGeoTileSpec spec = order_.take(it.value());
+        order_.insert(p, spec);
+        it.value() = p;
+    }
+}
+
 QT_END_NAMESPACE
 
 
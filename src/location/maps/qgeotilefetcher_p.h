@@ -54,6 +54,7 @@
 //
 
 #include <QObject>
+#include <QVector>
 #include <qlocationglobal.h>
 #include "qgeomaptype_p.h"
 #include "qgeotiledmappingmanagerengine_p.h"
@@ -66,6 +67,8 @@ class QGeoTileFetcherPrivate;
 class QGeoTiledMappingManagerEngine;
 class QGeoTiledMapReply;
 class QGeoTileSpec;
+class QGeoTileKey;
+class QPointF;
 
 class Q_LOCATION_EXPORT QGeoTileFetcher : public QObject
 {
@@ -76,13 +79,19 @@ public:
     virtual ~QGeoTileFetcher();
     void stopTimer();
 
+    void setMaximumConcurrentRequests(int maxRequests);
+    int maximumConcurrentRequests() const;
+
+    void postTileRequests(const QVector<QGeoTileKey> &tilesAdded, const QVector<QGeoTileKey> &tilesRemoved,
+                          const QVector<QGeoTileKey> &tilesPrefetched = QVector<QGeoTileKey>());
+
 public Q_SLOTS:
     void threadStarted();
     void threadFinished();
-    void updateTileRequests(const QSet<QGeoTileSpec> &tilesAdded, const QSet<QGeoTileSpec> &tilesRemoved);
+    void updateTileRequestFocus(const QPointF &center, int zoom, double visibleRadius);
 
 private Q_SLOTS:
-    void cancelTileRequests(const QSet<QGeoTileSpec> &tiles);
+    void processTileRequests();
     void requestNextTile();
     void finished();
 
@@ -61,7 +61,11 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QHash>
+#include <QSet>
+#include <QPointF>
 #include "qgeomaptype_p.h"
+#include "qgeotilekey_p.h"
+#include "qgeotilerequestqueue_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -70,20 +74,84 @@ class QGeoTiledMapReply;
 class QGeoTileCache;
 class QGeoTiledMappingManagerEngine;
 
+/*
+ * Pending tile requests, ordered by how soon the user is going to look at
+ * them. Tiles at the focus zoom level within the visible radius of the
+ * focus point come first, then the rest of that layer, then the other
+ * layers by their distance in zoom levels; within each group tiles are
+ * ordered by their distance from the focus point in whole tiles (rings).
+ * Equal priorities are served in the order they were queued. Prefetched
+ * tiles, which the camera may or may not get to, wait behind all of those;
+ * asking for one of them normally moves it up.
+ *
+ * Insertion, removal and taking the first tile are O(log n). Moving the
+ * focus is O(n) plus O(log n) for each tile which changes its group or
+ * ring. The distance of every tile changes with the focus, so no index
+ * can tell which tiles change ring without looking at them; the pass only
+ * compares two ints per tile though, and between two frames few tiles
+ * cross a ring. Only a change of the focus zoom level re-keys every tile.
+ */
+class QGeoTileFetchQueue
+{
+public:
+    QGeoTileFetchQueue();
+
+    void setFocus(const QPointF &center, int zoom, double visibleRadius);
+
+    void enqueue(const QGeoTileSpec &spec, bool prefetch = false);
+    bool remove(const QGeoTileSpec &spec);
+    bool remove(const QGeoTileKey &key);
+    QGeoTileSpec takeFirst(bool *prefetch = 0);
+
+    inline bool isEmpty() const { return order_.isEmpty(); }
+    inline int size() const { return order_.size(); }
+
+private:
+    struct Priority
+    {
+        int layer;
+        int ring;
+        quint64 sequence;
+        bool prefetch;
+
+        bool operator < (const Priority &rhs) const;
+    };
+
+    Priority priority(int zoom, int x, int y, quint64 sequence, bool prefetch) const;
+    void reprioritize();
+
+    QMap<Priority, QGeoTileSpec> order_;
+    QHash<QGeoTileKey, Priority> index_;
+    quint64 sequence_;
+
+    bool hasFocus_;
+    QPointF focusCenter_;  // mercator, 0 to 1
+    int focusZoom_;
+    double focusRadius_;   // in tiles at the focus zoom level
+};
+
 class QGeoTileFetcherPrivate
 {
 public:
     explicit QGeoTileFetcherPrivate(QGeoTiledMappingManagerEngine *engine);
     virtual ~QGeoTileFetcherPrivate();
 
+    void updateTimer();
+    void cancelRequest(const QGeoTileKey &key);
+
     QGeoTiledMappingManagerEngine *engine_;
 
     bool started_;
     bool stopped_;
     QTimer *timer_;
     QMutex queueMutex_;
-    QList<QGeoTileSpec> queue_;
-    QHash<QGeoTileSpec, QGeoTiledMapReply *> invmap_;
+    QGeoTileFetchQueue queue_;
+    // deltas posted by the engine, drained on the fetcher thread
+    QGeoTileRequestQueue requests_;
+    // prefetch requests which are being fetched
+    QSet<QGeoTileKey> prefetching_;
+    QHash<QGeoTileKey, QGeoTiledMapReply *> invmap_;
+    int maxConcurrentRequests_;
 
 private:
     Q_DISABLE_COPY(QGeoTileFetcherPrivate)
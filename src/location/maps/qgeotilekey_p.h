@@ -0,0 +1,154 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QGEOTILEKEY_P_H
+#define QGEOTILEKEY_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtLocation/qlocationglobal.h>
+#include <QtCore/qhash.h>
+
+#include "qgeotilespec_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * QGeoTileKey
+ *
+ * A plain value version of QGeoTileSpec for use as a hash key inside the
+ * tile pipeline. The plugin name is replaced by its interned id (see
+ * QGeoTileSpec::pluginId()) and mapId, zoom, x and y are packed into a
+ * single 64 bit word:
+ *
+ *   | mapId (10 bits) | unset (1 bit) | zoom (5 bits) | x (24 bits) | y (24 bits) |
+ *
+ * That covers every tile of every zoom level up to MaxZoom. The unset bit
+ * is set when zoom, x or y is negative, so that -1 (the "unset" value of
+ * QGeoTileSpec) can be told apart from the last tile of zoom level 24.
+ * Values outside of those ranges are masked, so two such keys may compare
+ * equal when the specs they were made from do not; QGeoTileSpec itself
+ * keeps the exact values.
+ */
+class QGeoTileKey
+{
+public:
+    enum { MaxZoom = 24 };
+
+    inline QGeoTileKey()
+        : pluginId_(0), packed_(pack(0, -1, -1, -1)) {}
+    inline explicit QGeoTileKey(const QGeoTileSpec &spec)
+        : pluginId_(spec.pluginId()),
+          packed_(pack(spec.mapId(), spec.zoom(), spec.x(), spec.y())) {}
+    inline QGeoTileKey(int pluginId, int mapId, int zoom, int x, int y)
+        : pluginId_(pluginId), packed_(pack(mapId, zoom, x, y)) {}
+
+    inline int pluginId() const { return pluginId_; }
+    inline int mapId() const { return int((packed_ >> 54) & 0x3ff); }
+    inline int zoom() const { return unpackSigned((packed_ >> 48) & 0x1f, 0x1f); }
+    inline int x() const { return unpackSigned((packed_ >> 24) & 0xffffff, 0xffffff); }
+    inline int y() const { return unpackSigned(packed_ & 0xffffff, 0xffffff); }
+
+    inline quint64 packed() const { return packed_; }
+    static inline QGeoTileKey fromPacked(int pluginId, quint64 packed)
+    {
+        QGeoTileKey key;
+        key.pluginId_ = pluginId;
+        key.packed_ = packed;
+        return key;
+    }
+
+    inline QGeoTileSpec toTileSpec() const { return QGeoTileSpec(*this); }
+
+    inline bool operator == (const QGeoTileKey &rhs) const
+    { return packed_ == rhs.packed_ && pluginId_ == rhs.pluginId_; }
+    inline bool operator != (const QGeoTileKey &rhs) const
+    { return !operator==(rhs); }
+    inline bool operator < (const QGeoTileKey &rhs) const
+    { return pluginId_ < rhs.pluginId_ || (pluginId_ == rhs.pluginId_ && packed_ < rhs.packed_); }
+
+private:
+    static const quint64 UnsetBit = Q_UINT64_C(1) << 53;
+
+    static inline quint64 pack(int mapId, int zoom, int x, int y)
+    {
+        return (quint64(quint32(mapId) & 0x3ff) << 54)
+                | ((zoom | x | y) < 0 ? quint64(UnsetBit) : quint64(0))
+                | (quint64(quint32(zoom) & 0x1f) << 48)
+                | (quint64(quint32(x) & 0xffffff) << 24)
+                | quint64(quint32(y) & 0xffffff);
+    }
+    // with the unset bit, all bits set is how -1 packs
+    inline int unpackSigned(quint64 v, quint64 mask) const
+    { return (packed_ & UnsetBit) && v == mask ? -1 : int(v); }
+
+    quint32 pluginId_;
+    quint64 packed_;
+};
+
+Q_DECLARE_TYPEINFO(QGeoTileKey, Q_PRIMITIVE_TYPE);
+
+/*
+ * The finalizer of MurmurHash3 (fmix64). Every input bit affects every
+ * output bit, so neighbouring tiles spread evenly over the buckets.
+ */
+inline uint qHash(const QGeoTileKey &key)
+{
+    quint64 h = key.packed() ^ (quint64(key.pluginId()) * Q_UINT64_C(0x9e3779b97f4a7c15));
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+    return uint(h ^ (h >> 32));
+}
+
+QT_END_NAMESPACE
+
+#endif // QGEOTILEKEY_P_H
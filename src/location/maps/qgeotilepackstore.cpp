@@ -0,0 +1,589 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "qgeotilepackstore_p.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QVector>
+#include <QDebug>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+const quint32 PackIndexMagic = 0x51475450; // "QGTP"
+const quint32 PackIndexVersion = 1;
+
+// don't bother compacting for less than this much dead data
+const qint64 MinimumCompactionWaste = 4 * 1024 * 1024;
+
+// records appended after the data file was mapped are read with plain
+// file reads until this much has piled up behind the mapping
+const qint64 RemapThreshold = 8 * 1024 * 1024;
+
+}
+
+/* Copies the live records of the data file, as they were when the
+ * compaction was started, to a new file. Records appended or removed in
+ * the meantime are dealt with in QGeoTilePackStore::compactionFinished(). */
+class QGeoTilePackCompaction : public QRunnable
+{
+public:
+    struct Span
+    {
+        QGeoTileKey key;
+        quint64 offset;
+        quint32 length;
+
+        bool operator < (const Span &rhs) const { return offset < rhs.offset; }
+    };
+
+    QGeoTilePackCompaction()
+        : store(0), snapshotEnd(0), ok(false)
+    {
+        setAutoDelete(false);
+    }
+
+    void run();
+
+    QGeoTilePackStore *store;
+    QString sourcePath;
+    QString targetPath;
+    QVector<Span> spans;
+    quint64 snapshotEnd;
+
+    QHash<QGeoTileKey, quint64> newOffsets;
+    bool ok;
+};
+
+void QGeoTilePackCompaction::run()
+{
+    QFile source(sourcePath);
+    QFile target(targetPath);
+
+    ok = source.open(QIODevice::ReadOnly)
+            && target.open(QIODevice::WriteOnly | QIODevice::Truncate);
+
+    // reading in file order keeps the source access sequential
+    qSort(spans.begin(), spans.end());
+
+    quint64 position = 0;
+    for (int i = 0; ok && i < spans.size(); ++i) {
+        const Span &span = spans.at(i);
+        if (!source.seek(span.offset)) {
+            ok = false;
+            break;
+        }
+        QByteArray bytes = source.read(span.length);
+        if (bytes.size() != int(span.length) || target.write(bytes) != bytes.size()) {
+            ok = false;
+            break;
+        }
+        newOffsets.insert(span.key, position);
+        position += span.length;
+    }
+
+    ok = ok && target.flush();
+    target.close();
+
+    QMetaObject::invokeMethod(store, "compactionFinished", Qt::QueuedConnection);
+}
+
+QGeoTilePackStore::QGeoTilePackStore(const QString &directory, QObject *parent)
+    : QObject(parent),
+      map_(0),
+      mappedSize_(0),
+      liveSize_(0),
+      mutex_(QMutex::Recursive)
+{
+    QDir dir(directory);
+    dataPath_ = dir.filePath(QLatin1String("tiles.pack"));
+    indexPath_ = dir.filePath(QLatin1String("tiles.idx"));
+
+    compactionPool_.setMaxThreadCount(1);
+}
+
+QGeoTilePackStore::~QGeoTilePackStore()
+{
+    close();
+}
+
+bool QGeoTilePackStore::open()
+{
+    QMutexLocker locker(&mutex_);
+
+    data_.setFileName(dataPath_);
+    if (!data_.open(QIODevice::ReadWrite)) {
+        qWarning() << "Unable to open tile pack file" << dataPath_;
+        return false;
+    }
+
+    records_.clear();
+    order_.clear();
+    formats_.clear();
+    liveSize_ = 0;
+
+    QFile index(indexPath_);
+    if (index.open(QIODevice::ReadOnly)) {
+        QDataStream in(&index);
+        in.setVersion(QDataStream::Qt_5_0);
+
+        quint32 magic = 0;
+        quint32 version = 0;
+        in >> magic >> version;
+
+        if (magic == PackIndexMagic && version == PackIndexVersion) {
+            QStringList plugins;
+            quint32 count = 0;
+            in >> plugins >> formats_ >> count;
+
+            QVector<int> pluginIds(plugins.size());
+            for (int i = 0; i < plugins.size(); ++i)
+                pluginIds[i] = QGeoTileSpec::internPlugin(plugins.at(i));
+
+            const quint64 dataSize = data_.size();
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                quint16 plugin;
+                quint64 packed;
+                Record r;
+                in >> plugin >> packed >> r.offset >> r.length >> r.format >> r.queue;
+
+                if (in.status() != QDataStream::Ok)
+                    break;
+                // the data file may have been truncated behind our back
+                if (plugin >= pluginIds.size() || r.offset + r.length > dataSize)
+                    continue;
+
+                QGeoTileKey key = QGeoTileKey::fromPacked(pluginIds.at(plugin), packed);
+                records_.insert(key, r);
+                order_.append(key);
+                liveSize_ += r.length;
+            }
+        }
+    }
+
+    // an index which doesn't cover the whole data file (e.g. after a crash)
+    // leaves dead space behind, reclaim it
+    maybeCompact();
+
+    return true;
+}
+
+void QGeoTilePackStore::close()
+{
+    QMutexLocker locker(&mutex_);
+
+    waitForCompaction();
+    unmapData();
+    if (data_.isOpen())
+        data_.close();
+}
+
+QList<QGeoTilePackStore::Entry> QGeoTilePackStore::entries() const
+{
+    QList<Entry> result;
+
+    for (int i = 0; i < order_.size(); ++i) {
+        QHash<QGeoTileKey, Record>::const_iterator it = records_.constFind(order_.at(i));
+        if (it == records_.constEnd())
+            continue;
+        Entry e;
+        e.spec = it.key().toTileSpec();
+        e.format = formats_.value(it->format);
+        e.size = it->length;
+        e.queue = it->queue;
+        result.append(e);
+    }
+
+    return result;
+}
+
+bool QGeoTilePackStore::contains(const QGeoTileSpec &spec) const
+{
+    return records_.contains(spec.key());
+}
+
+QByteArray QGeoTilePackStore::read(const QGeoTileSpec &spec, QString *format)
+{
+    QMutexLocker locker(&mutex_);
+
+    QHash<QGeoTileKey, Record>::const_iterator it = records_.constFind(spec.key());
+    if (it == records_.constEnd())
+        return QByteArray();
+
+    const Record &r = it.value();
+    if (format)
+        *format = formats_.value(r.format);
+
+    // remapping the whole file for every append would cost more than the
+    // reads it saves, so only do it once the unmapped tail has grown
+    const qint64 end = r.offset + r.length;
+    if ((map_ && end <= mappedSize_)
+            || ((!map_ || data_.size() - mappedSize_ >= RemapThreshold) && mapData(end))) {
+        return QByteArray(reinterpret_cast<const char *>(map_ + r.offset), r.length);
+    }
+
+    // mapping is not available on every platform / file system
+    if (!data_.seek(r.offset))
+        return QByteArray();
+    return data_.read(r.length);
+}
+
+bool QGeoTilePackStore::insert(const QGeoTileSpec &spec, const QByteArray &bytes, const QString &format)
+{
+    QMutexLocker locker(&mutex_);
+
+    if (!data_.isOpen() || bytes.isEmpty())
+        return false;
+
+    qint64 offset = data_.size();
+    if (!data_.seek(offset) || data_.write(bytes) != bytes.size()) {
+        qWarning() << "Unable to write to tile pack file" << dataPath_;
+        return false;
+    }
+    data_.flush();
+
+    QGeoTileKey key = spec.key();
+
+    Record r;
+    r.offset = offset;
+    r.length = bytes.size();
+    r.format = formatId(format);
+    r.queue = 0;
+
+    QHash<QGeoTileKey, Record>::iterator it = records_.find(key);
+    if (it != records_.end()) {
+        liveSize_ -= it->length;
+        it.value() = r;
+    } else {
+        records_.insert(key, r);
+        order_.append(key);
+    }
+    liveSize_ += r.length;
+
+    return true;
+}
+
+void QGeoTilePackStore::remove(const QGeoTileSpec &spec)
+{
+    QMutexLocker locker(&mutex_);
+
+    QHash<QGeoTileKey, Record>::iterator it = records_.find(spec.key());
+    if (it == records_.end())
+        return;
+
+    liveSize_ -= it->length;
+    records_.erase(it);
+
+    maybeCompact();
+}
+
+/*
+    Writes the index. \a queues holds the tiles of each 3Q queue, front
+    to back, so that the queues can be rebuilt in the same order.
+*/
+bool QGeoTilePackStore::writeIndex(const QList<QList<QGeoTileSpec> > &queues)
+{
+    QMutexLocker locker(&mutex_);
+
+    if (!data_.isOpen())
+        return false;
+
+    for (QHash<QGeoTileKey, Record>::iterator it = records_.begin(); it != records_.end(); ++it)
+        it->queue = 0;
+
+    QList<QGeoTileKey> order;
+    for (int q = 0; q < queues.size(); ++q) {
+        const QList<QGeoTileSpec> &queue = queues.at(q);
+        for (int i = 0; i < queue.size(); ++i) {
+            QGeoTileKey key = queue.at(i).key();
+            QHash<QGeoTileKey, Record>::iterator it = records_.find(key);
+            if (it == records_.end() || it->queue != 0)
+                continue;
+            it->queue = q + 1;
+            order.append(key);
+        }
+    }
+
+    // anything the caller did not mention goes last, in insertion order
+    for (int i = 0; i < order_.size(); ++i) {
+        QHash<QGeoTileKey, Record>::iterator it = records_.find(order_.at(i));
+        if (it != records_.end() && it->queue == 0)
+            order.append(order_.at(i));
+    }
+
+    order_ = order;
+    return writeIndexFile();
+}
+
+bool QGeoTilePackStore::writeIndexFile()
+{
+    data_.flush();
+
+    QStringList plugins;
+    QHash<int, quint16> pluginIndex;
+
+    QSaveFile index(indexPath_);
+    if (!index.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write tile pack index" << indexPath_;
+        return false;
+    }
+
+    // the plugin table has to come first, so collect it up front
+    QList<QGeoTileKey> keys;
+    for (int i = 0; i < order_.size(); ++i) {
+        const QGeoTileKey &key = order_.at(i);
+        if (!records_.contains(key))
+            continue;
+        keys.append(key);
+        if (!pluginIndex.contains(key.pluginId())) {
+            pluginIndex.insert(key.pluginId(), plugins.size());
+            plugins.append(QGeoTileSpec::pluginName(key.pluginId()));
+        }
+    }
+
+    QDataStream out(&index);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << PackIndexMagic << PackIndexVersion;
+    out << plugins << formats_ << quint32(keys.size());
+
+    for (int i = 0; i < keys.size(); ++i) {
+        const QGeoTileKey &key = keys.at(i);
+        const Record &r = records_[key];
+        out << pluginIndex.value(key.pluginId()) << key.packed()
+            << r.offset << r.length << r.format << r.queue;
+    }
+
+    return index.commit();
+}
+
+qint64 QGeoTilePackStore::dataSize() const
+{
+    QMutexLocker locker(&mutex_);
+    return data_.size();
+}
+
+qint64 QGeoTilePackStore::liveSize() const
+{
+    return liveSize_;
+}
+
+bool QGeoTilePackStore::isCompacting() const
+{
+    return !compaction_.isNull();
+}
+
+void QGeoTilePackStore::maybeCompact()
+{
+    qint64 waste = dataSize() - liveSize_;
+    if (waste > MinimumCompactionWaste && waste > liveSize_ / 2)
+        compact();
+}
+
+void QGeoTilePackStore::compact()
+{
+    QMutexLocker locker(&mutex_);
+
+    if (compaction_ || !data_.isOpen())
+        return;
+
+    data_.flush();
+
+    compaction_ = QSharedPointer<QGeoTilePackCompaction>(new QGeoTilePackCompaction);
+    compaction_->store = this;
+    compaction_->sourcePath = dataPath_;
+    compaction_->targetPath = dataPath_ + QLatin1String(".compact");
+    compaction_->snapshotEnd = data_.size();
+    compaction_->spans.reserve(records_.size());
+
+    QHash<QGeoTileKey, Record>::const_iterator it = records_.constBegin();
+    for (; it != records_.constEnd(); ++it) {
+        QGeoTilePackCompaction::Span span;
+        span.key = it.key();
+        span.offset = it->offset;
+        span.length = it->length;
+        compaction_->spans.append(span);
+    }
+
+    compactionPool_.start(compaction_.data());
+}
+
+void QGeoTilePackStore::waitForCompaction()
+{
+    compactionPool_.waitForDone();
+    if (compaction_)
+        compactionFinished();
+}
+
+void QGeoTilePackStore::compactionFinished()
+{
+    QMutexLocker locker(&mutex_);
+
+    QSharedPointer<QGeoTilePackCompaction> c = compaction_;
+    compaction_.clear();
+    if (!c)
+        return;
+
+    QFile target(c->targetPath);
+    if (!c->ok || !target.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        qWarning() << "Unable to compact tile pack file" << dataPath_;
+        QFile::remove(c->targetPath);
+        return;
+    }
+
+    // records still at their snapshot position have been copied, anything
+    // written since then is appended to the new file here. The new offsets
+    // only apply once the new file has replaced the old one.
+    QHash<QGeoTileKey, quint64> offsets;
+    offsets.reserve(records_.size());
+    quint64 position = target.size();
+    bool ok = true;
+    QHash<QGeoTileKey, Record>::const_iterator it = records_.constBegin();
+    for (; ok && it != records_.constEnd(); ++it) {
+        const Record &r = it.value();
+        QHash<QGeoTileKey, quint64>::const_iterator moved = c->newOffsets.constFind(it.key());
+        if (r.offset < c->snapshotEnd && moved != c->newOffsets.constEnd()) {
+            offsets.insert(it.key(), moved.value());
+            continue;
+        }
+
+        QByteArray bytes = read(it.key().toTileSpec());
+        ok = bytes.size() == int(r.length) && target.write(bytes) == bytes.size();
+        offsets.insert(it.key(), position);
+        position += bytes.size();
+    }
+    ok = ok && target.flush();
+    target.close();
+
+    if (!ok || !replaceDataFile(c->targetPath)) {
+        qWarning() << "Unable to compact tile pack file" << dataPath_;
+        QFile::remove(c->targetPath);
+        return;
+    }
+
+    QHash<QGeoTileKey, Record>::iterator rit = records_.begin();
+    for (; rit != records_.end(); ++rit)
+        rit->offset = offsets.value(rit.key());
+
+    // the old index refers to offsets in the old file
+    writeIndexFile();
+}
+
+/*
+    Puts the file at \a replacement in place of the data file. The data
+    file is moved aside first and moved back if that fails, so the records
+    stay valid for whichever file ends up in place. Returns true if the
+    data file was replaced.
+*/
+bool QGeoTilePackStore::replaceDataFile(const QString &replacement)
+{
+    const QString backupPath = dataPath_ + QLatin1String(".old");
+
+    unmapData();
+    data_.close();
+    QFile::remove(backupPath);
+
+    bool replaced = false;
+    bool restored = true;
+    if (QFile::rename(dataPath_, backupPath)) {
+        replaced = QFile::rename(replacement, dataPath_);
+        if (!replaced)
+            restored = QFile::rename(backupPath, dataPath_);
+    }
+
+    if (!data_.open(QIODevice::ReadWrite))
+        qWarning() << "Unable to open tile pack file" << dataPath_;
+
+    if (replaced) {
+        QFile::remove(backupPath);
+    } else if (!restored) {
+        // neither file is in place, what the records point at is gone
+        qWarning() << "Unable to restore tile pack file" << dataPath_ << "from" << backupPath;
+        records_.clear();
+        order_.clear();
+        liveSize_ = 0;
+        writeIndexFile();
+    }
+
+    return replaced;
+}
+
+bool QGeoTilePackStore::mapData(qint64 minimumSize)
+{
+    if (map_ && mappedSize_ >= minimumSize)
+        return true;
+
+    unmapData();
+
+    qint64 size = data_.size();
+    if (size < minimumSize || size == 0)
+        return false;
+
+    map_ = data_.map(0, size);
+    if (!map_)
+        return false;
+    mappedSize_ = size;
+    return true;
+}
+
+void QGeoTilePackStore::unmapData()
+{
+    if (map_)
+        data_.unmap(map_);
+    map_ = 0;
+    mappedSize_ = 0;
+}
+
+int QGeoTilePackStore::formatId(const QString &format)
+{
+    int id = formats_.indexOf(format);
+    if (id < 0) {
+        id = formats_.size();
+        formats_.append(format);
+    }
+    return id;
+}
+
+QT_END_NAMESPACE
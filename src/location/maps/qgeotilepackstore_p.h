@@ -0,0 +1,170 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QGEOTILEPACKSTORE_P_H
+#define QGEOTILEPACKSTORE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtLocation/qlocationglobal.h>
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThreadPool>
+
+#include "qgeotilespec_p.h"
+#include "qgeotilekey_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QGeoTilePackCompaction;
+
+/*
+ * QGeoTilePackStore
+ *
+ * Disk storage for the tile cache that keeps all tiles in a single
+ * append-only data file ("tiles.pack") next to a compact binary index
+ * ("tiles.idx"), instead of one file per tile. The data file is memory
+ * mapped for reads.
+ *
+ * Removing a tile only drops it from the index. Once enough of the data
+ * file is dead, the live records are copied to a fresh file on a worker
+ * thread and the files are swapped when that is done.
+ *
+ * The index is written by writeIndex(), together with the queue each
+ * tile was on in the 3Q disk cache, so the eviction state survives a
+ * restart. Tiles appended after the last index write are lost if the
+ * process dies; their bytes are reclaimed by the next compaction.
+ *
+ * read() may be called from any thread, the tile cache reads tiles on its
+ * decode threads. Everything else belongs to the thread the store lives in.
+ */
+class Q_LOCATION_EXPORT QGeoTilePackStore : public QObject
+{
+    Q_OBJECT
+public:
+    struct Entry
+    {
+        QGeoTileSpec spec;
+        QString format;
+        int size;
+        int queue;  // 1-3 for the 3Q queues, 0 if unknown
+    };
+
+    explicit QGeoTilePackStore(const QString &directory, QObject *parent = 0);
+    ~QGeoTilePackStore();
+
+    bool open();
+    void close();
+
+    // the tiles found in the index, in queue order
+    QList<Entry> entries() const;
+
+    bool contains(const QGeoTileSpec &spec) const;
+    QByteArray read(const QGeoTileSpec &spec, QString *format = 0);
+    bool insert(const QGeoTileSpec &spec, const QByteArray &bytes, const QString &format);
+    void remove(const QGeoTileSpec &spec);
+
+    bool writeIndex(const QList<QList<QGeoTileSpec> > &queues);
+
+    qint64 dataSize() const;
+    qint64 liveSize() const;
+    bool isCompacting() const;
+    void compact();
+    void waitForCompaction();
+
+private Q_SLOTS:
+    void compactionFinished();
+
+private:
+    struct Record
+    {
+        quint64 offset;
+        quint32 length;
+        quint16 format;
+        quint8 queue;
+    };
+
+    bool writeIndexFile();
+    bool replaceDataFile(const QString &replacement);
+    bool mapData(qint64 minimumSize);
+    void unmapData();
+    int formatId(const QString &format);
+    void maybeCompact();
+
+    QString dataPath_;
+    QString indexPath_;
+
+    QFile data_;
+    uchar *map_;
+    qint64 mappedSize_;
+
+    QHash<QGeoTileKey, Record> records_;
+    QList<QGeoTileKey> order_;
+    QStringList formats_;
+    qint64 liveSize_;
+
+    QThreadPool compactionPool_;
+    QSharedPointer<QGeoTilePackCompaction> compaction_;
+
+    // guards the data file, the mapping and the records against read()
+    // from other threads; recursive as compactionFinished() reads too
+    mutable QMutex mutex_;
+
+    Q_DISABLE_COPY(QGeoTilePackStore)
+};
+
+QT_END_NAMESPACE
+
+#endif // QGEOTILEPACKSTORE_P_H
@@ -60,6 +60,10 @@ public:
     QGeoTiledMapData *map_;
 
     QList<QSharedPointer<QGeoTileTexture> > requestTiles(const QSet<QGeoTileSpec> &tiles);
+    QList<QSharedPointer<QGeoTileTexture> > updateTiles(const QSet<QGeoTileSpec> &added,
+                                                        const QSet<QGeoTileSpec> &removed);
+    QList<QSharedPointer<QGeoTileTexture> > sendRequests(QSet<QGeoTileSpec> requestTiles,
+                                                         const QSet<QGeoTileSpec> &cancelTiles);
     void tileError(const QGeoTileSpec &tile, const QString &errorString);
 
     QHash<QGeoTileSpec, int> retries_;
@@ -67,6 +71,7 @@ public:
     QSet<QGeoTileSpec> requested_;
 
     void tileFetched(const QGeoTileSpec &spec);
+    void tileDecodeFailed(const QGeoTileSpec &spec);
 };
 
 QGeoTileRequestManager::QGeoTileRequestManager(QGeoTiledMapData *map)
@@ -85,12 +90,36 @@ QList<QSharedPointer<QGeoTileTexture> > QGeoTileRequestManager::requestTiles(con
     return d->requestTiles(tiles);
 }
 
+/*
+    Updates the requests for a view which gained the \a added tiles and lost
+    the \a removed ones, which is cheaper than handing over the whole view
+    to requestTiles() when the camera only pans. The added tiles must not
+    already be textured. Returns the added tiles found in the cache.
+*/
+QList<QSharedPointer<QGeoTileTexture> > QGeoTileRequestManager::updateTiles(const QSet<QGeoTileSpec> &added,
+                                                                           const QSet<QGeoTileSpec> &removed)
+{
+    Q_D(QGeoTileRequestManager);
+    return d->updateTiles(added, removed);
+}
+
 void QGeoTileRequestManager::tileFetched(const QGeoTileSpec &spec)
 {
     Q_D(QGeoTileRequestManager);
     d->tileFetched(spec);
 }
 
+/*
+    Requests \a spec from the engine after all. sendRequests() leaves tiles
+    which are being decoded to the cache, this is for those the cache could
+    not decode.
+*/
+void QGeoTileRequestManager::tileDecodeFailed(const QGeoTileSpec &spec)
+{
+    Q_D(QGeoTileRequestManager);
+    d->tileDecodeFailed(spec);
+}
+
 void QGeoTileRequestManager::tileError(const QGeoTileSpec &tile, const QString &errorString)
 {
     Q_D(QGeoTileRequestManager);
@@ -110,10 +139,37 @@ QList<QSharedPointer<QGeoTileTexture> > QGeoTileRequestManagerPrivate::requestTi
 {
     QSet<QGeoTileSpec> cancelTiles = requested_ - tiles;
     QSet<QGeoTileSpec> requestTiles = tiles - requested_;
-    QSet<QGeoTileSpec> cached;
 //    int tileSize = tiles.size();
 //    int newTiles = requestTiles.size();
 
+    return sendRequests(requestTiles, cancelTiles);
+}
+
+QList<QSharedPointer<QGeoTileTexture> > QGeoTileRequestManagerPrivate::updateTiles(const QSet<QGeoTileSpec> &added,
+                                                                                  const QSet<QGeoTileSpec> &removed)
+{
+    typedef QSet<QGeoTileSpec>::const_iterator iter;
+
+    QSet<QGeoTileSpec> cancelTiles;
+    for (iter i = removed.constBegin(); i != removed.constEnd(); ++i) {
+        if (requested_.contains(*i))
+            cancelTiles.insert(*i);
+    }
+
+    QSet<QGeoTileSpec> requestTiles;
+    for (iter i = added.constBegin(); i != added.constEnd(); ++i) {
+        if (!requested_.contains(*i))
+            requestTiles.insert(*i);
+    }
+
+    return sendRequests(requestTiles, cancelTiles);
+}
+
+QList<QSharedPointer<QGeoTileTexture> > QGeoTileRequestManagerPrivate::sendRequests(QSet<QGeoTileSpec> requestTiles,
+                                                                                   const QSet<QGeoTileSpec> &cancelTiles)
+{
+    QSet<QGeoTileSpec> cached;
+
     typedef QSet<QGeoTileSpec>::const_iterator iter;
 
     QList<QSharedPointer<QGeoTileTexture> > cachedTex;
@@ -131,6 +187,9 @@ QList<QSharedPointer<QGeoTileTexture> > QGeoTileRequestManagerPrivate::requestTi
             if (tex) {
                 cachedTex << tex;
                 cached.insert(tile);
+            } else if (engine->tileCache()->isDecodePending(tile)) {
+                // the cache will tell the map once it has been decoded
+                cached.insert(tile);
             }
         }
     }
@@ -169,6 +228,23 @@ void QGeoTileRequestManagerPrivate::tileFetched(const QGeoTileSpec &spec)
     futures_.remove(spec);
 }
 
+void QGeoTileRequestManagerPrivate::tileDecodeFailed(const QGeoTileSpec &spec)
+{
+    if (requested_.contains(spec) || !map_)
+        return;
+
+    QGeoTiledMappingManagerEngine *engine =
+            static_cast<QGeoTiledMappingManagerEngine *>(map_->engine());
+    if (!engine)
+        return;
+
+    // not through sendRequests(), which would look in the cache again
+    QSet<QGeoTileSpec> requestTiles;
+    requestTiles.insert(spec);
+    requested_.insert(spec);
+    engine->updateTileRequests(map_, requestTiles, QSet<QGeoTileSpec>());
+}
+
 // Represents a tile that needs to be retried after a certain period of time
 class RetryFuture : public QObject
 {
@@ -74,9 +74,12 @@ public:
     ~QGeoTileRequestManager();
 
     QList<QSharedPointer<QGeoTileTexture> > requestTiles(const QSet<QGeoTileSpec> &tiles);
+    QList<QSharedPointer<QGeoTileTexture> > updateTiles(const QSet<QGeoTileSpec> &added,
+                                                        const QSet<QGeoTileSpec> &removed);
 
     void tileError(const QGeoTileSpec &tile, const QString &errorString);
     void tileFetched(const QGeoTileSpec &spec);
+    void tileDecodeFailed(const QGeoTileSpec &spec);
 private:
     QGeoTileRequestManagerPrivate *d_ptr;
     Q_DECLARE_PRIVATE(QGeoTileRequestManager)
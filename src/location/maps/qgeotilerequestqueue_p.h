@@ -0,0 +1,141 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGEOTILEREQUESTQUEUE_P_H
+#define QGEOTILEREQUESTQUEUE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QVector>
+
+#include "qgeotilekey_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * One change to the set of tiles an engine wants from its fetcher: the
+ * tiles to start fetching, the tiles no map needs any more and the tiles
+ * to fetch once nothing else is waiting.
+ */
+struct QGeoTileRequestDelta
+{
+    QGeoTileRequestDelta() : next(0) {}
+
+    QVector<QGeoTileKey> added;
+    QVector<QGeoTileKey> removed;
+    QVector<QGeoTileKey> prefetched;
+
+    QGeoTileRequestDelta *next;
+};
+
+/*
+ * Hands QGeoTileRequestDeltas from any number of threads to a single
+ * consumer (the fetcher thread) without taking a lock.
+ *
+ * push() links the delta into a stack with a compare-and-swap; takeAll()
+ * swaps the whole stack out at once and reverses it, so deltas come out
+ * in the order they were pushed. As the consumer never pops single
+ * nodes there is no ABA problem.
+ *
+ * push() returns true when the queue was empty, which is when the
+ * consumer needs to be woken up. Deltas pushed before the consumer gets
+ * round to takeAll() ride along with that single wake-up.
+ */
+class QGeoTileRequestQueue
+{
+public:
+    inline QGeoTileRequestQueue() : head_(0) {}
+    inline ~QGeoTileRequestQueue()
+    {
+        QGeoTileRequestDelta *delta = takeAll();
+        while (delta) {
+            QGeoTileRequestDelta *next = delta->next;
+            delete delta;
+            delta = next;
+        }
+    }
+
+    inline bool push(QGeoTileRequestDelta *delta)
+    {
+        QGeoTileRequestDelta *head;
+        do {
+            head = head_.loadAcquire();
+            delta->next = head;
+        } while (!head_.testAndSetRelease(head, delta));
+        return head == 0;
+    }
+
+    // the caller owns the returned list, oldest delta first
+    inline QGeoTileRequestDelta *takeAll()
+    {
+        QGeoTileRequestDelta *delta = head_.fetchAndStoreAcquire(0);
+
+        QGeoTileRequestDelta *ordered = 0;
+        while (delta) {
+            QGeoTileRequestDelta *next = delta->next;
+            delta->next = ordered;
+            ordered = delta;
+            delta = next;
+        }
+        return ordered;
+    }
+
+    inline bool isEmpty() const { return head_.loadAcquire() == 0; }
+
+private:
+    QAtomicPointer<QGeoTileRequestDelta> head_;
+
+    Q_DISABLE_COPY(QGeoTileRequestQueue)
+};
+
+QT_END_NAMESPACE
+
+#endif // QGEOTILEREQUESTQUEUE_P_H
@@ -41,16 +41,68 @@
 
 #include "qgeotilespec_p.h"
 #include "qgeotilespec_p_p.h"
+#include "qgeotilekey_p.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QHash>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QVector>
 
 QT_BEGIN_NAMESPACE
 
+// Plugin names are interned so that tile specs only carry (and compare) an int.
+// Id 0 is reserved for the empty name.
+class QGeoTilePluginRegistry
+{
+public:
+    QGeoTilePluginRegistry()
+    {
+        names_.append(QString());
+        ids_.insert(QString(), 0);
+    }
+
+    int intern(const QString &plugin)
+    {
+        {
+            QReadLocker rl(&lock_);
+            QHash<QString, int>::const_iterator it = ids_.constFind(plugin);
+            if (it != ids_.constEnd())
+                return it.value();
+        }
+
+        QWriteLocker wl(&lock_);
+        QHash<QString, int>::const_iterator it = ids_.constFind(plugin);
+        if (it != ids_.constEnd())
+            return it.value();
+        int id = names_.size();
+        names_.append(plugin);
+        ids_.insert(plugin, id);
+        return id;
+    }
+
+    QString name(int id)
+    {
+        QReadLocker rl(&lock_);
+        return names_.value(id);
+    }
+
+private:
+    QReadWriteLock lock_;
+    QHash<QString, int> ids_;
+    QVector<QString> names_;
+};
+
+Q_GLOBAL_STATIC(QGeoTilePluginRegistry, pluginRegistry)
+
 QGeoTileSpec::QGeoTileSpec()
     : d(QSharedDataPointer<QGeoTileSpecPrivate>(new QGeoTileSpecPrivate())) {}
 
 QGeoTileSpec::QGeoTileSpec(const QString &plugin, int mapId, int zoom, int x, int y)
-        : d(QSharedDataPointer<QGeoTileSpecPrivate>(new QGeoTileSpecPrivate(plugin, mapId, zoom, x, y))) {}
+        : d(QSharedDataPointer<QGeoTileSpecPrivate>(new QGeoTileSpecPrivate(internPlugin(plugin), mapId, zoom, x, y))) {}
+
+QGeoTileSpec::QGeoTileSpec(const QGeoTileKey &key)
+        : d(QSharedDataPointer<QGeoTileSpecPrivate>(new QGeoTileSpecPrivate(key.pluginId(), key.mapId(),
+                                                                           key.zoom(), key.x(), key.y()))) {}
 
 QGeoTileSpec::QGeoTileSpec(const QGeoTileSpec &other)
     : d(other.d) {}
@@ -69,7 +121,26 @@ QGeoTileSpec &QGeoTileSpec::operator = (const QGeoTileSpec &other)
 
 QString QGeoTileSpec::plugin() const
 {
-    return d->plugin_;
+    return pluginName(d->pluginId_);
+}
+
+int QGeoTileSpec::pluginId() const
+{
+    return d->pluginId_;
+}
+
+int QGeoTileSpec::internPlugin(const QString &plugin)
+{
+    if (plugin.isEmpty())
+        return 0;
+    return pluginRegistry()->intern(plugin);
+}
+
+QString QGeoTileSpec::pluginName(int pluginId)
+{
+    if (pluginId == 0)
+        return QString();
+    return pluginRegistry()->name(pluginId);
 }
 
 void QGeoTileSpec::setZoom(int zoom)
@@ -112,6 +183,11 @@ int QGeoTileSpec::mapId() const
     return d->mapId_;
 }
 
+QGeoTileKey QGeoTileSpec::key() const
+{
+    return QGeoTileKey(d->pluginId_, d->mapId_, d->zoom_, d->x_, d->y_);
+}
+
 bool QGeoTileSpec::operator == (const QGeoTileSpec &rhs) const
 {
     return (*(d.constData()) == *(rhs.d.constData()));
@@ -124,12 +200,7 @@ bool QGeoTileSpec::operator < (const QGeoTileSpec &rhs) const
 
 unsigned int qHash(const QGeoTileSpec &spec)
 {
-    unsigned int result = (qHash(spec.plugin()) * 13) % 31;
-    result += ((spec.mapId() * 17) % 31) << 5;
-    result += ((spec.zoom() * 19) % 31) << 10;
-    result += ((spec.x() * 23) % 31) << 15;
-    result += ((spec.y() * 29) % 31) << 20;
-    return result;
+    return qHash(spec.key());
 }
 
 QDebug operator<< (QDebug dbg, const QGeoTileSpec &spec)
@@ -139,21 +210,22 @@ QDebug operator<< (QDebug dbg, const QGeoTileSpec &spec)
 }
 
 QGeoTileSpecPrivate::QGeoTileSpecPrivate()
-    : mapId_(0),
+    : pluginId_(0),
+    mapId_(0),
     zoom_(-1),
     x_(-1),
     y_(-1) {}
 
 QGeoTileSpecPrivate::QGeoTileSpecPrivate(const QGeoTileSpecPrivate &other)
     : QSharedData(other),
-      plugin_(other.plugin_),
+      pluginId_(other.pluginId_),
       mapId_(other.mapId_),
       zoom_(other.zoom_),
       x_(other.x_),
       y_(other.y_) {}
 
-QGeoTileSpecPrivate::QGeoTileSpecPrivate(const QString &plugin, int mapId, int zoom, int x, int y)
-    : plugin_(plugin),
+QGeoTileSpecPrivate::QGeoTileSpecPrivate(int pluginId, int mapId, int zoom, int x, int y)
+    : pluginId_(pluginId),
       mapId_(mapId),
       zoom_(zoom),
       x_(x),
@@ -166,7 +238,7 @@ QGeoTileSpecPrivate &QGeoTileSpecPrivate::operator = (const QGeoTileSpecPrivate
     if (this == &other)
         return *this;
 
-    plugin_ = other.plugin_;
+    pluginId_ = other.pluginId_;
     mapId_ = other.mapId_;
     zoom_ = other.zoom_;
     x_ = other.x_;
@@ -177,7 +249,7 @@ QGeoTileSpecPrivate &QGeoTileSpecPrivate::operator = (const QGeoTileSpecPrivate
 
 bool QGeoTileSpecPrivate::operator == (const QGeoTileSpecPrivate &rhs) const
 {
-    if (plugin_ != rhs.plugin_)
+    if (pluginId_ != rhs.pluginId_)
         return false;
 
     if (mapId_ != rhs.mapId_)
@@ -197,10 +269,9 @@ bool QGeoTileSpecPrivate::operator == (const QGeoTileSpecPrivate &rhs) const
 
 bool QGeoTileSpecPrivate::operator < (const QGeoTileSpecPrivate &rhs) const
 {
-    if (plugin_ < rhs.plugin_)
-        return true;
-    if (plugin_ > rhs.plugin_)
-        return false;
+    // ids are handed out in registration order, so order by name
+    if (pluginId_ != rhs.pluginId_)
+        return QGeoTileSpec::pluginName(pluginId_) < QGeoTileSpec::pluginName(rhs.pluginId_);
 
     if (mapId_ < rhs.mapId_)
         return true;
@@ -62,6 +62,7 @@
 QT_BEGIN_NAMESPACE
 
 class QGeoTileSpecPrivate;
+class QGeoTileKey;
 
 class Q_LOCATION_EXPORT QGeoTileSpec
 {
@@ -69,11 +70,13 @@ public:
     QGeoTileSpec();
     QGeoTileSpec(const QGeoTileSpec &other);
     QGeoTileSpec(const QString &plugin, int mapId, int zoom, int x, int y);
+    explicit QGeoTileSpec(const QGeoTileKey &key);
     ~QGeoTileSpec();
 
     QGeoTileSpec &operator = (const QGeoTileSpec &other);
 
     QString plugin() const;
+    int pluginId() const;
 
     void setZoom(int zoom);
     int zoom() const;
@@ -87,6 +90,11 @@ public:
     void setMapId(int mapId);
     int mapId() const;
 
+    QGeoTileKey key() const;
+
+    static int internPlugin(const QString &plugin);
+    static QString pluginName(int pluginId);
+
     bool operator == (const QGeoTileSpec &rhs) const;
     bool operator < (const QGeoTileSpec &rhs) const;
 
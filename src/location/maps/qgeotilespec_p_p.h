@@ -62,7 +62,7 @@ class QGeoTileSpecPrivate : public QSharedData
 public:
     QGeoTileSpecPrivate();
     QGeoTileSpecPrivate(const QGeoTileSpecPrivate &other);
-    QGeoTileSpecPrivate(const QString &plugin, int mapId, int zoom, int x, int y);
+    QGeoTileSpecPrivate(int pluginId, int mapId, int zoom, int x, int y);
     ~QGeoTileSpecPrivate();
 
     QGeoTileSpecPrivate &operator = (const QGeoTileSpecPrivate &other);
@@ -70,7 +70,7 @@ public:
     bool operator == (const QGeoTileSpecPrivate &rhs) const;
     bool operator < (const QGeoTileSpecPrivate &rhs) const;
 
-    QString plugin_;
+    int pluginId_;
     int mapId_;
     int zoom_;
     int x_;
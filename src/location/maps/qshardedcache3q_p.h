@@ -0,0 +1,306 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSHARDEDCACHE3Q_H
+#define QSHARDEDCACHE3Q_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#include "qcache3q_p.h"
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qthread.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * QShardedCache3Q
+ *
+ * A QCache3Q which can be used from several threads at once. Keys are spread
+ * over a fixed number of shards by their hash, each shard being a QCache3Q
+ * with its own lock, so that threads working on different keys rarely wait
+ * for each other. The 3Q policy is applied within each shard.
+ *
+ * The cost budget is global: setMaxCost() splits it evenly over the shards,
+ * which with a reasonable hash keeps the total close to what a single QCache3Q
+ * would hold. An object costing more than one shard's share can't be cached.
+ *
+ * The eviction policy is called with the shard's lock held, so it must not
+ * call back into the cache. Everything else, including the objects handed
+ * out, may be used from any thread.
+ */
+template <class Key, class T, class EvPolicy = QCache3QDefaultEvictionPolicy<Key,T> >
+class QShardedCache3Q
+{
+public:
+    explicit QShardedCache3Q(int maxCost = 100, int shardCount = -1);
+    ~QShardedCache3Q();
+
+    inline int shardCount() const { return shards_.size(); }
+
+    int maxCost() const;
+    void setMaxCost(int maxCost);
+    int totalCost() const;
+
+    void setPromoteAt(int p);
+    bool isAdaptive() const;
+    void setAdaptive(bool adaptive);
+
+    void clear();
+    bool insert(const Key &key, QSharedPointer<T> object, int cost = 1);
+    QSharedPointer<T> object(const Key &key) const;
+    QSharedPointer<T> operator[](const Key &key) const;
+
+    void remove(const Key &key);
+    bool contains(const Key &key) const;
+
+    void printStats();
+    // counters summed over the shards
+    QCache3QStats stats() const;
+    void resetStats();
+
+private:
+    struct Shard
+    {
+        Shard() : cache(0) {}
+        mutable QMutex mutex;
+        QCache3Q<Key,T,EvPolicy> cache;
+    };
+
+    inline Shard *shardFor(const Key &key) const
+    {
+        return shards_.at(qHash(key) % uint(shards_.size()));
+    }
+
+    // each shard is a separate allocation, keeping the locks of neighbouring
+    // shards off the same cache line
+    QVector<Shard *> shards_;
+    int maxCost_;
+
+    Q_DISABLE_COPY(QShardedCache3Q)
+};
+
+template <class Key, class T, class EvPolicy>
+QShardedCache3Q<Key,T,EvPolicy>::QShardedCache3Q(int maxCost, int shardCount)
+    : maxCost_(0)
+{
+    // a few shards per core keeps the chance of two threads meeting low,
+    // more would only fragment the budget
+    if (shardCount <= 0)
+        shardCount = qBound(4, QThread::idealThreadCount() * 2, 32);
+
+    shards_.reserve(shardCount);
+    for (int i = 0; i < shardCount; ++i)
+        shards_.append(new Shard);
+
+    setMaxCost(maxCost);
+}
+
+template <class Key, class T, class EvPolicy>
+QShardedCache3Q<Key,T,EvPolicy>::~QShardedCache3Q()
+{
+    qDeleteAll(shards_);
+}
+
+template <class Key, class T, class EvPolicy>
+int QShardedCache3Q<Key,T,EvPolicy>::maxCost() const
+{
+    return maxCost_;
+}
+
+template <class Key, class T, class EvPolicy>
+void QShardedCache3Q<Key,T,EvPolicy>::setMaxCost(int maxCost)
+{
+    maxCost_ = maxCost;
+
+    const int n = shards_.size();
+    for (int i = 0; i < n; ++i) {
+        // hand the remainder out one by one so the shares add up exactly
+        int share = maxCost / n + (i < maxCost % n ? 1 : 0);
+        QMutexLocker ml(&shards_[i]->mutex);
+        shards_[i]->cache.setMaxCost(share);
+    }
+}
+
+template <class Key, class T, class EvPolicy>
+int QShardedCache3Q<Key,T,EvPolicy>::totalCost() const
+{
+    int cost = 0;
+    for (int i = 0; i < shards_.size(); ++i) {
+        QMutexLocker ml(&shards_[i]->mutex);
+        cost += shards_[i]->cache.totalCost();
+    }
+    return cost;
+}
+
+template <class Key, class T, class EvPolicy>
+void QShardedCache3Q<Key,T,EvPolicy>::setPromoteAt(int p)
+{
+    for (int i = 0; i < shards_.size(); ++i) {
+        QMutexLocker ml(&shards_[i]->mutex);
+        shards_[i]->cache.setPromoteAt(p);
+    }
+}
+
+// all shards are switched together, so the first one speaks for them
+template <class Key, class T, class EvPolicy>
+bool QShardedCache3Q<Key,T,EvPolicy>::isAdaptive() const
+{
+    QMutexLocker ml(&shards_.first()->mutex);
+    return shards_.first()->cache.isAdaptive();
+}
+
+template <class Key, class T, class EvPolicy>
+void QShardedCache3Q<Key,T,EvPolicy>::setAdaptive(bool adaptive)
+{
+    for (int i = 0; i < shards_.size(); ++i) {
+        QMutexLocker ml(&shards_[i]->mutex);
+        shards_[i]->cache.setAdaptive(adaptive);
+    }
+}
+
+template <class Key, class T, class EvPolicy>
+void QShardedCache3Q<Key,T,EvPolicy>::clear()
+{
+    for (int i = 0; i < shards_.size(); ++i) {
+        QMutexLocker ml(&shards_[i]->mutex);
+        shards_[i]->cache.clear();
+    }
+}
+
+template <class Key, class T, class EvPolicy>
+bool QShardedCache3Q<Key,T,EvPolicy>::insert(const Key &key, QSharedPointer<T> object, int cost)
+{
+    Shard *shard = shardFor(key);
+    QMutexLocker ml(&shard->mutex);
+    return shard->cache.insert(key, object, cost);
+}
+
+template <class Key, class T, class EvPolicy>
+QSharedPointer<T> QShardedCache3Q<Key,T,EvPolicy>::object(const Key &key) const
+{
+    Shard *shard = shardFor(key);
+    QMutexLocker ml(&shard->mutex);
+    return shard->cache.object(key);
+}
+
+template <class Key, class T, class EvPolicy>
+inline QSharedPointer<T> QShardedCache3Q<Key,T,EvPolicy>::operator[](const Key &key) const
+{
+    return object(key);
+}
+
+template <class Key, class T, class EvPolicy>
+void QShardedCache3Q<Key,T,EvPolicy>::remove(const Key &key)
+{
+    Shard *shard = shardFor(key);
+    QMutexLocker ml(&shard->mutex);
+    shard->cache.remove(key);
+}
+
+template <class Key, class T, class EvPolicy>
+bool QShardedCache3Q<Key,T,EvPolicy>::contains(const Key &key) const
+{
+    Shard *shard = shardFor(key);
+    QMutexLocker ml(&shard->mutex);
+    return shard->cache.contains(key);
+}
+
+template <class Key, class T, class EvPolicy>
+void QShardedCache3Q<Key,T,EvPolicy>::printStats()
+{
+    for (int i = 0; i < shards_.size(); ++i) {
+        QMutexLocker ml(&shards_[i]->mutex);
+        shards_[i]->cache.printStats();
+    }
+}
+
+template <class Key, class T, class EvPolicy>
+QCache3QStats QShardedCache3Q<Key,T,EvPolicy>::stats() const
+{
+    QCache3QStats total;
+    for (int i = 0; i < shards_.size(); ++i) {
+        QCache3QStats s;
+        {
+            QMutexLocker ml(&shards_[i]->mutex);
+            s = shards_[i]->cache.stats();
+        }
+        total.hits += s.hits;
+        total.misses += s.misses;
+        total.ghostHits += s.ghostHits;
+        total.promotions += s.promotions;
+        total.evictions += s.evictions;
+        total.costIn += s.costIn;
+        total.costOut += s.costOut;
+        total.count += s.count;
+        total.cost += s.cost;
+        total.maxCost += s.maxCost;
+        total.newbies += s.newbies;
+        total.regulars += s.regulars;
+        total.hobos += s.hobos;
+        total.ghosts += s.ghosts;
+        total.minRecent += s.minRecent;
+        total.maxOldPopular += s.maxOldPopular;
+    }
+    return total;
+}
+
+template <class Key, class T, class EvPolicy>
+void QShardedCache3Q<Key,T,EvPolicy>::resetStats()
+{
+    for (int i = 0; i < shards_.size(); ++i) {
+        QMutexLocker ml(&shards_[i]->mutex);
+        shards_[i]->cache.resetStats();
+    }
+}
+
+QT_END_NAMESPACE
+
+#endif // QSHARDEDCACHE3Q_H
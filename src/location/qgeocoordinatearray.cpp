@@ -0,0 +1,181 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgeocoordinatearray_p.h"
+#include "qlocationutils_p.h"
+
+QT_BEGIN_NAMESPACE
+
+QGeoCoordinateArray::QGeoCoordinateArray(const QList<QGeoCoordinate> &coordinates)
+{
+    reserve(coordinates.size());
+    for (int i = 0; i < coordinates.size(); ++i)
+        append(coordinates.at(i));
+}
+
+void QGeoCoordinateArray::reserve(int size)
+{
+    lat_.reserve(size);
+    lon_.reserve(size);
+    alt_.reserve(size);
+}
+
+void QGeoCoordinateArray::clear()
+{
+    lat_.clear();
+    lon_.clear();
+    alt_.clear();
+}
+
+void QGeoCoordinateArray::append(double latitude, double longitude, double altitude)
+{
+    lat_.append(latitude);
+    lon_.append(longitude);
+    alt_.append(altitude);
+}
+
+void QGeoCoordinateArray::append(const QGeoCoordinate &coordinate)
+{
+    append(coordinate.latitude(), coordinate.longitude(), coordinate.altitude());
+}
+
+void QGeoCoordinateArray::append(const QGeoCoordinateArray &other)
+{
+    lat_ += other.lat_;
+    lon_ += other.lon_;
+    alt_ += other.alt_;
+}
+
+void QGeoCoordinateArray::replace(int i, const QGeoCoordinate &coordinate)
+{
+    lat_[i] = coordinate.latitude();
+    lon_[i] = coordinate.longitude();
+    alt_[i] = coordinate.altitude();
+}
+
+void QGeoCoordinateArray::removeAt(int i)
+{
+    lat_.remove(i);
+    lon_.remove(i);
+    alt_.remove(i);
+}
+
+/*
+    Returns the index of the last coordinate equal to \a coordinate, compared
+    like QGeoCoordinate::operator==() does, or -1 if there is none.
+*/
+int QGeoCoordinateArray::lastIndexOf(const QGeoCoordinate &coordinate) const
+{
+    double lat = coordinate.latitude();
+    double lon = coordinate.longitude();
+    double alt = coordinate.altitude();
+    for (int i = size() - 1; i >= 0; --i) {
+        if (equals(i, lat, lon, alt))
+            return i;
+    }
+    return -1;
+}
+
+bool QGeoCoordinateArray::isValid(int i) const
+{
+    return QLocationUtils::isValidLat(lat_.at(i)) && QLocationUtils::isValidLong(lon_.at(i));
+}
+
+QGeoCoordinate QGeoCoordinateArray::at(int i) const
+{
+    // the constructor leaves out of range, and so NaN, values unset
+    return QGeoCoordinate(lat_.at(i), lon_.at(i), alt_.at(i));
+}
+
+QList<QGeoCoordinate> QGeoCoordinateArray::toList() const
+{
+    QList<QGeoCoordinate> coordinates;
+    coordinates.reserve(size());
+    for (int i = 0; i < size(); ++i)
+        coordinates.append(at(i));
+    return coordinates;
+}
+
+/*
+    Writes the latitude and longitude of each coordinate in turn to
+    \a latLon, which must have room for twice size() doubles. That is the
+    layout QGeoProjection::coordinatesToMercator() and
+    QGeoMap::coordinatesToScreenPositions() take.
+*/
+void QGeoCoordinateArray::copyLatLon(double *latLon) const
+{
+    const double *lat = lat_.constData();
+    const double *lon = lon_.constData();
+    for (int i = 0; i < size(); ++i) {
+        latLon[2 * i] = lat[i];
+        latLon[2 * i + 1] = lon[i];
+    }
+}
+
+bool QGeoCoordinateArray::operator==(const QGeoCoordinateArray &other) const
+{
+    if (size() != other.size())
+        return false;
+    for (int i = 0; i < size(); ++i) {
+        if (!equals(i, other.lat_.at(i), other.lon_.at(i), other.alt_.at(i)))
+            return false;
+    }
+    return true;
+}
+
+// the same comparison as QGeoCoordinate::operator==()
+bool QGeoCoordinateArray::equals(int i, double latitude, double longitude, double altitude) const
+{
+    double lat = lat_.at(i);
+    double lon = lon_.at(i);
+    double alt = alt_.at(i);
+
+    bool latEqual = (qIsNaN(lat) && qIsNaN(latitude)) || qFuzzyCompare(lat, latitude);
+    bool lngEqual = (qIsNaN(lon) && qIsNaN(longitude)) || qFuzzyCompare(lon, longitude);
+    bool altEqual = (qIsNaN(alt) && qIsNaN(altitude)) || qFuzzyCompare(alt, altitude);
+
+    if (!qIsNaN(lat) && ((lat == 90.0) || (lat == -90.0)))
+        lngEqual = true;
+
+    return latEqual && lngEqual && altEqual;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,130 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtLocation module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGEOCOORDINATEARRAY_P_H
+#define QGEOCOORDINATEARRAY_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtLocation/qlocationglobal.h>
+#include <QtCore/qnumeric.h>
+#include <QList>
+#include <QVector>
+
+#include "qgeocoordinate.h"
+
+QT_BEGIN_NAMESPACE
+
+/*
+ * QGeoCoordinateArray
+ *
+ * A list of coordinates stored as one array each of latitudes, longitudes
+ * and altitudes, for paths of many points. Unlike a QList<QGeoCoordinate>
+ * it doesn't allocate per coordinate, and walking the latitudes and
+ * longitudes reads contiguous memory. Copies are implicitly shared.
+ *
+ * Invalid coordinates and missing altitudes are stored as NaN, like
+ * QGeoCoordinate does, so converting from and back to a list is lossless.
+ */
+class Q_LOCATION_EXPORT QGeoCoordinateArray
+{
+public:
+    QGeoCoordinateArray() {}
+    explicit QGeoCoordinateArray(const QList<QGeoCoordinate> &coordinates);
+
+    inline int size() const { return lat_.size(); }
+    inline int count() const { return lat_.size(); }
+    inline bool isEmpty() const { return lat_.isEmpty(); }
+
+    void reserve(int size);
+    void clear();
+
+    void append(double latitude, double longitude, double altitude = qQNaN());
+    void append(const QGeoCoordinate &coordinate);
+    void append(const QGeoCoordinateArray &other);
+    void replace(int i, const QGeoCoordinate &coordinate);
+    void removeAt(int i);
+    int lastIndexOf(const QGeoCoordinate &coordinate) const;
+
+    inline double latitude(int i) const { return lat_.at(i); }
+    inline double longitude(int i) const { return lon_.at(i); }
+    inline double altitude(int i) const { return alt_.at(i); }
+    bool isValid(int i) const;
+
+    inline const double *latitudes() const { return lat_.constData(); }
+    inline const double *longitudes() const { return lon_.constData(); }
+    inline const double *altitudes() const { return alt_.constData(); }
+
+    QGeoCoordinate at(int i) const;
+    QList<QGeoCoordinate> toList() const;
+
+    void copyLatLon(double *latLon) const;
+
+    // true if other is an unmodified copy of this array, without comparing
+    inline bool isSharedWith(const QGeoCoordinateArray &other) const
+    { return lat_.isSharedWith(other.lat_) && lon_.isSharedWith(other.lon_); }
+
+    bool operator==(const QGeoCoordinateArray &other) const;
+    inline bool operator!=(const QGeoCoordinateArray &other) const
+    { return !operator==(other); }
+
+private:
+    bool equals(int i, double latitude, double longitude, double altitude) const;
+
+    QVector<double> lat_;
+    QVector<double> lon_;
+    QVector<double> alt_;
+};
+
+Q_DECLARE_TYPEINFO(QGeoCoordinateArray, Q_MOVABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QGEOCOORDINATEARRAY_P_H
@@ -54,6 +54,7 @@
 #include <QString>
 
 #include <qgeoroute.h>
+#include <QtLocation/private/qgeoroutesegment_p.h>
 #include <QtLocation/QGeoRectangle>
 
 QT_BEGIN_NAMESPACE
@@ -276,9 +277,8 @@ bool QGeoRouteXmlParser::postProcessRoute(QGeoRoute *route)
             compactedRouteSegments.removeLast();
             lastSegment.setDistance(lastSegment.distance() + segment.distance());
             lastSegment.setTravelTime(lastSegment.travelTime() + segment.travelTime());
-            QList<QGeoCoordinate> path = lastSegment.path();
-            path.append(segment.path());
-            lastSegment.setPath(path);
+            QGeoRouteSegmentPrivate::get(lastSegment)->path.append(
+                        QGeoRouteSegmentPrivate::get(segment)->path);
             lastSegment.setManeuver(segment.maneuver());
             compactedRouteSegments.append(lastSegment);
         }
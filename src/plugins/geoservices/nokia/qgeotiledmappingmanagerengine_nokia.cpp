@@ -108,7 +108,11 @@ QGeoTiledMappingManagerEngineNokia::QGeoTiledMappingManagerEngineNokia(
     if (parameters.contains(QLatin1String("mapping.cache.directory")))
         cacheDir = parameters.value(QLatin1String("mapping.cache.directory")).toString();
 
-    QGeoTileCache *tileCache = createTileCacheWithDir(cacheDir);
+    DiskCacheStorage storage = FileStorage;
+    if (parameters.value(QLatin1String("mapping.cache.disk.storage")).toString() == QLatin1String("pack"))
+        storage = PackStorage;
+
+    QGeoTileCache *tileCache = createTileCacheWithDir(cacheDir, storage);
 
     if (parameters.contains(QLatin1String("mapping.cache.disk.size"))) {
       bool ok = false;
@@ -124,6 +128,19 @@ QGeoTiledMappingManagerEngineNokia::QGeoTiledMappingManagerEngineNokia(
           tileCache->setMaxMemoryUsage(cacheSize);
     }
 
+    if (parameters.contains(QLatin1String("mapping.cache.memory.compression")))
+        tileCache->setMemoryCompression(parameters.value(QLatin1String("mapping.cache.memory.compression")).toBool());
+
+    if (parameters.contains(QLatin1String("mapping.cache.adaptive")))
+        tileCache->setAdaptive(parameters.value(QLatin1String("mapping.cache.adaptive")).toBool());
+
+    if (parameters.contains(QLatin1String("mapping.cache.image.size"))) {
+      bool ok = false;
+      int cacheSize = parameters.value(QLatin1String("mapping.cache.image.size")).toString().toInt(&ok);
+      if (ok)
+          tileCache->setMaxImageUsage(cacheSize);
+    }
+
     if (parameters.contains(QLatin1String("mapping.cache.texture.size"))) {
       bool ok = false;
       int cacheSize = parameters.value(QLatin1String("mapping.cache.texture.size")).toString().toInt(&ok);
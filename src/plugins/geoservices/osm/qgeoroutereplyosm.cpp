@@ -237,12 +237,14 @@ static QGeoRoute constructRoute(const QByteArray &geometry, const QJsonArray &in
 
         segment.setManeuver(maneuver);
 
+        QList<QGeoCoordinate> segmentPath;
         if (firstPosition == -1)
-            segment.setPath(path.mid(position));
+            segmentPath = path.mid(position);
         else
-            segment.setPath(path.mid(position, firstPosition - position));
+            segmentPath = path.mid(position, firstPosition - position);
+        segment.setPath(segmentPath);
 
-        segmentPathLengthCount += segment.path().length();
+        segmentPathLengthCount += segmentPath.length();
 
         segment.setTravelTime(time);
 
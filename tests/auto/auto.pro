@@ -39,6 +39,7 @@ SUBDIRS += \
            qgeorectangle \
            qgeocircle \
            qgeocoordinate \
+           qgeocoordinatearray \
            qgeolocation \
            qgeopositioninfo \
            qgeopositioninfosource \
@@ -60,6 +61,13 @@ qtHaveModule(3d) {
            qgeocodingmanager \
            qgeomaneuver \
            qgeomapscene \
+           qgeomappolygontriangles \
+           qgeomapcirclebatch \
+           qgeomapgeometryjob \
+           qgeomappolylinehitgrid \
+           qgeoprojection \
+           qgeosimplifiedpath \
+           qgeospatialindex \
            qgeoroute \
            qgeoroutereply \
            qgeorouterequest \
@@ -67,6 +75,10 @@ qtHaveModule(3d) {
            qgeoroutingmanager \
            qgeoroutingmanagerplugins \
            qgeotilespec \
+           qgeotilecache \
+           qcache3q \
+           qshardedcache3q \
+           qgeotiledmappingmanagerengine \
            qgeoroutexmlparser \
            qgeomapcontroller \
            maptype \
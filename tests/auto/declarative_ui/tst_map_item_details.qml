@@ -232,6 +232,12 @@ Item {
         }
     }
 
+    MapPolygon {
+        id: extMapPolygonLarge
+        color: 'lightsteelblue'
+        border.width: 2
+    }
+
     MapPolygon {
         id: extMapPolygonEdge
         color: 'darkmagenta'
@@ -350,6 +356,27 @@ Item {
             verify(extMapPolygon.path.length == 0)
         }
 
+        function test_polygon_border_settles() {
+            map.clearMapItems()
+            // long enough for the border to be simplified on a worker thread
+            var path = []
+            for (var i = 0; i < 1200; ++i) {
+                var angle = 2 * Math.PI * i / 1200
+                path.push(QtLocation.coordinate(20 + 10 * Math.sin(angle),
+                                                20 + 10 * Math.cos(angle)))
+            }
+            extMapPolygonLarge.path = path
+            compare(extMapPolygonLarge.path.length, 1200)
+            map.addMapItem(extMapPolygonLarge)
+
+            // once the simplified border is in, the polygon has nothing more
+            // to update and the scene stops rendering
+            wait(1000)
+            verify(!waitForRendering(map, 500))
+
+            map.removeMapItem(extMapPolygonLarge)
+        }
+
         function test_polyline() {
             map.clearMapItems()
             clear_data()
@@ -407,13 +407,56 @@ Item {
                     mapForTestingListModel.secondItemCoord.longitude);
             compare(mapForTestingListModel.mapItems[0].center.latitude,
                     mapForTestingListModel.secondItemCoord.latitude);
+            // inserted rows are added together on the next event loop pass
             testingListModel.append({ lat: 1, lon: 1 });
+            compare(mapForTestingListModel.mapItems.length, 2);
+            wait(0);
             compare(mapForTestingListModel.mapItems.length, 3);
             compare(mapForTestingListModel.mapItems[2].center.latitude, 1);
             testingListModel.clear();
             compare(mapForTestingListModel.mapItems.length, 0);
         }
 
+        function test_reuse_on_reset() {
+            routeQuery.numberAlternativeRoutes = 3
+            routeModel.update();
+            compare(mapForTestingRouteModel.mapItems.length, 3)
+            var items = [mapForTestingRouteModel.mapItems[0],
+                         mapForTestingRouteModel.mapItems[1],
+                         mapForTestingRouteModel.mapItems[2]]
+
+            // the delegates are kept for the new rows of the model
+            routeQuery.numberAlternativeRoutes = 2
+            routeModel.update();
+            compare(mapForTestingRouteModel.mapItems.length, 2)
+            verify(items.indexOf(mapForTestingRouteModel.mapItems[0]) >= 0)
+            verify(items.indexOf(mapForTestingRouteModel.mapItems[1]) >= 0)
+
+            // and those left over for rows added later
+            routeQuery.numberAlternativeRoutes = 3
+            routeModel.update();
+            compare(mapForTestingRouteModel.mapItems.length, 3)
+            for (var i = 0; i < 3; ++i)
+                verify(items.indexOf(mapForTestingRouteModel.mapItems[i]) >= 0)
+
+            // but no more are kept aside than the model has rows
+            routeQuery.numberAlternativeRoutes = 1
+            routeModel.update();
+            compare(mapForTestingRouteModel.mapItems.length, 1)
+            routeQuery.numberAlternativeRoutes = 3
+            routeModel.update();
+            compare(mapForTestingRouteModel.mapItems.length, 3)
+            var reused = 0
+            for (var j = 0; j < 3; ++j) {
+                if (items.indexOf(mapForTestingRouteModel.mapItems[j]) >= 0)
+                    ++reused
+            }
+            compare(reused, 2)
+
+            routeModel.reset();
+            compare(mapForTestingRouteModel.mapItems.length, 0)
+        }
+
         function test_routemodel() {
             testModel.reset();
             mapItemsChangedSpy.clear()
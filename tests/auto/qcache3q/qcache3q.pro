@@ -0,0 +1,8 @@
+CONFIG += testcase
+TARGET = tst_qcache3q
+
+INCLUDEPATH += ../../../src/location/maps
+
+SOURCES += tst_qcache3q.cpp
+
+QT += testlib
@@ -0,0 +1,361 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcache3q_p.h"
+
+#include <QtTest/QtTest>
+#include <QFile>
+#include <QVector>
+
+#include <cmath>
+
+QT_USE_NAMESPACE
+
+struct TraceKey
+{
+    int mapId;
+    int zoom;
+    int x;
+    int y;
+
+    bool operator==(const TraceKey &other) const
+    {
+        return mapId == other.mapId && zoom == other.zoom && x == other.x && y == other.y;
+    }
+};
+
+inline uint qHash(const TraceKey &key)
+{
+    return (uint(key.zoom) << 28) ^ (uint(key.mapId) << 24) ^ (uint(key.x) << 12) ^ uint(key.y);
+}
+
+class TraceTile
+{
+};
+
+typedef QCache3Q<TraceKey, TraceTile> TraceCache;
+
+Q_DECLARE_METATYPE(QVector<TraceKey>)
+
+class tst_QCache3Q : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QVector<TraceKey> panTrace(int seed, int frames);
+    static QVector<TraceKey> placesTrace(int seed, int frames);
+    static QVector<TraceKey> readTrace(const QString &fileName);
+    static double replay(const QVector<TraceKey> &trace, int maxCost, bool adaptive);
+
+private slots:
+    void staticTweakables();
+    void newbieGhostGrowsRecent();
+    void regularGhostShrinksRecent();
+    void adaptiveBounds();
+    void adaptiveSetMaxCost();
+    void replay_data();
+    void replay();
+};
+
+// Deterministic generator, so that both policies see the same trace
+static quint32 nextRandom(quint32 *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// Appends the 7x5 tiles of a viewport centred on (x, y), the lookups one
+// frame of a pan produces
+static void addViewport(QVector<TraceKey> *trace, int zoom, double x, double y)
+{
+    for (int i = -3; i <= 3; ++i) {
+        for (int j = -2; j <= 2; ++j) {
+            TraceKey key = { 1, zoom, int(x) + i, int(y) + j };
+            trace->append(key);
+        }
+    }
+}
+
+// Wandering pans with the odd zoom step and jumps back to the start
+QVector<TraceKey> tst_QCache3Q::panTrace(int seed, int frames)
+{
+    QVector<TraceKey> trace;
+    quint32 state = seed;
+    double x = 500, y = 500, vx = 0, vy = 0;
+    int zoom = 10;
+
+    for (int f = 0; f < frames; ++f) {
+        if (nextRandom(&state) % 50 == 0) {
+            int z = qBound(8, zoom + ((nextRandom(&state) & 1) ? 1 : -1), 14);
+            double scale = std::pow(2.0, z - zoom);
+            x *= scale;
+            y *= scale;
+            zoom = z;
+        }
+        if (nextRandom(&state) % 20 == 0) {
+            vx = (int(nextRandom(&state) % 5) - 2) * 0.5;
+            vy = (int(nextRandom(&state) % 5) - 2) * 0.5;
+        }
+        if (nextRandom(&state) % 200 == 0) {
+            double scale = std::pow(2.0, zoom - 10);
+            x = 500 * scale;
+            y = 500 * scale;
+        }
+        x += vx;
+        y += vy;
+        addViewport(&trace, zoom, x, y);
+    }
+    return trace;
+}
+
+// Browsing around a few places, zooming in and out, and panning between them
+QVector<TraceKey> tst_QCache3Q::placesTrace(int seed, int frames)
+{
+    static const double placeX[] = { 500, 560, 420, 700 };
+    static const double placeY[] = { 500, 530, 610, 380 };
+
+    QVector<TraceKey> trace;
+    quint32 state = seed;
+    double x = 500, y = 500;
+    int zoom = 12;
+    int place = 0;
+    int dwell = 0;
+
+    for (int f = 0; f < frames; ++f) {
+        if (dwell > 0) {
+            --dwell;
+            x += (int(nextRandom(&state) % 3) - 1) * 0.3;
+            y += (int(nextRandom(&state) % 3) - 1) * 0.3;
+            if (nextRandom(&state) % 15 == 0) {
+                int z = (nextRandom(&state) & 1) ? 13 : 12;
+                double scale = std::pow(2.0, z - zoom);
+                x *= scale;
+                y *= scale;
+                zoom = z;
+            }
+        } else {
+            double scale = std::pow(2.0, zoom - 12);
+            double dx = placeX[place] * scale - x;
+            double dy = placeY[place] * scale - y;
+            double d = std::sqrt(dx * dx + dy * dy);
+            if (d < 1) {
+                dwell = 40 + nextRandom(&state) % 80;
+                place = nextRandom(&state) % 4;
+            } else {
+                x += dx / d * qMin(d, 1.5);
+                y += dy / d * qMin(d, 1.5);
+            }
+        }
+        addViewport(&trace, zoom, x, y);
+    }
+    return trace;
+}
+
+// Reads a trace recorded with QT_LOCATION_TILE_TRACE set, one "mapId zoom x y"
+// line per tile cache lookup
+QVector<TraceKey> tst_QCache3Q::readTrace(const QString &fileName)
+{
+    QVector<TraceKey> trace;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return trace;
+
+    while (!file.atEnd()) {
+        QList<QByteArray> fields = file.readLine().simplified().split(' ');
+        if (fields.size() != 4)
+            continue;
+        TraceKey key = { fields.at(0).toInt(), fields.at(1).toInt(),
+                         fields.at(2).toInt(), fields.at(3).toInt() };
+        trace.append(key);
+    }
+    return trace;
+}
+
+// Replays the lookups the way QGeoTileCache uses its tiers: a miss is
+// fetched and inserted
+double tst_QCache3Q::replay(const QVector<TraceKey> &trace, int maxCost, bool adaptive)
+{
+    TraceCache cache(maxCost);
+    cache.setAdaptive(adaptive);
+
+    int hits = 0;
+    for (int i = 0; i < trace.size(); ++i) {
+        if (cache.object(trace.at(i)))
+            ++hits;
+        else
+            cache.insert(trace.at(i), QSharedPointer<TraceTile>(new TraceTile));
+    }
+    return trace.isEmpty() ? 0.0 : double(hits) / trace.size();
+}
+
+static void insertTiles(TraceCache *cache, int from, int to, bool lookUp)
+{
+    for (int i = from; i < to; ++i) {
+        TraceKey key = { 1, 10, i, 0 };
+        cache->insert(key, QSharedPointer<TraceTile>(new TraceTile));
+        if (lookUp)
+            cache->object(key);
+    }
+}
+
+static bool lookUpTile(TraceCache *cache, int x)
+{
+    TraceKey key = { 1, 10, x, 0 };
+    return cache->object(key);
+}
+
+void tst_QCache3Q::staticTweakables()
+{
+    TraceCache cache(100);
+    QVERIFY(!cache.isAdaptive());
+    QCOMPARE(cache.minRecent(), 33);
+    QCOMPARE(cache.maxOldPopular(), 20);
+
+    insertTiles(&cache, 0, 200, false);
+    for (int i = 0; i < 50; ++i)
+        QVERIFY(!lookUpTile(&cache, i));
+
+    QCOMPARE(cache.minRecent(), 33);
+    QCOMPARE(cache.maxOldPopular(), 20);
+    QCOMPARE(cache.stats().ghostHits, quint64(50));
+}
+
+void tst_QCache3Q::newbieGhostGrowsRecent()
+{
+    TraceCache cache(100);
+    cache.setAdaptive(true);
+    int before = cache.minRecent();
+
+    // never looked up, so all of them are newbies when evicted
+    insertTiles(&cache, 0, 200, false);
+    QVERIFY(!lookUpTile(&cache, 50));
+    QVERIFY(cache.minRecent() > before);
+}
+
+void tst_QCache3Q::regularGhostShrinksRecent()
+{
+    TraceCache cache(100);
+    cache.setAdaptive(true);
+    int before = cache.minRecent();
+
+    // looked up once, so promoted to regulars, which are evicted once the
+    // few newcomers don't exceed minRecent
+    insertTiles(&cache, 0, 100, true);
+    insertTiles(&cache, 100, 130, false);
+    QVERIFY(!lookUpTile(&cache, 0));
+    QVERIFY(cache.minRecent() < before);
+}
+
+void tst_QCache3Q::adaptiveBounds()
+{
+    TraceCache cache(120);
+    cache.setAdaptive(true);
+
+    for (int round = 0; round < 20; ++round) {
+        insertTiles(&cache, round * 1000, round * 1000 + 400, false);
+        for (int i = 0; i < 200; ++i)
+            lookUpTile(&cache, round * 1000 + i);
+    }
+    QCOMPARE(cache.minRecent(), 80);
+    QVERIFY(cache.minRecent() + cache.maxOldPopular() < cache.maxCost());
+    QVERIFY(cache.totalCost() <= cache.maxCost());
+}
+
+void tst_QCache3Q::adaptiveSetMaxCost()
+{
+    TraceCache cache(100);
+    cache.setAdaptive(true);
+    insertTiles(&cache, 0, 200, false);
+    for (int i = 0; i < 100; ++i)
+        lookUpTile(&cache, i);
+    int learnt = cache.minRecent();
+    QVERIFY(learnt > 33);
+
+    // what was learnt is kept, scaled to the new size
+    cache.setMaxCost(200);
+    QVERIFY(qAbs(cache.minRecent() - 2 * learnt) <= 1);
+
+    cache.setMaxCost(100, 30, 10);
+    QCOMPARE(cache.minRecent(), 30);
+    QCOMPARE(cache.maxOldPopular(), 10);
+}
+
+void tst_QCache3Q::replay_data()
+{
+    QTest::addColumn<QVector<TraceKey> >("trace");
+    QTest::addColumn<int>("maxCost");
+
+    QVector<TraceKey> pan = panTrace(1, 3000);
+    QVector<TraceKey> places = placesTrace(1, 6000);
+    QTest::newRow("pan, 64 tiles") << pan << 64;
+    QTest::newRow("pan, 256 tiles") << pan << 256;
+    QTest::newRow("places, 128 tiles") << places << 128;
+    QTest::newRow("places, 1024 tiles") << places << 1024;
+
+    // sessions recorded with QT_LOCATION_TILE_TRACE
+    QString recorded = QString::fromLocal8Bit(qgetenv("QCACHE3Q_TRACE"));
+    if (!recorded.isEmpty()) {
+        QVector<TraceKey> trace = readTrace(recorded);
+        QTest::newRow("recorded, 64 tiles") << trace << 64;
+        QTest::newRow("recorded, 256 tiles") << trace << 256;
+        QTest::newRow("recorded, 1024 tiles") << trace << 1024;
+    }
+}
+
+void tst_QCache3Q::replay()
+{
+    QFETCH(QVector<TraceKey>, trace);
+    QFETCH(int, maxCost);
+
+    if (trace.isEmpty())
+        QSKIP("Empty trace");
+
+    double fixedRate = replay(trace, maxCost, false);
+    double adaptiveRate = replay(trace, maxCost, true);
+
+    // the generated traces are mostly frame to frame repeats, which either
+    // policy catches; adapting must at least not cost anything noticeable
+    QVERIFY(adaptiveRate >= fixedRate - 0.01);
+}
+
+QTEST_MAIN(tst_QCache3Q)
+
+#include "tst_qcache3q.moc"
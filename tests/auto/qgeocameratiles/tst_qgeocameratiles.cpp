@@ -47,6 +47,9 @@
 #include "qgeoprojection_p.h"
 #include "qdoublevector2d_p.h"
 #include "qgeomaptype_p.h"
+#include "qgeorectangle.h"
+#include "qgeocircle.h"
+#include "qgeocoordinate.h"
 
 #include <qtest.h>
 
@@ -120,6 +123,78 @@ private:
         }
     }
 
+
+    /*
+        Replays a camera moving from \a from to \a to over \a frames frames
+        with an OutQuad easing, like a flick animation, and returns how many
+        tiles were not there yet when they first became visible. Every frame
+        the fetcher starts at most \a perFrame requests, visible tiles
+        first, and each takes \a latency frames. With a \a budget, the tiles
+        along the path are queued behind the visible ones at the start.
+    */
+    int replayMisses(const QGeoCameraData &from, const QGeoCameraData &to,
+                     int frames, int perFrame, int latency, int budget)
+    {
+        QGeoCameraTiles ct;
+        ct.setMaximumZoomLevel(19);
+        ct.setTileSize(256);
+        ct.setScreenSize(QSize(800, 480));
+        ct.setPluginString("pluginA");
+        ct.setMapType(QGeoMapType(QGeoMapType::StreetMap, "street map", "street map", false, 1));
+        ct.setCamera(from);
+
+        QList<QGeoTileSpec> prefetch;
+        if (budget > 0)
+            prefetch = ct.tilesAlongPath(to, budget);
+
+        QDoubleVector2D start = QGeoProjection::coordToMercator(from.center());
+        QDoubleVector2D end = QGeoProjection::coordToMercator(to.center());
+
+        QSet<QGeoTileSpec> seen;
+        QSet<QGeoTileSpec> requested;
+        QHash<QGeoTileSpec, int> arrival;
+        QList<QGeoTileSpec> visibleQueue;
+        int misses = 0;
+
+        for (int frame = 0; frame <= frames; ++frame) {
+            double t = 1.0 * frame / frames;
+            double eased = 1.0 - (1.0 - t) * (1.0 - t);
+
+            QGeoCameraData camera = from;
+            camera.setCenter(QGeoProjection::mercatorToCoord(start + eased * (end - start)));
+            camera.setZoomLevel(from.zoomLevel() + eased * (to.zoomLevel() - from.zoomLevel()));
+            ct.setCamera(camera);
+
+            foreach (const QGeoTileSpec &tile, ct.tiles()) {
+                if (seen.contains(tile))
+                    continue;
+                seen.insert(tile);
+                if (!arrival.contains(tile) || arrival.value(tile) > frame)
+                    ++misses;
+                if (!requested.contains(tile))
+                    visibleQueue.append(tile);
+            }
+
+            for (int i = 0; i < perFrame; ++i) {
+                QGeoTileSpec tile;
+                if (!visibleQueue.isEmpty())
+                    tile = visibleQueue.takeFirst();
+                else if (!prefetch.isEmpty())
+                    tile = prefetch.takeFirst();
+                else
+                    break;
+                if (requested.contains(tile)) {
+                    --i;
+                    continue;
+                }
+                requested.insert(tile);
+                arrival.insert(tile, frame + latency);
+            }
+        }
+
+        return misses;
+    }
+
 private slots:
     void tilesPlugin()
     {
@@ -221,6 +296,203 @@ private slots:
         QCOMPARE(tiles3, tiles3_check);
     }
 
+    void tilesForArea()
+    {
+        QGeoCameraTiles ct;
+        ct.setPluginString("pluginA");
+        ct.setMapType(QGeoMapType(QGeoMapType::StreetMap, "street map", "street map", false, 1));
+
+        QSet<QGeoTileSpec> expected;
+
+        // inside a single tile
+        expected << QGeoTileSpec("pluginA", 1, 2, 2, 1);
+        QCOMPARE(ct.tilesForArea(QGeoRectangle(QGeoCoordinate(10.0, 10.0), QGeoCoordinate(5.0, 20.0)), 2),
+                 expected);
+
+        // across the dateline
+        expected.clear();
+        expected << QGeoTileSpec("pluginA", 1, 2, 3, 1) << QGeoTileSpec("pluginA", 1, 2, 0, 1);
+        QCOMPARE(ct.tilesForArea(QGeoRectangle(QGeoCoordinate(10.0, 170.0), QGeoCoordinate(5.0, -170.0)), 2),
+                 expected);
+
+        // the whole world
+        QGeoRectangle world(QGeoCoordinate(80.0, -180.0), QGeoCoordinate(-80.0, 180.0));
+        QCOMPARE(ct.tilesForArea(world, 2).size(), 16);
+        QCOMPARE(ct.tilesForArea(world, 0).size(), 1);
+
+        // a small circle stays within the tile of its center
+        QGeoCoordinate center(10.0, 10.0);
+        QSet<QGeoTileSpec> circleTiles = ct.tilesForArea(QGeoCircle(center, 1000.0), 4);
+        expected.clear();
+        expected << QGeoTileSpec("pluginA", 1, 4, 8, 7);
+        QCOMPARE(circleTiles, expected);
+
+        QVERIFY(ct.tilesForArea(QGeoRectangle(), 4).isEmpty());
+    }
+
+    void tilesDelta()
+    {
+        QGeoMapType mapType(QGeoMapType::StreetMap, "street map", "street map", false, 1);
+
+        QGeoCameraData camera;
+        camera.setZoomLevel(4.3);
+        camera.setCenter(QGeoCoordinate(12.3, 160.1));
+
+        QGeoCameraTiles ct;
+        ct.setMaximumZoomLevel(8);
+        ct.setTileSize(16);
+        ct.setScreenSize(QSize(70, 45));
+        ct.setPluginString("pluginA");
+        ct.setMapType(mapType);
+        ct.setCamera(camera);
+
+        // the delta accumulates from the empty set
+        QCOMPARE(ct.addedTiles(), ct.tiles());
+        QVERIFY(ct.removedTiles().isEmpty());
+        ct.clearTileDelta();
+
+        // pan east across the dateline and a little south
+        for (int i = 0; i < 40; ++i) {
+            QSet<QGeoTileSpec> before = ct.tiles();
+
+            QGeoCoordinate center = camera.center();
+            double lon = center.longitude() + 1.37;
+            if (lon > 180.0)
+                lon -= 360.0;
+            center.setLongitude(lon);
+            center.setLatitude(center.latitude() - 0.41);
+            camera.setCenter(center);
+            ct.setCamera(camera);
+
+            QSet<QGeoTileSpec> added = ct.addedTiles();
+            QSet<QGeoTileSpec> removed = ct.removedTiles();
+            ct.clearTileDelta();
+
+            QVERIFY((added & before).isEmpty());
+            QCOMPARE(removed - before, QSet<QGeoTileSpec>());
+            QCOMPARE((before - removed) + added, ct.tiles());
+
+            // the pan must agree with a full computation at the same camera
+            QGeoCameraTiles full;
+            full.setMaximumZoomLevel(8);
+            full.setTileSize(16);
+            full.setScreenSize(QSize(70, 45));
+            full.setPluginString("pluginA");
+            full.setMapType(mapType);
+            full.setCamera(camera);
+            QCOMPARE(ct.tiles(), full.tiles());
+        }
+
+        // panning back and forth before the delta is read cancels out
+        QGeoCoordinate center = camera.center();
+        camera.setCenter(QGeoCoordinate(center.latitude(), center.longitude() + 3.0));
+        ct.setCamera(camera);
+        camera.setCenter(center);
+        ct.setCamera(camera);
+        QVERIFY(ct.addedTiles().isEmpty());
+        QVERIFY(ct.removedTiles().isEmpty());
+
+        // a zoom change replaces the whole set
+        QSet<QGeoTileSpec> before = ct.tiles();
+        camera.setZoomLevel(5.3);
+        ct.setCamera(camera);
+        QCOMPARE(ct.removedTiles(), before);
+        QCOMPARE(ct.addedTiles(), ct.tiles());
+        ct.clearTileDelta();
+
+        // prefetching is reported as a delta as well
+        before = ct.tiles();
+        ct.findPrefetchTiles();
+        QCOMPARE((before - ct.removedTiles()) + ct.addedTiles(), ct.tiles());
+        QVERIFY(ct.tiles().contains(before));
+    }
+
+    void tilesAlongPath()
+    {
+        QGeoCameraData camera;
+        camera.setZoomLevel(4.0);
+        camera.setCenter(QGeoCoordinate(10.0, 1.0));
+
+        QGeoCameraTiles ct;
+        ct.setMaximumZoomLevel(8);
+        ct.setTileSize(16);
+        ct.setScreenSize(QSize(32, 32));
+        ct.setPluginString("pluginA");
+        ct.setMapType(QGeoMapType(QGeoMapType::StreetMap, "street map", "street map", false, 1));
+        ct.setCamera(camera);
+
+        // standing still there is nothing ahead
+        QVERIFY(ct.tilesAlongPath(camera, 100).isEmpty());
+
+        QGeoCameraData target = camera;
+        target.setCenter(QGeoCoordinate(10.0, 80.0));
+        QList<QGeoTileSpec> tiles = ct.tilesAlongPath(target, 100);
+        QVERIFY(!tiles.isEmpty());
+
+        // none are visible yet, and the ones at the target are included
+        QVERIFY((tiles.toSet() & ct.tiles()).isEmpty());
+        QCOMPARE(tiles.toSet().size(), tiles.size());
+        QGeoCameraTiles there;
+        there.setMaximumZoomLevel(8);
+        there.setTileSize(16);
+        there.setScreenSize(QSize(32, 32));
+        there.setPluginString("pluginA");
+        there.setMapType(QGeoMapType(QGeoMapType::StreetMap, "street map", "street map", false, 1));
+        there.setCamera(target);
+        QVERIFY(tiles.toSet().contains(there.tiles() - ct.tiles()));
+
+        // nearest first
+        QVERIFY(tiles.first().x() < tiles.last().x());
+
+        // the budget is respected, keeping the nearest tiles
+        QList<QGeoTileSpec> few = ct.tilesAlongPath(target, 3);
+        QCOMPARE(few, tiles.mid(0, 3));
+
+        // zooming in fetches the deeper levels
+        target = camera;
+        target.setZoomLevel(6.0);
+        tiles = ct.tilesAlongPath(target, 100);
+        QVERIFY(!tiles.isEmpty());
+        QCOMPARE(tiles.last().zoom(), 6);
+    }
+
+    void prefetchReplay_data()
+    {
+        QTest::addColumn<QGeoCoordinate>("toCenter");
+        QTest::addColumn<double>("toZoom");
+
+        QTest::newRow("flick east") << QGeoCoordinate(52.52, 13.50) << 14.0;
+        QTest::newRow("flick south west") << QGeoCoordinate(52.45, 13.30) << 14.0;
+        QTest::newRow("zoom in") << QGeoCoordinate(52.52, 13.40) << 16.0;
+    }
+
+    /*
+        Counts the tiles which are missing when they first become visible
+        during a flick or zoom animation, fetching ahead along the path and
+        not. The benchmark result is the count with fetching ahead.
+    */
+    void prefetchReplay()
+    {
+        QFETCH(QGeoCoordinate, toCenter);
+        QFETCH(double, toZoom);
+
+        QGeoCameraData from;
+        from.setCenter(QGeoCoordinate(52.52, 13.40));
+        from.setZoomLevel(14.0);
+
+        QGeoCameraData to = from;
+        to.setCenter(toCenter);
+        to.setZoomLevel(toZoom);
+
+        // one second at 60 frames per second, 4 requests started per frame
+        // which take 100ms each
+        int without = replayMisses(from, to, 60, 4, 6, 0);
+        int with = replayMisses(from, to, 60, 4, 6, 64);
+
+        QVERIFY(with < without);
+        QTest::setBenchmarkResult(with, QTest::Events);
+    }
+
     void tilesPositions()
     {
         QFETCH(double, mercatorX);
@@ -0,0 +1,9 @@
+CONFIG += testcase
+TARGET = tst_qgeocoordinatearray
+
+INCLUDEPATH += ../../../src/location
+
+SOURCES += tst_qgeocoordinatearray.cpp
+
+QT += location testlib
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,207 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/location
+
+#include "qgeocoordinatearray_p.h"
+
+#include <QtTest/QtTest>
+#include <QGeoCoordinate>
+
+QT_USE_NAMESPACE
+
+class tst_QGeoCoordinateArray : public QObject
+{
+    Q_OBJECT
+
+private:
+    // a route of n points zig-zagging north east, every tenth with an altitude
+    static QList<QGeoCoordinate> route(int n)
+    {
+        QList<QGeoCoordinate> path;
+        for (int i = 0; i < n; ++i) {
+            QGeoCoordinate c(-60.0 + 120.0 * i / n, -170.0 + (i % 7) * 0.01 + 340.0 * i / n);
+            if (i % 10 == 0)
+                c.setAltitude(i);
+            path.append(c);
+        }
+        return path;
+    }
+
+private slots:
+    void fromList();
+    void edit();
+    void compare();
+
+    void iterate_data();
+    void iterate();
+};
+
+void tst_QGeoCoordinateArray::fromList()
+{
+    QList<QGeoCoordinate> list;
+    list << QGeoCoordinate(10.0, 20.0)
+         << QGeoCoordinate(-30.5, 179.5, 120.0)
+         << QGeoCoordinate()
+         << QGeoCoordinate(90.0, 0.0);
+
+    QGeoCoordinateArray array(list);
+    QCOMPARE(array.size(), 4);
+    QVERIFY(!array.isEmpty());
+
+    QCOMPARE(array.latitude(1), -30.5);
+    QCOMPARE(array.longitude(1), 179.5);
+    QCOMPARE(array.altitude(1), 120.0);
+    QVERIFY(qIsNaN(array.altitude(0)));
+
+    QVERIFY(array.isValid(0));
+    QVERIFY(!array.isValid(2));
+    QVERIFY(!array.at(2).isValid());
+    QCOMPARE(array.at(1).type(), QGeoCoordinate::Coordinate3D);
+    QCOMPARE(array.at(0).type(), QGeoCoordinate::Coordinate2D);
+
+    QCOMPARE(array.toList(), list);
+
+    double latLon[8];
+    array.copyLatLon(latLon);
+    QCOMPARE(latLon[2], -30.5);
+    QCOMPARE(latLon[3], 179.5);
+    QCOMPARE(latLon[6], 90.0);
+
+    array.clear();
+    QVERIFY(array.isEmpty());
+    QCOMPARE(array.toList(), QList<QGeoCoordinate>());
+}
+
+void tst_QGeoCoordinateArray::edit()
+{
+    QGeoCoordinateArray array;
+    array.append(1.0, 2.0);
+    array.append(QGeoCoordinate(3.0, 4.0, 5.0));
+    array.append(1.0, 2.0);
+    QCOMPARE(array.size(), 3);
+
+    QCOMPARE(array.lastIndexOf(QGeoCoordinate(1.0, 2.0)), 2);
+    QCOMPARE(array.lastIndexOf(QGeoCoordinate(3.0, 4.0)), -1);
+    QCOMPARE(array.lastIndexOf(QGeoCoordinate(3.0, 4.0, 5.0)), 1);
+
+    array.removeAt(2);
+    QCOMPARE(array.size(), 2);
+    QCOMPARE(array.lastIndexOf(QGeoCoordinate(1.0, 2.0)), 0);
+
+    array.replace(0, QGeoCoordinate(-1.0, -2.0, 3.0));
+    QCOMPARE(array.at(0), QGeoCoordinate(-1.0, -2.0, 3.0));
+    QCOMPARE(array.at(1), QGeoCoordinate(3.0, 4.0, 5.0));
+
+    // copies are independent
+    QGeoCoordinateArray copy = array;
+    copy.replace(1, QGeoCoordinate(6.0, 7.0));
+    QCOMPARE(array.at(1), QGeoCoordinate(3.0, 4.0, 5.0));
+
+    copy.append(array);
+    QCOMPARE(copy.size(), 4);
+    QCOMPARE(copy.at(1), QGeoCoordinate(6.0, 7.0));
+    QCOMPARE(copy.at(3), QGeoCoordinate(3.0, 4.0, 5.0));
+    QCOMPARE(array.size(), 2);
+}
+
+void tst_QGeoCoordinateArray::compare()
+{
+    QList<QGeoCoordinate> list = route(100);
+    QGeoCoordinateArray a(list);
+    QGeoCoordinateArray b(list);
+    QVERIFY(a == b);
+    QVERIFY(!(a != b));
+
+    b.replace(50, QGeoCoordinate(0.0, 0.0));
+    QVERIFY(a != b);
+
+    b.removeAt(50);
+    QVERIFY(a != b);
+
+    // like QGeoCoordinate, longitude doesn't matter at the poles
+    QGeoCoordinateArray north;
+    north.append(90.0, 10.0);
+    QGeoCoordinateArray otherNorth;
+    otherNorth.append(90.0, -100.0);
+    QVERIFY(north == otherNorth);
+}
+
+void tst_QGeoCoordinateArray::iterate_data()
+{
+    QTest::addColumn<bool>("packed");
+
+    QTest::newRow("list") << false;
+    QTest::newRow("array") << true;
+}
+
+// what updating a map item for a long route costs: a copy of the path and
+// one pass over it
+void tst_QGeoCoordinateArray::iterate()
+{
+    QFETCH(bool, packed);
+
+    QList<QGeoCoordinate> list = route(50000);
+    QGeoCoordinateArray array(list);
+    double sum = 0.0;
+
+    if (packed) {
+        QBENCHMARK {
+            QGeoCoordinateArray path = array;
+            const double *lat = path.latitudes();
+            const double *lon = path.longitudes();
+            for (int i = 0; i < path.size(); ++i)
+                sum += lat[i] + lon[i];
+        }
+    } else {
+        QBENCHMARK {
+            QList<QGeoCoordinate> path = list;
+            for (int i = 0; i < path.size(); ++i)
+                sum += path.at(i).latitude() + path.at(i).longitude();
+        }
+    }
+
+    QVERIFY(!qIsNaN(sum));
+}
+
+QTEST_APPLESS_MAIN(tst_QGeoCoordinateArray)
+
+#include "tst_qgeocoordinatearray.moc"
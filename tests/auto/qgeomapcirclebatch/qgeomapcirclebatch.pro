@@ -0,0 +1,13 @@
+CONFIG += testcase
+TARGET = tst_qgeomapcirclebatch
+
+INCLUDEPATH += ../../../src/imports/location \
+               ../../../src/location/maps \
+               ../../../src/location
+
+HEADERS += ../../../src/imports/location/qgeomapcirclebatch_p.h
+SOURCES += tst_qgeomapcirclebatch.cpp \
+           ../../../src/imports/location/qgeomapcirclebatch.cpp
+
+QT += location gui testlib
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,303 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/imports/location
+
+#include "qgeomapcirclebatch_p.h"
+#include "qgeoprojection_p.h"
+
+#include <QtTest/QtTest>
+#include <QTransform>
+#include <QtCore/qmath.h>
+
+QT_USE_NAMESPACE
+
+typedef QGeoMapCircleBatch::Vertex Vertex;
+
+static const qreal width = 800;
+static const qreal height = 600;
+
+// mercator space to the screen for a camera looking straight down at
+// \a center, tilted by \a tilt in screen space
+static QTransform camera(const QDoubleVector2D &center, qreal zoomLevel,
+                         const QTransform &tilt = QTransform())
+{
+    qreal scale = 256.0 * qPow(2.0, zoomLevel);
+    return QTransform::fromTranslate(-center.x(), -center.y())
+            * QTransform::fromScale(scale, scale)
+            * QTransform::fromTranslate(width / 2, height / 2)
+            * tilt;
+}
+
+// what the map item does: four screen points around the middle and the
+// mercator positions they show, wrapped to the world like coordinates
+static bool setCamera(QGeoMapCircleBatch &batch, const QTransform &camera)
+{
+    QPointF screen[4] = { QPointF(width / 4, height / 4), QPointF(3 * width / 4, height / 4),
+                          QPointF(3 * width / 4, 3 * height / 4), QPointF(width / 4, 3 * height / 4) };
+    QDoubleVector2D mercator[4];
+    QTransform inverse = camera.inverted();
+    for (int i = 0; i < 4; ++i) {
+        QPointF p = inverse.map(screen[i]);
+        mercator[i] = QDoubleVector2D(p.x() - qFloor(p.x()), p.y());
+    }
+    return batch.setProjection(mercator, screen);
+}
+
+class tst_QGeoMapCircleBatch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void projection_data();
+    void projection();
+    void dateline();
+    void rebase();
+    void indexAt();
+    void fillVertices();
+    void benchmarkCamera_data();
+    void benchmarkCamera();
+};
+
+void tst_QGeoMapCircleBatch::projection_data()
+{
+    QTest::addColumn<QTransform>("tilt");
+
+    QTest::newRow("flat") << QTransform();
+    QTest::newRow("rotated") << QTransform().translate(400, 300).rotate(30).translate(-400, -300);
+    QTest::newRow("tilted") << QTransform(1.0, 0.0, 0.0002,
+                                          0.0, 1.0, 0.0008,
+                                          0.0, 0.0, 1.0);
+}
+
+void tst_QGeoMapCircleBatch::projection()
+{
+    QFETCH(QTransform, tilt);
+
+    QGeoCoordinate center(60.17, 24.94);
+    QTransform view = camera(QGeoProjection::coordToMercator(center), 14, tilt);
+
+    QGeoMapCircleBatch batch;
+    QList<QGeoCoordinate> coordinates;
+    coordinates << center << QGeoCoordinate(60.175, 24.93) << QGeoCoordinate(60.166, 24.95)
+                << QGeoCoordinate(60.18, 24.96);
+    foreach (const QGeoCoordinate &coordinate, coordinates)
+        batch.append(coordinate, 10, Qt::red);
+
+    setCamera(batch, view);
+    QVERIFY(batch.hasProjection());
+
+    QVector<Vertex> vertices(batch.vertexCount());
+    batch.fillVertices(vertices.data());
+    QVERIFY(!batch.isVertexDataDirty());
+
+    for (int i = 0; i < coordinates.size(); ++i) {
+        QDoubleVector2D m = QGeoProjection::coordToMercator(coordinates.at(i));
+        QPointF expected = view.map(QPointF(m.x(), m.y()));
+
+        QPointF actual = batch.screenPosition(i);
+        QVERIFY(qAbs(actual.x() - expected.x()) < 0.01);
+        QVERIFY(qAbs(actual.y() - expected.y()) < 0.01);
+
+        // what the shader gets from the float vertices
+        const Vertex &v = vertices.at(6 * i);
+        QPointF drawn = batch.transform().map(QPointF(v.x, v.y));
+        QVERIFY(qAbs(drawn.x() - expected.x()) < 0.1);
+        QVERIFY(qAbs(drawn.y() - expected.y()) < 0.1);
+    }
+}
+
+void tst_QGeoMapCircleBatch::dateline()
+{
+    QGeoMapCircleBatch batch;
+    batch.append(QGeoCoordinate(0.0, 179.9), 10, Qt::red);
+    batch.append(QGeoCoordinate(0.0, -179.9), 10, Qt::red);
+
+    // looking at the dateline, from either side of the world
+    for (int side = 0; side < 2; ++side) {
+        setCamera(batch, camera(QDoubleVector2D(side, 0.5), 10));
+        QVector<Vertex> vertices(batch.vertexCount());
+        batch.fillVertices(vertices.data());
+
+        qreal offset = 0.1 / 360.0 * 256.0 * 1024.0;
+        QVERIFY(qAbs(batch.screenPosition(0).x() - (width / 2 - offset)) < 0.01);
+        QVERIFY(qAbs(batch.screenPosition(1).x() - (width / 2 + offset)) < 0.01);
+        QVERIFY(qAbs(batch.screenPosition(0).y() - height / 2) < 0.01);
+
+        QPointF drawn = batch.transform().map(QPointF(vertices.at(6).x, vertices.at(6).y));
+        QVERIFY(qAbs(drawn.x() - (width / 2 + offset)) < 0.1);
+    }
+}
+
+void tst_QGeoMapCircleBatch::rebase()
+{
+    QGeoMapCircleBatch batch;
+    QGeoCoordinate coordinate(-33.86, 151.21);
+    QDoubleVector2D m = QGeoProjection::coordToMercator(coordinate);
+    batch.append(coordinate, 10, Qt::red);
+
+    QVERIFY(setCamera(batch, camera(m, 20)));
+    QVector<Vertex> vertices(batch.vertexCount());
+    batch.fillVertices(vertices.data());
+    QDoubleVector2D origin = batch.origin();
+
+    // panning a few thousand pixels keeps the vertices
+    QVERIFY(!setCamera(batch, camera(m + QDoubleVector2D(0.00001, 0.00002), 20)));
+    QVERIFY(!batch.isVertexDataDirty());
+    QCOMPARE(batch.origin(), origin);
+
+    // far enough for the floats to lose a pixel fills them again
+    QDoubleVector2D far = m + QDoubleVector2D(0.05, 0.0);
+    QVERIFY(setCamera(batch, camera(far, 20)));
+    QVERIFY(batch.isVertexDataDirty());
+    QVERIFY(qAbs(batch.origin().x() - far.x()) < 0.001);
+    batch.fillVertices(vertices.data());
+
+    // the circle is off the screen now, but still where it should be
+    QTransform view = camera(far, 20);
+    QPointF expected = view.map(QPointF(m.x(), m.y()));
+    QPointF drawn = batch.transform().map(QPointF(vertices.at(0).x, vertices.at(0).y));
+    QVERIFY(qAbs(drawn.x() - expected.x()) / qAbs(expected.x()) < 1e-6);
+
+    // zooming out keeps them too
+    QVERIFY(!setCamera(batch, camera(far, 5)));
+}
+
+void tst_QGeoMapCircleBatch::indexAt()
+{
+    QGeoMapCircleBatch batch;
+    QVERIFY(batch.indexAt(QPointF(width / 2, height / 2)) < 0);
+
+    QGeoCoordinate center(51.5, -0.12);
+    QDoubleVector2D m = QGeoProjection::coordToMercator(center);
+    batch.setRadiusUnit(QGeoMapCircleBatch::Pixels);
+    batch.append(center, 20, Qt::red);
+    batch.append(center, 10, Qt::blue);
+    setCamera(batch, camera(m, 12));
+
+    QCOMPARE(batch.screenRadius(0), qreal(20));
+    QCOMPARE(batch.indexAt(QPointF(width / 2, height / 2)), 1);
+    QCOMPARE(batch.indexAt(QPointF(width / 2 + 15, height / 2)), 0);
+    QCOMPARE(batch.indexAt(QPointF(width / 2 + 25, height / 2)), -1);
+
+    // in meters the size follows the zoom level: 10 meters are under half
+    // a pixel at zoom level 12, and about 27 pixels at 18
+    batch.setRadiusUnit(QGeoMapCircleBatch::Meters);
+    setCamera(batch, camera(m, 12));
+    QCOMPARE(batch.indexAt(QPointF(width / 2 + 1, height / 2)), -1);
+    setCamera(batch, camera(m, 18));
+    QCOMPARE(batch.indexAt(QPointF(width / 2 + 20, height / 2)), 1);
+    QCOMPARE(batch.indexAt(QPointF(width / 2 + 40, height / 2)), 0);
+    QCOMPARE(batch.indexAt(QPointF(width / 2 + 60, height / 2)), -1);
+}
+
+void tst_QGeoMapCircleBatch::fillVertices()
+{
+    QGeoMapCircleBatch batch;
+    batch.append(QGeoCoordinate(0.0, 0.0), 1000, QColor(255, 0, 0, 128));
+    setCamera(batch, camera(QDoubleVector2D(0.5, 0.5), 3));
+
+    QCOMPARE(batch.vertexCount(), 6);
+    QVector<Vertex> vertices(batch.vertexCount());
+    batch.fillVertices(vertices.data());
+
+    const Vertex &v = vertices.at(0);
+    QVERIFY(qAbs(v.radius / (1000.0 / (2.0 * M_PI * 6371007.2)) - 1.0) < 1e-6);
+    QCOMPARE(int(v.r), 128);
+    QCOMPARE(int(v.g), 0);
+    QCOMPARE(int(v.a), 128);
+
+    // the six corners make two triangles over the square around the circle
+    int sumX = 0;
+    int sumY = 0;
+    for (int i = 0; i < 6; ++i) {
+        QCOMPARE(vertices.at(i).x, v.x);
+        QVERIFY(qAbs(vertices.at(i).cornerX) == 1.0f && qAbs(vertices.at(i).cornerY) == 1.0f);
+        sumX += vertices.at(i).cornerX;
+        sumY += vertices.at(i).cornerY;
+    }
+    QCOMPARE(sumX, 0);
+    QCOMPARE(sumY, 0);
+
+    batch.setRadiusUnit(QGeoMapCircleBatch::Pixels);
+    QVERIFY(batch.isVertexDataDirty());
+    batch.fillVertices(vertices.data());
+    QCOMPARE(vertices.at(0).radius, 1000.0f);
+}
+
+void tst_QGeoMapCircleBatch::benchmarkCamera_data()
+{
+    QTest::addColumn<bool>("fill");
+
+    QTest::newRow("transform only") << false;
+    QTest::newRow("fill vertices") << true;
+}
+
+// What a frame of panning costs for 5000 circles: setting the transform,
+// against filling the vertex buffer as updating every circle would
+void tst_QGeoMapCircleBatch::benchmarkCamera()
+{
+    QFETCH(bool, fill);
+
+    QGeoMapCircleBatch batch;
+    qsrand(5000);
+    for (int i = 0; i < 5000; ++i) {
+        QGeoCoordinate coordinate(48.0 + (qrand() % 1000) / 500.0, 2.0 + (qrand() % 1000) / 500.0);
+        batch.append(coordinate, 50 + qrand() % 200, Qt::red);
+    }
+
+    QDoubleVector2D center = QGeoProjection::coordToMercator(QGeoCoordinate(49.0, 3.0));
+    QVector<Vertex> vertices(batch.vertexCount());
+    setCamera(batch, camera(center, 10));
+    batch.fillVertices(vertices.data());
+
+    int frame = 0;
+    QBENCHMARK {
+        ++frame;
+        setCamera(batch, camera(center + QDoubleVector2D((frame % 100) * 1e-5, 0.0), 10));
+        if (fill)
+            batch.fillVertices(vertices.data());
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_QGeoMapCircleBatch)
+
+#include "tst_qgeomapcirclebatch.moc"
@@ -0,0 +1,10 @@
+CONFIG += testcase
+TARGET = tst_qgeomapgeometryjob
+
+INCLUDEPATH += ../../../src/imports/location
+
+HEADERS += ../../../src/imports/location/qgeomapgeometryjob_p.h
+SOURCES += tst_qgeomapgeometryjob.cpp \
+           ../../../src/imports/location/qgeomapgeometryjob.cpp
+
+QT += testlib
@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/imports/location
+
+#include "qgeomapgeometryjob_p.h"
+
+#include <QtTest/QtTest>
+#include <QSemaphore>
+#include <QThreadPool>
+
+QT_USE_NAMESPACE
+
+class SquareJob : public QGeoMapGeometryJob
+{
+public:
+    SquareJob(QObject *receiver, int value, QSemaphore *gate = 0, QSemaphore *started = 0)
+        : QGeoMapGeometryJob(receiver, "finished"),
+          value(value), result(0), gate(gate), started(started) {}
+
+    int value;
+    int result;
+    QSemaphore *gate;
+    QSemaphore *started;
+
+protected:
+    void run()
+    {
+        if (started)
+            started->release();
+        if (gate)
+            gate->acquire();
+        result = value * value;
+    }
+};
+
+class Receiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    Receiver() : calls(0) {}
+
+    QSharedPointer<SquareJob> job;
+    QList<int> results;
+    int calls;
+
+public Q_SLOTS:
+    void finished()
+    {
+        ++calls;
+        if (!job || !job->isFinished())
+            return;
+        results << job->result;
+        job.clear();
+    }
+};
+
+class tst_QGeoMapGeometryJob : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void deliversResult();
+    void cancelledBeforeRun();
+    void cancelledWhileRunning();
+    void onlyLatestDelivered();
+};
+
+void tst_QGeoMapGeometryJob::deliversResult()
+{
+    Receiver receiver;
+    receiver.job = QSharedPointer<SquareJob>(new SquareJob(&receiver, 7));
+    QGeoMapGeometryJob::start(receiver.job);
+
+    QTRY_COMPARE(receiver.results, QList<int>() << 49);
+    QCOMPARE(receiver.calls, 1);
+}
+
+void tst_QGeoMapGeometryJob::cancelledBeforeRun()
+{
+    Receiver receiver;
+    QSharedPointer<SquareJob> job(new SquareJob(&receiver, 3));
+    job->cancel();
+    QVERIFY(job->isCancelled());
+    QGeoMapGeometryJob::start(job);
+
+    QVERIFY(QThreadPool::globalInstance()->waitForDone(5000));
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver.calls, 0);
+    QCOMPARE(job->result, 0);
+    QVERIFY(!job->isFinished());
+}
+
+void tst_QGeoMapGeometryJob::cancelledWhileRunning()
+{
+    QSemaphore gate;
+    QSemaphore started;
+    QSharedPointer<SquareJob> job;
+    {
+        Receiver receiver;
+        job = QSharedPointer<SquareJob>(new SquareJob(&receiver, 5, &gate, &started));
+        QGeoMapGeometryJob::start(job);
+        QVERIFY(started.tryAcquire(1, 5000));
+
+        // the receiver goes away while the job is still running
+        job->cancel();
+    }
+    gate.release();
+
+    QVERIFY(QThreadPool::globalInstance()->waitForDone(5000));
+    QCoreApplication::processEvents();
+    QCOMPARE(job->result, 25);
+    QVERIFY(!job->isFinished());
+}
+
+void tst_QGeoMapGeometryJob::onlyLatestDelivered()
+{
+    QSemaphore gate;
+    Receiver receiver;
+
+    for (int i = 1; i <= 4; ++i) {
+        if (receiver.job)
+            receiver.job->cancel();
+        receiver.job = QSharedPointer<SquareJob>(new SquareJob(&receiver, i, &gate));
+        QGeoMapGeometryJob::start(receiver.job);
+    }
+    gate.release(4);
+
+    QTRY_COMPARE(receiver.results, QList<int>() << 16);
+    QVERIFY(QThreadPool::globalInstance()->waitForDone(5000));
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver.calls, 1);
+}
+
+QTEST_GUILESS_MAIN(tst_QGeoMapGeometryJob)
+
+#include "tst_qgeomapgeometryjob.moc"
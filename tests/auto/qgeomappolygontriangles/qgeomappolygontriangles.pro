@@ -0,0 +1,14 @@
+CONFIG += testcase
+TARGET = tst_qgeomappolygontriangles
+
+INCLUDEPATH += ../../../src/imports/location \
+               ../../../src/location
+
+HEADERS += ../../../src/imports/location/qgeomappolygontriangles_p.h
+SOURCES += tst_qgeomappolygontriangles.cpp \
+           ../../../src/imports/location/qgeomappolygontriangles.cpp
+
+LIBS += -L../../../src/3rdparty/poly2tri -lpoly2tri
+
+QT += location testlib
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
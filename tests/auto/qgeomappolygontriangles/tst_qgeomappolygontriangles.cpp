@@ -0,0 +1,324 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/imports/location
+
+#include "qgeomappolygontriangles_p.h"
+
+#include <QtTest/QtTest>
+#include <QPainterPath>
+#include <QTransform>
+
+#include "../../../src/3rdparty/poly2tri/poly2tri.h"
+
+QT_USE_NAMESPACE
+
+typedef QGeoMapPolygonTriangles::Point Point;
+
+class tst_QGeoMapPolygonTriangles : public QObject
+{
+    Q_OBJECT
+
+private:
+    static qreal area(const QVector<Point> &vertices)
+    {
+        qreal sum = 0.0;
+        for (int i = 0; i + 2 < vertices.size(); i += 3) {
+            const Point &a = vertices.at(i);
+            const Point &b = vertices.at(i + 1);
+            const Point &c = vertices.at(i + 2);
+            sum += qAbs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) / 2.0;
+        }
+        return sum;
+    }
+
+    static QPainterPath square(qreal x, qreal y, qreal size)
+    {
+        QPainterPath path;
+        path.moveTo(x, y);
+        path.lineTo(x + size, y);
+        path.lineTo(x + size, y + size);
+        path.lineTo(x, y + size);
+        path.closeSubpath();
+        return path;
+    }
+
+    // n by n city blocks of 80 pixels with 20 pixel streets between them,
+    // every block with a courtyard notch so that it is not convex
+    static QList<QPainterPath> cityBlocks(int n)
+    {
+        QList<QPainterPath> blocks;
+        for (int row = 0; row < n; ++row) {
+            for (int column = 0; column < n; ++column) {
+                qreal x = column * 100.0;
+                qreal y = row * 100.0;
+                QPainterPath path;
+                path.moveTo(x, y);
+                path.lineTo(x + 80, y);
+                path.lineTo(x + 80, y + 80);
+                path.lineTo(x + 50, y + 80);
+                path.lineTo(x + 50, y + 40);
+                path.lineTo(x + 30, y + 40);
+                path.lineTo(x + 30, y + 80);
+                path.lineTo(x, y + 80);
+                path.closeSubpath();
+                blocks.append(path);
+            }
+        }
+        return blocks;
+    }
+
+    // Building footprints the way they come out of map data: mostly
+    // rectangles, plus L, T and U shaped buildings and a few with bevelled
+    // corners, all turned to some street angle. Made up here, as no data
+    // set ships with the tests, but sized and shaped like a city district.
+    static QList<QPainterPath> footprints(int n)
+    {
+        static const qreal shapes[][24] = {
+            // rectangle
+            { 0, 0, 10, 0, 10, 6, 0, 6, -1 },
+            // L
+            { 0, 0, 10, 0, 10, 4, 4, 4, 4, 10, 0, 10, -1 },
+            // T
+            { 0, 0, 12, 0, 12, 4, 8, 4, 8, 10, 4, 10, 4, 4, 0, 4, -1 },
+            // U
+            { 0, 0, 12, 0, 12, 10, 8, 10, 8, 4, 4, 4, 4, 10, 0, 10, -1 },
+            // bevelled corners
+            { 2, 0, 10, 0, 12, 2, 12, 8, 10, 10, 2, 10, 0, 8, 0, 2, -1 }
+        };
+        const int shapeCount = sizeof(shapes) / sizeof(shapes[0]);
+
+        QList<QPainterPath> paths;
+        qsrand(7);
+        for (int i = 0; i < n; ++i) {
+            const qreal *shape = shapes[i % 7 < 3 ? 0 : 1 + i % (shapeCount - 1)];
+
+            QTransform transform;
+            transform.translate((i % 50) * 30.0, (i / 50) * 30.0);
+            transform.rotate(qrand() % 90);
+            transform.scale(1.0 + (qrand() % 100) / 100.0, 1.0 + (qrand() % 100) / 100.0);
+
+            QPainterPath path;
+            for (int j = 0; shape[j] >= 0; j += 2) {
+                QPointF p = transform.map(QPointF(shape[j], shape[j + 1]));
+                if (j == 0)
+                    path.moveTo(p);
+                else
+                    path.lineTo(p);
+            }
+            path.closeSubpath();
+            paths.append(path);
+        }
+        return paths;
+    }
+
+private slots:
+    void triangulate();
+    void clip();
+    void clipOutside();
+
+    void pan_data();
+    void pan();
+
+    void triangulateFootprints_data();
+    void triangulateFootprints();
+};
+
+void tst_QGeoMapPolygonTriangles::triangulate()
+{
+    QGeoMapPolygonTriangles triangles;
+    QVERIFY(triangles.isEmpty());
+
+    triangles.triangulate(square(10, 20, 100));
+    QCOMPARE(triangles.vertices().size(), 6);
+    QCOMPARE(area(triangles.vertices()), 10000.0);
+    QCOMPARE(triangles.bounds(), QRectF(10, 20, 100, 100));
+
+    // concave, and triangulating again replaces the old triangles
+    QList<QPainterPath> block = cityBlocks(1);
+    triangles.triangulate(block.first());
+    QCOMPARE(triangles.vertices().size(), 6 * 3);
+    QCOMPARE(area(triangles.vertices()), 80.0 * 80.0 - 20.0 * 40.0);
+
+    triangles.clear();
+    QVERIFY(triangles.isEmpty());
+    QVERIFY(triangles.bounds().isNull());
+}
+
+void tst_QGeoMapPolygonTriangles::clip()
+{
+    QGeoMapPolygonTriangles triangles;
+    triangles.triangulate(square(0, 0, 100));
+
+    QVector<Point> vertices;
+    vertices << Point(-1, -1);
+
+    QRectF rect(50, 25, 100, 50);
+    QRectF bounds = triangles.clip(rect, vertices);
+
+    // what was there is kept, the rest are whole triangles inside rect
+    QCOMPARE(vertices.first().x, qreal(-1));
+    vertices.removeFirst();
+    QCOMPARE(vertices.size() % 3, 0);
+    QCOMPARE(area(vertices), 50.0 * 50.0);
+    QCOMPARE(bounds, QRectF(50, 25, 50, 50));
+    for (int i = 0; i < vertices.size(); ++i) {
+        QVERIFY(vertices.at(i).x >= rect.left() && vertices.at(i).x <= rect.right());
+        QVERIFY(vertices.at(i).y >= rect.top() && vertices.at(i).y <= rect.bottom());
+    }
+
+    // inside triangles are copied unchanged
+    vertices.clear();
+    bounds = triangles.clip(QRectF(-10, -10, 200, 200), vertices);
+    QCOMPARE(vertices.size(), triangles.vertices().size());
+    QCOMPARE(bounds, triangles.bounds());
+}
+
+void tst_QGeoMapPolygonTriangles::clipOutside()
+{
+    QGeoMapPolygonTriangles triangles;
+    triangles.triangulate(square(0, 0, 100));
+
+    QVector<Point> vertices;
+    QRectF bounds = triangles.clip(QRectF(200, 0, 100, 100), vertices);
+    QVERIFY(vertices.isEmpty());
+    QVERIFY(bounds.isNull());
+}
+
+void tst_QGeoMapPolygonTriangles::pan_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("retriangulate") << false;
+    QTest::newRow("cached") << true;
+}
+
+// a layer of city blocks under a 800x600 viewport moving across it, the
+// way the polygon items are updated while the map is panned
+void tst_QGeoMapPolygonTriangles::pan()
+{
+    QFETCH(bool, cached);
+
+    QList<QPainterPath> blocks = cityBlocks(40);
+    QList<QGeoMapPolygonTriangles> triangles;
+    for (int i = 0; i < blocks.size(); ++i) {
+        triangles.append(QGeoMapPolygonTriangles());
+        triangles.last().triangulate(blocks.at(i));
+    }
+
+    QVector<Point> vertices;
+    qreal total = 0.0;
+
+    QBENCHMARK {
+        total = 0.0;
+        for (int step = 0; step < 20; ++step) {
+            QRectF viewport(step * 157.0, step * 113.0, 800, 600);
+            for (int i = 0; i < blocks.size(); ++i) {
+                vertices.clear();
+                if (cached) {
+                    triangles.at(i).clip(viewport, vertices);
+                    total += area(vertices);
+                } else {
+                    QPainterPath rect;
+                    rect.addRect(viewport);
+                    QPainterPath clipped = blocks.at(i).intersected(rect);
+                    if (clipped.elementCount() < 3)
+                        continue;
+                    QGeoMapPolygonTriangles retriangulated;
+                    retriangulated.triangulate(clipped);
+                    total += area(retriangulated.vertices());
+                }
+            }
+        }
+    }
+
+    // the viewport spans whole blocks and streets, 56% of it is blocks
+    QVERIFY(total > 0.0);
+    QVERIFY(qAbs(total - 20 * 800.0 * 600.0 * 0.56) < 0.05 * total);
+}
+
+void tst_QGeoMapPolygonTriangles::triangulateFootprints_data()
+{
+    QTest::addColumn<bool>("pooled");
+
+    QTest::newRow("new points and CDT per polygon") << false;
+    QTest::newRow("pooled") << true;
+}
+
+void tst_QGeoMapPolygonTriangles::triangulateFootprints()
+{
+    QFETCH(bool, pooled);
+
+    QList<QPainterPath> paths = footprints(2000);
+    int count = 0;
+
+    QBENCHMARK {
+        count = 0;
+        for (int i = 0; i < paths.size(); ++i) {
+            const QPainterPath &path = paths.at(i);
+            if (pooled) {
+                QGeoMapPolygonTriangles triangles;
+                triangles.triangulate(path);
+                count += triangles.vertices().size() / 3;
+            } else {
+                // what the polygon item used to do, less the leak
+                std::vector<p2t::Point*> points;
+                for (int j = 0; j < path.elementCount() - 1; ++j)
+                    points.push_back(new p2t::Point(path.elementAt(j).x, path.elementAt(j).y));
+                p2t::CDT *cdt = new p2t::CDT(points);
+                cdt->Triangulate();
+                count += int(cdt->GetTriangles().size());
+                delete cdt;
+                qDeleteAll(points.begin(), points.end());
+            }
+        }
+    }
+
+    // a polygon of n corners makes n - 2 triangles
+    int expected = 0;
+    for (int i = 0; i < paths.size(); ++i)
+        expected += paths.at(i).elementCount() - 1 - 2;
+    QCOMPARE(count, expected);
+}
+
+QTEST_APPLESS_MAIN(tst_QGeoMapPolygonTriangles)
+
+#include "tst_qgeomappolygontriangles.moc"
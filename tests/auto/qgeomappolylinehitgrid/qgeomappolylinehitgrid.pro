@@ -0,0 +1,10 @@
+CONFIG += testcase
+TARGET = tst_qgeomappolylinehitgrid
+
+INCLUDEPATH += ../../../src/imports/location
+
+HEADERS += ../../../src/imports/location/qgeomappolylinehitgrid_p.h
+SOURCES += tst_qgeomappolylinehitgrid.cpp \
+           ../../../src/imports/location/qgeomappolylinehitgrid.cpp
+
+QT += gui testlib
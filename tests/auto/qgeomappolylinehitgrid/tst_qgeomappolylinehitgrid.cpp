@@ -0,0 +1,240 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/imports/location
+
+#include "qgeomappolylinehitgrid_p.h"
+
+#include <QtTest/QtTest>
+#include <QPainterPath>
+#include <QLineF>
+#include <QtCore/qmath.h>
+
+QT_USE_NAMESPACE
+
+class tst_QGeoMapPolylineHitGrid : public QObject
+{
+    Q_OBJECT
+
+private:
+    static void addPoint(QVector<qreal> &points, QVector<QPainterPath::ElementType> &types,
+                         qreal x, qreal y, bool move = false)
+    {
+        points << x << y;
+        types << (move || types.isEmpty() ? QPainterPath::MoveToElement
+                                          : QPainterPath::LineToElement);
+    }
+
+    // the distance to the nearest segment, measured the slow way
+    static qreal distance(const QVector<qreal> &points,
+                          const QVector<QPainterPath::ElementType> &types,
+                          const QPointF &point)
+    {
+        qreal best = qInf();
+        for (int i = 1; i < types.size(); ++i) {
+            if (types.at(i) == QPainterPath::MoveToElement)
+                continue;
+            QPointF a(points.at(2 * i - 2), points.at(2 * i - 1));
+            QPointF b(points.at(2 * i), points.at(2 * i + 1));
+            QPointF d = b - a;
+            qreal length = d.x() * d.x() + d.y() * d.y();
+            QPointF v = point - a;
+            qreal t = length > 0 ? (v.x() * d.x() + v.y() * d.y()) / length : 0;
+            t = qBound(qreal(0), t, qreal(1));
+            best = qMin(best, QLineF(a + t * d, point).length());
+        }
+        return best;
+    }
+
+private Q_SLOTS:
+    void empty();
+    void segment();
+    void moveToGap();
+    void vertical();
+    void zigzag();
+
+    void query_data();
+    void query();
+};
+
+void tst_QGeoMapPolylineHitGrid::empty()
+{
+    QGeoMapPolylineHitGrid grid;
+    QVERIFY(!grid.isBuilt());
+    QVERIFY(!grid.contains(QPointF(0, 0), 10));
+
+    QVector<qreal> points;
+    QVector<QPainterPath::ElementType> types;
+    addPoint(points, types, 5, 5);
+    grid.build(points, types);
+    QVERIFY(grid.isBuilt());
+    QVERIFY(!grid.contains(QPointF(5, 5), 10));
+
+    grid.clear();
+    QVERIFY(!grid.isBuilt());
+}
+
+void tst_QGeoMapPolylineHitGrid::segment()
+{
+    QVector<qreal> points;
+    QVector<QPainterPath::ElementType> types;
+    addPoint(points, types, 0, 0);
+    addPoint(points, types, 100, 0);
+
+    QGeoMapPolylineHitGrid grid;
+    grid.build(points, types);
+
+    QVERIFY(grid.contains(QPointF(50, 0), 1));
+    QVERIFY(grid.contains(QPointF(50, 2), 2));
+    QVERIFY(!grid.contains(QPointF(50, 2.5), 2));
+
+    // the ends are round
+    QVERIFY(grid.contains(QPointF(-3, 4), 5));
+    QVERIFY(!grid.contains(QPointF(-4, 4), 5));
+    QVERIFY(grid.contains(QPointF(103, -4), 5));
+    QVERIFY(!grid.contains(QPointF(104, -4), 5));
+}
+
+void tst_QGeoMapPolylineHitGrid::moveToGap()
+{
+    QVector<qreal> points;
+    QVector<QPainterPath::ElementType> types;
+    addPoint(points, types, 0, 0);
+    addPoint(points, types, 10, 0);
+    addPoint(points, types, 90, 0, true);
+    addPoint(points, types, 100, 0);
+
+    QGeoMapPolylineHitGrid grid;
+    grid.build(points, types);
+
+    QVERIFY(grid.contains(QPointF(5, 0), 1));
+    QVERIFY(grid.contains(QPointF(95, 0), 1));
+    QVERIFY(!grid.contains(QPointF(50, 0), 1));
+}
+
+void tst_QGeoMapPolylineHitGrid::vertical()
+{
+    QVector<qreal> points;
+    QVector<QPainterPath::ElementType> types;
+    for (int i = 0; i <= 50; ++i)
+        addPoint(points, types, 20, i * 10);
+
+    QGeoMapPolylineHitGrid grid;
+    grid.build(points, types);
+
+    QVERIFY(grid.contains(QPointF(20, 255), 0.5));
+    QVERIFY(grid.contains(QPointF(22, 499), 3));
+    QVERIFY(!grid.contains(QPointF(24, 250), 3));
+    QVERIFY(!grid.contains(QPointF(20, 510), 3));
+}
+
+void tst_QGeoMapPolylineHitGrid::zigzag()
+{
+    // every segment crosses the whole line, so it lands in a whole row of
+    // cells
+    QVector<qreal> points;
+    QVector<QPainterPath::ElementType> types;
+    for (int i = 0; i <= 200; ++i)
+        addPoint(points, types, (i % 2) * 1000, i * 5);
+
+    QGeoMapPolylineHitGrid grid;
+    grid.build(points, types);
+
+    for (int i = 0; i < 200; ++i) {
+        QPointF point(500, i * 5 + 2.5);
+        QVERIFY(grid.contains(point, 0.1));
+        QVERIFY(!grid.contains(point + QPointF(0, 1), 0.1));
+    }
+}
+
+void tst_QGeoMapPolylineHitGrid::query_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<qreal>("width");
+
+    QTest::newRow("short thin") << 10 << qreal(1);
+    QTest::newRow("long thin") << 5000 << qreal(1);
+    QTest::newRow("long wide") << 5000 << qreal(20);
+}
+
+void tst_QGeoMapPolylineHitGrid::query()
+{
+    QFETCH(int, count);
+    QFETCH(qreal, width);
+
+    // a wandering line, the kind a track recorded over a day makes
+    QVector<qreal> points;
+    QVector<QPainterPath::ElementType> types;
+    qreal x = 0;
+    qreal y = 0;
+    qsrand(7);
+    for (int i = 0; i < count; ++i) {
+        addPoint(points, types, x, y);
+        qreal angle = 2 * M_PI * (qrand() % 360) / 360.0;
+        x += 8 * qCos(angle);
+        y += 8 * qSin(angle);
+    }
+
+    QGeoMapPolylineHitGrid grid;
+    grid.build(points, types);
+
+    QVector<QPointF> probes;
+    for (int i = 0; i < 500; ++i)
+        probes << QPointF(points.at(2 * (i % count)) + (qrand() % 100) / 10.0 - 5,
+                          points.at(2 * (i % count) + 1) + (qrand() % 100) / 10.0 - 5);
+
+    foreach (const QPointF &probe, probes) {
+        qreal d = distance(points, types, probe);
+        // leave out probes right on the edge, where rounding decides
+        if (qAbs(d - width / 2) < 1e-6)
+            continue;
+        QCOMPARE(grid.contains(probe, width / 2), d <= width / 2);
+    }
+
+    QBENCHMARK {
+        foreach (const QPointF &probe, probes)
+            grid.contains(probe, width / 2);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_QGeoMapPolylineHitGrid)
+
+#include "tst_qgeomappolylinehitgrid.moc"
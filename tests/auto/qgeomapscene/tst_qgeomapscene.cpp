@@ -49,7 +49,6 @@
 #include "qdoublevector2d_p.h"
 #include "qgeotilecache_p.h"
 
-#include <Qt3D/qglscenenode.h>
 #include <Qt3D/qgltexture2d.h>
 
 #include <qtest.h>
@@ -67,6 +66,20 @@ class tst_QGeoMapScene : public QObject
     Q_OBJECT
 
     private:
+    static QSharedPointer<QGeoTileTexture> texture(const QGeoTileSpec &spec)
+    {
+        QSharedPointer<QGeoTileTexture> tt(new QGeoTileTexture);
+        tt->spec = spec;
+        tt->texture = new QGLTexture2D();
+        return tt;
+    }
+
+    // a tile of the same plugin and map as spec
+    static QGeoTileSpec relative(const QGeoTileSpec &spec, int zoom, int x, int y)
+    {
+        return QGeoTileSpec(spec.plugin(), spec.mapId(), zoom, x, y);
+    }
+
     void row(QString name, double screenX, double screenY, double cameraCenterX, double cameraCenterY,
              double zoom, int tileSize, int screenWidth, int screenHeight, double mercatorX, double mercatorY){
 
@@ -390,6 +403,12 @@ class tst_QGeoMapScene : public QObject
 
             QCOMPARE(point.x(), screenX);
             QCOMPARE(point.y(), screenY);
+
+            // and the same in a batch, in place
+            double batch[4] = { 0.5, 0.5, mercatorX, mercatorY };
+            mapGeometry.mercatorToScreenPositions(batch, batch, 2);
+            QCOMPARE(batch[2], screenX);
+            QCOMPARE(batch[3], screenY);
         }
 
         void mercatorToScreenPositions_data(){
@@ -416,9 +435,8 @@ class tst_QGeoMapScene : public QObject
             int sideLength = 1 << static_cast<int>(floor(camera.zoomLevel()));
             double quaterTile = 1.0 / (sideLength * 4.0);
 
-            // test that there are no scene nodes initially
-            QGLSceneNode* node = mapGeometry.sceneNode();
-            QCOMPARE(node->children().count(), 0);
+            // test that there are no tiles in the mesh initially
+            QCOMPARE(mapGeometry.stats().tiles, 0);
 
             // the camera is currently centered on top-left corner of the middle tile
             // (so 4 tiles should be visible and added to map geometry)
@@ -426,9 +444,8 @@ class tst_QGeoMapScene : public QObject
             tt->texture = new QGLTexture2D();
             foreach (QGeoTileSpec spec, ct.tiles())
                 mapGeometry.addTile(spec, tt); // add tiles with empty texture
-            QGLSceneNode* node2 = mapGeometry.sceneNode();
-            QCOMPARE(node2->children().count(), ct.tiles().count());
-            QCOMPARE(node2->children().count(), 4);
+            QCOMPARE(mapGeometry.stats().tiles, ct.tiles().count());
+            QCOMPARE(mapGeometry.stats().tiles, 4);
 
             // move camera slightly in x direction but within the same tile bounds
             // and verify that no new tiles are added through addTile
@@ -438,10 +455,9 @@ class tst_QGeoMapScene : public QObject
             mapGeometry.setVisibleTiles(ct.tiles());
             foreach (QGeoTileSpec spec, ct.tiles())
                 mapGeometry.addTile(spec, tt);
-            QGLSceneNode* node3 = mapGeometry.sceneNode();
             // test to see that there are still only 4 tiles in the map geometry
-            QCOMPARE(node3->children().count(), ct.tiles().count());
-            QCOMPARE(node3->children().count(), 4);
+            QCOMPARE(mapGeometry.stats().tiles, ct.tiles().count());
+            QCOMPARE(mapGeometry.stats().tiles, 4);
 
             // move camera further in x to align with edges of middle tile so that 6 tiles are fetched
             camera.setCenter(QGeoProjection::mercatorToCoord(QDoubleVector2D(0.5 + quaterTile*2, 0.5)));
@@ -450,9 +466,8 @@ class tst_QGeoMapScene : public QObject
             mapGeometry.setVisibleTiles(ct.tiles());
             foreach (QGeoTileSpec spec, ct.tiles())
                 mapGeometry.addTile(spec, tt);
-            QGLSceneNode* node4 = mapGeometry.sceneNode();
-            QCOMPARE(node4->children().count(), ct.tiles().count());
-            QCOMPARE(node4->children().count(), 6);
+            QCOMPARE(mapGeometry.stats().tiles, ct.tiles().count());
+            QCOMPARE(mapGeometry.stats().tiles, 6);
 
             // move camera further in x so that the 2 tiles on the left are now removed
             camera.setCenter(QGeoProjection::mercatorToCoord(QDoubleVector2D(0.5 + quaterTile*4, 0.5)));
@@ -461,9 +476,8 @@ class tst_QGeoMapScene : public QObject
             mapGeometry.setVisibleTiles(ct.tiles());
             foreach (QGeoTileSpec spec, ct.tiles())
                 mapGeometry.addTile(spec, tt);
-            QGLSceneNode* node5 = mapGeometry.sceneNode();
-            QCOMPARE(node5->children().count(), ct.tiles().count());
-            QCOMPARE(node5->children().count(), 4);
+            QCOMPARE(mapGeometry.stats().tiles, ct.tiles().count());
+            QCOMPARE(mapGeometry.stats().tiles, 4);
 
            // test adding tiles with wrapping and clipping
             camera.setCenter(QGeoProjection::mercatorToCoord(QDoubleVector2D(0.0, 0.0)));
@@ -472,9 +486,143 @@ class tst_QGeoMapScene : public QObject
             mapGeometry.setVisibleTiles(ct.tiles());
             foreach (QGeoTileSpec spec, ct.tiles())
                 mapGeometry.addTile(spec, tt);
-            QGLSceneNode* node6 = mapGeometry.sceneNode();
-            QCOMPARE(node6->children().count(), ct.tiles().count());
-            QCOMPARE(node6->children().count(), 2);
+            QCOMPARE(mapGeometry.stats().tiles, ct.tiles().count());
+            QCOMPARE(mapGeometry.stats().tiles, 2);
+        }
+
+        void fallbackTiles(){
+            QGeoCameraData camera;
+            camera.setZoomLevel(4.0);
+            camera.setCenter(QGeoProjection::mercatorToCoord(QDoubleVector2D(0.5, 0.5)));
+
+            QGeoMapScene mapGeometry;
+            mapGeometry.setTileSize(16);
+            mapGeometry.setScreenSize(QSize(16,16));
+            mapGeometry.setCameraData(camera);
+
+            QGeoCameraTiles ct;
+            ct.setMaximumZoomLevel(8);
+            ct.setTileSize(16);
+            ct.setCamera(camera);
+            ct.setScreenSize(QSize(16,16));
+            mapGeometry.setVisibleTiles(ct.tiles());
+
+            // the four tiles around the center, 7 and 8 in either direction
+            QGeoTileSpec topLeft;
+            QGeoTileSpec bottomRight;
+            foreach (const QGeoTileSpec &spec, ct.tiles()) {
+                if (spec.x() == 7 && spec.y() == 7)
+                    topLeft = spec;
+                else if (spec.x() == 8 && spec.y() == 8)
+                    bottomRight = spec;
+            }
+            QCOMPARE(topLeft.zoom(), 4);
+            QCOMPARE(bottomRight.zoom(), 4);
+
+            // the top left tile is drawn from its parent
+            QList<QSharedPointer<QGeoTileTexture> > parent;
+            parent << texture(relative(topLeft, 3, 3, 3));
+            mapGeometry.addFallback(topLeft, parent);
+            QCOMPARE(mapGeometry.stats().tiles, 0);
+            QCOMPARE(mapGeometry.stats().fallbackTiles, 1);
+            QCOMPARE(mapGeometry.stats().drawCalls, 1);
+
+            // and the bottom right one from its children
+            QList<QSharedPointer<QGeoTileTexture> > children;
+            for (int i = 0; i < 4; ++i)
+                children << texture(relative(bottomRight, 5, 16 + (i & 1), 16 + (i >> 1)));
+            mapGeometry.addFallback(bottomRight, children);
+            QCOMPARE(mapGeometry.stats().fallbackTiles, 2);
+            QCOMPARE(mapGeometry.stats().drawCalls, 5);
+
+            // the exact tile replaces the fallback and takes over its slot
+            mapGeometry.resetStats();
+            mapGeometry.addTile(topLeft, texture(topLeft));
+            QCOMPARE(mapGeometry.stats().tiles, 1);
+            QCOMPARE(mapGeometry.stats().fallbackTiles, 1);
+            QCOMPARE(mapGeometry.stats().drawCalls, 5);
+            QCOMPARE(mapGeometry.stats().slotAllocations, 0);
+
+            // a fallback for a textured tile is ignored
+            mapGeometry.addFallback(topLeft, parent);
+            QCOMPARE(mapGeometry.stats().fallbackTiles, 1);
+
+            // the fallback goes with its tile, one tile to the left
+            int sideLength = 1 << static_cast<int>(floor(camera.zoomLevel()));
+            camera.setCenter(QGeoProjection::mercatorToCoord(QDoubleVector2D(0.5 - 1.0 / sideLength, 0.5)));
+            mapGeometry.setCameraData(camera);
+            ct.setCamera(camera);
+            QVERIFY(!ct.tiles().contains(bottomRight));
+            mapGeometry.setVisibleTiles(ct.tiles());
+            QCOMPARE(mapGeometry.stats().tiles, 1);
+            QCOMPARE(mapGeometry.stats().fallbackTiles, 0);
+            QCOMPARE(mapGeometry.stats().drawCalls, 1);
+        }
+
+        // Headless: counts what a scripted pan costs the mesh per camera
+        // change, and the draw calls the next frame would make.
+        void drawCallsPerCameraChange(){
+            QGeoCameraData camera;
+            camera.setZoomLevel(4.0);
+
+            QGeoMapScene mapGeometry;
+            mapGeometry.setTileSize(16);
+            mapGeometry.setScreenSize(QSize(64,64));
+
+            QGeoCameraTiles ct;
+            ct.setMaximumZoomLevel(8);
+            ct.setTileSize(16);
+            ct.setScreenSize(QSize(64,64));
+
+            QSharedPointer<QGeoTileTexture> tt(new QGeoTileTexture);
+            tt->texture = new QGLTexture2D();
+
+            int sideLength = 1 << static_cast<int>(floor(camera.zoomLevel()));
+            double quaterTile = 1.0 / (sideLength * 4.0);
+
+            QSet<QGeoTileSpec> previous;
+            int maxVisible = 0;
+            int allocations = 0;
+            for (int step = 0; step < 16; ++step) {
+                camera.setCenter(QGeoProjection::mercatorToCoord(QDoubleVector2D(0.5 + step * quaterTile, 0.5)));
+                mapGeometry.resetStats();
+                mapGeometry.setCameraData(camera);
+                ct.setCamera(camera);
+                QSet<QGeoTileSpec> tiles = ct.tiles();
+                mapGeometry.setVisibleTiles(tiles);
+                foreach (const QGeoTileSpec &spec, tiles)
+                    mapGeometry.addTile(spec, tt);
+
+                QGeoMapSceneStats stats = mapGeometry.stats();
+                // only the tiles coming into view are written
+                QCOMPARE(stats.quadWrites, (tiles - previous).size());
+                QCOMPARE(stats.tiles, tiles.size());
+                // nowhere near the dateline, so the map is drawn once
+                QCOMPARE(stats.copies, 1);
+                QCOMPARE(stats.drawCalls, tiles.size());
+
+                maxVisible = qMax(maxVisible, tiles.size());
+                allocations += stats.slotAllocations;
+                previous = tiles;
+            }
+            // slots of tiles going out of view are reused
+            QVERIFY(allocations <= maxVisible);
+
+            // a view reaching past the dateline draws a second copy
+            QGeoMapScene world;
+            world.setTileSize(16);
+            world.setScreenSize(QSize(16,16));
+            camera.setZoomLevel(0.0);
+            camera.setCenter(QGeoProjection::mercatorToCoord(QDoubleVector2D(0.25, 0.5)));
+            world.setCameraData(camera);
+            ct.setCamera(camera);
+            ct.setScreenSize(QSize(16,16));
+            world.setVisibleTiles(ct.tiles());
+            foreach (const QGeoTileSpec &spec, ct.tiles())
+                world.addTile(spec, tt);
+            QCOMPARE(world.stats().tiles, 1);
+            QCOMPARE(world.stats().copies, 2);
+            QCOMPARE(world.stats().drawCalls, 2);
         }
 };
 
@@ -0,0 +1,9 @@
+CONFIG += testcase
+TARGET = tst_qgeoprojection
+
+INCLUDEPATH += ../../../src/location/maps
+
+SOURCES += tst_qgeoprojection.cpp
+
+QT += location testlib
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
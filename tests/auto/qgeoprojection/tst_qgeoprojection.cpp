@@ -0,0 +1,166 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/location/maps
+
+#include "qgeoprojection_p.h"
+#include "qdoublevector2d_p.h"
+
+#include <QtTest/QtTest>
+#include <QGeoCoordinate>
+#include <QVector>
+
+#include <cmath>
+
+QT_USE_NAMESPACE
+
+class tst_QGeoProjection : public QObject
+{
+    Q_OBJECT
+
+private:
+    // a path winding around the world n times, going up and down in latitude
+    static QVector<double> path(int points, int n);
+
+private Q_SLOTS:
+    void coordinatesToMercator_data();
+    void coordinatesToMercator();
+    void inPlace();
+    void projectPath_data();
+    void projectPath();
+};
+
+QVector<double> tst_QGeoProjection::path(int points, int n)
+{
+    QVector<double> latLon(2 * points);
+    for (int i = 0; i < points; ++i) {
+        double t = double(i) / points;
+        latLon[2 * i] = 84.0 * std::sin(2.0 * M_PI * 3.0 * t);
+        latLon[2 * i + 1] = -180.0 + std::fmod(360.0 * n * t, 360.0);
+    }
+    return latLon;
+}
+
+void tst_QGeoProjection::coordinatesToMercator_data()
+{
+    QTest::addColumn<double>("latitude");
+    QTest::addColumn<double>("longitude");
+
+    QTest::newRow("origin") << 0.0 << 0.0;
+    QTest::newRow("north pole") << 90.0 << 0.0;
+    QTest::newRow("south pole") << -90.0 << 0.0;
+    QTest::newRow("past the mercator limit") << 85.1 << 10.0;
+    QTest::newRow("at the mercator limit") << -85.05112878 << 10.0;
+    QTest::newRow("dateline west") << 12.5 << -180.0;
+    QTest::newRow("dateline east") << -12.5 << 180.0;
+    QTest::newRow("brisbane") << -27.47 << 153.02;
+    QTest::newRow("oslo") << 59.91 << 10.75;
+}
+
+void tst_QGeoProjection::coordinatesToMercator()
+{
+    QFETCH(double, latitude);
+    QFETCH(double, longitude);
+
+    QDoubleVector2D expected = QGeoProjection::coordToMercator(QGeoCoordinate(latitude, longitude));
+
+    // in the middle of a batch, and alone so it takes any scalar tail
+    double latLon[6] = { 1.0, 2.0, latitude, longitude, 3.0, 4.0 };
+    double mercator[6];
+    QGeoProjection::coordinatesToMercator(latLon, mercator, 3);
+    QVERIFY(qAbs(mercator[2] - expected.x()) < 1e-12);
+    QVERIFY(qAbs(mercator[3] - expected.y()) < 1e-12);
+
+    QGeoProjection::coordinatesToMercator(latLon + 2, mercator, 1);
+    QVERIFY(qAbs(mercator[0] - expected.x()) < 1e-12);
+    QVERIFY(qAbs(mercator[1] - expected.y()) < 1e-12);
+}
+
+void tst_QGeoProjection::inPlace()
+{
+    QVector<double> latLon = path(1001, 3);
+    QVector<double> mercator(latLon.size());
+    QGeoProjection::coordinatesToMercator(latLon.constData(), mercator.data(), 1001);
+
+    QGeoProjection::coordinatesToMercator(latLon.constData(), latLon.data(), 1001);
+    QCOMPARE(latLon, mercator);
+}
+
+void tst_QGeoProjection::projectPath_data()
+{
+    QTest::addColumn<bool>("batch");
+
+    QTest::newRow("one at a time") << false;
+    QTest::newRow("batch") << true;
+}
+
+// 100k points, the size of a long recorded track
+void tst_QGeoProjection::projectPath()
+{
+    QFETCH(bool, batch);
+
+    const int points = 100000;
+    QVector<double> latLon = path(points, 5);
+    QVector<double> mercator(latLon.size());
+
+    if (batch) {
+        QBENCHMARK {
+            QGeoProjection::coordinatesToMercator(latLon.constData(), mercator.data(), points);
+        }
+    } else {
+        QBENCHMARK {
+            for (int i = 0; i < points; ++i) {
+                QDoubleVector2D m = QGeoProjection::coordToMercator(
+                            QGeoCoordinate(latLon.at(2 * i), latLon.at(2 * i + 1)));
+                mercator[2 * i] = m.x();
+                mercator[2 * i + 1] = m.y();
+            }
+        }
+    }
+
+    QDoubleVector2D last = QGeoProjection::coordToMercator(
+                QGeoCoordinate(latLon.at(2 * points - 2), latLon.at(2 * points - 1)));
+    QVERIFY(qAbs(mercator.at(2 * points - 2) - last.x()) < 1e-12);
+    QVERIFY(qAbs(mercator.at(2 * points - 1) - last.y()) < 1e-12);
+}
+
+QTEST_APPLESS_MAIN(tst_QGeoProjection)
+#include "tst_qgeoprojection.moc"
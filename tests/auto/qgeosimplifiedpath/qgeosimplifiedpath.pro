@@ -0,0 +1,10 @@
+CONFIG += testcase
+TARGET = tst_qgeosimplifiedpath
+
+INCLUDEPATH += ../../../src/location/maps \
+               ../../../src/location
+
+SOURCES += tst_qgeosimplifiedpath.cpp
+
+QT += location testlib
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
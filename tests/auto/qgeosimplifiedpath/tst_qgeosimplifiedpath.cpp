@@ -0,0 +1,235 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/location/maps
+
+#include "qgeosimplifiedpath_p.h"
+#include "qgeoprojection_p.h"
+#include "qdoublevector2d_p.h"
+
+#include <QtTest/QtTest>
+#include <QGeoCoordinate>
+
+#include <cmath>
+
+QT_USE_NAMESPACE
+
+class tst_QGeoSimplifiedPath : public QObject
+{
+    Q_OBJECT
+
+private:
+    // a GPS track like random walk of n points heading east
+    static QGeoCoordinateArray track(int n)
+    {
+        QGeoCoordinateArray path;
+        path.reserve(n);
+        qsrand(1);
+        double lat = 40.0;
+        double lon = 10.0;
+        for (int i = 0; i < n; ++i) {
+            lat += 1.0e-4 * (qrand() % 201 - 100) / 100.0;
+            lon += 1.0e-4 * (qrand() % 201 - 80) / 100.0;
+            path.append(lat, lon);
+        }
+        return path;
+    }
+
+    static double segmentDistance(const QDoubleVector2D &p, const QDoubleVector2D &a,
+                                  const QDoubleVector2D &b)
+    {
+        QDoubleVector2D ab = b - a;
+        QDoubleVector2D ap = p - a;
+        double length2 = ab.x() * ab.x() + ab.y() * ab.y();
+        double t = length2 > 0.0 ? (ap.x() * ab.x() + ap.y() * ab.y()) / length2 : 0.0;
+        t = qBound(0.0, t, 1.0);
+        QDoubleVector2D d = ap - t * ab;
+        return std::sqrt(d.x() * d.x() + d.y() * d.y());
+    }
+
+private slots:
+    void empty();
+    void straightLine();
+    void invalidPoints();
+    void tolerance();
+    void dateline();
+    void builtFor();
+    void build();
+};
+
+void tst_QGeoSimplifiedPath::empty()
+{
+    QGeoSimplifiedPath none;
+    QCOMPARE(none.levelCount(), 0);
+    QVERIFY(none.indicesForTolerance(1.0).isEmpty());
+
+    QGeoCoordinateArray invalid;
+    invalid.append(QGeoCoordinate());
+    QGeoSimplifiedPath simplified(invalid);
+    QCOMPARE(simplified.levelCount(), 0);
+    QVERIFY(simplified.indicesForTolerance(0.0).isEmpty());
+}
+
+void tst_QGeoSimplifiedPath::straightLine()
+{
+    QGeoCoordinateArray path;
+    for (int i = 0; i <= 100; ++i)
+        path.append(0.0, -50.0 + i);
+
+    QGeoSimplifiedPath simplified(path);
+    int last = simplified.levelCount() - 1;
+
+    QVector<int> ends;
+    ends << 0 << 100;
+    QCOMPARE(simplified.indices(0), ends);
+    QCOMPARE(simplified.indicesForTolerance(1.0e-9), ends);
+
+    QCOMPARE(simplified.tolerance(last), 0.0);
+    QCOMPARE(simplified.indices(last).size(), 101);
+    QCOMPARE(simplified.indicesForTolerance(0.0).size(), 101);
+}
+
+void tst_QGeoSimplifiedPath::invalidPoints()
+{
+    QGeoCoordinateArray path;
+    path.append(QGeoCoordinate());
+    path.append(1.0, 1.0);
+    path.append(QGeoCoordinate());
+    path.append(2.0, 3.0);
+    path.append(1.0, 5.0);
+    path.append(QGeoCoordinate());
+
+    QGeoSimplifiedPath simplified(path);
+    QVector<int> valid;
+    valid << 1 << 3 << 4;
+    QCOMPARE(simplified.indices(simplified.levelCount() - 1), valid);
+}
+
+// every point left out of a level is within its tolerance of the line
+// through the points kept around it, and levels only ever add points
+void tst_QGeoSimplifiedPath::tolerance()
+{
+    QGeoCoordinateArray path = track(5000);
+    QGeoSimplifiedPath simplified(path);
+    QVERIFY(simplified.levelCount() > 2);
+
+    QVector<QDoubleVector2D> mercator;
+    for (int i = 0; i < path.size(); ++i)
+        mercator.append(QGeoProjection::coordToMercator(path.at(i)));
+
+    int previous = 0;
+    for (int level = 0; level < simplified.levelCount(); ++level) {
+        const QVector<int> &indices = simplified.indices(level);
+        double tolerance = simplified.tolerance(level);
+
+        QVERIFY(indices.size() > previous);
+        previous = indices.size();
+        QCOMPARE(indices.first(), 0);
+        QCOMPARE(indices.last(), path.size() - 1);
+
+        if (level > 0)
+            QVERIFY(tolerance < simplified.tolerance(level - 1));
+        QCOMPARE(simplified.indicesForTolerance(tolerance), indices);
+
+        for (int k = 0; k + 1 < indices.size(); ++k) {
+            QVERIFY(indices.at(k) < indices.at(k + 1));
+            const QDoubleVector2D &a = mercator.at(indices.at(k));
+            const QDoubleVector2D &b = mercator.at(indices.at(k + 1));
+            for (int i = indices.at(k) + 1; i < indices.at(k + 1); ++i)
+                QVERIFY(segmentDistance(mercator.at(i), a, b) < tolerance + 1.0e-12);
+        }
+    }
+
+    // no level holds more than half of the points, except the full one
+    for (int level = 0; level < simplified.levelCount() - 1; ++level)
+        QVERIFY(simplified.indices(level).size() <= path.size() / 2);
+    QCOMPARE(simplified.indices(simplified.levelCount() - 1).size(), path.size());
+}
+
+void tst_QGeoSimplifiedPath::dateline()
+{
+    QGeoCoordinateArray path;
+    path.append(10.0, 178.0);
+    path.append(10.0, 179.5);
+    path.append(10.0, -179.5);
+    path.append(10.0, -178.0);
+
+    QGeoSimplifiedPath simplified(path);
+
+    // the straight line across the dateline needs only its ends
+    QVector<int> ends;
+    ends << 0 << 3;
+    QCOMPARE(simplified.indices(0), ends);
+
+    QGeoCoordinate center = QGeoProjection::mercatorToCoord(simplified.center());
+    QVERIFY(qAbs(qAbs(center.longitude()) - 180.0) < 1.0e-6);
+}
+
+void tst_QGeoSimplifiedPath::builtFor()
+{
+    QGeoCoordinateArray path = track(100);
+    QGeoSimplifiedPath simplified(path);
+
+    QGeoCoordinateArray copy = path;
+    QVERIFY(simplified.isBuiltFor(copy));
+
+    // an equal but separately built path is not recognized
+    QVERIFY(!simplified.isBuiltFor(track(100)));
+
+    copy.append(0.0, 0.0);
+    QVERIFY(!simplified.isBuiltFor(copy));
+    QVERIFY(simplified.isBuiltFor(path));
+}
+
+void tst_QGeoSimplifiedPath::build()
+{
+    QGeoCoordinateArray path = track(100000);
+    int levels = 0;
+    QBENCHMARK {
+        QGeoSimplifiedPath simplified(path);
+        levels = simplified.levelCount();
+    }
+    QVERIFY(levels > 2);
+}
+
+QTEST_APPLESS_MAIN(tst_QGeoSimplifiedPath)
+
+#include "tst_qgeosimplifiedpath.moc"
@@ -0,0 +1,10 @@
+CONFIG += testcase
+TARGET = tst_qgeospatialindex
+
+INCLUDEPATH += ../../../src/location/maps \
+               ../../../src/location
+
+SOURCES += tst_qgeospatialindex.cpp
+
+QT += location testlib
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
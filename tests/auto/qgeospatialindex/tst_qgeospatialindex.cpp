@@ -0,0 +1,228 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/location/maps
+
+#include "qgeospatialindex_p.h"
+
+#include <QtTest/QtTest>
+
+QT_USE_NAMESPACE
+
+class tst_QGeoSpatialIndex : public QObject
+{
+    Q_OBJECT
+
+private:
+    static double random(double from, double to)
+    {
+        return from + (to - from) * qrand() / double(RAND_MAX);
+    }
+
+    // whether \a rect overlaps \a query in any of the worlds side by side
+    static bool overlaps(const QRectF &rect, const QRectF &query)
+    {
+        double top = qBound(0.0, rect.top(), 1.0);
+        double bottom = qBound(0.0, rect.bottom(), 1.0);
+        if (top > query.bottom() || query.top() > bottom)
+            return false;
+        if (rect.width() >= 1.0 || query.width() >= 1.0)
+            return true;
+        for (int k = -8; k <= 8; ++k) {
+            if (rect.left() + k <= query.right() && query.left() <= rect.right() + k)
+                return true;
+        }
+        return false;
+    }
+
+    // circles and short polylines spread over a city
+    static QVector<QRectF> cityItems(int n)
+    {
+        QVector<QRectF> items;
+        qsrand(1);
+        for (int i = 0; i < n; ++i) {
+            double x = random(0.52, 0.57);
+            double y = random(0.33, 0.38);
+            if (i % 2)
+                items.append(QRectF(x, y, 2.0e-5, 2.0e-5));
+            else
+                items.append(QRectF(x, y, random(0.0, 4.0e-4), random(0.0, 4.0e-4)));
+        }
+        return items;
+    }
+
+    // a 1024x768 viewport at zoom level 12, grown by half on each side
+    static QRectF viewport(int step)
+    {
+        double width = 1024.0 / (256.0 * (1 << 12));
+        double height = 768.0 / (256.0 * (1 << 12));
+        double x = 0.52 + (step % 100) * 5.0e-4;
+        return QRectF(x - width, 0.35 - height, 2.0 * width, 2.0 * height);
+    }
+
+private slots:
+    void insertAndRemove();
+    void dateline();
+    void intersecting();
+    void pan_data();
+    void pan();
+};
+
+void tst_QGeoSpatialIndex::insertAndRemove()
+{
+    QGeoSpatialIndex<int> index;
+    QVERIFY(index.isEmpty());
+
+    index.insert(1, QRectF(0.1, 0.1, 0.01, 0.01));
+    index.insert(2, QRectF(0.6, 0.6, 0.01, 0.01));
+    QCOMPARE(index.size(), 2);
+    QVERIFY(index.contains(1));
+    QCOMPARE(index.rect(2), QRectF(0.6, 0.6, 0.01, 0.01));
+
+    // inserting again moves the value
+    index.insert(1, QRectF(0.6, 0.6, 0.02, 0.02));
+    QCOMPARE(index.size(), 2);
+    QVERIFY(index.intersecting(QRectF(0.0, 0.0, 0.2, 0.2)).isEmpty());
+    QCOMPARE(index.intersecting(QRectF(0.6, 0.6, 0.1, 0.1)).size(), 2);
+
+    QVERIFY(index.remove(2));
+    QVERIFY(!index.remove(2));
+    QVERIFY(!index.contains(2));
+    QCOMPARE(index.intersecting(QRectF(0.6, 0.6, 0.1, 0.1)), QSet<int>() << 1);
+
+    index.clear();
+    QVERIFY(index.isEmpty());
+    QVERIFY(index.intersecting(QRectF(0.0, 0.0, 1.0, 1.0)).isEmpty());
+}
+
+void tst_QGeoSpatialIndex::dateline()
+{
+    QGeoSpatialIndex<int> index;
+    index.insert(1, QRectF(0.98, 0.5, 0.04, 0.01));   // across the dateline
+    index.insert(2, QRectF(0.01, 0.5, 0.005, 0.01));  // just east of it
+    index.insert(3, QRectF(-0.03, 0.5, 0.005, 0.01)); // just west, unwrapped
+    index.insert(4, QRectF(0.5, 0.5, 0.0, 0.0));      // a point
+
+    QCOMPARE(index.intersecting(QRectF(0.005, 0.4, 0.01, 0.2)), QSet<int>() << 1 << 2);
+    QCOMPARE(index.intersecting(QRectF(0.96, 0.4, 0.02, 0.2)), QSet<int>() << 1 << 3);
+    QCOMPARE(index.intersecting(QRectF(-0.04, 0.4, 0.03, 0.2)), QSet<int>() << 1 << 3);
+    QCOMPARE(index.intersecting(QRectF(1.9, 0.4, 0.2, 0.2)), QSet<int>() << 1 << 2 << 3);
+    QCOMPARE(index.intersecting(QRectF(0.4, 0.4, 0.1, 0.1)), QSet<int>() << 4);
+    QCOMPARE(index.intersecting(QRectF(-0.5, 0.0, 1.0, 1.0)).size(), 4);
+}
+
+// the same answers as testing every rectangle, with values moved and removed
+void tst_QGeoSpatialIndex::intersecting()
+{
+    qsrand(3);
+    QGeoSpatialIndex<int> index;
+    QVector<QRectF> rects;
+    for (int i = 0; i < 2000; ++i) {
+        double width = 1.2 * qPow(random(0.0, 1.0), 6);
+        double height = 0.5 * qPow(random(0.0, 1.0), 6);
+        rects.append(QRectF(random(-1.0, 2.0), random(0.0, 1.0), width, height));
+        index.insert(i, rects.last());
+    }
+    for (int i = 0; i < rects.size(); i += 3)
+        index.remove(i);
+    for (int i = 1; i < rects.size(); i += 3) {
+        rects[i] = QRectF(random(-1.0, 2.0), random(0.0, 1.0), 1.0e-3, 0.0);
+        index.insert(i, rects.at(i));
+    }
+    QCOMPARE(index.size(), 2000 - 667);
+
+    for (int q = 0; q < 200; ++q) {
+        QRectF query(random(-2.0, 2.0), random(-0.1, 1.1),
+                     1.1 * qPow(random(0.0, 1.0), 3), qPow(random(0.0, 1.0), 3));
+        QSet<int> found = index.intersecting(query);
+        for (int i = 0; i < rects.size(); ++i) {
+            bool expected = i % 3 != 0 && overlaps(rects.at(i), query);
+            QCOMPARE(found.contains(i), expected);
+        }
+    }
+}
+
+void tst_QGeoSpatialIndex::pan_data()
+{
+    QTest::addColumn<bool>("indexed");
+    QTest::newRow("every item") << false;
+    QTest::newRow("items in view") << true;
+}
+
+// 10000 items over a city panned across at street level, where the map
+// used to pass every camera change to every item
+void tst_QGeoSpatialIndex::pan()
+{
+    QFETCH(bool, indexed);
+
+    QVector<QRectF> items = cityItems(10000);
+    QGeoSpatialIndex<int> index;
+    for (int i = 0; i < items.size(); ++i)
+        index.insert(i, items.at(i));
+
+    QSet<int> expected;
+    for (int i = 0; i < items.size(); ++i) {
+        if (overlaps(items.at(i), viewport(0)))
+            expected.insert(i);
+    }
+    QCOMPARE(index.intersecting(viewport(0)), expected);
+    QVERIFY(expected.size() < items.size() / 100);
+
+    int updated = 0;
+    QBENCHMARK {
+        for (int step = 0; step < 100; ++step) {
+            QRectF query = viewport(step);
+            if (indexed) {
+                updated += index.intersecting(query).size();
+            } else {
+                for (int i = 0; i < items.size(); ++i) {
+                    if (items.at(i).intersects(query))
+                        ++updated;
+                }
+            }
+        }
+    }
+    QVERIFY(updated > 0);
+}
+
+QTEST_APPLESS_MAIN(tst_QGeoSpatialIndex)
+
+#include "tst_qgeospatialindex.moc"
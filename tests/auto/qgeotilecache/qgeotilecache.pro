@@ -0,0 +1,9 @@
+CONFIG += testcase
+TARGET = tst_qgeotilecache
+
+INCLUDEPATH += ../../../src/location/maps
+
+SOURCES += tst_qgeotilecache.cpp
+
+QT += location 3d testlib
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
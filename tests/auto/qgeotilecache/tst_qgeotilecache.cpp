@@ -0,0 +1,624 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/location/maps
+
+#include "qgeotilespec_p.h"
+#include "qgeotilecache_p.h"
+#include "qgeotilepackstore_p.h"
+
+#include <QtTest/QtTest>
+#include <QtTest/QSignalSpy>
+
+#include <QBuffer>
+#include <QImage>
+#include <QTemporaryDir>
+
+QT_USE_NAMESPACE
+
+class tst_QGeoTileCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QGeoTileCache();
+
+private:
+    static QByteArray tileBytes(int seed, const char *format = "PNG");
+
+private Q_SLOTS:
+    void blockingGet();
+    void nonBlockingGetFromMemory();
+    void nonBlockingGetFromDisk();
+    void nonBlockingGetMissing();
+    void corruptTile_data();
+    void corruptTile();
+    void panFrameTimes_data();
+    void panFrameTimes();
+    void imageTier();
+    void ancestorsAndChildren();
+    void memoryCompression();
+    void stats();
+    void lazyIndex();
+    void packStorage();
+    void packCompaction();
+    void packCompactionFailure();
+    void packReadAfterAppend();
+    void startupTime_data();
+    void startupTime();
+};
+
+tst_QGeoTileCache::tst_QGeoTileCache()
+{
+}
+
+QByteArray tst_QGeoTileCache::tileBytes(int seed, const char *format)
+{
+    QImage image(256, 256, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.setPixel(x, y, qRgb((x * seed) & 0xff, (y + seed) & 0xff, (x ^ y) & 0xff));
+    }
+
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, format);
+    return bytes;
+}
+
+void tst_QGeoTileCache::blockingGet()
+{
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path());
+
+    QGeoTileSpec spec(QStringLiteral("test"), 1, 10, 20, 30);
+    cache.insert(spec, tileBytes(1), QStringLiteral("png"), QGeoTiledMappingManagerEngine::MemoryCache);
+
+    QSharedPointer<QGeoTileTexture> tex = cache.get(spec);
+    QVERIFY(tex);
+    QCOMPARE(tex->spec, spec);
+    QVERIFY(!cache.isDecodePending(spec));
+}
+
+void tst_QGeoTileCache::nonBlockingGetFromMemory()
+{
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path());
+    QSignalSpy spy(&cache, SIGNAL(tileDecoded(QGeoTileSpec)));
+
+    QGeoTileSpec spec(QStringLiteral("test"), 1, 10, 20, 30);
+    cache.insert(spec, tileBytes(2), QStringLiteral("png"), QGeoTiledMappingManagerEngine::MemoryCache);
+
+    QVERIFY(!cache.get(spec, QGeoTileCache::NonBlockingLoad));
+    QVERIFY(cache.isDecodePending(spec));
+
+    // asking again while the decode is in flight must not queue a second one
+    QVERIFY(!cache.get(spec, QGeoTileCache::NonBlockingLoad));
+
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<QGeoTileSpec>(), spec);
+    QVERIFY(!cache.isDecodePending(spec));
+
+    QSharedPointer<QGeoTileTexture> tex = cache.get(spec, QGeoTileCache::NonBlockingLoad);
+    QVERIFY(tex);
+    QCOMPARE(tex->spec, spec);
+}
+
+void tst_QGeoTileCache::nonBlockingGetFromDisk()
+{
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path());
+    QSignalSpy spy(&cache, SIGNAL(tileDecoded(QGeoTileSpec)));
+
+    QGeoTileSpec spec(QStringLiteral("test"), 1, 12, 40, 50);
+    cache.insert(spec, tileBytes(3), QStringLiteral("png"), QGeoTiledMappingManagerEngine::DiskCache);
+    QCOMPARE(cache.memoryUsage(), 0);
+
+    QVERIFY(!cache.get(spec, QGeoTileCache::NonBlockingLoad));
+    QTRY_COMPARE(spy.count(), 1);
+
+    // the bytes read from disk are promoted to the memory cache as well
+    QVERIFY(cache.memoryUsage() > 0);
+    QVERIFY(cache.get(spec, QGeoTileCache::NonBlockingLoad));
+}
+
+void tst_QGeoTileCache::nonBlockingGetMissing()
+{
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path());
+
+    QSignalSpy failed(&cache, SIGNAL(tileDecodeFailed(QGeoTileSpec)));
+
+    // until the index has loaded the decode thread looks for the file
+    QGeoTileSpec spec(QStringLiteral("test"), 1, 5, 1, 1);
+    QVERIFY(!cache.get(spec, QGeoTileCache::NonBlockingLoad));
+    QTRY_COMPARE(failed.count(), 1);
+    QCOMPARE(failed.at(0).at(0).value<QGeoTileSpec>(), spec);
+    QVERIFY(!cache.isDecodePending(spec));
+
+    QTRY_VERIFY(cache.isIndexLoaded());
+    QVERIFY(!cache.get(spec, QGeoTileCache::NonBlockingLoad));
+    QVERIFY(!cache.isDecodePending(spec));
+    QCOMPARE(failed.count(), 1);
+}
+
+void tst_QGeoTileCache::corruptTile_data()
+{
+    QTest::addColumn<int>("storage");
+
+    QTest::newRow("files") << int(QGeoTiledMappingManagerEngine::FileStorage);
+    QTest::newRow("pack") << int(QGeoTiledMappingManagerEngine::PackStorage);
+}
+
+void tst_QGeoTileCache::corruptTile()
+{
+    QFETCH(int, storage);
+
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path(), QGeoTiledMappingManagerEngine::DiskCacheStorage(storage));
+    QTRY_VERIFY(cache.isIndexLoaded());
+    QSignalSpy decoded(&cache, SIGNAL(tileDecoded(QGeoTileSpec)));
+    QSignalSpy failed(&cache, SIGNAL(tileDecodeFailed(QGeoTileSpec)));
+
+    QGeoTileSpec spec(QStringLiteral("test"), 1, 9, 7, 8);
+    cache.insert(spec, QByteArray(512, 'x'), QStringLiteral("png"),
+                 QGeoTiledMappingManagerEngine::DiskCache);
+    QVERIFY(cache.isInDiskCache(spec));
+    QVERIFY(cache.diskUsage() > 0);
+
+    QVERIFY(!cache.get(spec, QGeoTileCache::NonBlockingLoad));
+    QTRY_COMPARE(failed.count(), 1);
+    QCOMPARE(failed.at(0).at(0).value<QGeoTileSpec>(), spec);
+    QCOMPARE(decoded.count(), 0);
+
+    // the bad tile is gone from every tier, so it is fetched again
+    QVERIFY(!cache.isInDiskCache(spec));
+    QCOMPARE(cache.diskUsage(), 0);
+    QCOMPARE(cache.memoryUsage(), 0);
+    QVERIFY(!cache.get(spec, QGeoTileCache::NonBlockingLoad));
+    QVERIFY(!cache.isDecodePending(spec));
+    if (storage == QGeoTiledMappingManagerEngine::FileStorage)
+        QVERIFY(QDir(dir.path()).entryList(QStringList() << QStringLiteral("*.png")).isEmpty());
+
+    // a good copy takes its place
+    cache.insert(spec, tileBytes(9), QStringLiteral("png"), QGeoTiledMappingManagerEngine::DiskCache);
+    QVERIFY(!cache.get(spec, QGeoTileCache::NonBlockingLoad));
+    QTRY_COMPARE(decoded.count(), 1);
+    QVERIFY(cache.get(spec, QGeoTileCache::NonBlockingLoad));
+}
+
+void tst_QGeoTileCache::panFrameTimes_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::newRow("blocking") << int(QGeoTileCache::BlockingLoad);
+    QTest::newRow("non-blocking") << int(QGeoTileCache::NonBlockingLoad);
+}
+
+// Scripted pan across a 16x16 block of cached tiles: each frame a new column
+// of tiles becomes visible, which is what the request manager asks for.
+void tst_QGeoTileCache::panFrameTimes()
+{
+    QFETCH(int, mode);
+
+    const int side = 16;
+    const int visibleColumns = 4;
+
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path());
+    cache.setMaxMemoryUsage(64 * 1024 * 1024);
+    cache.setExtraTextureUsage(128 * 1024 * 1024);
+
+    for (int x = 0; x < side; ++x) {
+        for (int y = 0; y < side; ++y) {
+            cache.insert(QGeoTileSpec(QStringLiteral("test"), 1, 15, x, y),
+                         tileBytes(x * side + y), QStringLiteral("png"),
+                         QGeoTiledMappingManagerEngine::MemoryCache);
+        }
+    }
+
+    // the pan can only be run once, afterwards every tile is a texture
+    QBENCHMARK_ONCE {
+        for (int frame = 0; frame + visibleColumns <= side; ++frame) {
+            int x = frame + visibleColumns - 1;
+            for (int y = 0; y < side; ++y)
+                cache.get(QGeoTileSpec(QStringLiteral("test"), 1, 15, x, y),
+                          QGeoTileCache::LoadMode(mode));
+
+            // let decoded tiles arrive between frames, as the event loop would
+            QCoreApplication::processEvents();
+        }
+    }
+
+    // every visited tile must end up in the texture cache eventually
+    for (int x = visibleColumns - 1; x < side; ++x) {
+        QGeoTileSpec spec(QStringLiteral("test"), 1, 15, x, 0);
+        QTRY_VERIFY(!cache.isDecodePending(spec));
+        QVERIFY(cache.get(spec, QGeoTileCache::NonBlockingLoad));
+    }
+}
+
+void tst_QGeoTileCache::imageTier()
+{
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path());
+    cache.setMaxImageUsage(4 * 1024 * 1024);
+    // room for a single 256x256 texture
+    cache.setExtraTextureUsage(300 * 1024);
+
+    QGeoTileSpec first(QStringLiteral("test"), 1, 10, 1, 1);
+    QGeoTileSpec second(QStringLiteral("test"), 1, 10, 2, 1);
+    cache.insert(first, tileBytes(7), QStringLiteral("png"), QGeoTiledMappingManagerEngine::MemoryCache);
+    cache.insert(second, tileBytes(8), QStringLiteral("png"), QGeoTiledMappingManagerEngine::MemoryCache);
+
+    QVERIFY(cache.get(first));
+    QVERIFY(cache.imageUsage() > 0);
+    QVERIFY(cache.get(second));
+    QVERIFY(cache.textureUsage() <= cache.maxTextureUsage());
+
+    // the first texture is gone but its image is not, so no decode is queued
+    QSharedPointer<QGeoTileTexture> tex = cache.get(first, QGeoTileCache::NonBlockingLoad);
+    QVERIFY(tex);
+    QVERIFY(!cache.isDecodePending(first));
+}
+
+void tst_QGeoTileCache::ancestorsAndChildren()
+{
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path());
+
+    QGeoTileSpec parent(QStringLiteral("test"), 1, 10, 20, 30);
+    QGeoTileSpec child(QStringLiteral("test"), 1, 11, 40, 61);
+    QGeoTileSpec tile(QStringLiteral("test"), 1, 12, 81, 122);
+    cache.insert(parent, tileBytes(9), QStringLiteral("png"), QGeoTiledMappingManagerEngine::MemoryCache);
+    cache.insert(child, tileBytes(10), QStringLiteral("png"), QGeoTiledMappingManagerEngine::MemoryCache);
+
+    // only encoded tiles, which would need a decode
+    QVERIFY(!cache.bestAncestor(tile));
+    QVERIFY(cache.availableChildren(parent).isEmpty());
+    QVERIFY(!cache.isDecodePending(parent));
+    QVERIFY(!cache.isDecodePending(child));
+
+    QVERIFY(cache.get(parent));
+    QSharedPointer<QGeoTileTexture> ancestor = cache.bestAncestor(tile);
+    QVERIFY(ancestor);
+    QCOMPARE(ancestor->spec, parent);
+    QVERIFY(!cache.bestAncestor(tile, 1));
+
+    // the closest ancestor wins
+    QVERIFY(cache.get(child));
+    ancestor = cache.bestAncestor(tile);
+    QVERIFY(ancestor);
+    QCOMPARE(ancestor->spec, child);
+
+    QList<QSharedPointer<QGeoTileTexture> > children = cache.availableChildren(parent);
+    QCOMPARE(children.size(), 1);
+    QCOMPARE(children.first()->spec, child);
+}
+
+void tst_QGeoTileCache::memoryCompression()
+{
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path());
+    cache.setMemoryCompression(true);
+    cache.setMaxMemoryUsage(16 * 1024 * 1024);
+
+    // BMP compresses well, PNG does not
+    QGeoTileSpec bmp(QStringLiteral("test"), 1, 10, 1, 1);
+    QByteArray bmpBytes = tileBytes(9, "BMP");
+    cache.insert(bmp, bmpBytes, QStringLiteral("bmp"), QGeoTiledMappingManagerEngine::MemoryCache);
+    QVERIFY(cache.memoryUsage() < bmpBytes.size() / 2);
+
+    QGeoTileSpec png(QStringLiteral("test"), 1, 10, 2, 1);
+    QByteArray pngBytes = tileBytes(9);
+    int before = cache.memoryUsage();
+    cache.insert(png, pngBytes, QStringLiteral("png"), QGeoTiledMappingManagerEngine::MemoryCache);
+    QCOMPARE(cache.memoryUsage() - before, pngBytes.size());
+
+    QVERIFY(cache.get(png));
+
+    // the compressed tile is unpacked on the decode thread
+    QSignalSpy spy(&cache, SIGNAL(tileDecoded(QGeoTileSpec)));
+    QVERIFY(!cache.get(bmp, QGeoTileCache::NonBlockingLoad));
+    QTRY_COMPARE(spy.count(), 1);
+    QVERIFY(cache.get(bmp, QGeoTileCache::NonBlockingLoad));
+}
+
+void tst_QGeoTileCache::stats()
+{
+    QTemporaryDir dir;
+    QGeoTileCache cache(dir.path());
+    // room for a single 256x256 texture
+    cache.setExtraTextureUsage(300 * 1024);
+
+    QGeoTileSpec first(QStringLiteral("test"), 1, 10, 1, 1);
+    QGeoTileSpec second(QStringLiteral("test"), 1, 10, 2, 1);
+    QGeoTileSpec missing(QStringLiteral("test"), 1, 10, 3, 1);
+    QByteArray firstBytes = tileBytes(10);
+    QByteArray secondBytes = tileBytes(11);
+    cache.insert(first, firstBytes, QStringLiteral("png"), QGeoTiledMappingManagerEngine::MemoryCache);
+    cache.insert(second, secondBytes, QStringLiteral("png"), QGeoTiledMappingManagerEngine::MemoryCache);
+
+    QVERIFY(cache.get(first));
+    QVERIFY(cache.get(first));
+    QVERIFY(cache.get(second));
+    QVERIFY(!cache.get(missing));
+
+    QVariantMap stats = cache.stats();
+    QVariantMap texture = stats.value(QStringLiteral("texture")).toMap();
+    QVariantMap memory = stats.value(QStringLiteral("memory")).toMap();
+    QVariantMap disk = stats.value(QStringLiteral("disk")).toMap();
+
+    QCOMPARE(texture.value(QStringLiteral("hits")).toInt(), 1);
+    QCOMPARE(texture.value(QStringLiteral("misses")).toInt(), 3);
+    QVERIFY(texture.value(QStringLiteral("evictions")).toInt() >= 1);
+    QCOMPARE(texture.value(QStringLiteral("count")).toInt(), 1);
+    QCOMPARE(memory.value(QStringLiteral("hits")).toInt(), 2);
+    QCOMPARE(memory.value(QStringLiteral("misses")).toInt(), 1);
+    QCOMPARE(memory.value(QStringLiteral("bytesIn")).toInt(), firstBytes.size() + secondBytes.size());
+    QCOMPARE(disk.value(QStringLiteral("misses")).toInt(), 1);
+
+    QVariantMap decodeTime = stats.value(QStringLiteral("decodeTime")).toMap();
+    QCOMPARE(decodeTime.value(QStringLiteral("count")).toInt(), 2);
+    QVERIFY(!decodeTime.value(QStringLiteral("buckets")).toList().isEmpty());
+
+    cache.resetStats();
+    stats = cache.stats();
+    texture = stats.value(QStringLiteral("texture")).toMap();
+    QCOMPARE(texture.value(QStringLiteral("hits")).toInt(), 0);
+    QCOMPARE(texture.value(QStringLiteral("count")).toInt(), 1);
+    QCOMPARE(stats.value(QStringLiteral("decodeTime")).toMap().value(QStringLiteral("count")).toInt(), 0);
+
+    QSignalSpy spy(&cache, SIGNAL(statsUpdated(QVariantMap)));
+    cache.setStatsInterval(10);
+    QCOMPARE(cache.statsInterval(), 10);
+    QTRY_VERIFY(spy.count() > 0);
+    cache.setStatsInterval(0);
+    QCOMPARE(cache.statsInterval(), 0);
+}
+
+void tst_QGeoTileCache::lazyIndex()
+{
+    QTemporaryDir dir;
+    QList<QGeoTileSpec> specs;
+    for (int i = 0; i < 600; ++i)
+        specs.append(QGeoTileSpec(QStringLiteral("test"), 1, 13, i, i % 7));
+
+    QByteArray bytes = tileBytes(6);
+    const int maxUsage = specs.size() * bytes.size() * 2;
+
+    int usage = 0;
+    {
+        QGeoTileCache cache(dir.path());
+        cache.setMaxDiskUsage(maxUsage);
+        QTRY_VERIFY(cache.isIndexLoaded());
+        for (int i = 0; i < specs.size(); ++i) {
+            cache.insert(specs.at(i), bytes, QStringLiteral("png"),
+                         QGeoTiledMappingManagerEngine::DiskCache);
+        }
+        usage = cache.diskUsage();
+    }
+
+    QGeoTileCache cache(dir.path());
+    cache.setMaxDiskUsage(maxUsage);
+    QSignalSpy spy(&cache, SIGNAL(indexLoaded()));
+    QCOMPARE(cache.timeToFirstTile(), qint64(-1));
+
+    // found by probing the file system if the index is not there yet
+    QSharedPointer<QGeoTileTexture> tex = cache.get(specs.last());
+    QVERIFY(tex);
+    QVERIFY(cache.timeToFirstTile() >= 0);
+
+    QTRY_COMPARE(spy.count(), 1);
+    QVERIFY(cache.isIndexLoaded());
+    QVERIFY(cache.indexLoadTime() >= 0);
+    QCOMPARE(cache.diskUsage(), usage);
+}
+
+void tst_QGeoTileCache::packStorage()
+{
+    QTemporaryDir dir;
+    QGeoTileSpec first(QStringLiteral("test"), 1, 10, 1, 2);
+    QGeoTileSpec second(QStringLiteral("other"), 2, 11, 3, 4);
+    int usage = 0;
+
+    {
+        QGeoTileCache cache(dir.path(), QGeoTiledMappingManagerEngine::PackStorage);
+        QCOMPARE(cache.diskStorage(), QGeoTiledMappingManagerEngine::PackStorage);
+        cache.insert(first, tileBytes(4), QStringLiteral("png"), QGeoTiledMappingManagerEngine::DiskCache);
+        cache.insert(second, tileBytes(5), QStringLiteral("png"), QGeoTiledMappingManagerEngine::DiskCache);
+        usage = cache.diskUsage();
+        QVERIFY(usage > 0);
+    }
+
+    QStringList files = QDir(dir.path()).entryList(QDir::Files);
+    QCOMPARE(files.size(), 2);
+    QVERIFY(files.contains(QStringLiteral("tiles.pack")));
+    QVERIFY(files.contains(QStringLiteral("tiles.idx")));
+
+    QGeoTileCache cache(dir.path(), QGeoTiledMappingManagerEngine::PackStorage);
+    QCOMPARE(cache.diskUsage(), usage);
+
+    QSharedPointer<QGeoTileTexture> tex = cache.get(second);
+    QVERIFY(tex);
+    QCOMPARE(tex->spec, second);
+
+    QSignalSpy spy(&cache, SIGNAL(tileDecoded(QGeoTileSpec)));
+    QVERIFY(!cache.get(first, QGeoTileCache::NonBlockingLoad));
+    QTRY_COMPARE(spy.count(), 1);
+    QVERIFY(cache.get(first, QGeoTileCache::NonBlockingLoad));
+}
+
+void tst_QGeoTileCache::packCompaction()
+{
+    QTemporaryDir dir;
+    QGeoTilePackStore store(dir.path());
+    QVERIFY(store.open());
+
+    const int count = 64;
+    for (int i = 0; i < count; ++i) {
+        QByteArray bytes(128 * 1024, char(i));
+        QVERIFY(store.insert(QGeoTileSpec(QStringLiteral("test"), 1, 12, i, 0), bytes,
+                             QStringLiteral("png")));
+    }
+    QCOMPARE(store.liveSize(), store.dataSize());
+
+    // dropping three quarters of the tiles kicks off a compaction
+    for (int i = 0; i < count; ++i) {
+        if (i % 4)
+            store.remove(QGeoTileSpec(QStringLiteral("test"), 1, 12, i, 0));
+    }
+
+    // appended while the compaction may still be running
+    QByteArray late(1024, 'x');
+    QVERIFY(store.insert(QGeoTileSpec(QStringLiteral("test"), 1, 12, 0, 1), late,
+                         QStringLiteral("jpg")));
+
+    store.waitForCompaction();
+    QVERIFY(store.dataSize() < count * 128 * 1024 / 2);
+
+    // tiles removed while the copy ran are only reclaimed by the next one
+    store.compact();
+    store.waitForCompaction();
+    QCOMPARE(store.dataSize(), store.liveSize());
+
+    for (int i = 0; i < count; i += 4) {
+        QByteArray bytes = store.read(QGeoTileSpec(QStringLiteral("test"), 1, 12, i, 0));
+        QCOMPARE(bytes, QByteArray(128 * 1024, char(i)));
+    }
+    QString format;
+    QCOMPARE(store.read(QGeoTileSpec(QStringLiteral("test"), 1, 12, 0, 1), &format), late);
+    QCOMPARE(format, QStringLiteral("jpg"));
+    QVERIFY(!store.contains(QGeoTileSpec(QStringLiteral("test"), 1, 12, 1, 0)));
+}
+
+void tst_QGeoTileCache::packCompactionFailure()
+{
+    QTemporaryDir dir;
+
+    // a directory in the way of the backup stops the data file from being
+    // moved aside, so the compacted file can't be put in its place
+    QDir(dir.path()).mkpath(QStringLiteral("tiles.pack.old/blocker"));
+
+    QGeoTilePackStore store(dir.path());
+    QVERIFY(store.open());
+
+    const int count = 64;
+    for (int i = 0; i < count; ++i) {
+        QByteArray bytes(128 * 1024, char(i));
+        QVERIFY(store.insert(QGeoTileSpec(QStringLiteral("test"), 1, 12, i, 0), bytes,
+                             QStringLiteral("png")));
+    }
+    for (int i = 0; i < count; ++i) {
+        if (i % 4)
+            store.remove(QGeoTileSpec(QStringLiteral("test"), 1, 12, i, 0));
+    }
+    store.compact();
+    store.waitForCompaction();
+
+    // nothing moved, the records still point into the old file
+    QCOMPARE(store.dataSize(), qint64(count * 128 * 1024));
+    QVERIFY(!QFile::exists(dir.path() + QStringLiteral("/tiles.pack.compact")));
+    for (int i = 0; i < count; i += 4) {
+        QByteArray bytes = store.read(QGeoTileSpec(QStringLiteral("test"), 1, 12, i, 0));
+        QCOMPARE(bytes, QByteArray(128 * 1024, char(i)));
+    }
+}
+
+void tst_QGeoTileCache::packReadAfterAppend()
+{
+    QTemporaryDir dir;
+    QGeoTilePackStore store(dir.path());
+    QVERIFY(store.open());
+
+    // every read maps what is there, every insert grows the file behind it
+    for (int i = 0; i < 32; ++i) {
+        QByteArray bytes(4096 + i, char(i));
+        QVERIFY(store.insert(QGeoTileSpec(QStringLiteral("test"), 1, 12, i, 0), bytes,
+                             QStringLiteral("png")));
+        for (int j = 0; j <= i; ++j) {
+            QCOMPARE(store.read(QGeoTileSpec(QStringLiteral("test"), 1, 12, j, 0)),
+                     QByteArray(4096 + j, char(j)));
+        }
+    }
+}
+
+void tst_QGeoTileCache::startupTime_data()
+{
+    QTest::addColumn<int>("storage");
+    QTest::newRow("files") << int(QGeoTiledMappingManagerEngine::FileStorage);
+    QTest::newRow("pack") << int(QGeoTiledMappingManagerEngine::PackStorage);
+}
+
+// Time until the whole index is available, for a warm disk cache of a few
+// thousand tiles
+void tst_QGeoTileCache::startupTime()
+{
+    QFETCH(int, storage);
+    QGeoTiledMappingManagerEngine::DiskCacheStorage diskStorage =
+            QGeoTiledMappingManagerEngine::DiskCacheStorage(storage);
+
+    const int count = 4000;
+    QByteArray bytes(2048, 'x');
+
+    QTemporaryDir dir;
+    {
+        QGeoTileCache cache(dir.path(), diskStorage);
+        for (int i = 0; i < count; ++i) {
+            cache.insert(QGeoTileSpec(QStringLiteral("test"), 1, 14, i % 64, i / 64),
+                         bytes, QStringLiteral("png"), QGeoTiledMappingManagerEngine::DiskCache);
+        }
+    }
+
+    // a second run would time the queue files written by the first one
+    QScopedPointer<QGeoTileCache> cache;
+    QBENCHMARK_ONCE {
+        cache.reset(new QGeoTileCache(dir.path(), diskStorage));
+        // the bytes are no image, so look at the disk cache rather than get()
+        QTRY_VERIFY(cache->isIndexLoaded());
+    }
+
+    QCOMPARE(cache->diskUsage(), count * bytes.size());
+}
+
+QTEST_MAIN(tst_QGeoTileCache)
+
+#include "tst_qgeotilecache.moc"
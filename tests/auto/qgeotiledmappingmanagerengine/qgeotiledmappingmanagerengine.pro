@@ -0,0 +1,8 @@
+CONFIG += testcase
+TARGET = tst_qgeotiledmappingmanagerengine
+
+INCLUDEPATH += ../../../src/location/maps
+
+SOURCES += tst_qgeotiledmappingmanagerengine.cpp
+
+QT += location testlib
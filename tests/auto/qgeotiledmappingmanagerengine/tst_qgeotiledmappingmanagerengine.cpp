@@ -0,0 +1,653 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/location/maps
+
+#include "qgeotiledmappingmanagerengine_p.h"
+#include "qgeotilefetcher_p.h"
+#include "qgeotiledmapreply_p.h"
+#include "qgeotilespec_p.h"
+#include "qgeotilekey_p.h"
+#include "qgeotilerequestqueue_p.h"
+#include "qgeocameratiles_p.h"
+#include "qgeocameracapabilities_p.h"
+#include "qgeomaptype_p.h"
+
+#include <QtTest/QtTest>
+#include <QtTest/QSignalSpy>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTemporaryDir>
+#include <QGeoRectangle>
+
+QT_USE_NAMESPACE
+
+// a reply which never finishes, so requests stay in flight until canceled
+class PendingReply : public QGeoTiledMapReply
+{
+    Q_OBJECT
+public:
+    PendingReply(const QGeoTileSpec &spec, QObject *parent = 0)
+        : QGeoTiledMapReply(spec, parent) {}
+
+    void abort();
+};
+
+// a reply which is done as soon as it is made
+class FinishedReply : public QGeoTiledMapReply
+{
+    Q_OBJECT
+public:
+    FinishedReply(const QGeoTileSpec &spec, QObject *parent = 0)
+        : QGeoTiledMapReply(spec, parent)
+    {
+        setMapImageData(QByteArray(64, 'x'));
+        setMapImageFormat(QStringLiteral("png"));
+        setFinished(true);
+    }
+};
+
+class RecordingFetcher : public QGeoTileFetcher
+{
+    Q_OBJECT
+public:
+    RecordingFetcher(QGeoTiledMappingManagerEngine *engine, int window)
+        : QGeoTileFetcher(engine),
+          finishReplies_(false)
+    {
+        setMaximumConcurrentRequests(window);
+    }
+
+    void setFinishReplies(bool finish)
+    {
+        QMutexLocker ml(&mutex_);
+        finishReplies_ = finish;
+    }
+
+    QList<QGeoTileSpec> requested() const
+    {
+        QMutexLocker ml(&mutex_);
+        return requested_;
+    }
+
+    QList<QGeoTileSpec> aborted() const
+    {
+        QMutexLocker ml(&mutex_);
+        return aborted_;
+    }
+
+    void recordAbort(const QGeoTileSpec &spec)
+    {
+        QMutexLocker ml(&mutex_);
+        aborted_.append(spec);
+    }
+
+protected:
+    bool init() { return true; }
+
+private:
+    QGeoTiledMapReply *getTileImage(const QGeoTileSpec &spec)
+    {
+        QMutexLocker ml(&mutex_);
+        requested_.append(spec);
+        if (finishReplies_)
+            return new FinishedReply(spec, this);
+        return new PendingReply(spec, this);
+    }
+
+    mutable QMutex mutex_;
+    bool finishReplies_;
+    QList<QGeoTileSpec> requested_;
+    QList<QGeoTileSpec> aborted_;
+};
+
+void PendingReply::abort()
+{
+    static_cast<RecordingFetcher *>(parent())->recordAbort(tileSpec());
+    QGeoTiledMapReply::abort();
+}
+
+class TestEngine : public QGeoTiledMappingManagerEngine
+{
+    Q_OBJECT
+public:
+    TestEngine(int window = 100000)
+    {
+        setTileSize(QSize(256, 256));
+        fetcher_ = new RecordingFetcher(this, window);
+        setTileFetcher(fetcher_);
+
+        QGeoCameraCapabilities capabilities;
+        capabilities.setMinimumZoomLevel(0.0);
+        capabilities.setMaximumZoomLevel(20.0);
+        setCameraCapabilities(capabilities);
+    }
+
+    QGeoMapData *createMapData() { return 0; }
+
+    void setCacheDirectory(const QString &directory)
+    {
+        createTileCacheWithDir(directory);
+    }
+
+    RecordingFetcher *fetcher_;
+};
+
+class tst_QGeoTiledMappingManagerEngine : public QObject
+{
+    Q_OBJECT
+
+private:
+    // the engine only uses maps as keys until a tile arrives, and the
+    // replies of the test fetcher never finish
+    static QGeoTiledMapData *fakeMap(int i)
+    {
+        return reinterpret_cast<QGeoTiledMapData *>(quintptr(i + 1) * 64);
+    }
+
+    static QSet<QGeoTileSpec> column(int x, int zoom, int height)
+    {
+        QSet<QGeoTileSpec> tiles;
+        for (int y = 0; y < height; ++y)
+            tiles.insert(QGeoTileSpec("plugin", 1, zoom, x, y));
+        return tiles;
+    }
+
+    static QSet<QGeoTileSpec> block(int x, int width, int zoom, int height)
+    {
+        QSet<QGeoTileSpec> tiles;
+        for (int i = 0; i < width; ++i)
+            tiles += column(x + i, zoom, height);
+        return tiles;
+    }
+
+    static int areaTileCount(const QGeoShape &area, int minZoom, int maxZoom)
+    {
+        QGeoCameraTiles cameraTiles;
+        int count = 0;
+        for (int zoom = minZoom; zoom <= maxZoom; ++zoom)
+            count += cameraTiles.tilesForArea(area, zoom).size();
+        return count;
+    }
+
+private slots:
+    void requestQueueOrder();
+    void sharedTiles();
+    void deregisterMap();
+    void prefetch();
+    void fetchOrder();
+    void fetchCancel();
+    void fetchWindow();
+    void seedTiles();
+    void cancelSeeding();
+    void seedInFlight();
+    void seedQueueCap();
+    void perFrame_data();
+    void perFrame();
+};
+
+void tst_QGeoTiledMappingManagerEngine::requestQueueOrder()
+{
+    QGeoTileRequestQueue queue;
+    QVERIFY(queue.isEmpty());
+
+    for (int i = 0; i < 5; ++i) {
+        QGeoTileRequestDelta *delta = new QGeoTileRequestDelta;
+        delta->added.append(QGeoTileKey(1, 1, 3, i, 0));
+        // only the first push has to wake the consumer
+        QCOMPARE(queue.push(delta), i == 0);
+    }
+
+    QGeoTileRequestDelta *delta = queue.takeAll();
+    QVERIFY(queue.isEmpty());
+    for (int i = 0; i < 5; ++i) {
+        QVERIFY(delta);
+        QCOMPARE(delta->added.first().x(), i);
+        QGeoTileRequestDelta *next = delta->next;
+        delete delta;
+        delta = next;
+    }
+    QVERIFY(!delta);
+
+    // pushing from several threads loses nothing
+    class Pusher : public QThread
+    {
+    public:
+        Pusher(QGeoTileRequestQueue *queue, int id) : queue_(queue), id_(id) {}
+        void run()
+        {
+            for (int i = 0; i < 1000; ++i) {
+                QGeoTileRequestDelta *delta = new QGeoTileRequestDelta;
+                delta->added.append(QGeoTileKey(1, 1, 10, id_, i));
+                queue_->push(delta);
+            }
+        }
+        QGeoTileRequestQueue *queue_;
+        int id_;
+    };
+
+    QList<Pusher *> pushers;
+    for (int t = 0; t < 4; ++t)
+        pushers.append(new Pusher(&queue, t));
+    foreach (Pusher *p, pushers)
+        p->start();
+
+    QVector<int> last(4, -1);
+    int total = 0;
+    bool running = true;
+    while (running || !queue.isEmpty()) {
+        running = false;
+        foreach (Pusher *p, pushers)
+            running = running || !p->isFinished();
+
+        delta = queue.takeAll();
+        while (delta) {
+            // the deltas of each producer come out in order
+            QGeoTileKey key = delta->added.first();
+            QCOMPARE(key.y(), last[key.x()] + 1);
+            last[key.x()] = key.y();
+            ++total;
+            QGeoTileRequestDelta *next = delta->next;
+            delete delta;
+            delta = next;
+        }
+    }
+    foreach (Pusher *p, pushers) {
+        p->wait();
+        delete p;
+    }
+    QCOMPARE(total, 4000);
+}
+
+void tst_QGeoTiledMappingManagerEngine::sharedTiles()
+{
+    TestEngine engine;
+    RecordingFetcher *fetcher = engine.fetcher_;
+
+    QSet<QGeoTileSpec> tilesA = block(0, 3, 4, 3);
+    QSet<QGeoTileSpec> tilesB = block(2, 3, 4, 3);
+
+    engine.updateTileRequests(fakeMap(0), tilesA, QSet<QGeoTileSpec>());
+    engine.updateTileRequests(fakeMap(1), tilesB, QSet<QGeoTileSpec>());
+
+    // the shared column is only fetched once
+    QTRY_COMPARE(fetcher->requested().size(), 15);
+    QCOMPARE(fetcher->requested().toSet(), tilesA + tilesB);
+
+    // map A lets go of everything, the column B still needs stays
+    engine.updateTileRequests(fakeMap(0), QSet<QGeoTileSpec>(), tilesA);
+    QTRY_COMPARE(fetcher->aborted().size(), 6);
+    QCOMPARE(fetcher->aborted().toSet(), tilesA - tilesB);
+
+    // dropping and asking again in one update leaves the request alone
+    QSet<QGeoTileSpec> shared = column(2, 4, 3);
+    engine.updateTileRequests(fakeMap(1), shared, shared);
+    engine.updateTileRequests(fakeMap(1), QSet<QGeoTileSpec>(), tilesB - shared);
+    QTRY_COMPARE(fetcher->aborted().size(), 12);
+    QCOMPARE(fetcher->requested().size(), 15);
+    QVERIFY((fetcher->aborted().toSet() & shared).isEmpty());
+}
+
+void tst_QGeoTiledMappingManagerEngine::deregisterMap()
+{
+    TestEngine engine;
+    RecordingFetcher *fetcher = engine.fetcher_;
+
+    QSet<QGeoTileSpec> tiles = block(0, 2, 5, 2);
+
+    engine.registerMap(fakeMap(0));
+    engine.registerMap(fakeMap(1));
+    engine.updateTileRequests(fakeMap(0), tiles, QSet<QGeoTileSpec>());
+    engine.updateTileRequests(fakeMap(1), tiles, QSet<QGeoTileSpec>());
+    QTRY_COMPARE(fetcher->requested().size(), 4);
+
+    // once map 0 is gone, map 1 alone decides about the tiles
+    engine.deregisterMap(fakeMap(0));
+    engine.updateTileRequests(fakeMap(1), QSet<QGeoTileSpec>(), tiles);
+    QTRY_COMPARE(fetcher->aborted().size(), 4);
+
+    engine.deregisterMap(fakeMap(1));
+}
+
+void tst_QGeoTiledMappingManagerEngine::prefetch()
+{
+    TestEngine engine;
+    RecordingFetcher *fetcher = engine.fetcher_;
+
+    QList<QGeoTileSpec> ahead = block(0, 2, 6, 2).toList();
+    engine.prefetchTiles(fakeMap(0), ahead);
+    QTRY_COMPARE(fetcher->requested().size(), 4);
+
+    // a map asking for a prefetched tile doesn't fetch it again
+    QSet<QGeoTileSpec> visible;
+    visible << ahead.first();
+    engine.updateTileRequests(fakeMap(0), visible, QSet<QGeoTileSpec>());
+
+    // a new path cancels the old one, except for what a map needs
+    QList<QGeoTileSpec> next = column(5, 6, 2).toList();
+    engine.prefetchTiles(fakeMap(0), next);
+    QTRY_COMPARE(fetcher->requested().size(), 6);
+    QTRY_COMPARE(fetcher->aborted().size(), 3);
+    QVERIFY(!fetcher->aborted().contains(ahead.first()));
+
+    // and the camera stopping cancels the rest
+    engine.prefetchTiles(fakeMap(0), QList<QGeoTileSpec>());
+    QTRY_COMPARE(fetcher->aborted().size(), 5);
+    QCOMPARE(fetcher->requested().size(), 6);
+}
+
+void tst_QGeoTiledMappingManagerEngine::fetchOrder()
+{
+    // one request at a time, canceling it lets the next one go
+    TestEngine engine(1);
+    RecordingFetcher *fetcher = engine.fetcher_;
+
+    const int zoom = 4;
+    const double side = 16.0;
+
+    // looking at the middle of tile 0, 0 with the tiles around it visible
+    engine.updateTileRequestFocus(QPointF(0.5 / side, 0.5 / side), zoom, 1.5);
+    engine.updateTileRequests(fakeMap(0), block(0, 4, zoom, 4), QSet<QGeoTileSpec>());
+
+    QTRY_COMPARE(fetcher->requested().size(), 1);
+    QCOMPARE(fetcher->requested().first(), QGeoTileSpec("plugin", 1, zoom, 0, 0));
+
+    for (int i = 1; i < 4; ++i) {
+        QSet<QGeoTileSpec> done;
+        done << fetcher->requested().last();
+        engine.updateTileRequests(fakeMap(0), QSet<QGeoTileSpec>(), done);
+        QTRY_COMPARE(fetcher->requested().size(), i + 1);
+    }
+
+    // the visible ones come first
+    QSet<QGeoTileSpec> visible;
+    visible << QGeoTileSpec("plugin", 1, zoom, 0, 0) << QGeoTileSpec("plugin", 1, zoom, 1, 0)
+            << QGeoTileSpec("plugin", 1, zoom, 0, 1) << QGeoTileSpec("plugin", 1, zoom, 1, 1);
+    QCOMPARE(fetcher->requested().toSet(), visible);
+
+    // then, after the camera moved to the far corner, the tile under it
+    engine.updateTileRequestFocus(QPointF(3.5 / side, 3.5 / side), zoom, 1.5);
+    QSet<QGeoTileSpec> done;
+    done << fetcher->requested().last();
+    engine.updateTileRequests(fakeMap(0), QSet<QGeoTileSpec>(), done);
+    QTRY_COMPARE(fetcher->requested().size(), 5);
+    QCOMPARE(fetcher->requested().last(), QGeoTileSpec("plugin", 1, zoom, 3, 3));
+}
+
+void tst_QGeoTiledMappingManagerEngine::fetchCancel()
+{
+    TestEngine engine(1);
+    RecordingFetcher *fetcher = engine.fetcher_;
+
+    QSet<QGeoTileSpec> tiles = column(0, 5, 3);
+    engine.updateTileRequests(fakeMap(0), tiles, QSet<QGeoTileSpec>());
+    QTRY_COMPARE(fetcher->requested().size(), 1);
+
+    // a queued tile is dropped without ever being requested
+    QGeoTileSpec inFlight = fetcher->requested().first();
+    QGeoTileSpec queued = (tiles - (QSet<QGeoTileSpec>() << inFlight)).toList().first();
+    engine.updateTileRequests(fakeMap(0), QSet<QGeoTileSpec>(),
+                              QSet<QGeoTileSpec>() << queued);
+
+    // and one in flight is aborted
+    engine.updateTileRequests(fakeMap(0), QSet<QGeoTileSpec>(),
+                              QSet<QGeoTileSpec>() << inFlight);
+    QTRY_COMPARE(fetcher->requested().size(), 2);
+    QCOMPARE(fetcher->aborted(), QList<QGeoTileSpec>() << inFlight);
+
+    QGeoTileSpec last = fetcher->requested().last();
+    QVERIFY(!(last == queued));
+    engine.updateTileRequests(fakeMap(0), QSet<QGeoTileSpec>(),
+                              QSet<QGeoTileSpec>() << last);
+    QTRY_COMPARE(fetcher->aborted().size(), 2);
+    QCOMPARE(fetcher->requested().size(), 2);
+    QVERIFY(!fetcher->requested().contains(queued));
+}
+
+void tst_QGeoTiledMappingManagerEngine::fetchWindow()
+{
+    TestEngine engine(3);
+    RecordingFetcher *fetcher = engine.fetcher_;
+
+    engine.updateTileRequests(fakeMap(0), block(0, 5, 5, 2), QSet<QGeoTileSpec>());
+
+    // no more than the window is in flight
+    QTRY_COMPARE(fetcher->requested().size(), 3);
+    QTest::qWait(50);
+    QCOMPARE(fetcher->requested().size(), 3);
+
+    // and freeing a slot lets exactly one more through
+    engine.updateTileRequests(fakeMap(0), QSet<QGeoTileSpec>(),
+                              QSet<QGeoTileSpec>() << fetcher->requested().first());
+    QTRY_COMPARE(fetcher->requested().size(), 4);
+    QTest::qWait(50);
+    QCOMPARE(fetcher->requested().size(), 4);
+    QCOMPARE(fetcher->aborted().size(), 1);
+}
+
+void tst_QGeoTiledMappingManagerEngine::seedTiles()
+{
+    QTemporaryDir dir;
+    TestEngine engine;
+    engine.setCacheDirectory(dir.path());
+    engine.setSeedingRate(1000);
+    RecordingFetcher *fetcher = engine.fetcher_;
+    fetcher->setFinishReplies(true);
+
+    QGeoRectangle area(QGeoCoordinate(20.0, 10.0), QGeoCoordinate(10.0, 20.0));
+    int total = areaTileCount(area, 3, 6);
+    QVERIFY(total > 0);
+
+    QSignalSpy progress(&engine, SIGNAL(seedingProgress(int,int,int)));
+    QSignalSpy finished(&engine, SIGNAL(seedingFinished(bool)));
+
+    QVERIFY(engine.seedTiles(area, 3, 6, QGeoMapType()));
+    QVERIFY(engine.isSeeding());
+
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(finished.first().at(0).toBool(), false);
+    QVERIFY(!engine.isSeeding());
+    QCOMPARE(fetcher->requested().size(), total);
+
+    // one step per tile, the last one complete
+    QCOMPARE(progress.count(), total);
+    QCOMPARE(progress.last().at(0).toInt(), total);
+    QCOMPARE(progress.last().at(1).toInt(), 0);
+    QCOMPARE(progress.last().at(2).toInt(), total);
+
+    // the tiles are on disk now, seeding again doesn't fetch any of them
+    progress.clear();
+    QVERIFY(engine.seedTiles(area, 3, 6, QGeoMapType()));
+    QTRY_COMPARE(finished.count(), 2);
+    QCOMPARE(fetcher->requested().size(), total);
+    QVERIFY(!progress.isEmpty());
+    QCOMPARE(progress.last().at(0).toInt(), total);
+}
+
+void tst_QGeoTiledMappingManagerEngine::cancelSeeding()
+{
+    QTemporaryDir dir;
+    TestEngine engine;
+    engine.setCacheDirectory(dir.path());
+    engine.setSeedingRate(1000);
+    RecordingFetcher *fetcher = engine.fetcher_;
+
+    QSignalSpy progress(&engine, SIGNAL(seedingProgress(int,int,int)));
+    QSignalSpy finished(&engine, SIGNAL(seedingFinished(bool)));
+
+    QGeoRectangle area(QGeoCoordinate(20.0, 10.0), QGeoCoordinate(10.0, 20.0));
+    QVERIFY(engine.seedTiles(area, 3, 8, QGeoMapType()));
+    QTRY_VERIFY(fetcher->requested().size() >= 4);
+
+    engine.cancelSeeding();
+    QVERIFY(!engine.isSeeding());
+    QCOMPARE(finished.count(), 1);
+    QCOMPARE(finished.first().at(0).toBool(), true);
+
+    // everything sent is withdrawn and nothing more is asked for
+    QTRY_COMPARE(fetcher->aborted().toSet(), fetcher->requested().toSet());
+    int requested = fetcher->requested().size();
+    QTest::qWait(50);
+    QCOMPARE(fetcher->requested().size(), requested);
+    QCOMPARE(progress.count(), 0);
+
+    // canceling twice doesn't report anything
+    engine.cancelSeeding();
+    QCOMPARE(finished.count(), 1);
+}
+
+void tst_QGeoTiledMappingManagerEngine::seedInFlight()
+{
+    QTemporaryDir dir;
+    TestEngine engine;
+    engine.setCacheDirectory(dir.path());
+    engine.setSeedingRate(1000);
+    RecordingFetcher *fetcher = engine.fetcher_;
+
+    QGeoRectangle area(QGeoCoordinate(20.0, 10.0), QGeoCoordinate(10.0, 20.0));
+    int total = areaTileCount(area, 5, 6);
+    QVERIFY(total > 1);
+    QVERIFY(engine.seedTiles(area, 5, 6, QGeoMapType()));
+    QTRY_COMPARE(fetcher->requested().size(), total);
+
+    // a map asking for a tile the seeding is fetching shares the request
+    QGeoTileSpec shared = fetcher->requested().first();
+    engine.updateTileRequests(fakeMap(0), QSet<QGeoTileSpec>() << shared, QSet<QGeoTileSpec>());
+    QTest::qWait(50);
+    QCOMPARE(fetcher->requested().size(), total);
+
+    // which outlives the seeding
+    engine.cancelSeeding();
+    QTRY_COMPARE(fetcher->aborted().size(), total - 1);
+    QVERIFY(!fetcher->aborted().contains(shared));
+}
+
+void tst_QGeoTiledMappingManagerEngine::seedQueueCap()
+{
+    QTemporaryDir dir;
+    TestEngine engine;
+    engine.setCacheDirectory(dir.path());
+    engine.setSeedingRate(1000);
+    engine.fetcher_->setFinishReplies(true);
+
+    QGeoRectangle world(QGeoCoordinate(85.0, -180.0), QGeoCoordinate(-85.0, 180.0));
+
+    // about a billion tiles, refused without enumerating them
+    QTest::ignoreMessage(QtWarningMsg, "Not seeding zoom levels 15 to 15 of the area, "
+                                       "more than 65536 tiles would be queued");
+    QVERIFY(!engine.seedTiles(world, 15, 15, QGeoMapType()));
+    QVERIFY(!engine.isSeeding());
+
+    // the coarse levels fit, level 8 alone would fill the queue
+    QSignalSpy progress(&engine, SIGNAL(seedingProgress(int,int,int)));
+    QTest::ignoreMessage(QtWarningMsg, "Not seeding zoom levels 8 to 20 of the area, "
+                                       "more than 65536 tiles would be queued");
+    QVERIFY(engine.seedTiles(world, 0, 20, QGeoMapType()));
+    QTRY_VERIFY(!progress.isEmpty());
+    QCOMPARE(progress.first().at(2).toInt(), areaTileCount(world, 0, 7));
+
+    engine.cancelSeeding();
+}
+
+void tst_QGeoTiledMappingManagerEngine::perFrame_data()
+{
+    QTest::addColumn<int>("maps");
+
+    QTest::newRow("1 map") << 1;
+    QTest::newRow("4 maps") << 4;
+    QTest::newRow("8 maps") << 8;
+}
+
+/*
+    Every map pans by one column of tiles per frame over a view of 8 x 6
+    tiles, with neighbouring maps sharing half of their view. One iteration
+    is one frame, the time the GUI thread spends handing the deltas of all
+    maps to the fetcher.
+*/
+void tst_QGeoTiledMappingManagerEngine::perFrame()
+{
+    QFETCH(int, maps);
+
+    const int width = 8;
+    const int height = 6;
+    const int zoom = 16;
+
+    TestEngine engine;
+
+    QVector<int> left(maps);
+    for (int m = 0; m < maps; ++m) {
+        left[m] = m * width / 2;
+        engine.updateTileRequests(fakeMap(m), block(left[m], width, zoom, height),
+                                  QSet<QGeoTileSpec>());
+    }
+
+    // precompute the deltas, the camera side is not what is measured here
+    const int frames = 64;
+    QVector<QVector<QPair<QSet<QGeoTileSpec>, QSet<QGeoTileSpec> > > > deltas(maps);
+    for (int m = 0; m < maps; ++m) {
+        for (int f = 0; f < frames; ++f) {
+            int x = left[m] + f;
+            deltas[m].append(qMakePair(column(x + width, zoom, height), column(x, zoom, height)));
+        }
+    }
+
+    int frame = 0;
+
+    QBENCHMARK {
+        // go back and forth so the views stay bounded
+        bool back = (frame / frames) % 2;
+        int f = back ? frames - 1 - frame % frames : frame % frames;
+
+        for (int m = 0; m < maps; ++m) {
+            const QPair<QSet<QGeoTileSpec>, QSet<QGeoTileSpec> > &d = deltas[m].at(f);
+            if (back)
+                engine.updateTileRequests(fakeMap(m), d.second, d.first);
+            else
+                engine.updateTileRequests(fakeMap(m), d.first, d.second);
+        }
+        ++frame;
+    }
+}
+
+QTEST_MAIN(tst_QGeoTiledMappingManagerEngine)
+
+#include "tst_qgeotiledmappingmanagerengine.moc"
@@ -43,6 +43,10 @@
 #include <QtTest/QtTest>
 
 #include "qgeotilespec_p.h"
+#include "qgeotilekey_p.h"
+
+#include <QHash>
+#include <QSet>
 
 QT_USE_NAMESPACE
 
@@ -72,6 +76,13 @@ private Q_SLOTS:
     void lessThanOperatorTest();
     void qHashTest_data();
     void qHashTest();
+    void keyTest_data();
+    void keyTest();
+    void keyRange();
+    void hashDistribution_data();
+    void hashDistribution();
+    void keyLookup_data();
+    void keyLookup();
 };
 
 tst_QGeoTileSpec::tst_QGeoTileSpec()
@@ -325,6 +336,145 @@ void tst_QGeoTileSpec::qHashTest()
     QVERIFY(hash2 != hash3);
 }
 
+void tst_QGeoTileSpec::keyTest_data()
+{
+    populateGeoTileSpecData();
+}
+
+void tst_QGeoTileSpec::keyTest()
+{
+    QFETCH(QString,plugin);
+    QFETCH(int,mapId);
+    QFETCH(int,zoom);
+    QFETCH(int,x);
+    QFETCH(int,y);
+
+    QGeoTileSpec spec(plugin, mapId, zoom, x, y);
+    QGeoTileKey key = spec.key();
+    QCOMPARE(key.pluginId(), spec.pluginId());
+    QCOMPARE(QGeoTileSpec::pluginName(key.pluginId()), plugin);
+    QCOMPARE(key, QGeoTileSpec(plugin, mapId, zoom, x, y).key());
+    QCOMPARE(qHash(key), qHash(spec));
+
+    // specs inside the packed ranges survive the round trip unchanged
+    if (mapId >= 0 && mapId < 1024 && x >= 0 && y >= 0) {
+        QGeoTileSpec spec2 = key.toTileSpec();
+        QVERIFY(spec2 == spec);
+    }
+
+    QGeoTileSpec spec3(plugin + QLatin1String("other"), mapId, zoom, x, y);
+    QVERIFY(spec3.pluginId() != spec.pluginId());
+    QVERIFY(spec3.key() != key);
+
+    QGeoTileKey empty;
+    QVERIFY(empty == QGeoTileSpec().key());
+    QCOMPARE(empty.zoom(), -1);
+    QCOMPARE(empty.x(), -1);
+    QCOMPARE(empty.y(), -1);
+}
+
+void tst_QGeoTileSpec::keyRange()
+{
+    // the last tile of the deepest zoom level is not mistaken for unset
+    const int zoom = QGeoTileKey::MaxZoom;
+    const int last = (1 << zoom) - 1;
+    QGeoTileSpec spec(QString("geo plugin"), 1023, zoom, last, last);
+    QGeoTileKey key = spec.key();
+    QCOMPARE(key.zoom(), zoom);
+    QCOMPARE(key.x(), last);
+    QCOMPARE(key.y(), last);
+    QVERIFY(key.toTileSpec() == spec);
+    QVERIFY(key != QGeoTileKey());
+
+    // as read back from a pack index
+    QGeoTileKey stored = QGeoTileKey::fromPacked(key.pluginId(), key.packed());
+    QCOMPARE(stored, key);
+    QVERIFY(stored.toTileSpec() == spec);
+}
+
+void tst_QGeoTileSpec::hashDistribution_data()
+{
+    QTest::addColumn<int>("zoom");
+    QTest::newRow("zoom 7, 16k tiles") << 7;
+    QTest::newRow("zoom 8, 65k tiles") << 8;
+}
+
+// Fill a bucket array the size QHash would use for every tile of a zoom
+// level and check how many buckets end up occupied.
+void tst_QGeoTileSpec::hashDistribution()
+{
+    QFETCH(int, zoom);
+
+    const int side = 1 << zoom;
+    const int count = side * side;
+    int buckets = 1;
+    while (buckets < count)
+        buckets <<= 1;
+    buckets -= 1;   // odd, like the primes QHash picks
+
+    QVector<int> occupancy(buckets);
+    for (int x = 0; x < side; ++x) {
+        for (int y = 0; y < side; ++y)
+            ++occupancy[qHash(QGeoTileSpec(QStringLiteral("plugin"), 1, zoom, x, y)) % buckets];
+    }
+
+    int used = 0;
+    int longest = 0;
+    for (int i = 0; i < buckets; ++i) {
+        if (occupancy.at(i) > 0)
+            ++used;
+        longest = qMax(longest, occupancy.at(i));
+    }
+
+    // a uniform hash fills about 1 - 1/e of the buckets at load factor 1
+    QVERIFY(used > buckets / 2);
+    QVERIFY(longest < 16);
+}
+
+void tst_QGeoTileSpec::keyLookup_data()
+{
+    QTest::addColumn<bool>("useKey");
+    QTest::newRow("QGeoTileSpec") << false;
+    QTest::newRow("QGeoTileKey") << true;
+}
+
+void tst_QGeoTileSpec::keyLookup()
+{
+    QFETCH(bool, useKey);
+
+    const int side = 128;
+    QHash<QGeoTileSpec, int> specHash;
+    QHash<QGeoTileKey, int> keyHash;
+    QVector<QGeoTileSpec> specs;
+    for (int x = 0; x < side; ++x) {
+        for (int y = 0; y < side; ++y) {
+            QGeoTileSpec spec(QStringLiteral("plugin"), 1, 7, x, y);
+            specs.append(spec);
+            specHash.insert(spec, x);
+            keyHash.insert(spec.key(), x);
+        }
+    }
+
+    int found = 0;
+    if (useKey) {
+        QVector<QGeoTileKey> keys;
+        foreach (const QGeoTileSpec &spec, specs)
+            keys.append(spec.key());
+        QBENCHMARK {
+            found = 0;
+            foreach (const QGeoTileKey &key, keys)
+                found += keyHash.contains(key) ? 1 : 0;
+        }
+    } else {
+        QBENCHMARK {
+            found = 0;
+            foreach (const QGeoTileSpec &spec, specs)
+                found += specHash.contains(spec) ? 1 : 0;
+        }
+    }
+    QCOMPARE(found, side * side);
+}
+
 QTEST_APPLESS_MAIN(tst_QGeoTileSpec)
 
 #include "tst_qgeotilespec.moc"
@@ -0,0 +1,8 @@
+CONFIG += testcase
+TARGET = tst_qshardedcache3q
+
+INCLUDEPATH += ../../../src/location/maps
+
+SOURCES += tst_qshardedcache3q.cpp
+
+QT += location testlib
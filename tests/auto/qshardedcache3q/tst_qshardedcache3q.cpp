@@ -0,0 +1,250 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qshardedcache3q_p.h"
+
+#include <QtTest/QtTest>
+#include <QAtomicInt>
+#include <QThread>
+
+QT_USE_NAMESPACE
+
+static QAtomicInt liveObjects;
+static QAtomicInt evictedObjects;
+
+class CountedObject
+{
+public:
+    explicit CountedObject(int v) : value(v) { liveObjects.ref(); }
+    ~CountedObject() { liveObjects.deref(); }
+    int value;
+};
+
+class CountingPolicy : public QCache3QDefaultEvictionPolicy<int, CountedObject>
+{
+protected:
+    void aboutToBeEvicted(const int &key, QSharedPointer<CountedObject> obj)
+    {
+        Q_UNUSED(key);
+        Q_UNUSED(obj);
+        evictedObjects.ref();
+    }
+};
+
+typedef QShardedCache3Q<int, CountedObject, CountingPolicy> TestCache;
+
+// Mixes lookups and inserts over a key range the cache can't hold at once,
+// like the GUI or render thread looking up tiles while the fetcher inserts.
+class CacheWorker : public QThread
+{
+public:
+    CacheWorker(TestCache *cache, int seed, int operations, int keyRange, int insertPercent)
+        : cache_(cache), seed_(seed), operations_(operations),
+          keyRange_(keyRange), insertPercent_(insertPercent), hits(0), mismatches(0) {}
+
+    void run()
+    {
+        quint32 state = seed_ * 2654435761u + 1;
+        for (int i = 0; i < operations_; ++i) {
+            state = state * 1664525u + 1013904223u;
+            int key = (state >> 8) % keyRange_;
+            if (int((state >> 4) % 100) < insertPercent_) {
+                cache_->insert(key, QSharedPointer<CountedObject>(new CountedObject(key)), 1 + (key % 3));
+            } else {
+                QSharedPointer<CountedObject> obj = cache_->object(key);
+                if (obj) {
+                    ++hits;
+                    if (obj->value != key)
+                        ++mismatches;
+                }
+            }
+        }
+    }
+
+private:
+    TestCache *cache_;
+    int seed_;
+    int operations_;
+    int keyRange_;
+    int insertPercent_;
+
+public:
+    int hits;
+    int mismatches;
+};
+
+class tst_QShardedCache3Q : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void insertAndLookup();
+    void globalBudget();
+    void stats();
+    void concurrentStress_data();
+    void concurrentStress();
+};
+
+void tst_QShardedCache3Q::init()
+{
+    liveObjects.store(0);
+    evictedObjects.store(0);
+}
+
+void tst_QShardedCache3Q::insertAndLookup()
+{
+    TestCache cache(100, 4);
+    QCOMPARE(cache.shardCount(), 4);
+
+    for (int i = 0; i < 20; ++i)
+        QVERIFY(cache.insert(i, QSharedPointer<CountedObject>(new CountedObject(i))));
+
+    for (int i = 0; i < 20; ++i) {
+        QVERIFY(cache.contains(i));
+        QSharedPointer<CountedObject> obj = cache.object(i);
+        QVERIFY(obj);
+        QCOMPARE(obj->value, i);
+    }
+    QVERIFY(!cache.object(20));
+
+    cache.remove(3);
+    QVERIFY(!cache.contains(3));
+    QVERIFY(!cache.object(3));
+    QCOMPARE(cache.totalCost(), 19);
+
+    cache.clear();
+    QCOMPARE(cache.totalCost(), 0);
+    QCOMPARE(liveObjects.load(), 0);
+}
+
+void tst_QShardedCache3Q::globalBudget()
+{
+    TestCache cache(1002, 4);
+    QCOMPARE(cache.maxCost(), 1002);
+    QCOMPARE(cache.stats().maxCost, 1002);
+
+    for (int i = 0; i < 5000; ++i)
+        cache.insert(i, QSharedPointer<CountedObject>(new CountedObject(i)));
+    QVERIFY(cache.totalCost() <= 1002);
+    QVERIFY(evictedObjects.load() >= 5000 - 1002);
+
+    // a shard's share is the limit for a single object
+    QVERIFY(!cache.insert(-1, QSharedPointer<CountedObject>(new CountedObject(-1)), 300));
+
+    cache.setMaxCost(100);
+    QVERIFY(cache.totalCost() <= 100);
+}
+
+void tst_QShardedCache3Q::stats()
+{
+    TestCache cache(100, 2);
+    for (int i = 0; i < 10; ++i)
+        cache.insert(i, QSharedPointer<CountedObject>(new CountedObject(i)));
+    for (int i = 0; i < 15; ++i)
+        cache.object(i);
+
+    QCache3QStats s = cache.stats();
+    QCOMPARE(s.hits, quint64(10));
+    QCOMPARE(s.misses, quint64(5));
+    QCOMPARE(s.count, 10);
+    QCOMPARE(s.cost, 10);
+    QCOMPARE(s.costIn, qint64(10));
+
+    cache.resetStats();
+    s = cache.stats();
+    QCOMPARE(s.hits, quint64(0));
+    QCOMPARE(s.count, 10);
+}
+
+void tst_QShardedCache3Q::concurrentStress_data()
+{
+    QTest::addColumn<int>("shards");
+    QTest::newRow("single lock") << 1;
+    QTest::newRow("sharded") << 16;
+}
+
+// One writer and several readers hammering the same cache. Checks that
+// objects come back intact, the budget holds and nothing leaks; the timings
+// of the two rows show what sharding buys over a single lock.
+void tst_QShardedCache3Q::concurrentStress()
+{
+    QFETCH(int, shards);
+
+    const int readers = qMax(2, QThread::idealThreadCount() - 1);
+    const int operations = 200000;
+    const int keyRange = 4096;
+    const int maxCost = 2048;
+
+    {
+        TestCache cache(maxCost, shards);
+
+        QList<CacheWorker *> workers;
+        workers << new CacheWorker(&cache, 0, operations, keyRange, 100);
+        for (int i = 1; i <= readers; ++i)
+            workers << new CacheWorker(&cache, i, operations, keyRange, 10);
+
+        QBENCHMARK_ONCE {
+            foreach (CacheWorker *worker, workers)
+                worker->start();
+            foreach (CacheWorker *worker, workers)
+                QVERIFY(worker->wait(60000));
+        }
+
+        int hits = 0;
+        foreach (CacheWorker *worker, workers) {
+            QCOMPARE(worker->mismatches, 0);
+            hits += worker->hits;
+        }
+        qDeleteAll(workers);
+
+        QVERIFY(cache.totalCost() <= maxCost);
+        QCache3QStats s = cache.stats();
+        QCOMPARE(int(s.hits), hits);
+        QVERIFY(s.evictions > 0);
+    }
+
+    QCOMPARE(liveObjects.load(), 0);
+}
+
+QTEST_MAIN(tst_QShardedCache3Q)
+
+#include "tst_qshardedcache3q.moc"